@@ -0,0 +1,212 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/analysis.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <type_traits>
+
+namespace djehuti {
+namespace audio {
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// An in-place, iterative radix-2 FFT of one size, with its twiddle factors and bit-reversal
+// permutation worked out ahead of time.
+class Fft {
+ public:
+    explicit Fft(size_t size) : size_(size), twiddles_(size / 2u), reversed_(size) {
+        for (size_t k = 0u; k < size / 2u; ++k) {
+            twiddles_[k] = std::polar(1.0, -2.0 * M_PI * static_cast<double>(k) /
+                                               static_cast<double>(size));
+        }
+        size_t bits = 0u;
+        while ((size_t{1} << bits) < size) {
+            ++bits;
+        }
+        for (size_t i = 0u; i < size; ++i) {
+            size_t r = 0u;
+            for (size_t b = 0u; b < bits; ++b) {
+                r |= ((i >> b) & 1u) << (bits - 1u - b);
+            }
+            reversed_[i] = static_cast<uint32_t>(r);
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    void transform(Complex *data) const {
+        for (size_t i = 0u; i < size_; ++i) {
+            if (i < reversed_[i]) {
+                std::swap(data[i], data[reversed_[i]]);
+            }
+        }
+        for (size_t half = 1u; half < size_; half *= 2u) {
+            const size_t stride = size_ / (2u * half);
+            for (size_t start = 0u; start < size_; start += 2u * half) {
+                for (size_t k = 0u; k < half; ++k) {
+                    const Complex t = twiddles_[k * stride] * data[start + k + half];
+                    data[start + k + half] = data[start + k] - t;
+                    data[start + k] += t;
+                }
+            }
+        }
+    }
+
+ private:
+    size_t size_;
+    std::vector<Complex> twiddles_;
+    std::vector<uint32_t> reversed_;
+};
+
+template <typename SampleType>
+constexpr double full_scale() {
+    return std::is_integral<SampleType>::value
+               ? -static_cast<double>(std::numeric_limits<SampleType>::min())
+               : 1.0;
+}
+
+// Adds the power spectrum of each channel's frames to its row of power. The channels are taken
+// two at a time, one as the real part and the other as the imaginary part of one complex FFT,
+// and then pulled apart using the symmetry of the spectra of real signals.
+template <typename SampleType>
+void add_power(const AudioView<SampleType> &clip,
+               const Fft &fft,
+               const std::vector<double> &window,
+               std::vector<std::vector<double>> *power) {
+    const size_t n = fft.size();
+    const double scale = 1.0 / full_scale<SampleType>();
+    std::vector<Complex> data(n);
+    const size_t num_frames = clip.length() / n;
+    for (size_t c = 0u; c < clip.num_channels(); c += 2u) {
+        const bool pair = c + 1u < clip.num_channels();
+        std::vector<double> &first = (*power)[c];
+        std::vector<double> &second = (*power)[pair ? c + 1u : c];
+        for (size_t frame = 0u; frame < num_frames; ++frame) {
+            const size_t offset = frame * n;
+            for (size_t i = 0u; i < n; ++i) {
+                const double w = window[i] * scale;
+                const double re = static_cast<double>(clip.at(offset + i, c)) * w;
+                const double im = pair ? static_cast<double>(clip.at(offset + i, c + 1u)) * w : 0.0;
+                data[i] = Complex(re, im);
+            }
+            fft.transform(data.data());
+            for (size_t k = 1u; k < n / 2u; ++k) {
+                const Complex z = data[k];
+                const Complex mirror = std::conj(data[n - k]);
+                if (pair) {
+                    first[k] += std::norm(0.5 * (z + mirror));
+                    second[k] += std::norm(0.5 * (z - mirror));
+                } else {
+                    first[k] += std::norm(z);
+                }
+            }
+        }
+    }
+}
+
+// Returns the frequency at the peak of the power spectrum, or nothing if it's all zero.
+std::optional<Frequency> dominant(const std::vector<double> &power,
+                                  size_t frame_size,
+                                  Frequency sample_rate) {
+    const auto peak = std::max_element(power.begin() + 1, power.end() - 1);
+    if (*peak <= 0.0) {
+        return std::nullopt;
+    }
+    const auto k = static_cast<size_t>(peak - power.begin());
+    // Fit a parabola to the log power of the peak bin and its neighbors (which is close to
+    // exact for a Hann window) to find where between the bins the peak really is.
+    double offset = 0.0;
+    if (power[k - 1u] > 0.0 && power[k + 1u] > 0.0) {
+        const double a = std::log(power[k - 1u]);
+        const double b = std::log(power[k]);
+        const double c = std::log(power[k + 1u]);
+        const double denominator = a - 2.0 * b + c;
+        if (denominator < 0.0) {
+            offset = std::clamp(0.5 * (a - c) / denominator, -0.5, 0.5);
+        }
+    }
+    return Frequency::from_hertz((static_cast<double>(k) + offset) * sample_rate.hertz() /
+                                 static_cast<double>(frame_size));
+}
+
+template <typename SampleType>
+std::vector<ChannelAnalysis> analyze_clip(const AudioView<SampleType> &clip,
+                                          Frequency sample_rate) {
+    const size_t num_channels = clip.num_channels();
+    std::vector<ChannelAnalysis> result(num_channels);
+
+    // Peak and RMS, in one pass over the frames.
+    std::vector<double> peaks(num_channels, 0.0);
+    std::vector<double> squares(num_channels, 0.0);
+    for (size_t i = 0u; i < clip.length(); ++i) {
+        for (size_t c = 0u; c < num_channels; ++c) {
+            const double x = static_cast<double>(clip.at(i, c));
+            peaks[c] = std::max(peaks[c], std::abs(x));
+            squares[c] += x * x;
+        }
+    }
+    const double scale = full_scale<SampleType>();
+    for (size_t c = 0u; c < num_channels; ++c) {
+        result[c].peak = peaks[c] / scale;
+        if (clip.length() != 0u) {
+            result[c].rms = std::sqrt(squares[c] / static_cast<double>(clip.length())) / scale;
+        }
+    }
+
+    // The spectrum, in the biggest power-of-two frames that fit (up to FRAME_SIZE).
+    if (clip.length() < MIN_FRAME_SIZE) {
+        return result;
+    }
+    size_t frame_size = MIN_FRAME_SIZE;
+    while (frame_size < FRAME_SIZE && frame_size * 2u <= clip.length()) {
+        frame_size *= 2u;
+    }
+    const Fft fft(frame_size);
+    std::vector<double> window(frame_size);
+    for (size_t i = 0u; i < frame_size; ++i) {
+        window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * static_cast<double>(i) /
+                                         static_cast<double>(frame_size));
+    }
+    std::vector<std::vector<double>> power(num_channels, std::vector<double>(frame_size / 2u));
+    add_power(clip, fft, window, &power);
+    for (size_t c = 0u; c < num_channels; ++c) {
+        result[c].dominant = dominant(power[c], frame_size, sample_rate);
+    }
+    return result;
+}
+
+}  // namespace
+
+std::vector<ChannelAnalysis> analyze(const AudioView<int16_t> &clip, Frequency sample_rate) {
+    return analyze_clip(clip, sample_rate);
+}
+
+std::vector<ChannelAnalysis> analyze(const AudioView<float> &clip, Frequency sample_rate) {
+    return analyze_clip(clip, sample_rate);
+}
+
+}  // namespace audio
+}  // namespace djehuti
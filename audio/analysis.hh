@@ -0,0 +1,58 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "audio/audioview.hh"
+#include "audio/frequency.hh"
+
+namespace djehuti {
+namespace audio {
+
+/// What analyze() finds in one channel of a clip.
+struct ChannelAnalysis {
+    /// The largest absolute sample, as a fraction of full scale.
+    double peak = 0.0;
+    /// The root-mean-square level, as a fraction of full scale.
+    double rms = 0.0;
+    /// The frequency with the most power, unless the channel is silent or too short to tell.
+    std::optional<Frequency> dominant;
+};
+
+/**
+ * Analyze each channel of a clip. Integer samples are scaled so that full scale is 1, and float
+ * samples are taken as they are. The dominant frequency comes from the power spectrum averaged
+ * over Hann-windowed frames of up to FRAME_SIZE samples (Welch's method), refined between bins
+ * by fitting a parabola to the peak; clips shorter than MIN_FRAME_SIZE samples don't have one.
+ */
+std::vector<ChannelAnalysis> analyze(const AudioView<int16_t> &clip, Frequency sample_rate);
+std::vector<ChannelAnalysis> analyze(const AudioView<float> &clip, Frequency sample_rate);
+
+/// The largest frame analyze() takes the spectrum of.
+constexpr size_t FRAME_SIZE = 8192u;
+/// The smallest.
+constexpr size_t MIN_FRAME_SIZE = 64u;
+
+}  // namespace audio
+}  // namespace djehuti
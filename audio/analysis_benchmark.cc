@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "audio/analysis.hh"
+#include "audio/audioview.hh"
+#include "audio/wav.hh"
+#include "util/benchmark.hh"
+
+// What dumb_server does with an /analyze request, from the bytes of the body to the numbers in
+// the reply: finding the samples in a WAV file, viewing them in place and analyzing them, for
+// stereo 16-bit clips 1, 10 and 60 seconds long.
+
+int main() {
+    using namespace djehuti;
+    constexpr uint32_t RATE = 48000u;
+    for (const size_t seconds : {1u, 10u, 60u}) {
+        const size_t length = seconds * RATE;
+        std::vector<int16_t> samples(length * 2u);
+        for (size_t i = 0u; i < length; ++i) {
+            const double t = static_cast<double>(i) / RATE;
+            samples[2u * i] = static_cast<int16_t>(8000.0 * std::sin(2.0 * M_PI * 440.0 * t));
+            samples[2u * i + 1u] = static_cast<int16_t>(4000.0 * std::sin(2.0 * M_PI * 660.0 * t));
+        }
+        const std::string wav = audio::write_wav(
+            {audio::SampleFormat::S16, 2u, RATE,
+             std::string_view(reinterpret_cast<const char *>(samples.data()),
+                              samples.size() * sizeof(int16_t))});
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "analyze %zu s", seconds);
+        benchmark::run(name, [&] {
+            const auto clip = audio::parse_wav(wav);
+            const auto view = audio::AudioView<int16_t>::from_bytes(
+                clip->samples.data(), clip->samples.size(), clip->num_channels);
+            benchmark::do_not_optimize(
+                audio::analyze(*view, audio::Frequency::from_hertz(clip->sample_rate)));
+        }, length, wav.size());
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/analysis.hh"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace audio {
+
+namespace {
+
+// Interleaved sine tones, one per channel, at the given frequencies and amplitudes.
+std::vector<float> tones(const std::vector<std::pair<double, double>> &channels,
+                         size_t length,
+                         double sample_rate) {
+    std::vector<float> samples(length * channels.size());
+    for (size_t i = 0u; i < length; ++i) {
+        for (size_t c = 0u; c < channels.size(); ++c) {
+            const double t = static_cast<double>(i) / sample_rate;
+            samples[i * channels.size() + c] = static_cast<float>(
+                channels[c].second * std::sin(2.0 * M_PI * channels[c].first * t));
+        }
+    }
+    return samples;
+}
+
+}  // namespace
+
+TEST(AnalysisTest, Float) {
+    const double rate = 48000.0;
+    const auto samples = tones({{440.0, 0.5}, {1234.5, 0.25}, {97.0, 1.0}}, 48000u, rate);
+    const auto result =
+        analyze(AudioView<float>(samples.data(), 48000u, 3u), Frequency::from_hertz(rate));
+    ASSERT_EQ(result.size(), 3u);
+    const double expected[][3] = {{440.0, 0.5}, {1234.5, 0.25}, {97.0, 1.0}};
+    for (size_t c = 0u; c < 3u; ++c) {
+        EXPECT_NEAR(result[c].peak, expected[c][1], 1e-3) << c;
+        EXPECT_NEAR(result[c].rms, expected[c][1] / std::sqrt(2.0), 1e-3) << c;
+        ASSERT_TRUE(result[c].dominant) << c;
+        EXPECT_NEAR(result[c].dominant->hertz(), expected[c][0], 0.5) << c;
+    }
+}
+
+TEST(AnalysisTest, Int16) {
+    const double rate = 44100.0;
+    const auto tone = tones({{880.0, 0.5}, {220.0, 0.125}}, 10000u, rate);
+    std::vector<int16_t> samples(tone.size());
+    for (size_t i = 0u; i < tone.size(); ++i) {
+        samples[i] = static_cast<int16_t>(std::lround(tone[i] * 32768.0));
+    }
+    const auto result =
+        analyze(AudioView<int16_t>(samples.data(), 10000u, 2u), Frequency::from_hertz(rate));
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_NEAR(result[0].peak, 0.5, 1e-3);
+    EXPECT_NEAR(result[1].rms, 0.125 / std::sqrt(2.0), 1e-3);
+    ASSERT_TRUE(result[0].dominant);
+    ASSERT_TRUE(result[1].dominant);
+    EXPECT_NEAR(result[0].dominant->hertz(), 880.0, 1.0);
+    EXPECT_NEAR(result[1].dominant->hertz(), 220.0, 1.0);
+}
+
+TEST(AnalysisTest, Quiet) {
+    const std::vector<int16_t> silence(4096u, 0);
+    auto result =
+        analyze(AudioView<int16_t>(silence.data(), 2048u, 2u), Frequency::from_hertz(8000.0));
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0].peak, 0.0);
+    EXPECT_EQ(result[1].rms, 0.0);
+    EXPECT_FALSE(result[0].dominant);
+    EXPECT_FALSE(result[1].dominant);
+
+    // Too short to have a spectrum, but not too short to have a level.
+    const int16_t blip[] = {-32768, 16384, 0};
+    result = analyze(AudioView<int16_t>(blip, 3u), Frequency::from_hertz(8000.0));
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].peak, 1.0);
+    EXPECT_DOUBLE_EQ(result[0].rms, std::sqrt(1.25 / 3.0));
+    EXPECT_FALSE(result[0].dominant);
+
+    result = analyze(AudioView<float>(nullptr, 0u), Frequency::from_hertz(8000.0));
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].rms, 0.0);
+}
+
+}  // namespace audio
+}  // namespace djehuti
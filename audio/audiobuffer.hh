@@ -24,6 +24,8 @@
 #include <type_traits>
 #include <vector>
 
+#include "audio/audioview.hh"
+
 namespace djehuti {
 namespace audio {
 
@@ -73,9 +75,16 @@ class AudioBuffer {
     /// The number of audio channels.
     size_t num_channels() const { return num_channels_; }
 
+    /// A view of the samples, which is good until the AudioBuffer is reallocated.
+    AudioView<SampleType> view() const {
+        return AudioView<SampleType>(samples_.data(), length_, num_channels_);
+    }
+
  private:
     // Compute the index at which the given sample is stored.
-    size_t index(size_t offset, size_t channel_num) { return offset * num_channels_ + channel_num; }
+    size_t index(size_t offset, size_t channel_num) const {
+        return offset * num_channels_ + channel_num;
+    }
 
     size_t length_;
     size_t num_channels_;
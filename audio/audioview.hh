@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace djehuti {
+namespace audio {
+
+/**
+ * An AudioView is a read-only window onto interleaved samples that something else owns, such
+ * as an AudioBuffer or the bytes of a request body, with the same accessors as AudioBuffer. It
+ * is a small copyable value, and is good only as long as the samples are.
+ */
+template <typename SampleType>
+class AudioView final {
+ public:
+    /// The default constructor makes an empty view (0 samples, 0 channels).
+    AudioView() = default;
+
+    /// View length samples of each of num_channels channels, interleaved.
+    AudioView(const SampleType *samples, size_t length, size_t num_channels = 1u)
+        : samples_(samples), length_(length), num_channels_(num_channels) {}
+
+    /**
+     * View raw bytes as interleaved samples of num_channels channels, without copying them.
+     * Returns nothing if there are no channels, if the bytes aren't aligned for SampleType, or
+     * if they aren't a whole number of samples of every channel.
+     */
+    static std::optional<AudioView> from_bytes(const void *bytes,
+                                               size_t size,
+                                               size_t num_channels = 1u) {
+        static_assert(std::is_trivially_copyable<SampleType>::value,
+                      "Only plain samples can be viewed as bytes");
+        const size_t frame_size = sizeof(SampleType) * num_channels;
+        if (num_channels == 0u ||
+            reinterpret_cast<uintptr_t>(bytes) % alignof(SampleType) != 0u ||
+            size % frame_size != 0u) {
+            return std::nullopt;
+        }
+        return AudioView(static_cast<const SampleType *>(bytes), size / frame_size, num_channels);
+    }
+
+    /// Direct access to the raw samples. Is not bounds-checked.
+    const SampleType &at(size_t offset, size_t channel_num = 0u) const {
+        return samples_[offset * num_channels_ + channel_num];
+    }
+
+    /// The length of the AudioView, in samples.
+    size_t length() const { return length_; }
+
+    /// The number of audio channels.
+    size_t num_channels() const { return num_channels_; }
+
+    /// The interleaved samples.
+    const SampleType *data() const { return samples_; }
+
+ private:
+    const SampleType *samples_ = nullptr;
+    size_t length_ = 0u;
+    size_t num_channels_ = 0u;
+};
+
+}  // namespace audio
+}  // namespace djehuti
@@ -0,0 +1,80 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/audioview.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "audio/audiobuffer.hh"
+
+namespace djehuti {
+namespace audio {
+
+TEST(AudioViewTest, OfBuffer) {
+    AudioBuffer<float> buf(100u, 2u);
+    for (size_t i = 0u; i < 100u; ++i) {
+        buf.at(i, 0u) = static_cast<float>(i);
+        buf.at(i, 1u) = -static_cast<float>(i);
+    }
+    const AudioView<float> view = buf.view();
+    EXPECT_EQ(view.length(), 100u);
+    EXPECT_EQ(view.num_channels(), 2u);
+    for (size_t i = 0u; i < 100u; ++i) {
+        EXPECT_EQ(view.at(i, 0u), buf.at(i, 0u));
+        EXPECT_EQ(view.at(i, 1u), buf.at(i, 1u));
+        EXPECT_EQ(&view.at(i, 1u), &buf.at(i, 1u));
+    }
+
+    const AudioView<float> empty;
+    EXPECT_EQ(empty.length(), 0u);
+    EXPECT_EQ(empty.num_channels(), 0u);
+}
+
+TEST(AudioViewTest, FromBytes) {
+    // Three stereo frames of 16-bit samples, as they'd arrive in a request body.
+    const int16_t samples[] = {1, -1, 2, -2, 3, -3};
+    std::string body(sizeof(samples) + 1u, '\0');
+    std::memcpy(&body[0], samples, sizeof(samples));
+
+    const auto view = AudioView<int16_t>::from_bytes(body.data(), sizeof(samples), 2u);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->length(), 3u);
+    EXPECT_EQ(view->num_channels(), 2u);
+    EXPECT_EQ(view->data(), reinterpret_cast<const int16_t *>(body.data()));
+    EXPECT_EQ(view->at(2u, 0u), 3);
+    EXPECT_EQ(view->at(2u, 1u), -3);
+
+    // Not a whole number of frames.
+    EXPECT_FALSE(AudioView<int16_t>::from_bytes(body.data(), sizeof(samples) - 2u, 2u));
+    EXPECT_FALSE(AudioView<int16_t>::from_bytes(body.data(), sizeof(samples) + 1u, 1u));
+    // Misaligned.
+    EXPECT_FALSE(AudioView<int16_t>::from_bytes(body.data() + 1, 2u, 1u));
+    // No channels.
+    EXPECT_FALSE(AudioView<int16_t>::from_bytes(body.data(), 0u, 0u));
+    // Empty is fine.
+    EXPECT_EQ(AudioView<int16_t>::from_bytes(body.data(), 0u, 2u)->length(), 0u);
+}
+
+}  // namespace audio
+}  // namespace djehuti
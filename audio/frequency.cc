@@ -20,15 +20,73 @@
 
 #include "audio/frequency.hh"
 
+#include "audio/notation.hh"
+
 using namespace djehuti::literals;
 
 namespace djehuti {
 namespace audio {
 
+namespace {
+
+// The name of each pitch class, indexed by semitones above C.
+constexpr std::string_view NOTE_NAMES[] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+// The pitch class of each note letter, indexed by letter - 'A'.
+constexpr long LETTER_PITCH_CLASSES[] = {9, 11, 0, 2, 4, 5, 7};
+
+constexpr long NOTES_PER_OCTAVE = 12;
+constexpr double CENTS_PER_NOTE = 100.0;
+
+}  // namespace
+
 constexpr double Frequency::DEFAULT_BEAT_TOLERANCE_HZ;
 constexpr double Frequency::REFERENCE_NOTE;
 constexpr double Frequency::REFERENCE_FREQ;
 constexpr double Frequency::CROSSOVER_FREQ;
+constexpr size_t Frequency::MAX_NOTENAME_LENGTH;
+
+char *Frequency::to_notename(char *first, char *last) const {
+    // Even the most extreme finite doubles are within a few thousand octaves of A440, so the
+    // note number can't overflow.
+    const double midi = midi_note();
+    if (!std::isfinite(midi)) {
+        return nullptr;
+    }
+    const long note = std::lround(midi);
+    const long cents = std::lround((midi - static_cast<double>(note)) * CENTS_PER_NOTE);
+    const long pitch_class = ((note % NOTES_PER_OCTAVE) + NOTES_PER_OCTAVE) % NOTES_PER_OCTAVE;
+    const long octave = (note - pitch_class) / NOTES_PER_OCTAVE - 1;
+    first = notation::write_str(first, last, NOTE_NAMES[pitch_class]);
+    first = notation::write_int(first, last, octave);
+    if (cents != 0) {
+        first = notation::write_cents(first, last, cents);
+    }
+    return first;
+}
+
+std::optional<Frequency> Frequency::from_notename(std::string_view name) {
+    if (name.empty()) {
+        return std::nullopt;
+    }
+    const char letter = name.front() & ~0x20;  // ASCII upper case.
+    if (letter < 'A' || letter > 'G') {
+        return std::nullopt;
+    }
+    name.remove_prefix(1u);
+    long note = LETTER_PITCH_CLASSES[letter - 'A'];
+    for (; !name.empty() && (name.front() == '#' || name.front() == 'b'); name.remove_prefix(1u)) {
+        note += (name.front() == '#') ? 1 : -1;
+    }
+    long octave = 0;
+    double cents = 0.0;
+    if (!notation::parse_int(&name, &octave) || !notation::parse_cents(name, &cents)) {
+        return std::nullopt;
+    }
+    return from_midi_note((static_cast<double>(octave) + 1.0) * NOTES_PER_OCTAVE +
+                          static_cast<double>(note) + cents / CENTS_PER_NOTE);
+}
 
 const Frequency &Frequency::audio_cd_sample_rate() {
     static const Frequency rate = 44100_hz;
@@ -51,6 +109,16 @@ std::ostream &operator<<(std::ostream &os, const Frequency &freq) {
         case Frequency::PERIOD_SEC:
             os << freq.period_sec();
             break;
+        case Frequency::NOTENAME: {
+            char buf[Frequency::MAX_NOTENAME_LENGTH];
+            const char *end = freq.to_notename(buf, buf + sizeof(buf));
+            if (end != nullptr) {
+                os.write(buf, end - buf);
+            } else {
+                os << freq.hertz() << "_hz";
+            }
+            break;
+        }
         default:  // AUTO and invalid values come here.
             os << freq.hertz() << "_hz";
             break;
@@ -22,10 +22,14 @@
 
 #include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <optional>
+#include <string_view>
 
 #include "audio/interval.hh"
 #include "util/math.hh"
+#include "util/quantity.hh"
 
 namespace djehuti {
 namespace audio {
@@ -50,6 +54,11 @@ class Frequency final {
 
     /// Return the Frequency expressed in Hz.
     constexpr double hertz() const { return hertz_; }
+    /// Return the Frequency as a Quantity in the given unit (units::Kilohertz, ...).
+    template <typename U>
+    constexpr Quantity<U> as() const {
+        return Quantity<units::Hertz>(hertz_);
+    }
     /// Return the Frequency expressed as a cycle length in seconds (1/Hz).
     constexpr double period_sec() const { return 1.0 / hertz_; }
     /// Return the Frequency expressed as a cycle length (1/Hz).
@@ -63,6 +72,11 @@ class Frequency final {
 
     /// Create a Frequency from Hz.
     static constexpr Frequency from_hertz(double hz) { return Frequency(hz); }
+    /// Create a Frequency from a Quantity in any frequency unit.
+    template <typename U>
+    static constexpr Frequency from_quantity(const Quantity<U> &freq) {
+        return Frequency(freq.template in<units::Hertz>());
+    }
     /// Create a Frequency from a cycle length in seconds (1/Hz).
     static constexpr Frequency from_period_sec(double period) { return Frequency(1.0 / period); }
     /// Create a Frequency from a cycle length (1/Hz).
@@ -126,6 +140,21 @@ class Frequency final {
     bool operator>(const Frequency &other) const { return hertz_ > other.hertz_; }
     bool operator>=(const Frequency &other) const { return hertz_ >= other.hertz_; }
 
+    /// The largest number of characters that to_notename will ever write.
+    static constexpr size_t MAX_NOTENAME_LENGTH = 32u;
+
+    /// Write the name of the nearest equal-tempered note ("A4", "C#5 +3c", "A#2 -12c") into
+    /// [first, last). Middle C is "C4", and sharps are used rather than flats. A cents deviation
+    /// is appended unless the Frequency rounds to exactly the note. Does not allocate or use the
+    /// locale. Returns one past the last character written, or nullptr if the buffer is too small
+    /// or the Frequency has no note (it's zero, infinite or NaN).
+    char *to_notename(char *first, char *last) const;
+
+    /// Create a Frequency from a note name ("A4", "Eb3", "F#-1", "A4 +3c", "C5-2.5c"), as
+    /// written by to_notename. Accepts any number of '#' or 'b' accidentals. Returns nullopt if
+    /// the name can't be parsed.
+    static std::optional<Frequency> from_notename(std::string_view name);
+
     // I/O manipulators.
     static std::ostream &output_auto(std::ostream &os) { return output_format(os, AUTO); }
     static std::ostream &output_hertz(std::ostream &os) { return output_format(os, HERTZ); }
@@ -133,9 +162,9 @@ class Frequency final {
     static std::ostream &output_period_sec(std::ostream &os) {
         return output_format(os, PERIOD_SEC);
     }
-    // static std::ostream &output_notename(std::ostream &os) {
-    //    return output_format(os, NOTENAME);
-    // }
+    static std::ostream &output_notename(std::ostream &os) {
+        return output_format(os, NOTENAME);
+    }
 
  private:
     // Output formats.
@@ -144,7 +173,7 @@ class Frequency final {
         HERTZ = 1,
         MIDI = 2,
         PERIOD_SEC = 3,
-        // NOTENAME = 4
+        NOTENAME = 4,
     };
 
     // Reference points.
@@ -180,8 +209,9 @@ using Period = Frequency;
 using Pitch = Frequency;
 
 /// In AUTO mode (the default, or if Frequency::output_auto manipulator is used), the stream
-/// inserter represents the Frequency as a _hz literal. In the other modes, a raw number in
-/// the appropriate unit is output, with no suffix.
+/// inserter represents the Frequency as a _hz literal. In NOTENAME mode, it is output as by
+/// Frequency::to_notename ("A4 +3c"). In the other modes, a raw number in the appropriate unit
+/// is output, with no suffix.
 std::ostream &operator<<(std::ostream &, const Frequency &);
 
 template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
@@ -199,11 +229,11 @@ Frequency operator/(const Frequency &freq, const T &d) {
     return Frequency::from_hertz(freq.hertz() / d);
 }
 
-Frequency operator+(const Frequency &freq, const Interval &intv) {
+inline Frequency operator+(const Frequency &freq, const Interval &intv) {
     return Frequency::from_hertz(freq.hertz() * intv.ratio());
 }
 
-Frequency operator-(const Frequency &freq, const Interval &intv) {
+inline Frequency operator-(const Frequency &freq, const Interval &intv) {
     return Frequency::from_hertz(freq.hertz() / intv.ratio());
 }
 
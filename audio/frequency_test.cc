@@ -20,6 +20,7 @@
 
 #include "audio/frequency.hh"
 
+#include <cmath>
 #include <sstream>
 
 #include "gtest/gtest.h"
@@ -129,5 +130,106 @@ TEST(FrequencyTest, FrequencyOutput) {
     }
 }
 
+TEST(FrequencyTest, IntervalMusicalNames) {
+    {
+        std::ostringstream oss;
+        oss << Interval::output_musical << Interval::fifth() << "/" << Interval::minor_third()
+            << "/" << Interval::major_ninth() << "/" << Interval::tritone() << "/" << 1_octaves
+            << "/" << 0_semitones << "/" << 2_octaves;
+        EXPECT_EQ(oss.str(), "P5/m3/M9/A4/P8/P1/P15");
+    }
+    {
+        std::ostringstream oss;
+        oss << Interval::output_musical << (Interval::fifth() + 2_cents) << "/"
+            << (0_semitones - Interval::fourth()) << "/" << (Interval::major_third() - 14_cents);
+        EXPECT_EQ(oss.str(), "P5 +2c/-P4/M3 -14c");
+    }
+    {
+        char buf[4];
+        EXPECT_EQ(Interval::fifth().to_musical(buf, buf + sizeof(buf)), buf + 2);
+        EXPECT_EQ(std::string(buf, 2), "P5");
+        EXPECT_EQ((Interval::fifth() + 2_cents).to_musical(buf, buf + sizeof(buf)), nullptr);
+    }
+
+    for (int semis = -30; semis <= 30; ++semis) {
+        const auto intv = Interval::from_semitones(semis) + 7_cents;
+        char buf[Interval::MAX_MUSICAL_LENGTH];
+        const char *end = intv.to_musical(buf, buf + sizeof(buf));
+        ASSERT_NE(end, nullptr);
+        const auto parsed = Interval::from_musical(std::string_view(buf, end - buf));
+        ASSERT_TRUE(parsed.has_value()) << std::string(buf, end - buf);
+        EXPECT_TRUE(parsed->almost_equal(intv)) << std::string(buf, end - buf);
+    }
+
+    EXPECT_EQ(Interval::from_musical("d5"), Interval::tritone());
+    EXPECT_EQ(Interval::from_musical("A2"), Interval::minor_third());
+    EXPECT_EQ(Interval::from_musical("m10"), Interval::minor_tenth());
+    EXPECT_EQ(Interval::from_musical("d7"), Interval::major_sixth());
+    EXPECT_EQ(Interval::from_musical("-M2"), 0_semitones - Interval::whole_step());
+    EXPECT_FALSE(Interval::from_musical("").has_value());
+    EXPECT_FALSE(Interval::from_musical("P3").has_value());
+    EXPECT_FALSE(Interval::from_musical("m5").has_value());
+    EXPECT_FALSE(Interval::from_musical("M0").has_value());
+    EXPECT_FALSE(Interval::from_musical("d1").has_value());
+    EXPECT_FALSE(Interval::from_musical("X4").has_value());
+    EXPECT_FALSE(Interval::from_musical("P5 +2").has_value());
+    EXPECT_FALSE(Interval::from_musical("P5x").has_value());
+}
+
+TEST(FrequencyTest, NoteNames) {
+    {
+        std::ostringstream oss;
+        oss << Frequency::output_notename << A4 << "/" << C4 << "/" << Eb4 << "/" << C4_FLAT << "/"
+            << 443_hz << "/" << 8.176_hz;
+        EXPECT_EQ(oss.str(), "A4/C4/D#4/B3 +43c/A4 +12c/C-1");
+    }
+    {
+        std::ostringstream oss;
+        oss << Frequency::output_notename << 0_hz << "/" << Frequency::output_auto << A4;
+        EXPECT_EQ(oss.str(), "0_hz/440_hz");
+    }
+    {
+        char buf[2];
+        EXPECT_EQ(A4.to_notename(buf, buf + sizeof(buf)), buf + 2);
+        EXPECT_EQ(std::string(buf, 2), "A4");
+        EXPECT_EQ(C4_FLAT.to_notename(buf, buf + sizeof(buf)), nullptr);
+    }
+    for (double hz : {0.0, double{INFINITY}, double{NAN}}) {
+        char buf[Frequency::MAX_NOTENAME_LENGTH];
+        EXPECT_EQ(Frequency::from_hertz(hz).to_notename(buf, buf + sizeof(buf)), nullptr) << hz;
+    }
+
+    for (double midi = -20.0; midi <= 140.0; midi += 0.37) {
+        const auto freq = Frequency::from_midi_note(midi);
+        char buf[Frequency::MAX_NOTENAME_LENGTH];
+        const char *end = freq.to_notename(buf, buf + sizeof(buf));
+        ASSERT_NE(end, nullptr);
+        const auto parsed = Frequency::from_notename(std::string_view(buf, end - buf));
+        ASSERT_TRUE(parsed.has_value()) << std::string(buf, end - buf);
+        EXPECT_TRUE(parsed->interval(freq).almost_equal(0_cents, 0.005))
+            << std::string(buf, end - buf);
+    }
+
+    EXPECT_TRUE(Frequency::from_notename("A4")->almost_equal(440_hz));
+    EXPECT_TRUE(Frequency::from_notename("a4")->almost_equal(440_hz));
+    EXPECT_TRUE(Frequency::from_notename("Eb4")->almost_equal(Eb4));
+    EXPECT_TRUE(Frequency::from_notename("Bbb3")->almost_equal(Frequency::from_midi_note(57)));
+    EXPECT_TRUE(Frequency::from_notename("C4-57c")->almost_equal(C4 - 57_cents));
+    EXPECT_TRUE(Frequency::from_notename("C4 +12.5c")->almost_equal(C4 + 12.5_cents));
+    EXPECT_TRUE(Frequency::from_notename("C-1")->almost_equal(Frequency::from_midi_note(0)));
+    EXPECT_FALSE(Frequency::from_notename("").has_value());
+    EXPECT_FALSE(Frequency::from_notename("H4").has_value());
+    EXPECT_FALSE(Frequency::from_notename("A").has_value());
+    EXPECT_FALSE(Frequency::from_notename("A4 3").has_value());
+    EXPECT_FALSE(Frequency::from_notename("A4 +3cents").has_value());
+}
+
+TEST(FrequencyTest, Quantities) {
+    EXPECT_EQ(Frequency::from_quantity(Quantity<units::Kilohertz>(44.1)).hertz(), 44100.0);
+    EXPECT_EQ(Frequency::concert_pitch().as<units::PerMinute>().value(), 26400.0);
+    EXPECT_EQ(Interval::from_quantity(Quantity<units::Octaves>(2.0)).semitones(), 24.0);
+    EXPECT_EQ(Interval::from_semitones(7.0).as<units::Cents>().value(), 700.0);
+}
+
 }  // namespace audio
 }  // namespace djehuti
@@ -20,14 +20,122 @@
 
 #include "audio/interval.hh"
 
+#include "audio/notation.hh"
+
 using namespace djehuti::literals;
 
 namespace djehuti {
 namespace audio {
 
+namespace {
+
+// The musical name of each interval within an octave, indexed by semitones.
+struct MusicalName {
+    char quality;
+    long number;
+};
+constexpr MusicalName MUSICAL_NAMES[] = {
+    {'P', 1},
+    {'m', 2},
+    {'M', 2},
+    {'m', 3},
+    {'M', 3},
+    {'P', 4},
+    {'A', 4},
+    {'P', 5},
+    {'m', 6},
+    {'M', 6},
+    {'m', 7},
+    {'M', 7},
+};
+
+// The size in semitones of each perfect or major simple interval, indexed by number - 1.
+constexpr long DIATONIC_SEMITONES[] = {0, 2, 4, 5, 7, 9, 11};
+// Whether each simple interval is a perfect one (vs. major/minor), indexed by number - 1.
+constexpr bool DIATONIC_PERFECT[] = {true, false, false, true, true, false, false};
+
+constexpr long SEMITONES_PER_OCTAVE_L = 12;
+constexpr long DEGREES_PER_OCTAVE = 7;
+
+// Intervals bigger than this (in semitones) have no sensible name.
+constexpr double MAX_NAMED_SEMITONES = 1e12;
+
+}  // namespace
+
 constexpr double Interval::DEFAULT_TOLERANCE;
 constexpr double Interval::SEMITONES_PER_OCTAVE;
 constexpr double Interval::CENTS_PER_SEMITONE;
+constexpr size_t Interval::MAX_MUSICAL_LENGTH;
+
+char *Interval::to_musical(char *first, char *last) const {
+    const double magnitude = std::abs(semitones_);
+    if (!(magnitude <= MAX_NAMED_SEMITONES)) {  // Also catches NaN.
+        return nullptr;
+    }
+    const long semis = std::lround(magnitude);
+    const long cents = std::lround((magnitude - static_cast<double>(semis)) * CENTS_PER_SEMITONE);
+    const MusicalName &name = MUSICAL_NAMES[semis % SEMITONES_PER_OCTAVE_L];
+    const long number = name.number + DEGREES_PER_OCTAVE * (semis / SEMITONES_PER_OCTAVE_L);
+    if (semitones_ < 0.0 && (semis != 0 || cents != 0)) {
+        first = notation::write_str(first, last, "-");
+    }
+    first = notation::write_str(first, last, std::string_view(&name.quality, 1u));
+    first = notation::write_int(first, last, number);
+    if (cents != 0) {
+        first = notation::write_cents(first, last, cents);
+    }
+    return first;
+}
+
+std::optional<Interval> Interval::from_musical(std::string_view name) {
+    double sign = 1.0;
+    if (!name.empty() && name.front() == '-') {
+        sign = -1.0;
+        name.remove_prefix(1u);
+    }
+    if (name.empty()) {
+        return std::nullopt;
+    }
+    const char quality = name.front();
+    name.remove_prefix(1u);
+    long number = 0;
+    if (name.empty() || name.front() < '0' || name.front() > '9' ||
+        !notation::parse_int(&name, &number) || number < 1 ||
+        static_cast<double>(number) > MAX_NAMED_SEMITONES) {
+        return std::nullopt;
+    }
+    const long degree = (number - 1) % DEGREES_PER_OCTAVE;
+    const bool perfect = DIATONIC_PERFECT[degree];
+    long semis = DIATONIC_SEMITONES[degree] +
+                 SEMITONES_PER_OCTAVE_L * ((number - 1) / DEGREES_PER_OCTAVE);
+    switch (quality) {
+        case 'P':
+        case 'M':
+            if (perfect != (quality == 'P')) {
+                return std::nullopt;
+            }
+            break;
+        case 'm':
+            if (perfect) {
+                return std::nullopt;
+            }
+            semis -= 1;
+            break;
+        case 'A':
+            semis += 1;
+            break;
+        case 'd':
+            semis -= perfect ? 1 : 2;
+            break;
+        default:
+            return std::nullopt;
+    }
+    double cents = 0.0;
+    if (semis < 0 || !notation::parse_cents(name, &cents)) {
+        return std::nullopt;
+    }
+    return Interval(sign * (static_cast<double>(semis) + cents / CENTS_PER_SEMITONE));
+}
 
 const Interval &Interval::unison() {
     static const Interval i = 0_semitones;
@@ -120,6 +228,16 @@ std::ostream &operator<<(std::ostream &os, const Interval &intv) {
         case Interval::OCTAVES:
             os << intv.octaves();
             break;
+        case Interval::MUSICAL: {
+            char buf[Interval::MAX_MUSICAL_LENGTH];
+            const char *end = intv.to_musical(buf, buf + sizeof(buf));
+            if (end != nullptr) {
+                os.write(buf, end - buf);
+            } else {
+                os << intv.semitones() << "_semitones";
+            }
+            break;
+        }
         default:  // AUTO and invalid values will come here.
             if (std::abs(intv.semitones()) >= 12.0) {
                 os << intv.octaves() << "_octaves";
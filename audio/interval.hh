@@ -21,9 +21,13 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <optional>
+#include <string_view>
 
 #include "util/math.hh"
+#include "util/quantity.hh"
 
 namespace djehuti {
 namespace audio {
@@ -49,21 +53,35 @@ class Interval final {
     /// Return the Interval expressed in semitones.
     constexpr double semitones() const { return semitones_; }
     /// Return the Interval expressed in cents.
-    constexpr double cents() const { return semitones_ * CENTS_PER_SEMITONE; }
+    constexpr double cents() const {
+        return units::convert<units::Semitones, units::Cents>(semitones_);
+    }
     /// Return the Interval expressed in octaves.
-    constexpr double octaves() const { return semitones_ / SEMITONES_PER_OCTAVE; }
+    constexpr double octaves() const {
+        return units::convert<units::Semitones, units::Octaves>(semitones_);
+    }
     /// Return the Interval expressed as a ratio.
     MAYBE_CONSTEXPR double ratio() const { return std::exp2(octaves()); }
+    /// Return the Interval as a Quantity in the given unit (units::Cents, ...).
+    template <typename U>
+    constexpr Quantity<U> as() const {
+        return Quantity<units::Semitones>(semitones_);
+    }
 
     /// Create an Interval from a number of semitones.
     static constexpr Interval from_semitones(double semitones) { return Interval(semitones); }
     /// Create an Interval from a number of cents.
     static constexpr Interval from_cents(double cents) {
-        return Interval(cents / CENTS_PER_SEMITONE);
+        return Interval(units::convert<units::Cents, units::Semitones>(cents));
     }
     /// Create an Interval from a number of octaves.
     static constexpr Interval from_octaves(double octaves) {
-        return Interval(octaves * SEMITONES_PER_OCTAVE);
+        return Interval(units::convert<units::Octaves, units::Semitones>(octaves));
+    }
+    /// Create an Interval from a Quantity in any interval unit.
+    template <typename U>
+    static constexpr Interval from_quantity(const Quantity<U> &interval) {
+        return Interval(interval.template in<units::Semitones>());
     }
     /// Create an Interval from a ratio.
     static MAYBE_CONSTEXPR Interval from_ratio(double ratio) {
@@ -121,12 +139,27 @@ class Interval final {
     static const Interval &minor_tenth();
     static const Interval &major_tenth();
 
+    /// The largest number of characters that to_musical will ever write.
+    static constexpr size_t MAX_MUSICAL_LENGTH = 32u;
+
+    /// Write the musical name of the Interval ("P5", "m3", "M9", "-P4", "M3 +14c") into
+    /// [first, last). The name is that of the nearest whole number of semitones, with a cents
+    /// deviation appended if it is not exact; the tritone is written as "A4". Downward intervals
+    /// are prefixed with '-'. Does not allocate or use the locale. Returns one past the last
+    /// character written, or nullptr if the buffer is too small.
+    char *to_musical(char *first, char *last) const;
+
+    /// Create an Interval from its musical name, as written by to_musical. Any of the qualities
+    /// P, M, m, A and d are accepted for the appropriate interval numbers. Returns nullopt if
+    /// the name can't be parsed.
+    static std::optional<Interval> from_musical(std::string_view name);
+
     // I/O manipulators.
     static std::ostream &output_auto(std::ostream &os) { return output_format(os, AUTO); }
     static std::ostream &output_semitones(std::ostream &os) { return output_format(os, SEMITONES); }
     static std::ostream &output_cents(std::ostream &os) { return output_format(os, CENTS); }
     static std::ostream &output_octaves(std::ostream &os) { return output_format(os, OCTAVES); }
-    // static std::ostream &output_musical(std::ostream &os) { return output_format(os, MUSICAL); }
+    static std::ostream &output_musical(std::ostream &os) { return output_format(os, MUSICAL); }
 
  private:
     // Output format selectors.
@@ -135,12 +168,14 @@ class Interval final {
         SEMITONES = 1,
         CENTS = 2,
         OCTAVES = 3,
-        // MUSICAL = 4
+        MUSICAL = 4,
     };
 
     // Reference points.
-    static constexpr double SEMITONES_PER_OCTAVE = 12.0;
-    static constexpr double CENTS_PER_SEMITONE = 100.0;
+    static constexpr double SEMITONES_PER_OCTAVE =
+        units::Conversion<units::Octaves, units::Semitones>::multiplier;
+    static constexpr double CENTS_PER_SEMITONE =
+        units::Conversion<units::Semitones, units::Cents>::multiplier;
 
     // This constructor is private; use a unit-safe factory instead.
     constexpr explicit Interval(double semitones) : semitones_(semitones) {}
@@ -173,6 +208,7 @@ class Interval final {
 /// If the format is not AUTO (one of the output format manipulators has been used), it is output
 /// as a plain number with the given units.
 /// That is, `os << Interval::output_semitones << Interval::from_cents(50.0)` will output "0.5".
+/// In MUSICAL mode, it is output by name, as by Interval::to_musical ("P5").
 std::ostream &operator<<(std::ostream &os, const Interval &intv);
 
 /// Returns the sum of the two intervals.
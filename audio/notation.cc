@@ -0,0 +1,121 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/notation.hh"
+
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+namespace djehuti {
+namespace audio {
+namespace notation {
+
+namespace {
+
+// Long enough for the digits of any long.
+constexpr size_t MAX_DIGITS = 20u;
+
+std::string_view skip_blanks(std::string_view text) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1u);
+    }
+    return text;
+}
+
+}  // namespace
+
+char *write_str(char *first, char *last, std::string_view str) {
+    if (first == nullptr || static_cast<size_t>(last - first) < str.size()) {
+        return nullptr;
+    }
+    std::memcpy(first, str.data(), str.size());
+    return first + str.size();
+}
+
+char *write_int(char *first, char *last, long value) {
+    // Work with the magnitude as unsigned so that LONG_MIN doesn't overflow.
+    unsigned long magnitude = static_cast<unsigned long>(value);
+    if (value < 0) {
+        magnitude = 0ul - magnitude;
+    }
+    char digits[MAX_DIGITS];
+    char *d = digits + MAX_DIGITS;
+    do {
+        *--d = static_cast<char>('0' + magnitude % 10u);
+        magnitude /= 10u;
+    } while (magnitude != 0u);
+    if (value < 0) {
+        first = write_str(first, last, "-");
+    }
+    return write_str(first, last, std::string_view(d, digits + MAX_DIGITS - d));
+}
+
+char *write_cents(char *first, char *last, long cents) {
+    first = write_str(first, last, cents < 0 ? " -" : " +");
+    first = write_int(first, last, cents < 0 ? -cents : cents);
+    return write_str(first, last, "c");
+}
+
+bool parse_int(std::string_view *text, long *value) {
+    std::string_view t = *text;
+    bool negative = false;
+    if (!t.empty() && (t.front() == '+' || t.front() == '-')) {
+        negative = (t.front() == '-');
+        t.remove_prefix(1u);
+    }
+    unsigned long magnitude = 0u;
+    const auto result = std::from_chars(t.data(), t.data() + t.size(), magnitude);
+    if (result.ec != std::errc() || magnitude > static_cast<unsigned long>(LONG_MAX)) {
+        return false;
+    }
+    *value = negative ? -static_cast<long>(magnitude) : static_cast<long>(magnitude);
+    text->remove_prefix(result.ptr - text->data());
+    return true;
+}
+
+bool parse_cents(std::string_view text, double *cents) {
+    text = skip_blanks(text);
+    if (text.empty()) {
+        *cents = 0.0;
+        return true;
+    }
+    bool negative = false;
+    if (text.front() == '+' || text.front() == '-') {
+        negative = (text.front() == '-');
+        text.remove_prefix(1u);
+    }
+    double magnitude = 0.0;
+    const auto result = std::from_chars(
+        text.data(), text.data() + text.size(), magnitude, std::chars_format::fixed);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    text.remove_prefix(result.ptr - text.data());
+    if (text != "c") {
+        return false;
+    }
+    *cents = negative ? -magnitude : magnitude;
+    return true;
+}
+
+}  // namespace notation
+}  // namespace audio
+}  // namespace djehuti
@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Helpers shared by the Frequency and Interval text conversions. These never allocate and never
+// consult the locale, so they are safe to use on hot paths.
+
+namespace djehuti {
+namespace audio {
+namespace notation {
+
+/// Copy the characters of str into [first, last). Returns one past the last character written,
+/// or nullptr if the buffer is too small (or first is nullptr).
+char *write_str(char *first, char *last, std::string_view str);
+
+/// Write the decimal representation of value into [first, last). Returns one past the last
+/// character written, or nullptr if the buffer is too small (or first is nullptr).
+char *write_int(char *first, char *last, long value);
+
+/// Write a cents deviation as " +3c" or " -12c" into [first, last). Returns one past the last
+/// character written, or nullptr if the buffer is too small (or first is nullptr).
+char *write_cents(char *first, char *last, long cents);
+
+/// Parse an optionally-signed decimal integer from the front of *text, advancing *text past it.
+/// Returns false (leaving *text alone) if there is no integer there.
+bool parse_int(std::string_view *text, long *value);
+
+/// Parse an optional cents deviation (" +3c", "-2.5c") making up all of text. An empty (or
+/// all-blank) text is zero cents. Returns false if text is anything else.
+bool parse_cents(std::string_view text, double *cents);
+
+}  // namespace notation
+}  // namespace audio
+}  // namespace djehuti
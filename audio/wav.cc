@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/wav.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace djehuti {
+namespace audio {
+
+namespace {
+
+constexpr uint16_t FORMAT_PCM = 1u;
+constexpr uint16_t FORMAT_IEEE_FLOAT = 3u;
+constexpr uint16_t FORMAT_EXTENSIBLE = 0xfffeu;
+
+// WAV files are little-endian, as are the machines we run on.
+template <typename T>
+T read(const char *p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void write(std::string *out, T value) {
+    out->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+}  // namespace
+
+std::optional<WavClip> parse_wav(std::string_view bytes) {
+    if (bytes.size() < 12u || bytes.substr(0u, 4u) != "RIFF" || bytes.substr(8u, 4u) != "WAVE") {
+        return std::nullopt;
+    }
+    std::optional<WavClip> clip;
+    size_t pos = 12u;
+    while (bytes.size() - pos >= 8u) {
+        const std::string_view id = bytes.substr(pos, 4u);
+        const size_t size = read<uint32_t>(bytes.data() + pos + 4u);
+        pos += 8u;
+        const std::string_view body = bytes.substr(pos, size);  // Maybe cut short.
+        if (id == "fmt ") {
+            if (body.size() < 16u) {
+                return std::nullopt;
+            }
+            uint16_t format = read<uint16_t>(body.data());
+            if (format == FORMAT_EXTENSIBLE) {
+                // The real format is the first two bytes of the sub-format GUID.
+                if (body.size() < 26u) {
+                    return std::nullopt;
+                }
+                format = read<uint16_t>(body.data() + 24u);
+            }
+            clip = WavClip();
+            clip->num_channels = read<uint16_t>(body.data() + 2u);
+            clip->sample_rate = read<uint32_t>(body.data() + 4u);
+            const uint16_t bits = read<uint16_t>(body.data() + 14u);
+            if (format == FORMAT_PCM && bits == 16u) {
+                clip->format = SampleFormat::S16;
+            } else if (format == FORMAT_IEEE_FLOAT && bits == 32u) {
+                clip->format = SampleFormat::F32;
+            } else {
+                return std::nullopt;
+            }
+            if (clip->num_channels == 0u || clip->sample_rate == 0u) {
+                return std::nullopt;
+            }
+        } else if (id == "data") {
+            if (!clip) {
+                return std::nullopt;  // The format has to come first.
+            }
+            const size_t frame_size = sample_size(clip->format) * clip->num_channels;
+            clip->samples = body.substr(0u, body.size() - body.size() % frame_size);
+            return clip;
+        }
+        if (size > bytes.size() - pos) {
+            break;
+        }
+        pos += size + (size & 1u);  // Chunks are padded to an even size.
+        pos = std::min(pos, bytes.size());
+    }
+    return std::nullopt;
+}
+
+std::string write_wav(const WavClip &clip) {
+    const size_t size = sample_size(clip.format);
+    std::string out;
+    out.reserve(44u + clip.samples.size());
+    out.append("RIFF");
+    write<uint32_t>(&out, static_cast<uint32_t>(36u + clip.samples.size()));
+    out.append("WAVEfmt ");
+    write<uint32_t>(&out, 16u);
+    write<uint16_t>(&out, clip.format == SampleFormat::S16 ? FORMAT_PCM : FORMAT_IEEE_FLOAT);
+    write<uint16_t>(&out, static_cast<uint16_t>(clip.num_channels));
+    write<uint32_t>(&out, clip.sample_rate);
+    write<uint32_t>(&out, static_cast<uint32_t>(clip.sample_rate * size * clip.num_channels));
+    write<uint16_t>(&out, static_cast<uint16_t>(size * clip.num_channels));
+    write<uint16_t>(&out, static_cast<uint16_t>(8u * size));
+    out.append("data");
+    write<uint32_t>(&out, static_cast<uint32_t>(clip.samples.size()));
+    out.append(clip.samples.data(), clip.samples.size());  // Always an even size.
+    return out;
+}
+
+}  // namespace audio
+}  // namespace djehuti
@@ -0,0 +1,63 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace djehuti {
+namespace audio {
+
+/// The sample formats we can analyze, as found in WAV files or raw PCM.
+enum class SampleFormat {
+    S16,  // Signed 16-bit integers, little-endian.
+    F32,  // 32-bit IEEE floats, little-endian.
+};
+
+/// Returns the size of one sample in the format, in bytes.
+constexpr size_t sample_size(SampleFormat format) {
+    return format == SampleFormat::S16 ? 2u : 4u;
+}
+
+/// What a WAV file holds: its samples are the bytes of its data chunk, not a copy of them.
+struct WavClip {
+    SampleFormat format;
+    size_t num_channels;
+    uint32_t sample_rate;
+    std::string_view samples;
+};
+
+/**
+ * Finds the format and samples in the bytes of a WAV file, or returns nothing if they aren't
+ * one or its samples aren't in a SampleFormat. Plain and WAVE_FORMAT_EXTENSIBLE format chunks
+ * are understood; a data chunk that claims to run past the end is cut short (as streaming
+ * writers leave them), to a whole number of frames.
+ */
+std::optional<WavClip> parse_wav(std::string_view bytes);
+
+/// Returns the bytes of a WAV file holding the clip.
+std::string write_wav(const WavClip &clip);
+
+}  // namespace audio
+}  // namespace djehuti
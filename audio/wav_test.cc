@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio/wav.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace audio {
+
+TEST(WavTest, RoundTrip) {
+    const int16_t samples[] = {0, 1, -1, 32767, -32768, 12345};
+    const std::string bytes(reinterpret_cast<const char *>(samples), sizeof(samples));
+    const std::string wav = write_wav(WavClip{SampleFormat::S16, 2u, 44100u, bytes});
+    EXPECT_EQ(wav.size(), 44u + sizeof(samples));
+
+    const auto clip = parse_wav(wav);
+    ASSERT_TRUE(clip.has_value());
+    EXPECT_EQ(clip->format, SampleFormat::S16);
+    EXPECT_EQ(clip->num_channels, 2u);
+    EXPECT_EQ(clip->sample_rate, 44100u);
+    EXPECT_EQ(clip->samples, bytes);
+    // The samples are a view of the file, not a copy.
+    EXPECT_EQ(clip->samples.data(), wav.data() + 44);
+
+    const float floats[] = {0.5f, -0.25f};
+    const auto float_clip = parse_wav(write_wav(WavClip{
+        SampleFormat::F32, 1u, 48000u,
+        std::string_view(reinterpret_cast<const char *>(floats), sizeof(floats))}));
+    ASSERT_TRUE(float_clip.has_value());
+    EXPECT_EQ(float_clip->format, SampleFormat::F32);
+    EXPECT_EQ(float_clip->samples.size(), sizeof(floats));
+}
+
+TEST(WavTest, Chunks) {
+    const int16_t samples[] = {1, 2, 3, 4};
+    const std::string bytes(reinterpret_cast<const char *>(samples), sizeof(samples));
+    std::string wav = write_wav(WavClip{SampleFormat::S16, 1u, 8000u, bytes});
+
+    // An odd-sized chunk before the data, padded to an even size.
+    std::string with_list = wav;
+    with_list.insert(36u, std::string("LIST\x03\0\0\0abc\0", 12u));
+    auto clip = parse_wav(with_list);
+    ASSERT_TRUE(clip.has_value());
+    EXPECT_EQ(clip->samples, bytes);
+
+    // WAVE_FORMAT_EXTENSIBLE, with the format in the sub-format GUID.
+    std::string extensible = wav.substr(0u, 20u);
+    extensible[16] = 40;  // The fmt chunk's size.
+    const char fmt[] = "\xfe\xff\x01\x00\x40\x1f\x00\x00\x80\x3e\x00\x00\x02\x00\x10\x00"
+                       "\x16\x00\x10\x00\x04\x00\x00\x00\x01\x00\x00\x00\x00\x00\x10\x00"
+                       "\x80\x00\x00\xaa\x00\x38\x9b\x71";
+    extensible.append(fmt, 40u);
+    extensible.append(wav, 36u, std::string::npos);
+    clip = parse_wav(extensible);
+    ASSERT_TRUE(clip.has_value());
+    EXPECT_EQ(clip->format, SampleFormat::S16);
+    EXPECT_EQ(clip->sample_rate, 8000u);
+    EXPECT_EQ(clip->samples, bytes);
+
+    // A data chunk that runs past the end, as a streaming writer leaves it, and ends mid-frame.
+    std::string truncated = wav.substr(0u, wav.size() - 3u);
+    clip = parse_wav(truncated);
+    ASSERT_TRUE(clip.has_value());
+    EXPECT_EQ(clip->samples, bytes.substr(0u, 4u));
+}
+
+TEST(WavTest, NotWav) {
+    EXPECT_FALSE(parse_wav(""));
+    EXPECT_FALSE(parse_wav("RIFF\0\0\0\0WAVX"));
+    const int16_t samples[] = {1, 2};
+    const std::string bytes(reinterpret_cast<const char *>(samples), sizeof(samples));
+    const std::string wav = write_wav(WavClip{SampleFormat::S16, 1u, 8000u, bytes});
+    // No data chunk.
+    EXPECT_FALSE(parse_wav(wav.substr(0u, 36u)));
+    // 24-bit samples.
+    std::string wide = wav;
+    wide[34] = 24;
+    EXPECT_FALSE(parse_wav(wide));
+    // No channels.
+    std::string silent = wav;
+    silent[22] = 0;
+    EXPECT_FALSE(parse_wav(silent));
+    // Data before the format.
+    std::string backwards = wav.substr(0u, 12u) + wav.substr(36u) + wav.substr(12u, 24u);
+    EXPECT_FALSE(parse_wav(backwards));
+}
+
+}  // namespace audio
+}  // namespace djehuti
@@ -18,25 +18,714 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "audio/analysis.hh"
+#include "audio/audioview.hh"
+#include "audio/wav.hh"
 #include "pistache/endpoint.h"
+#include "util/admission.hh"
+#include "util/affinity.hh"
+#include "util/async_log.hh"
+#include "util/binary_protocol.hh"
+#include "util/binary_server.hh"
+#include "util/http_request.hh"
+#include "util/metrics.hh"
+#include "util/rate_limit.hh"
+#include "util/response_cache.hh"
+#include "util/string_builder.hh"
+#include "util/thread_pool.hh"
+#include "util/uring_http_server.hh"
+#include "util/unit_conversion.hh"
 
 using namespace ::Pistache;
+namespace audio = ::djehuti::audio;
+namespace binary = ::djehuti::binary;
+namespace metrics = ::djehuti::metrics;
 
-class HelloHandler : public Http::Handler {
+namespace {
+
+metrics::Registry registry;
+std::unique_ptr<djehuti::AsyncLog> request_log;
+std::unique_ptr<djehuti::ThreadPool> analysis_pool;
+
+using Ticket = djehuti::AdmissionController::Ticket;
+
+// What keeps us from taking on more than we can: rate limits per client address and for everyone
+// together, and an adaptive limit on the requests in progress. Each is null if it's turned off.
+std::unique_ptr<djehuti::KeyedTokenBuckets> client_rate_limit;
+std::unique_ptr<djehuti::TokenBucket> global_rate_limit;
+std::unique_ptr<djehuti::AdmissionController> admission;
+
+metrics::Counter &rejected(const char *reason) {
+    return registry.counter("dumb_server_rejected_total",
+                            "Requests turned away before they were served.", {{"reason", reason}});
+}
+
+// Decides whether to take on a request from the client. Returns Ok, with the ticket to hold until
+// it's been answered, or the code to turn it away with: Too_Many_Requests if the client (or
+// everyone) is over their rate, or Service_Unavailable if requests are already queueing too long.
+Http::Code admit(std::string_view client, Ticket *ticket) {
+    static metrics::Counter &client_rate = rejected("client_rate");
+    static metrics::Counter &global_rate = rejected("global_rate");
+    static metrics::Counter &overload = rejected("overload");
+    if (client_rate_limit != nullptr && !client_rate_limit->try_take(client)) {
+        client_rate.add();
+        return Http::Code::Too_Many_Requests;
+    }
+    if (global_rate_limit != nullptr && !global_rate_limit->try_take()) {
+        global_rate.add();
+        return Http::Code::Too_Many_Requests;
+    }
+    if (admission != nullptr) {
+        *ticket = admission->try_admit();
+        if (!*ticket) {
+            overload.add();
+            return Http::Code::Service_Unavailable;
+        }
+    }
+    return Http::Code::Ok;
+}
+
+const char *rejection_message(Http::Code code) {
+    return code == Http::Code::Too_Many_Requests ? "Too many requests\n" : "Overloaded\n";
+}
+
+// The metrics kept for each route.
+struct RouteMetrics {
+    explicit RouteMetrics(const std::string &route)
+        : requests(registry.counter("dumb_server_requests_total", "Requests received.",
+                                    {{"route", route}})),
+          in_flight(registry.gauge("dumb_server_requests_in_flight", "Requests being handled.",
+                                   {{"route", route}})),
+          latency(registry.histogram("dumb_server_request_duration_seconds",
+                                     "Time taken to handle requests.", {{"route", route}}, 1e-9)) {}
+
+    metrics::Counter &requests;
+    metrics::Gauge &in_flight;
+    metrics::Histogram &latency;  // In nanoseconds.
+};
+
+using CachedResponse = djehuti::ResponseCache::Response;
+
+// What a route that renders its response needs of a request, whichever backend took it.
+struct RenderRequest {
+    std::string_view method;
+    std::string_view resource;
+    std::string_view query;  // Without the '?'.
+    std::string_view body;
+    bool accepts_gzip = false;
+};
+
+// A route serves the requests for its path, or for anything under it if the path ends in a
+// slash, and counts and times them under its path. Most routes render their responses, and
+// either backend can serve them; the rest need Pistache. Serving a request takes its admission
+// ticket along, for routes that answer later to hold on to.
+struct Route {
+    using Serve = std::function<void(const Http::Request &, Http::ResponseWriter, Ticket)>;
+    using Render = std::function<std::shared_ptr<const CachedResponse>(const RenderRequest &)>;
+
+    Route(const std::string &path, Serve serve)
+        : path(path), serve(std::move(serve)), metrics(path) {}
+    Route(const std::string &path, Render render);
+
+    bool matches(std::string_view resource) const {
+        return path.back() == '/' ? resource.substr(0u, path.size()) == path : resource == path;
+    }
+
+    const std::string path;
+    const Serve serve;
+    const Render render;  // Null if only Pistache can serve the route.
+    RouteMetrics metrics;
+};
+
+// The routes, most specific first; the last one matches everything.
+std::vector<std::unique_ptr<Route>> routes;
+
+const Route &find_route(std::string_view resource) {
+    return **std::find_if(routes.begin(), routes.end(),
+                          [resource](auto &route) { return route->matches(resource); });
+}
+
+// Counts and times a request (and logs it, if we're logging) around serving it.
+template <typename Serve>
+void instrumented(const RouteMetrics &metrics,
+                  std::string_view method,
+                  std::string_view resource,
+                  Serve &&serve) {
+    const auto start = std::chrono::steady_clock::now();
+    metrics.requests.add();
+    metrics.in_flight.add();
+    if (request_log != nullptr && request_log->sample()) {
+        request_log->log("Serving ", method, ' ', resource);
+    }
+    serve();
+    metrics.in_flight.sub();
+    metrics.latency.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                             start)
+            .count()));
+}
+
+// Repeated requests to the routes that render their responses are answered from here, unless
+// it's null (which it is if --response_cache_mb is 0).
+std::unique_ptr<djehuti::ResponseCache> response_cache;
+
+CachedResponse rendered(Http::Code code, std::string body) {
+    CachedResponse response;
+    response.status = static_cast<int>(code);
+    response.content_type = "text/plain";
+    response.body = std::move(body);
+    return response;
+}
+
+// Sends a rendered response, or its gzipped copy if it has one and the client takes gzip.
+void send_rendered(const CachedResponse &rendered,
+                   bool accepts_gzip,
+                   Http::ResponseWriter response) {
+    const auto code = static_cast<Http::Code>(rendered.status);
+    const auto mime = Http::Mime::MediaType::fromString(rendered.content_type);
+    if (rendered.gzipped.empty()) {
+        response.send(code, rendered.body, mime);
+        return;
+    }
+    response.headers().addRaw(Http::Header::Raw("Vary", "Accept-Encoding"));
+    if (!accepts_gzip) {
+        response.send(code, rendered.body, mime);
+        return;
+    }
+    response.headers().addRaw(Http::Header::Raw("Content-Encoding", "gzip"));
+    response.send(code, rendered.gzipped, mime);
+}
+
+Route::Route(const std::string &path, Render render)
+    : path(path),
+      serve([render](const Http::Request &request, Http::ResponseWriter response, Ticket) {
+          const std::string query = request.query().as_str();  // With its '?'.
+          const auto accepted = request.headers().tryGetRaw("Accept-Encoding");
+          RenderRequest r;
+          r.method = Http::methodString(request.method());
+          r.resource = request.resource();
+          r.query = std::string_view(query).substr(query.empty() ? 0u : 1u);
+          r.body = request.body();
+          r.accepts_gzip =
+              !accepted.isEmpty() && accepted.get().value().find("gzip") != std::string::npos;
+          send_rendered(*render(r), r.accepts_gzip, std::move(response));
+      }),
+      render(std::move(render)),
+      metrics(path) {}
+
+// Makes a route's renderer out of a function that renders a response, looking it up in the
+// response cache first and keeping it there afterward if it went well. Rendering must depend on
+// nothing but the method, resource, query and body. Requests too big to make keys of are just
+// rendered.
+Route::Render cached(std::function<CachedResponse(const RenderRequest &)> render) {
+    metrics::Counter &hits = registry.counter(
+        "dumb_server_cache_lookups_total", "Lookups in the response cache.", {{"result", "hit"}});
+    metrics::Counter &misses = registry.counter(
+        "dumb_server_cache_lookups_total", "Lookups in the response cache.", {{"result", "miss"}});
+    return [render, &hits, &misses](const RenderRequest &request) {
+        if (response_cache == nullptr ||
+            !response_cache->cacheable(request.method, request.resource, request.query,
+                                       request.body)) {
+            return std::make_shared<const CachedResponse>(render(request));
+        }
+        std::string key = djehuti::ResponseCache::make_key(
+            request.method, request.resource, request.query, request.body);
+        auto found = response_cache->find(key);
+        if (found != nullptr) {
+            hits.add();
+            return found;
+        }
+        misses.add();
+        CachedResponse fresh = render(request);
+        if (fresh.status != static_cast<int>(Http::Code::Ok)) {
+            return std::make_shared<const CachedResponse>(std::move(fresh));
+        }
+        return response_cache->insert(std::move(key), std::move(fresh));
+    };
+}
+
+// Copies the response cache's counts into the registry, for /metrics.
+void export_cache_stats() {
+    if (response_cache == nullptr) {
+        return;
+    }
+    static metrics::Counter &insertions = registry.counter(
+        "dumb_server_cache_insertions_total", "Responses put in the response cache.");
+    static metrics::Counter &evictions =
+        registry.counter("dumb_server_cache_evictions_total",
+                         "Responses evicted from the response cache to make room.");
+    static metrics::Counter &expirations =
+        registry.counter("dumb_server_cache_expirations_total",
+                         "Responses dropped from the response cache once their TTL was up.");
+    static metrics::Gauge &entries =
+        registry.gauge("dumb_server_cache_entries", "Responses in the response cache.");
+    static metrics::Gauge &bytes =
+        registry.gauge("dumb_server_cache_bytes", "What the response cache holds, in bytes.");
+    static std::mutex mutex;  // So that two scrapes at once don't both add the same counts.
+    const auto stats = response_cache->stats();
+    std::lock_guard<std::mutex> lock(mutex);
+    insertions.add(stats.insertions - insertions.value());
+    evictions.add(stats.evictions - evictions.value());
+    expirations.add(stats.expirations - expirations.value());
+    entries.set(static_cast<int64_t>(stats.entries));
+    bytes.set(static_cast<int64_t>(stats.bytes));
+}
+
+// Renders /convert/<dimension>?from=<unit>&to=<unit>, converting the values in the query's v, or
+// if there isn't one, in the body: numbers separated by whitespace or commas, one per line in the
+// response. The scratch space is kept per thread, so that once it has grown to fit the biggest
+// request nothing more is allocated but the response.
+CachedResponse render_conversion(const RenderRequest &request) {
+    const std::string_view dimension = request.resource.substr(std::strlen("/convert/"));
+    const auto from = djehuti::query_param(request.query, "from");
+    const auto to = djehuti::query_param(request.query, "to");
+    if (!from || !to) {
+        return rendered(Http::Code::Bad_Request, "Both from and to units are needed\n");
+    }
+    const auto conversion = djehuti::units::RuntimeConversion::find(dimension, *from, *to);
+    if (!conversion) {
+        return rendered(Http::Code::Not_Found, "No such conversion\n");
+    }
+
+    thread_local std::vector<double> values;
+    thread_local djehuti::string::StringBuilder out;
+    out.clear();
+    const auto v = djehuti::query_param(request.query, "v");
+    const std::string_view text = v ? std::string_view(*v) : request.body;
+    size_t error_offset;
+    if (!djehuti::units::convert_list(*conversion, text, &values, &out, &error_offset)) {
+        out.clear();
+        out.append("Not a number at offset ").append(error_offset).append('\n');
+        return rendered(Http::Code::Bad_Request, out.str());
+    }
+    return rendered(Http::Code::Ok, out.str());
+}
+
+// One /analyze request, handed from the network thread that took it to the analysis thread that
+// answers it. The samples are a view into the body, which is moved here rather than copied.
+struct Analysis {
+    Analysis(std::string body, Http::ResponseWriter response, Ticket ticket)
+        : body(std::move(body)), response(std::move(response)), ticket(std::move(ticket)) {}
+
+    std::string body;
+    Http::ResponseWriter response;
+    Ticket ticket;  // Given back when we're done with it, once the reply is sent.
+    audio::SampleFormat format = audio::SampleFormat::S16;
+    size_t num_channels = 1u;
+    uint32_t sample_rate = 0u;
+    std::string_view samples;
+};
+
+// Returns the query parameter as a positive number, or 0 if it's missing or isn't one.
+uint32_t query_number(const Http::Request &request, const std::string &name) {
+    const auto value = request.query().get(name);
+    if (value.isEmpty()) {
+        return 0u;
+    }
+    const std::string text = value.get();
+    uint32_t number = 0u;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() ? number : 0u;
+}
+
+// The most channels raw samples can have (as many as a WAV file can).
+constexpr uint32_t MAX_CHANNELS = 65535u;
+
+// Finds the format and samples of the body: a WAV file, or if it doesn't start like one, raw
+// little-endian PCM as the query says. Returns the reason if we can't.
+const char *find_samples(const Http::Request &request, Analysis *analysis) {
+    const std::string_view body = analysis->body;
+    if (body.empty()) {
+        return "There are no samples\n";
+    }
+    if (body.substr(0u, 4u) == "RIFF") {
+        const auto clip = audio::parse_wav(body);
+        if (!clip || clip->num_channels == 0u || clip->sample_rate == 0u ||
+            clip->samples.empty()) {
+            return "Not a WAV file we can read\n";
+        }
+        analysis->format = clip->format;
+        analysis->num_channels = clip->num_channels;
+        analysis->sample_rate = clip->sample_rate;
+        analysis->samples = clip->samples;
+        return nullptr;
+    }
+    const auto format = request.query().get("format");
+    const std::string name = format.isEmpty() ? std::string("s16le") : format.get();
+    if (name == "s16le") {
+        analysis->format = audio::SampleFormat::S16;
+    } else if (name == "f32le") {
+        analysis->format = audio::SampleFormat::F32;
+    } else {
+        return "The format must be s16le or f32le\n";
+    }
+    analysis->num_channels = request.query().get("channels").isEmpty()
+                                 ? 1u
+                                 : query_number(request, "channels");
+    analysis->sample_rate = query_number(request, "rate");
+    if (analysis->num_channels == 0u || analysis->sample_rate == 0u) {
+        return "Raw samples need a rate, and a channel count if there's more than one\n";
+    }
+    if (analysis->num_channels > MAX_CHANNELS) {
+        return "There can be at most 65535 channels\n";
+    }
+    if (body.size() % (audio::sample_size(analysis->format) * analysis->num_channels) != 0u) {
+        return "The body isn't a whole number of frames\n";
+    }
+    analysis->samples = body;
+    return nullptr;
+}
+
+// Analyzes the samples where they are, unless they aren't aligned for their type (which a WAV
+// file with odd chunks before its data can do to them), in which case we copy them first.
+template <typename SampleType>
+std::vector<audio::ChannelAnalysis> analyze_samples(const Analysis &analysis) {
+    auto view = audio::AudioView<SampleType>::from_bytes(
+        analysis.samples.data(), analysis.samples.size(), analysis.num_channels);
+    std::vector<SampleType> aligned;
+    if (!view) {
+        aligned.resize(analysis.samples.size() / sizeof(SampleType));
+        std::memcpy(aligned.data(), analysis.samples.data(), aligned.size() * sizeof(SampleType));
+        view = audio::AudioView<SampleType>(
+            aligned.data(), aligned.size() / analysis.num_channels, analysis.num_channels);
+    }
+    return audio::analyze(*view, audio::Frequency::from_hertz(analysis.sample_rate));
+}
+
+// Appends the number, or null if it's infinite or NaN (which float samples can make the levels),
+// since JSON has no way to write those.
+void append_number(djehuti::string::StringBuilder *out, double x) {
+    if (std::isfinite(x)) {
+        out->append(x);
+    } else {
+        out->append("null");
+    }
+}
+
+// Runs on an analysis thread: streams the reply, starting with what we know before analyzing
+// and then a line per channel.
+void run_analysis(Analysis *analysis) {
+    analysis->ticket.started();  // The time in the pool's queue is what admission control limits.
+    const size_t frames =
+        analysis->samples.size() / (audio::sample_size(analysis->format) * analysis->num_channels);
+    djehuti::string::StringBuilder out;
+    out.append("{\"sample_rate\":")
+        .append(analysis->sample_rate)
+        .append(",\"frames\":")
+        .append(frames)
+        .append(",\"seconds\":")
+        .append(static_cast<double>(frames) / analysis->sample_rate)
+        .append(",\"channels\":[\n");
+    analysis->response.setMime(MIME(Application, Json));
+    auto stream = analysis->response.stream(Http::Code::Ok);
+    stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+    stream.flush();
+
+    const auto channels = analysis->format == audio::SampleFormat::S16
+                              ? analyze_samples<int16_t>(*analysis)
+                              : analyze_samples<float>(*analysis);
+    for (size_t c = 0u; c < channels.size(); ++c) {
+        out.clear();
+        out.append("{\"peak\":");
+        append_number(&out, channels[c].peak);
+        out.append(",\"rms\":");
+        append_number(&out, channels[c].rms);
+        out.append(",\"dominant_hz\":");
+        if (channels[c].dominant) {
+            char note[audio::Frequency::MAX_NOTENAME_LENGTH];
+            const char *end = channels[c].dominant->to_notename(note, note + sizeof(note));
+            append_number(&out, channels[c].dominant->hertz());
+            if (end != nullptr) {
+                out.append(",\"note\":\"")
+                    .append(std::string_view(note, static_cast<size_t>(end - note)))
+                    .append('"');
+            } else {
+                out.append(",\"note\":null");
+            }
+        } else {
+            out.append("null,\"note\":null");
+        }
+        out.append(c + 1u < channels.size() ? "},\n" : "}\n");
+        stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+    stream.write("]}\n", 3);
+    stream.ends();
+}
+
+// Takes the body out of the request rather than copying it. Pistache only hands the handler the
+// request by const reference, but the request is the connection's parser's own (it isn't const),
+// which resets it before parsing the next one and doesn't read the body again in between.
+std::string take_body(const Http::Request &request) {
+    return std::move(const_cast<std::string &>(request.body()));
+}
+
+// Serves /analyze: finds the peak and RMS level and the dominant frequency of each channel of
+// the audio in the body, on the analysis pool so that a long clip doesn't hold up the network
+// thread and the connections it serves. (So the route's latency is only the time to hand it
+// over.)
+void serve_analysis(const Http::Request &request, Http::ResponseWriter response, Ticket ticket) {
+    static metrics::Counter &pool_full = rejected("pool_full");
+    auto analysis = std::make_shared<Analysis>(take_body(request), std::move(response),
+                                               std::move(ticket));
+    if (const char *error = find_samples(request, analysis.get())) {
+        analysis->response.send(Http::Code::Bad_Request, error);
+        return;
+    }
+    if (!analysis_pool->submit([analysis] { run_analysis(analysis.get()); })) {
+        pool_full.add();
+        analysis->response.send(Http::Code::Service_Unavailable, "Too busy to analyze\n");
+    }
+}
+
+void add_routes() {
+    routes.push_back(std::make_unique<Route>("/analyze", serve_analysis));
+    routes.push_back(std::make_unique<Route>("/convert/", cached(render_conversion)));
+    metrics::Gauge &admission_limit = registry.gauge(
+        "dumb_server_admission_limit", "The most requests admission control lets in at once.");
+    routes.push_back(std::make_unique<Route>(
+        "/metrics", Route::Render([&admission_limit](const RenderRequest &) {
+            if (admission != nullptr) {
+                admission_limit.set(static_cast<int64_t>(admission->limit()));
+            }
+            export_cache_stats();
+            return std::make_shared<const CachedResponse>(
+                rendered(Http::Code::Ok, registry.render()));
+        })));
+    const auto hello =
+        std::make_shared<const CachedResponse>(rendered(Http::Code::Ok, "Hello, World"));
+    routes.push_back(std::make_unique<Route>(
+        "/", Route::Render([hello](const RenderRequest &) { return hello; })));
+}
+
+class DumbHandler : public Http::Handler {
  public:
-    HTTP_PROTOTYPE(HelloHandler)
+    HTTP_PROTOTYPE(DumbHandler)
 
     void onRequest(const Http::Request &request, Http::ResponseWriter response) {
-        LOG(INFO) << "Serving a request";
-        response.send(Http::Code::Ok, "Hello, World");
+        const Route &route = find_route(request.resource());
+        instrumented(route.metrics, Http::methodString(request.method()), request.resource(), [&] {
+            Ticket ticket;
+            const std::string client = request.address().host();
+            const Http::Code code = admit(client, &ticket);
+            if (code != Http::Code::Ok) {
+                response.send(code, rejection_message(code));
+                return;
+            }
+            route.serve(request, std::move(response), std::move(ticket));
+        });
     }
 };
 
+// Serves a request taken by the io_uring backend, which has only the routes that render.
+void serve_uring(const djehuti::HttpRequest &request,
+                 djehuti::UringHttpServer::Response *response) {
+    const Route &route = find_route(request.path);
+    instrumented(route.metrics, request.method, request.path, [&] {
+        Ticket ticket;
+        const Http::Code code = admit(request.peer, &ticket);
+        if (code != Http::Code::Ok) {
+            response->send(static_cast<int>(code), "text/plain", rejection_message(code));
+            return;
+        }
+        if (!route.render) {
+            response->send(501, "text/plain", "Not served by the uring backend\n");
+            return;
+        }
+        RenderRequest r;
+        r.method = request.method;
+        r.resource = request.path;
+        r.query = request.query;
+        r.body = request.body;
+        r.accepts_gzip = request.header("Accept-Encoding").find("gzip") != std::string_view::npos;
+        const auto rendered = route.render(r);
+        if (rendered->gzipped.empty()) {
+            response->send(rendered->status, rendered->content_type, rendered->body);
+        } else if (r.accepts_gzip) {
+            response->send(rendered->status, rendered->content_type, rendered->gzipped,
+                           "Vary: Accept-Encoding\r\nContent-Encoding: gzip\r\n");
+        } else {
+            response->send(rendered->status, rendered->content_type, rendered->body,
+                           "Vary: Accept-Encoding\r\n");
+        }
+    });
+}
+
+// Converts the values in the body of a binary CONVERT request, straight from and to doubles.
+void serve_binary_conversion(std::string_view body, djehuti::BinaryServer::Reply *reply) {
+    binary::Convert convert;
+    if (!binary::parse_convert(body, &convert)) {
+        reply->set_status(binary::Status::BAD_REQUEST);
+        reply->body()->append("Not a conversion\n");
+        return;
+    }
+    const auto conversion =
+        djehuti::units::RuntimeConversion::find(convert.dimension, convert.from, convert.to);
+    if (!conversion) {
+        reply->set_status(binary::Status::NOT_FOUND);
+        reply->body()->append("No such conversion\n");
+        return;
+    }
+    thread_local std::vector<double> values;
+    values.resize(convert.count());
+    binary::read_doubles(convert.values, values.data());
+    conversion->apply(values.data(), values.size(), values.data());
+    binary::append_doubles(reply->body(), values.data(), values.size());
+}
+
+// Serves a request on the binary port (see util/binary_protocol.hh). It's admitted as an HTTP
+// request would be, and counted and timed under a route of its own for each operation.
+// Conversions skip the response cache: its key would cost more than converting a few doubles.
+void serve_binary(const binary::Frame &request,
+                  std::string_view peer,
+                  djehuti::BinaryServer::Reply *reply) {
+    static RouteMetrics ping_metrics("binary:ping");
+    static RouteMetrics convert_metrics("binary:convert");
+    static RouteMetrics other_metrics("binary:other");
+    const auto op = static_cast<binary::Op>(request.code);
+    const bool is_convert = op == binary::Op::CONVERT;
+    const bool is_ping = op == binary::Op::PING;
+    const RouteMetrics &metrics =
+        is_convert ? convert_metrics : is_ping ? ping_metrics : other_metrics;
+    instrumented(metrics, "BINARY", is_convert ? "convert" : is_ping ? "ping" : "other", [&] {
+        Ticket ticket;
+        const Http::Code code = admit(peer, &ticket);
+        if (code != Http::Code::Ok) {
+            reply->set_status(code == Http::Code::Too_Many_Requests
+                                  ? binary::Status::TOO_MANY_REQUESTS
+                                  : binary::Status::OVERLOADED);
+            reply->body()->append(rejection_message(code));
+            return;
+        }
+        if (is_convert) {
+            serve_binary_conversion(request.body, reply);
+        } else if (!is_ping) {
+            reply->set_status(binary::Status::BAD_REQUEST);
+            reply->body()->append("No such operation\n");
+        }
+    });
+}
+
+}  // namespace
+
 DEFINE_string(listen_address, "*:8080", "The address on which to listen");
+DEFINE_string(backend, "pistache",
+              "The HTTP server to use: pistache, or uring for our own io_uring one (Linux 6.0 "
+              "or later), which serves every route but /analyze");
+DEFINE_int32(binary_port, 0,
+             "A port to serve the binary protocol on as well, for internal clients that convert "
+             "at a high rate (see util/binary_protocol.hh), with as many threads as HTTP (0 for "
+             "none)");
+DEFINE_int32(threads, 0, "The number of worker threads (0 for one per hardware thread)");
+DEFINE_bool(reuse_port, false,
+            "Run an independent endpoint per worker thread, each with its own SO_REUSEPORT "
+            "socket, and let the kernel spread connections across them");
+DEFINE_bool(pin_threads, false,
+            "Pin the workers to CPUs: with --reuse_port each gets a CPU of its own, and "
+            "otherwise the server is confined to as many CPUs as it has workers");
+DEFINE_int64(max_request_bytes, 64 << 20, "The largest request we'll take, body and all");
+DEFINE_double(rate_limit, 0.0,
+              "The most requests a second to take from everyone together, beyond which they "
+              "get 429s (0 for no limit)");
+DEFINE_double(rate_limit_burst, 1000.0, "The most requests over --rate_limit to take at once");
+DEFINE_double(client_rate_limit, 0.0,
+              "The most requests a second to take from any one client address, beyond which "
+              "they get 429s (0 for no limit)");
+DEFINE_double(client_rate_limit_burst, 50.0,
+              "The most requests over --client_rate_limit to take from a client at once");
+DEFINE_int32(admission_target_ms, 50,
+             "Turn requests away with 503s, by lowering the limit on those in progress, when "
+             "the ones already taken wait longer than this to be worked on (0 to take all)");
+DEFINE_int32(admission_max_in_flight, 4096, "The most requests to have in progress at once");
+DEFINE_int32(analysis_threads, 0,
+             "The number of threads analyzing /analyze bodies (0 for one per hardware thread)");
+DEFINE_int32(analysis_queue, 256, "The most /analyze requests waiting for a thread");
+DEFINE_int32(response_cache_mb, 64,
+             "The most memory to keep rendered responses in, to answer repeated requests "
+             "(0 for no cache)");
+DEFINE_int32(response_cache_ttl_ms, 60000, "How long a cached response is good for");
+DEFINE_bool(response_cache_gzip, true,
+            "Keep a gzipped copy of each cached response, for clients that take gzip");
+DEFINE_string(request_log, "", "A file to log requests to, in the background (none if empty)");
+DEFINE_int32(request_log_sample_every, 1, "Log one in this many requests on each thread");
+DEFINE_bool(request_log_block, false,
+            "When the request log falls behind, make requests wait for it rather than "
+            "leave lines out");
+
+namespace {
+
+// Returns the host part of --listen_address, and sets *port to its port.
+std::string listen_host(uint16_t *port) {
+    const size_t colon = FLAGS_listen_address.rfind(':');
+    const char *digits = FLAGS_listen_address.c_str() + colon + 1u;
+    const char *end = FLAGS_listen_address.c_str() + FLAGS_listen_address.size();
+    if (colon == std::string::npos || std::from_chars(digits, end, *port).ptr != end) {
+        LOG(FATAL) << "The listen address must be host:port, not " << FLAGS_listen_address;
+    }
+    return FLAGS_listen_address.substr(0u, colon);
+}
+
+// Starts serving the binary protocol on --binary_port, on the same address as HTTP, in threads
+// of its own. Returns null if it's turned off.
+std::unique_ptr<djehuti::BinaryServer> start_binary_server(int threads) {
+    if (FLAGS_binary_port <= 0) {
+        return nullptr;
+    }
+    djehuti::BinaryServer::Options options;
+    uint16_t http_port;
+    options.address = listen_host(&http_port);
+    options.port = static_cast<uint16_t>(FLAGS_binary_port);
+    options.num_threads = static_cast<size_t>(threads);
+    options.pin_threads = FLAGS_pin_threads;
+    auto server = std::make_unique<djehuti::BinaryServer>(options, serve_binary);
+    PCHECK(server->start()) << "Can't serve the binary protocol on port " << FLAGS_binary_port;
+    LOG(INFO) << "Serving the binary protocol on port " << server->port() << " with " << threads
+              << " threads";
+    return server;
+}
+
+// Serves with the io_uring backend, one ring per thread, until we're killed.
+void serve_uring_backend(int threads) {
+    djehuti::UringHttpServer::Options options;
+    uint16_t port;
+    options.address = listen_host(&port);
+    options.port = port;
+    options.num_threads = static_cast<size_t>(threads);
+    options.pin_threads = FLAGS_pin_threads;
+    options.max_request_bytes = static_cast<size_t>(FLAGS_max_request_bytes);
+    djehuti::UringHttpServer server(options, serve_uring);
+    PCHECK(server.start()) << "Can't start the io_uring server";
+    LOG(INFO) << "Serving on " << FLAGS_listen_address << " with " << threads << " rings";
+    server.wait();
+}
+
+// Serves on one endpoint with the given number of threads, until we're killed.
+void serve(const Address &addr, int threads, Flags<Tcp::Options> flags) {
+    Http::Endpoint server(addr);
+    server.init(Http::Endpoint::options().threads(threads).flags(flags).maxPayload(
+        static_cast<size_t>(FLAGS_max_request_bytes)));
+    server.setHandler(std::make_shared<DumbHandler>());
+    server.serve();
+}
+
+}  // namespace
 
 int main(int argc, char *argv[]) {
     ::gflags::SetUsageMessage("A stupid server");
@@ -44,14 +733,103 @@ int main(int argc, char *argv[]) {
     ::gflags::ParseCommandLineFlags(&argc, &argv, true);
     ::google::InitGoogleLogging(argv[0]);
 
+    int threads = FLAGS_threads;
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    const std::vector<int> cpus = djehuti::allowed_cpus();
+    if (FLAGS_pin_threads && cpus.empty()) {
+        LOG(FATAL) << "Can't tell which CPUs we may run on";
+    }
+    if (FLAGS_pin_threads && static_cast<size_t>(threads) > cpus.size()) {
+        LOG(WARNING) << "Pinning " << threads << " workers to " << cpus.size() << " CPUs";
+    }
+
+    if (!FLAGS_request_log.empty()) {
+        djehuti::AsyncLog::Options options;
+        options.sample_every = static_cast<uint32_t>(std::max(1, FLAGS_request_log_sample_every));
+        options.overflow = FLAGS_request_log_block ? djehuti::AsyncLog::Overflow::BLOCK
+                                                   : djehuti::AsyncLog::Overflow::DROP;
+        request_log = djehuti::AsyncLog::open(FLAGS_request_log, options);
+        PCHECK(request_log != nullptr) << "Can't open " << FLAGS_request_log;
+    }
+
+    djehuti::ThreadPool::Options pool_options;
+    pool_options.num_threads = static_cast<size_t>(std::max(0, FLAGS_analysis_threads));
+    pool_options.max_queued = static_cast<size_t>(std::max(1, FLAGS_analysis_queue));
+    pool_options.on_exception = [](std::exception_ptr exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception &e) {
+            LOG(ERROR) << "An analysis failed: " << e.what();
+        } catch (...) {
+            LOG(ERROR) << "An analysis failed";
+        }
+    };
+    analysis_pool = std::make_unique<djehuti::ThreadPool>(std::move(pool_options));
+    if (FLAGS_response_cache_mb > 0) {
+        djehuti::ResponseCache::Options options;
+        options.max_bytes = static_cast<size_t>(FLAGS_response_cache_mb) << 20;
+        options.ttl = std::chrono::milliseconds(FLAGS_response_cache_ttl_ms);
+        options.gzip = FLAGS_response_cache_gzip;
+        response_cache = std::make_unique<djehuti::ResponseCache>(options);
+    }
+    if (FLAGS_client_rate_limit > 0.0) {
+        djehuti::KeyedTokenBuckets::Options options;
+        options.rate = FLAGS_client_rate_limit;
+        options.burst = FLAGS_client_rate_limit_burst;
+        client_rate_limit = std::make_unique<djehuti::KeyedTokenBuckets>(options);
+    }
+    if (FLAGS_rate_limit > 0.0) {
+        global_rate_limit =
+            std::make_unique<djehuti::TokenBucket>(FLAGS_rate_limit, FLAGS_rate_limit_burst);
+    }
+    if (FLAGS_admission_target_ms > 0) {
+        djehuti::AdmissionController::Options options;
+        options.max_limit = static_cast<size_t>(std::max(1, FLAGS_admission_max_in_flight));
+        options.initial_limit = options.max_limit;
+        options.target = std::chrono::milliseconds(FLAGS_admission_target_ms);
+        admission = std::make_unique<djehuti::AdmissionController>(options);
+    }
+    add_routes();
+    // It serves until we're killed, like HTTP does.
+    const auto binary_server = start_binary_server(threads);
+
+    if (FLAGS_backend == "uring") {
+        serve_uring_backend(threads);
+        return EXIT_SUCCESS;
+    }
+    if (FLAGS_backend != "pistache") {
+        LOG(FATAL) << "No such backend: " << FLAGS_backend;
+    }
     Address addr(FLAGS_listen_address);
-    auto opts =
-        Http::Endpoint::options().threads(1).flags(Flags<Tcp::Options>(Tcp::Options::ReuseAddr));
-    Http::Endpoint server(addr);
-    server.init(opts);
-    server.setHandler(std::make_shared<HelloHandler>());
-    LOG(INFO) << "Serving on " << FLAGS_listen_address;
-    server.serve();
+    if (!FLAGS_reuse_port) {
+        if (FLAGS_pin_threads) {
+            // The endpoint's threads inherit our affinity.
+            const size_t count = std::min(static_cast<size_t>(threads), cpus.size());
+            const std::vector<int> ours(cpus.begin(), cpus.begin() + count);
+            PCHECK(djehuti::pin_current_thread(ours)) << "Can't pin to " << ours.size() << " CPUs";
+        }
+        LOG(INFO) << "Serving on " << FLAGS_listen_address << " with " << threads << " threads";
+        serve(addr, threads, Flags<Tcp::Options>(Tcp::Options::ReuseAddr));
+        return EXIT_SUCCESS;
+    }
+
+    // One single-threaded endpoint per worker, each listening on its own socket.
+    LOG(INFO) << "Serving on " << FLAGS_listen_address << " with " << threads << " endpoints";
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&addr, &cpus, i] {
+            if (FLAGS_pin_threads) {
+                const int cpu = cpus[static_cast<size_t>(i) % cpus.size()];
+                PCHECK(djehuti::pin_current_thread(cpu)) << "Can't pin to CPU " << cpu;
+            }
+            serve(addr, 1, Flags<Tcp::Options>(Tcp::Options::ReuseAddr | Tcp::Options::ReusePort));
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
 
     return EXIT_SUCCESS;
 }
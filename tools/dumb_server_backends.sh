@@ -0,0 +1,88 @@
+#!/bin/bash
+# Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Compares dumb_server's Pistache and io_uring backends: requests per second from load_generator
+# against a local instance, and (if perf is installed and allowed to trace) the server's system
+# calls per request, with 1 connection and with 64 per thread.
+#
+# Usage: dumb_server_backends.sh [threads] [seconds] [path]
+
+set -euo pipefail
+
+THREADS=${1:-1}
+SECONDS_PER_RUN=${2:-10}
+REQUEST_PATH=${3:-/}
+PORT=18080
+SERVER=${SERVER:-$(dirname "$0")/dumb_server}
+LOAD_GENERATOR=${LOAD_GENERATOR:-$(dirname "$0")/load_generator}
+
+# Prints how many requests the server has had, from its metrics.
+requests_served() {
+    curl -s "http://127.0.0.1:$PORT/metrics" \
+        | awk '/^dumb_server_requests_total/ { total += $2 } END { print total + 0 }'
+}
+
+# Runs one measurement, printing the throughput and the system calls per request (or "-").
+measure() {
+    local backend=$1
+    local connections=$2
+    "$SERVER" --backend="$backend" --listen_address="127.0.0.1:$PORT" --threads="$THREADS" \
+        --pin_threads --minloglevel=1 &
+    local pid=$!
+    sleep 1
+    local before perf_pid perf_out
+    before=$(requests_served)
+    perf_out=$(mktemp)
+    perf_pid=
+    if command -v perf > /dev/null; then
+        perf stat -x, -e raw_syscalls:sys_enter -p "$pid" -o "$perf_out" 2> /dev/null &
+        perf_pid=$!
+    fi
+    local throughput
+    throughput=$("$LOAD_GENERATOR" --target="127.0.0.1:$PORT" --threads="$THREADS" \
+        --connections="$connections" --duration_s="$SECONDS_PER_RUN" --path="$REQUEST_PATH" \
+        | awk '/^Throughput:/ { print $2 }')
+    local syscalls=-
+    if [ -n "$perf_pid" ]; then
+        kill -INT "$perf_pid"
+        wait "$perf_pid" 2> /dev/null || true
+        local after count
+        after=$(requests_served)
+        count=$(awk -F, '/raw_syscalls:sys_enter/ { print $1 }' "$perf_out")
+        if [[ "$count" =~ ^[0-9]+$ ]] && [ "$after" -gt "$before" ]; then
+            syscalls=$(awk -v c="$count" -v n="$((after - before))" \
+                'BEGIN { printf "%.2f", c / n }')
+        fi
+    fi
+    rm -f "$perf_out"
+    kill "$pid"
+    wait "$pid" 2> /dev/null || true
+    printf "%16s %16s" "$throughput" "$syscalls"
+}
+
+printf "%8s %12s %16s %16s\n" backend connections requests/s syscalls/request
+for backend in pistache uring; do
+    for connections in 1 $((64 * THREADS)); do
+        printf "%8s %12d " "$backend" "$connections"
+        measure "$backend" "$connections"
+        printf "\n"
+    done
+done
@@ -0,0 +1,74 @@
+#!/bin/bash
+# Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Measures dumb_server's throughput with 1, 2, 4, ... up to N worker threads, in both the shared
+# endpoint and --reuse_port modes, using load_generator against a local instance.
+#
+# Usage: dumb_server_scaling.sh [max_threads] [seconds]
+
+set -euo pipefail
+
+MAX_THREADS=${1:-$(nproc)}
+SECONDS_PER_RUN=${2:-10}
+PORT=18080
+SERVER=${SERVER:-$(dirname "$0")/dumb_server}
+LOAD_GENERATOR=${LOAD_GENERATOR:-$(dirname "$0")/load_generator}
+
+# Runs one measurement: the server with the given flags, loaded with 64 connections per thread.
+# Prints the throughput, with a * if load_generator saw errors or left requests unanswered, or
+# "failed" if it didn't finish; its full output goes to stderr when anything went wrong.
+measure() {
+    local threads=$1
+    shift
+    # Its output goes to stderr, so that it doesn't hold our caller's $(...) open.
+    "$SERVER" --listen_address="127.0.0.1:$PORT" --threads="$threads" --pin_threads "$@" \
+        --minloglevel=1 >&2 &
+    local pid=$!
+    sleep 1
+    local output
+    local status=0
+    output=$("$LOAD_GENERATOR" --target="127.0.0.1:$PORT" --threads="$threads" \
+        --connections=$((64 * threads)) --duration_s="$SECONDS_PER_RUN" 2>&1) || status=$?
+    kill "$pid" 2> /dev/null || true
+    wait "$pid" 2> /dev/null || true
+    local throughput
+    throughput=$(awk '/^Throughput:/ { print $2 }' <<< "$output")
+    if [ "$status" -ne 0 ]; then
+        printf "threads=%s%s: load_generator exited with %d\n%s\n" "$threads" "${*:+ $*}" \
+            "$status" "$output" >&2
+    fi
+    if [ -z "$throughput" ]; then
+        echo failed
+    elif [ "$status" -ne 0 ]; then
+        echo "$throughput*"
+    else
+        echo "$throughput"
+    fi
+}
+
+printf "%8s %16s %16s\n" threads shared reuse_port
+threads=1
+while [ "$threads" -le "$MAX_THREADS" ]; do
+    shared=$(measure "$threads")
+    reuse_port=$(measure "$threads" --reuse_port)
+    printf "%8d %16s %16s\n" "$threads" "$shared" "$reuse_port"
+    threads=$((threads * 2))
+done
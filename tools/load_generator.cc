@@ -0,0 +1,731 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A load generator for dumb_server (or any HTTP/1.1 server): it holds many keep-alive
+// connections open from an epoll loop per thread, sends a mix of requests on them, either as
+// fast as they're answered (closed loop, optionally paced) or at a fixed rate whatever happens
+// to them (open loop), and reports the throughput and the latency percentiles.
+//
+// Latency is measured from when each request was meant to start, not from when it was sent, so
+// a server that stalls is charged for the requests it kept us from sending, rather than the
+// stall hiding them (coordinated omission). In open loop requests are meant to start on their
+// schedule and wait for a free connection if need be; in closed loop with a rate, each
+// connection has a schedule of its own. Unpaced closed loop has no schedule, so there is
+// nothing to correct; the time from sending each request is reported either way.
+//
+// When measuring ends, we stop starting new requests but wait (for up to --drain_s) for the ones
+// meant to start while measuring to be answered, sending any still waiting for a connection. The
+// slowest requests are the last to finish, so stopping at once would leave them out. Whatever is
+// still unanswered or unsent at the end is counted, and its latency so far recorded.
+//
+// A connection that can't be made is counted, and tried again a little later.
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "util/http_response.hh"
+#include "util/metrics.hh"
+
+DEFINE_string(target, "127.0.0.1:8080", "The host:port of the server to load");
+DEFINE_int32(connections, 64, "The number of connections to hold open, across all threads");
+DEFINE_int32(threads, 1, "The number of threads, each with its own share of the connections");
+DEFINE_double(duration_s, 10.0, "How long to measure for, in seconds");
+DEFINE_double(warmup_s, 1.0, "How long to run before measuring, in seconds");
+DEFINE_double(drain_s, 5.0,
+              "How long to wait after measuring for the requests meant to start while measuring "
+              "to be answered, in seconds");
+DEFINE_string(mode, "closed",
+              "closed: each connection sends its next request once the last is answered; "
+              "open: requests start at --rate, whether or not earlier ones have been answered");
+DEFINE_double(rate, 0.0,
+              "Requests per second across all connections: the arrival rate in open loop, or "
+              "the pace in closed loop (0 for as fast as they're answered)");
+DEFINE_string(method, "GET", "The method of the request to send");
+DEFINE_string(path, "/", "The path (and query) of the request to send");
+DEFINE_string(body_file, "", "A file holding the body of the request to send");
+DEFINE_string(mix, "",
+              "A file of requests to send instead of --method, --path and --body_file, one a "
+              "line: <weight> <method> <path> [<body file>]; blank lines and #s are skipped");
+
+namespace {
+
+using Histogram = ::djehuti::metrics::Histogram;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool read_file(const std::string &path, std::string *contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    contents->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// The requests to send, each whole and ready to write, picked at random by weight.
+class RequestMix final {
+ public:
+    void add(double weight,
+             const std::string &method,
+             const std::string &path,
+             const std::string &host,
+             const std::string &body) {
+        std::string request = method + " " + path + " HTTP/1.1\r\nHost: " + host + "\r\n";
+        if (!body.empty() || method == "POST" || method == "PUT") {
+            request += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        request += "\r\n" + body;
+        requests_.push_back(std::move(request));
+        total_ += weight;
+        cumulative_.push_back(total_);
+    }
+
+    bool empty() const { return requests_.empty(); }
+
+    const std::string &pick(std::mt19937_64 *gen) const {
+        if (requests_.size() == 1u) {
+            return requests_.front();
+        }
+        const double x = std::uniform_real_distribution<double>(0.0, total_)(*gen);
+        const size_t i = static_cast<size_t>(
+            std::upper_bound(cumulative_.begin(), cumulative_.end(), x) - cumulative_.begin());
+        return requests_[std::min(i, requests_.size() - 1u)];
+    }
+
+ private:
+    std::vector<std::string> requests_;
+    std::vector<double> cumulative_;
+    double total_ = 0.0;
+};
+
+RequestMix load_mix(const std::string &host) {
+    RequestMix mix;
+    if (FLAGS_mix.empty()) {
+        std::string body;
+        if (!FLAGS_body_file.empty() && !read_file(FLAGS_body_file, &body)) {
+            PLOG(FATAL) << "Can't read " << FLAGS_body_file;
+        }
+        mix.add(1.0, FLAGS_method, FLAGS_path, host, body);
+        return mix;
+    }
+    std::ifstream in(FLAGS_mix);
+    PCHECK(in) << "Can't read " << FLAGS_mix;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        std::istringstream fields(line.substr(0u, line.find('#')));
+        double weight;
+        std::string method, path, body_file, body;
+        if (!(fields >> weight)) {
+            continue;
+        }
+        CHECK(fields >> method >> path && weight > 0.0)
+            << FLAGS_mix << ":" << number << ": expected <weight> <method> <path> [<body file>]";
+        if (fields >> body_file && !read_file(body_file, &body)) {
+            PLOG(FATAL) << "Can't read " << body_file;
+        }
+        mix.add(weight, method, path, host, body);
+    }
+    CHECK(!mix.empty()) << "No requests in " << FLAGS_mix;
+    return mix;
+}
+
+// What each thread counts, added up at the end.
+struct Totals {
+    uint64_t completed = 0u;  // Requests meant to start while measuring, and answered.
+    uint64_t non_2xx = 0u;    // Of those, the ones without a 2xx status.
+    uint64_t errors = 0u;     // Requests lost to a broken connection or an unreadable response.
+    uint64_t timed_out = 0u;  // Requests sent but not answered by the end of the drain.
+    uint64_t unsent = 0u;     // Requests still waiting to be sent at the end of the drain.
+    uint64_t failed_connects = 0u;
+    uint64_t bytes_read = 0u;
+    // The histograms only keep each value to within a bucket, so the largest are kept here.
+    uint64_t max_latency = 0u;
+    uint64_t max_service_time = 0u;
+};
+
+struct Connection {
+    int fd = -1;
+    bool connected = false;
+    bool busy = false;
+    std::string out;  // Written so far up to out_offset.
+    size_t out_offset = 0u;
+    djehuti::HttpResponseParser parser;
+    int64_t intended = 0;  // When the request in flight was meant to start.
+    int64_t sent = 0;      // When it was sent.
+    int64_t next_due = 0;  // When the next request is meant to start (closed loop).
+    int64_t retry_at = 0;  // When to try connecting again, if connecting failed.
+};
+
+// One thread's share of the load: its connections, and the epoll loop that drives them.
+class Worker final {
+ public:
+    Worker(const addrinfo *address,
+           const RequestMix &mix,
+           size_t num_connections,
+           double rate,
+           bool open_loop,
+           int64_t measure_from,
+           int64_t measure_until,
+           int64_t drain_until,
+           Histogram *latency,
+           Histogram *service_time,
+           uint64_t seed)
+        : address_(address),
+          mix_(mix),
+          connections_(num_connections),
+          open_loop_(open_loop),
+          interval_(rate > 0.0 ? static_cast<int64_t>(1e9 / rate) : 0),
+          measure_from_(measure_from),
+          measure_until_(measure_until),
+          drain_until_(drain_until),
+          latency_(latency),
+          service_time_(service_time),
+          gen_(seed) {}
+
+    ~Worker() {
+        for (Connection &c : connections_) {
+            if (c.fd >= 0) {
+                ::close(c.fd);
+            }
+        }
+        if (timer_ >= 0) {
+            ::close(timer_);
+        }
+        if (epoll_ >= 0) {
+            ::close(epoll_);
+        }
+    }
+
+    void run();
+
+    const Totals &totals() const { return totals_; }
+
+ private:
+    void connect(Connection *c);
+    void connect_failed(Connection *c, int error);
+    void reconnect(Connection *c) {
+        const auto it = std::find(idle_.begin(), idle_.end(), index(c));
+        if (it != idle_.end()) {
+            idle_.erase(it);
+        }
+        if (c->fd >= 0) {
+            ::close(c->fd);
+            c->fd = -1;
+        }
+        connect(c);
+    }
+    size_t index(const Connection *c) const { return static_cast<size_t>(c - connections_.data()); }
+    void send(Connection *c, int64_t intended, int64_t now);
+    void flush(Connection *c);
+    void receive(Connection *c);
+    void complete(Connection *c, int64_t now);
+    void record_latency(int64_t ns) {
+        latency_->record(static_cast<uint64_t>(ns));
+        totals_.max_latency = std::max(totals_.max_latency, static_cast<uint64_t>(ns));
+    }
+    void record_service_time(int64_t ns) {
+        service_time_->record(static_cast<uint64_t>(ns));
+        totals_.max_service_time = std::max(totals_.max_service_time, static_cast<uint64_t>(ns));
+    }
+    void fail(Connection *c);
+    void dispatch(int64_t now);
+    int64_t next_wakeup(int64_t now) const;
+    bool measured(int64_t intended) const {
+        return intended >= measure_from_ && intended < measure_until_;
+    }
+    bool owed() const;
+    void give_up(int64_t now);
+
+    const addrinfo *address_;
+    const RequestMix &mix_;
+    std::vector<Connection> connections_;
+    const bool open_loop_;
+    const int64_t interval_;  // Between requests: on the thread in open loop, or a connection.
+    const int64_t measure_from_;
+    const int64_t measure_until_;
+    const int64_t drain_until_;
+    Histogram *latency_;
+    Histogram *service_time_;
+    std::mt19937_64 gen_;
+    int epoll_ = -1;
+    int timer_ = -1;
+    std::vector<size_t> idle_;       // Connections with nothing in flight.
+    std::deque<int64_t> backlog_;    // Open loop: start times of requests waiting for one.
+    int64_t next_arrival_ = 0;       // Open loop: the start time of the next request.
+    size_t num_unconnected_ = 0u;    // Connections waiting for their retry_at.
+    Totals totals_;
+};
+
+void Worker::connect(Connection *c) {
+    c->connected = false;
+    c->busy = false;
+    c->parser.reset();
+    c->fd = ::socket(address_->ai_family, address_->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     address_->ai_protocol);
+    if (c->fd < 0) {
+        connect_failed(c, errno);  // Out of descriptors, most likely.
+        return;
+    }
+    const int one = 1;
+    ::setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(c->fd, address_->ai_addr, address_->ai_addrlen) != 0 && errno != EINPROGRESS) {
+        connect_failed(c, errno);
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = index(c);
+    PCHECK(::epoll_ctl(epoll_, EPOLL_CTL_ADD, c->fd, &event) == 0) << "Can't watch a socket";
+}
+
+// Counts a connection that couldn't be made, and leaves it to be tried again shortly.
+void Worker::connect_failed(Connection *c, int error) {
+    constexpr int64_t RETRY_NS = 10000000;
+    if (totals_.failed_connects++ == 0u) {
+        LOG(WARNING) << "Can't connect to " << FLAGS_target << ": " << std::strerror(error);
+    }
+    if (c->fd >= 0) {
+        ::close(c->fd);
+        c->fd = -1;
+    }
+    c->retry_at = now_ns() + RETRY_NS;
+    ++num_unconnected_;
+}
+
+void Worker::send(Connection *c, int64_t intended, int64_t now) {
+    c->busy = true;
+    c->intended = intended;
+    c->sent = now;
+    c->out = mix_.pick(&gen_);
+    c->out_offset = 0u;
+    flush(c);
+}
+
+void Worker::flush(Connection *c) {
+    while (c->out_offset < c->out.size()) {
+        const ssize_t n = ::send(c->fd, c->out.data() + c->out_offset,
+                                 c->out.size() - c->out_offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fail(c);
+            }
+            return;  // The rest goes when epoll says there's room.
+        }
+        c->out_offset += static_cast<size_t>(n);
+    }
+}
+
+void Worker::receive(Connection *c) {
+    char buffer[64 << 10];
+    for (;;) {
+        const ssize_t n = ::read(c->fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fail(c);
+            }
+            return;
+        }
+        if (n == 0) {
+            c->parser.close();
+            if (c->busy && c->parser.state() == djehuti::HttpResponseParser::State::COMPLETE) {
+                complete(c, now_ns());
+            }
+            if (c->busy) {
+                fail(c);
+            } else {
+                reconnect(c);
+            }
+            return;
+        }
+        totals_.bytes_read += static_cast<uint64_t>(n);
+        if (!c->busy) {
+            fail(c);  // Nobody asked for that.
+            return;
+        }
+        const std::string_view data(buffer, static_cast<size_t>(n));
+        const size_t used = c->parser.parse(data);
+        switch (c->parser.state()) {
+            case djehuti::HttpResponseParser::State::INCOMPLETE:
+                break;
+            case djehuti::HttpResponseParser::State::COMPLETE:
+                if (used != data.size()) {
+                    fail(c);
+                    return;
+                }
+                complete(c, now_ns());
+                if (!c->parser.keep_alive()) {
+                    reconnect(c);
+                    return;
+                }
+                c->parser.reset();
+                break;
+            case djehuti::HttpResponseParser::State::FAILED:
+                fail(c);
+                return;
+        }
+    }
+}
+
+void Worker::complete(Connection *c, int64_t now) {
+    if (measured(c->intended)) {
+        ++totals_.completed;
+        const int status = c->parser.status();
+        if (status < 200 || status >= 300) {
+            ++totals_.non_2xx;
+        }
+        record_latency(now - c->intended);
+        record_service_time(now - c->sent);
+    }
+    c->busy = false;
+    if (!open_loop_ && interval_ > 0) {
+        c->next_due += interval_;
+    }
+    idle_.push_back(index(c));
+}
+
+void Worker::fail(Connection *c) {
+    if (c->busy && measured(c->intended)) {
+        ++totals_.errors;
+    }
+    const bool was_busy = c->busy;
+    reconnect(c);
+    if (was_busy && !open_loop_ && interval_ > 0) {
+        c->next_due += interval_;
+    }
+}
+
+// Sends whatever is due on the connections that are free to take it. Once measuring is over,
+// only what was meant to start before then is still due.
+void Worker::dispatch(int64_t now) {
+    if (open_loop_) {
+        while (next_arrival_ <= now && next_arrival_ < measure_until_) {
+            backlog_.push_back(next_arrival_);
+            next_arrival_ += interval_;
+        }
+        while (!backlog_.empty() && !idle_.empty()) {
+            Connection &c = connections_[idle_.back()];
+            idle_.pop_back();
+            send(&c, backlog_.front(), now);
+            backlog_.pop_front();
+        }
+        return;
+    }
+    for (size_t i = 0u; i < idle_.size();) {
+        Connection &c = connections_[idle_[i]];
+        const bool due = now < measure_until_ || (interval_ > 0 && measured(c.next_due));
+        if (c.next_due <= now && due) {
+            idle_[i] = idle_.back();
+            idle_.pop_back();
+            send(&c, interval_ > 0 ? c.next_due : now, now);
+        } else {
+            ++i;
+        }
+    }
+}
+
+// Returns when we next have something to send or a connection to retry, or the end if sooner.
+int64_t Worker::next_wakeup(int64_t now) const {
+    // Once measuring is over, what's left to send goes as connections come free.
+    int64_t next = drain_until_;
+    if (now < measure_until_) {
+        next = measure_until_;
+        if (open_loop_) {
+            next = std::min(next, next_arrival_);
+        } else {
+            for (size_t i : idle_) {
+                next = std::min(next, connections_[i].next_due);
+            }
+        }
+    }
+    if (num_unconnected_ > 0u) {
+        for (const Connection &c : connections_) {
+            if (c.fd < 0) {
+                next = std::min(next, c.retry_at);
+            }
+        }
+    }
+    return next;
+}
+
+// Returns whether a request meant to start while measuring is still unanswered or unsent.
+bool Worker::owed() const {
+    for (const Connection &c : connections_) {
+        if (c.busy ? measured(c.intended) : !open_loop_ && interval_ > 0 && measured(c.next_due)) {
+            return true;
+        }
+    }
+    return std::any_of(backlog_.begin(), backlog_.end(),
+                       [this](int64_t intended) { return measured(intended); });
+}
+
+// Counts what's still owed at the end of the drain, and records its latency so far (which is
+// less than it would have been, but far more honest than leaving it out).
+void Worker::give_up(int64_t now) {
+    for (const Connection &c : connections_) {
+        if (c.busy && measured(c.intended)) {
+            ++totals_.timed_out;
+            record_latency(now - c.intended);
+            record_service_time(now - c.sent);
+        }
+        if (!open_loop_ && interval_ > 0) {
+            // A paced connection owes a request for each interval it didn't get to.
+            for (int64_t intended = c.busy ? c.next_due + interval_ : c.next_due;
+                 intended < measure_until_; intended += interval_) {
+                if (measured(intended)) {
+                    ++totals_.unsent;
+                    record_latency(now - intended);
+                }
+            }
+        }
+    }
+    for (int64_t intended : backlog_) {
+        if (measured(intended)) {
+            ++totals_.unsent;
+            record_latency(now - intended);
+        }
+    }
+}
+
+void Worker::run() {
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    PCHECK(epoll_ >= 0) << "Can't make an epoll";
+    timer_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    PCHECK(timer_ >= 0) << "Can't make a timer";
+    epoll_event timer_event{};
+    timer_event.events = EPOLLIN;
+    timer_event.data.u64 = connections_.size();
+    PCHECK(::epoll_ctl(epoll_, EPOLL_CTL_ADD, timer_, &timer_event) == 0);
+
+    // Spread the connections' first requests (or the thread's arrivals) over an interval.
+    const int64_t start = now_ns();
+    next_arrival_ = start;
+    for (size_t i = 0u; i < connections_.size(); ++i) {
+        connections_[i].next_due = start + interval_ * static_cast<int64_t>(i) /
+                                               static_cast<int64_t>(connections_.size());
+        connect(&connections_[i]);
+    }
+
+    epoll_event events[256];
+    for (;;) {
+        const int64_t now = now_ns();
+        if (now >= drain_until_ || (now >= measure_until_ && !owed())) {
+            give_up(now);
+            break;
+        }
+        if (num_unconnected_ > 0u) {
+            for (Connection &c : connections_) {
+                if (c.fd < 0 && c.retry_at <= now) {
+                    --num_unconnected_;
+                    connect(&c);
+                }
+            }
+        }
+        dispatch(now);
+        const int64_t wakeup = next_wakeup(now);
+        itimerspec when{};
+        when.it_value.tv_sec = wakeup / 1000000000;
+        when.it_value.tv_nsec = wakeup % 1000000000;
+        ::timerfd_settime(timer_, TFD_TIMER_ABSTIME, &when, nullptr);
+
+        const int n = ::epoll_wait(epoll_, events, static_cast<int>(std::size(events)), -1);
+        if (n < 0) {
+            PCHECK(errno == EINTR) << "epoll_wait failed";
+            continue;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == connections_.size()) {
+                uint64_t expirations;
+                while (::read(timer_, &expirations, sizeof(expirations)) > 0) {
+                }
+                continue;
+            }
+            Connection *c = &connections_[events[i].data.u64];
+            if (c->fd < 0) {
+                continue;
+            }
+            if (!c->connected) {
+                int error = 0;
+                socklen_t size = sizeof(error);
+                ::getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &error, &size);
+                if (error != 0) {
+                    connect_failed(c, error);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) == 0) {
+                    continue;
+                }
+                c->connected = true;
+                idle_.push_back(index(c));
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush(c);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                receive(c);
+            }
+        }
+    }
+}
+
+// Formats nanoseconds in units to suit.
+std::string format_ns(uint64_t ns) {
+    char text[32];
+    if (ns < 1000000u) {
+        std::snprintf(text, sizeof(text), "%.1fus", ns / 1e3);
+    } else if (ns < 1000000000u) {
+        std::snprintf(text, sizeof(text), "%.2fms", ns / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.2fs", ns / 1e9);
+    }
+    return text;
+}
+
+void print_percentiles(const char *title, const Histogram &histogram, uint64_t max) {
+    const Histogram::Snapshot snapshot = histogram.snapshot();
+    std::printf("%s\n", title);
+    std::printf("  %10s %10s %10s %10s %10s %10s %10s\n", "mean", "p50", "p90", "p99", "p99.9",
+                "p99.99", "max");
+    std::printf("  %10s", format_ns(snapshot.count == 0u ? 0u : snapshot.sum / snapshot.count)
+                              .c_str());
+    for (double q : {0.5, 0.9, 0.99, 0.999, 0.9999}) {
+        std::printf(" %10s", format_ns(snapshot.quantile(q)).c_str());
+    }
+    std::printf(" %10s\n", format_ns(max).c_str());
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    ::gflags::SetUsageMessage("Load an HTTP server and measure how it copes");
+    ::gflags::ParseCommandLineFlags(&argc, &argv, true);
+    ::google::InitGoogleLogging(argv[0]);
+
+    const bool open_loop = FLAGS_mode == "open";
+    CHECK(open_loop || FLAGS_mode == "closed") << "--mode must be open or closed";
+    CHECK(!open_loop || FLAGS_rate > 0.0) << "Open loop needs a --rate";
+    const int threads = std::max(1, FLAGS_threads);
+    CHECK(FLAGS_connections >= threads) << "Each thread needs at least one connection";
+
+    const size_t colon = FLAGS_target.rfind(':');
+    CHECK(colon != std::string::npos) << "--target must be host:port";
+    const std::string host = FLAGS_target.substr(0u, colon);
+    const std::string port = FLAGS_target.substr(colon + 1u);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *address = nullptr;
+    const int error = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &address);
+    CHECK(error == 0) << "Can't find " << FLAGS_target << ": " << ::gai_strerror(error);
+    const RequestMix mix = load_mix(FLAGS_target);
+
+    // Open loop splits the arrivals between the threads; closed loop paces each connection.
+    const double rate = open_loop ? FLAGS_rate / threads : FLAGS_rate / FLAGS_connections;
+    const int64_t measure_from = now_ns() + static_cast<int64_t>(FLAGS_warmup_s * 1e9);
+    const int64_t measure_until = measure_from + static_cast<int64_t>(FLAGS_duration_s * 1e9);
+    const int64_t drain_until =
+        measure_until + static_cast<int64_t>(std::max(0.0, FLAGS_drain_s) * 1e9);
+    Histogram latency;
+    Histogram service_time;
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < threads; ++i) {
+        const size_t num_connections = static_cast<size_t>(
+            FLAGS_connections / threads + (i < FLAGS_connections % threads ? 1 : 0));
+        workers.push_back(std::make_unique<Worker>(address, mix, num_connections, rate, open_loop,
+                                                   measure_from, measure_until, drain_until,
+                                                   &latency, &service_time,
+                                                   static_cast<uint64_t>(i)));
+    }
+    std::vector<std::thread> running;
+    for (auto &worker : workers) {
+        running.emplace_back(&Worker::run, worker.get());
+    }
+    for (auto &thread : running) {
+        thread.join();
+    }
+    ::freeaddrinfo(address);
+
+    Totals totals;
+    for (const auto &worker : workers) {
+        totals.completed += worker->totals().completed;
+        totals.non_2xx += worker->totals().non_2xx;
+        totals.errors += worker->totals().errors;
+        totals.timed_out += worker->totals().timed_out;
+        totals.unsent += worker->totals().unsent;
+        totals.failed_connects += worker->totals().failed_connects;
+        totals.bytes_read += worker->totals().bytes_read;
+        totals.max_latency = std::max(totals.max_latency, worker->totals().max_latency);
+        totals.max_service_time =
+            std::max(totals.max_service_time, worker->totals().max_service_time);
+    }
+    std::printf("%d connections on %d threads, %s loop", FLAGS_connections, threads,
+                open_loop ? "open" : "closed");
+    if (FLAGS_rate > 0.0) {
+        std::printf(" at %g requests/s", FLAGS_rate);
+    }
+    std::printf(", for %gs after %gs of warmup\n", FLAGS_duration_s, FLAGS_warmup_s);
+    std::printf("Completed: %llu (%llu not 2xx), errors: %llu, unanswered: %llu, never sent: %llu, "
+                "failed connects: %llu, read %.1f MB\n",
+                static_cast<unsigned long long>(totals.completed),
+                static_cast<unsigned long long>(totals.non_2xx),
+                static_cast<unsigned long long>(totals.errors),
+                static_cast<unsigned long long>(totals.timed_out),
+                static_cast<unsigned long long>(totals.unsent),
+                static_cast<unsigned long long>(totals.failed_connects), totals.bytes_read / 1e6);
+    std::printf("Throughput: %.1f requests/s\n", totals.completed / FLAGS_duration_s);
+    if (open_loop || FLAGS_rate > 0.0) {
+        print_percentiles("Latency from when each request was meant to start:", latency,
+                          totals.max_latency);
+    }
+    print_percentiles("Latency from when each request was sent:", service_time,
+                      totals.max_service_time);
+    return totals.errors == 0u && totals.timed_out == 0u && totals.unsent == 0u &&
+                   totals.failed_connects == 0u
+               ? EXIT_SUCCESS
+               : EXIT_FAILURE;
+}
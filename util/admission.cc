@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/admission.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace djehuti {
+
+namespace {
+
+constexpr int64_t NO_DELAY_YET = std::numeric_limits<int64_t>::max();
+
+int64_t nanoseconds(AdmissionController::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}  // namespace
+
+AdmissionController::Ticket &AdmissionController::Ticket::operator=(Ticket &&other) noexcept {
+    if (this != &other) {
+        finish();
+        controller_ = std::exchange(other.controller_, nullptr);
+        admitted_ = other.admitted_;
+        started_ = other.started_;
+        was_started_ = other.was_started_;
+    }
+    return *this;
+}
+
+void AdmissionController::Ticket::started(Clock::time_point now) {
+    started_ = now;
+    was_started_ = true;
+}
+
+void AdmissionController::Ticket::finish(Clock::time_point now) {
+    if (controller_ != nullptr) {
+        const auto delay = std::max(Clock::duration::zero(), started_ - admitted_);
+        std::exchange(controller_, nullptr)
+            ->release(was_started_
+                          ? std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count()
+                          : -1,
+                      now);
+    }
+}
+
+AdmissionController::AdmissionController(Options options)
+    : options_(options),
+      limit_(std::clamp(options.initial_limit, options.min_limit, options.max_limit)),
+      window_min_delay_(NO_DELAY_YET) {}
+
+AdmissionController::Ticket AdmissionController::try_admit(Clock::time_point now) {
+    size_t in_flight = in_flight_.load(std::memory_order_relaxed);
+    do {
+        if (in_flight >= limit_.load(std::memory_order_relaxed)) {
+            window_turned_away_.store(true, std::memory_order_relaxed);
+            return Ticket();
+        }
+    } while (!in_flight_.compare_exchange_weak(in_flight, in_flight + 1u,
+                                               std::memory_order_relaxed));
+    return Ticket(this, now);
+}
+
+void AdmissionController::release(int64_t delay, Clock::time_point now) {
+    in_flight_.fetch_sub(1u, std::memory_order_relaxed);
+    int64_t min_delay = window_min_delay_.load(std::memory_order_relaxed);
+    while (delay >= 0 && delay < min_delay &&
+           !window_min_delay_.compare_exchange_weak(min_delay, delay, std::memory_order_relaxed)) {
+    }
+
+    // Whoever gets to move the window on adjusts the limit for the one that just ended.
+    const int64_t t = nanoseconds(now);
+    int64_t window_end = window_end_.load(std::memory_order_relaxed);
+    const int64_t next_end =
+        t + std::chrono::duration_cast<std::chrono::nanoseconds>(options_.window).count();
+    if (t < window_end ||
+        !window_end_.compare_exchange_strong(window_end, next_end, std::memory_order_relaxed)) {
+        return;
+    }
+    min_delay = window_min_delay_.exchange(NO_DELAY_YET, std::memory_order_relaxed);
+    const bool turned_away = window_turned_away_.exchange(false, std::memory_order_relaxed);
+    const size_t limit = limit_.load(std::memory_order_relaxed);
+    if (min_delay != NO_DELAY_YET &&
+        min_delay > std::chrono::duration_cast<std::chrono::nanoseconds>(options_.target).count()) {
+        const auto cut =
+            static_cast<size_t>(std::floor(static_cast<double>(limit) * options_.backoff));
+        limit_.store(std::max(options_.min_limit, cut), std::memory_order_relaxed);
+    } else if (turned_away) {
+        limit_.store(std::min(options_.max_limit, limit + 1u), std::memory_order_relaxed);
+    }
+}
+
+}  // namespace djehuti
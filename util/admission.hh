@@ -0,0 +1,119 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace djehuti {
+
+/**
+ * An AdmissionController limits how many requests a server works on at once, and adapts the
+ * limit to keep the time requests spend queued inside the server (waiting for a worker, say)
+ * under a target. Under overload the excess is turned away at once, for the client to retry
+ * later or elsewhere, instead of joining a queue that only grows and makes everyone wait.
+ *
+ * The limit is adjusted once a window, the way CoDel decides to drop: if even the least delayed
+ * request finishing in the window waited longer than the target, there's a standing queue and
+ * the limit is cut by a factor; otherwise, if the limit turned anyone away, it goes up by one.
+ * Everything is atomic, so admitting and releasing never take a lock.
+ */
+class AdmissionController final {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        /// The limit to start with, and the range it's kept within.
+        size_t initial_limit = 64u;
+        size_t min_limit = 1u;
+        size_t max_limit = 4096u;
+        /// The queueing delay to keep under.
+        std::chrono::microseconds target{5000};
+        /// How often the limit is adjusted.
+        std::chrono::microseconds window{100000};
+        /// What the limit is multiplied by when the target is missed.
+        double backoff = 0.75;
+    };
+
+    /**
+     * A Ticket is an admitted request's place under the limit, which it gives back when it's
+     * finished (or destroyed). A default-constructed or moved-from Ticket is empty; so is one
+     * for a request that wasn't admitted.
+     */
+    class Ticket final {
+     public:
+        Ticket() = default;
+        Ticket(Ticket &&other) noexcept { *this = std::move(other); }
+        Ticket &operator=(Ticket &&other) noexcept;
+        ~Ticket() { finish(); }
+
+        explicit operator bool() const { return controller_ != nullptr; }
+
+        /**
+         * Notes that work on the request has begun, so that the time since it was admitted is
+         * its queueing delay. Only marked tickets give the controller a delay to go on: a
+         * request served at once, or turned away after it was admitted, says nothing about the
+         * queue, and counting it as no delay would keep the limit from ever being cut.
+         */
+        void started(Clock::time_point now = Clock::now());
+        /// Gives the place back, if it hasn't been already.
+        void finish(Clock::time_point now = Clock::now());
+
+     private:
+        friend class AdmissionController;
+        Ticket(AdmissionController *controller, Clock::time_point admitted)
+            : controller_(controller), admitted_(admitted) {}
+
+        AdmissionController *controller_ = nullptr;
+        Clock::time_point admitted_;
+        Clock::time_point started_;
+        bool was_started_ = false;
+    };
+
+    AdmissionController() : AdmissionController(Options()) {}
+    explicit AdmissionController(Options options);
+
+    AdmissionController(const AdmissionController &) = delete;
+    AdmissionController &operator=(const AdmissionController &) = delete;
+
+    /// Admits a request if there's room under the limit, returning an empty Ticket if not.
+    Ticket try_admit(Clock::time_point now = Clock::now());
+
+    size_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    size_t in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+
+ private:
+    // Gives back a place, with the request's queueing delay in nanoseconds, or a negative
+    // number if it has none.
+    void release(int64_t delay, Clock::time_point now);
+
+    const Options options_;
+    std::atomic<size_t> limit_;
+    std::atomic<size_t> in_flight_{0u};
+    std::atomic<int64_t> window_end_{0};     // In nanoseconds since the clock's epoch.
+    std::atomic<int64_t> window_min_delay_;  // In nanoseconds.
+    std::atomic<bool> window_turned_away_{false};
+};
+
+}  // namespace djehuti
@@ -0,0 +1,169 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/admission.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+namespace {
+
+using namespace std::chrono_literals;
+using Clock = AdmissionController::Clock;
+
+const Clock::time_point START = Clock::time_point() + 1h;
+
+struct Overload {
+    size_t admitted = 0u;
+    size_t turned_away = 0u;
+    Clock::duration p99_delay{};  // Of the requests admitted after the first second.
+};
+
+// Simulates a server with one worker taking 1 ms a request, offered three times what it can do
+// for five seconds, and returns how the requests fared. With instant_too, each request to the
+// worker comes with one that's answered at once without queueing, and isn't counted.
+Overload overload(AdmissionController *controller, bool instant_too = false) {
+    std::deque<AdmissionController::Ticket> queue;
+    std::vector<Clock::duration> delays;
+    Overload result;
+    auto busy_until = START;
+    const auto gap = std::chrono::duration_cast<Clock::duration>(1ms) / 3;
+    for (auto t = START; t < START + 5s; t += gap) {
+        // The worker takes the next request whenever it's free.
+        while (!queue.empty() && busy_until <= t) {
+            const auto start = std::max(busy_until, t - gap);
+            queue.front().started(start);
+            queue.front().finish(start + 1ms);
+            queue.pop_front();
+            busy_until = start + 1ms;
+        }
+        if (instant_too) {
+            controller->try_admit(t).finish(t);
+        }
+        auto ticket = controller->try_admit(t);
+        if (!ticket) {
+            ++result.turned_away;
+            continue;
+        }
+        ++result.admitted;
+        // It'll start when everything ahead of it is done.
+        const auto starts = std::max(busy_until, t) + static_cast<int>(queue.size()) * 1ms;
+        if (t >= START + 1s) {
+            delays.push_back(starts - t);
+        }
+        queue.push_back(std::move(ticket));
+    }
+    std::sort(delays.begin(), delays.end());
+    result.p99_delay = delays[delays.size() * 99u / 100u];
+    return result;
+}
+
+}  // namespace
+
+TEST(AdmissionControllerTest, Limit) {
+    AdmissionController::Options options;
+    options.initial_limit = 2u;
+    AdmissionController controller(options);
+    auto a = controller.try_admit(START);
+    auto b = controller.try_admit(START);
+    EXPECT_TRUE(a);
+    EXPECT_TRUE(b);
+    EXPECT_FALSE(controller.try_admit(START));
+    EXPECT_EQ(controller.in_flight(), 2u);
+
+    a.finish(START);
+    EXPECT_FALSE(a);
+    EXPECT_EQ(controller.in_flight(), 1u);
+    auto c = std::move(b);
+    EXPECT_EQ(controller.in_flight(), 1u);
+    c = AdmissionController::Ticket();
+    EXPECT_EQ(controller.in_flight(), 0u);
+}
+
+TEST(AdmissionControllerTest, Adapts) {
+    AdmissionController::Options options;
+    options.initial_limit = 10u;
+    options.target = 5ms;
+    options.window = 100ms;
+    AdmissionController controller(options);
+    controller.try_admit(START).finish(START);  // Ends the first window, at once.
+
+    // A window of requests that queued too long cuts the limit...
+    auto slow = controller.try_admit(START + 50ms);
+    slow.started(START + 60ms);
+    slow.finish(START + 100ms);
+    EXPECT_EQ(controller.limit(), 7u);
+
+    // ...and a window in which requests were turned away without queueing raises it.
+    std::vector<AdmissionController::Ticket> tickets;
+    for (int i = 0; i < 8; ++i) {
+        tickets.push_back(controller.try_admit(START + 150ms));
+    }
+    EXPECT_FALSE(tickets.back());
+    for (auto &ticket : tickets) {
+        ticket.finish(START + 150ms);
+    }
+    controller.try_admit(START + 200ms).finish(START + 200ms);
+    EXPECT_EQ(controller.limit(), 8u);
+
+    // A quiet window leaves it alone.
+    controller.try_admit(START + 300ms).finish(START + 300ms);
+    EXPECT_EQ(controller.limit(), 8u);
+}
+
+TEST(AdmissionControllerTest, BoundsDelayUnderOverload) {
+    // With a limit that never adapts (and is never reached), the queue just grows.
+    AdmissionController::Options fixed;
+    fixed.initial_limit = fixed.min_limit = fixed.max_limit = 1000000u;
+    AdmissionController unlimited(fixed);
+    const Overload queued = overload(&unlimited);
+    EXPECT_EQ(queued.turned_away, 0u);
+    EXPECT_GT(queued.p99_delay, 1s);
+
+    AdmissionController::Options options;
+    options.target = 5ms;
+    options.window = 100ms;
+    AdmissionController adaptive(options);
+    const Overload shed = overload(&adaptive);
+    // It does about what the worker can, and turns the rest away rather than keep them waiting.
+    EXPECT_GT(shed.admitted, 4500u);
+    EXPECT_GT(shed.turned_away, 9000u);
+    EXPECT_LT(shed.p99_delay, 20ms);
+}
+
+TEST(AdmissionControllerTest, BoundsDelayUnderMixedTraffic) {
+    // Requests that never queue say nothing about the queue, and mustn't hide it.
+    AdmissionController::Options options;
+    options.target = 5ms;
+    options.window = 100ms;
+    AdmissionController adaptive(options);
+    const Overload shed = overload(&adaptive, true);
+    EXPECT_GT(shed.admitted, 4500u);
+    EXPECT_GT(shed.turned_away, 9000u);
+    EXPECT_LT(shed.p99_delay, 20ms);
+}
+
+}  // namespace djehuti
@@ -0,0 +1,41 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+namespace djehuti {
+
+/// Returns the CPUs that this thread may run on, in increasing order, or none (with errno set)
+/// if we can't tell.
+std::vector<int> allowed_cpus();
+
+/**
+ * Restricts the calling thread to the given CPUs. Threads it starts afterward inherit the
+ * restriction, so pinning a thread before it builds a thread pool pins the pool too. Returns
+ * false (with errno set) if we can't.
+ */
+bool pin_current_thread(const std::vector<int> &cpus);
+
+/// Restricts the calling thread to one CPU.
+inline bool pin_current_thread(int cpu) { return pin_current_thread(std::vector<int>{cpu}); }
+
+}  // namespace djehuti
@@ -0,0 +1,58 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/affinity.hh"
+
+#include <cerrno>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+TEST(AffinityTests, PinAndRestore) {
+    const std::vector<int> original = allowed_cpus();
+    ASSERT_FALSE(original.empty());
+
+    ASSERT_TRUE(pin_current_thread(original.back()));
+    EXPECT_EQ(allowed_cpus(), std::vector<int>{original.back()});
+
+    // New threads inherit the pinning.
+    std::vector<int> inherited;
+    std::thread([&inherited] { inherited = allowed_cpus(); }).join();
+    EXPECT_EQ(inherited, std::vector<int>{original.back()});
+
+    ASSERT_TRUE(pin_current_thread(original));
+    EXPECT_EQ(allowed_cpus(), original);
+}
+
+TEST(AffinityTests, BadCpus) {
+    const std::vector<int> original = allowed_cpus();
+    errno = 0;
+    EXPECT_FALSE(pin_current_thread(-1));
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_FALSE(pin_current_thread(1 << 20));
+    // An empty set is refused by the kernel.
+    EXPECT_FALSE(pin_current_thread(std::vector<int>{}));
+    EXPECT_EQ(allowed_cpus(), original);
+}
+
+}  // namespace djehuti
@@ -23,8 +23,18 @@
 namespace djehuti {
 
 constexpr double Angle::DEFAULT_TOLERANCE;
-constexpr double Angle::HALF_CIRCLE_DEG;
+constexpr double Angle::FULL_CIRCLE_DEG;
 constexpr double Angle::TWO_PI;
+constexpr double Angle::TWO_PI_LO;
+constexpr double Angle::INV_TWO_PI;
+constexpr double Angle::CODY_WAITE_1;
+constexpr double Angle::CODY_WAITE_2;
+constexpr double Angle::CODY_WAITE_3;
+constexpr double Angle::CODY_WAITE_LIMIT;
+constexpr uint64_t Angle::INV_TWO_PI_BITS[];
+constexpr int Angle::POW2_SHIFTS[];
+constexpr double Angle::POW2_UP[];
+constexpr double Angle::POW2_DOWN[];
 
 std::ostream &operator<<(std::ostream &os, const Angle &angle) {
     switch (os.iword(Angle::geti())) {
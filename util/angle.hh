@@ -20,8 +20,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <type_traits>
+
+#include "util/math.hh"
+#include "util/quantity.hh"
 
 namespace djehuti {
 
@@ -47,26 +53,39 @@ class Angle final {
     /// Return the Angle measurement in radians. Always in the range [0, 2*Pi).
     constexpr double radians() const { return radians_; }
     /// Return the Angle measurement in degrees. Always in the range [0, 360).
-    constexpr double degrees() const { return radians_ * HALF_CIRCLE_DEG / M_PI; }
+    constexpr double degrees() const {
+        return units::convert<units::Radians, units::Degrees>(radians_);
+    }
+    /// Return the Angle as a Quantity in the given unit (units::Degrees, units::Turns, ...).
+    template <typename U>
+    constexpr Quantity<U> as() const {
+        return Quantity<units::Radians>(radians_);
+    }
 
     /// Create an Angle from a measurement in radians.
     static constexpr Angle from_radians(double radians) { return Angle(radians); }
 
     /// Create an Angle from a measurement in degrees.
+    /// Whole turns are removed exactly before converting, so huge measurements lose nothing.
     static constexpr Angle from_degrees(double degrees) {
-        return Angle(degrees * M_PI / HALF_CIRCLE_DEG);
+        return Angle(units::convert<units::Degrees, units::Radians>(normalize_degrees(degrees)));
     }
 
-    /// Returns true if the two Angles are within `tolerance` radians of one other.
-    bool almost_equal(const Angle &other, double tolerance = DEFAULT_TOLERANCE) const {
-        double diff = radians_ - other.radians_;
-        while (diff < -M_PI) {
-            diff += TWO_PI;
-        }
-        while (diff >= M_PI) {
-            diff -= TWO_PI;
+    /// Create an Angle from a Quantity in any angle unit.
+    template <typename U>
+    static constexpr Angle from_quantity(const Quantity<U> &angle) {
+        if constexpr (std::is_same<U, units::Degrees>::value) {
+            return from_degrees(angle.value());  // The exact way.
+        } else {
+            return from_radians(angle.template in<units::Radians>());
         }
-        return std::abs(diff) <= std::abs(tolerance);
+    }
+
+    /// Returns true if the two Angles are within `tolerance` radians of one other.
+    constexpr bool almost_equal(const Angle &other, double tolerance = DEFAULT_TOLERANCE) const {
+        // Both are in [0, 2*Pi), so the short way around is one or the other of these.
+        const double diff = djehuti::abs(radians_ - other.radians_);
+        return std::min(diff, TWO_PI - diff) <= djehuti::abs(tolerance);
     }
 
     /// Returns true if the two Angles are exactly equal.
@@ -117,15 +136,148 @@ class Angle final {
  private:
     enum OutputFormat : long { AUTO = 0, RADIANS = 1, DEGREES = 2 };
 
-    static constexpr double HALF_CIRCLE_DEG = 180.0;
+    static constexpr double FULL_CIRCLE_DEG = 360.0;
     static constexpr double TWO_PI = 2.0 * M_PI;
+    // The part of 2*Pi that doesn't fit in TWO_PI.
+    static constexpr double TWO_PI_LO = 2.4492935982947064e-16;
+
+    static constexpr double INV_TWO_PI = 0.5 * M_1_PI;
+
+    // 2*Pi as a sum of three doubles, the first two with only 33 significant bits, for
+    // Cody-Waite reduction of measures up to CODY_WAITE_LIMIT.
+    static constexpr double CODY_WAITE_1 = 0x1.921fb544p+2;
+    static constexpr double CODY_WAITE_2 = 0x1.0b4611a6p-32;
+    static constexpr double CODY_WAITE_3 = 0x1.3198a2e037073p-67;
+    static constexpr double CODY_WAITE_LIMIT = 0x1p22;
+
+    // 1/(2*Pi) in binary fixed point, 64 bits per word, most significant first.
+    static constexpr uint64_t INV_TWO_PI_BITS[] = {
+        0x28be60db9391054aull, 0x7f09d5f47d4d3770ull, 0x36d8a5664f10e410ull,
+        0x7f9458eaf7aef158ull, 0x6dc91b8e909374b8ull, 0x01924bba82746487ull,
+        0x3f877ac72c4a69cfull, 0xba208d7d4baed121ull, 0x3a671c09ad17df90ull,
+        0x4e64758e60d4ce7dull, 0x272117e2ef7e4a0eull, 0xc7fe25fff7816603ull,
+        0xfbcbc462d6829b47ull, 0xdb4d9fb3c9f2c26dull, 0xd3d18fd9a797fa8bull,
+        0x5d49eeb1faf97c5eull, 0xcf41ce7de294a4baull, 0x9afed7ec47e35742ull,
+        0x1580cc11bf1edaeaull,
+    };
+
+    // Powers of two used to take doubles apart without a (non-constexpr) bit_cast.
+    static constexpr int POW2_SHIFTS[] = {512, 256, 128, 64, 32, 16, 8, 4, 2, 1};
+    static constexpr double POW2_UP[] = {
+        0x1p512, 0x1p256, 0x1p128, 0x1p64, 0x1p32, 0x1p16, 0x1p8, 0x1p4, 0x1p2, 0x1p1};
+    static constexpr double POW2_DOWN[] = {
+        0x1p-512, 0x1p-256, 0x1p-128, 0x1p-64, 0x1p-32, 0x1p-16, 0x1p-8, 0x1p-4, 0x1p-2, 0x1p-1};
+
+    __extension__ typedef unsigned __int128 uint128;
 
     // This constructor is private; use one of the static methods that specifies units instead.
     explicit constexpr Angle(double radians) : radians_(normalize(radians)) {}
 
-    // Converts a radians measure to be in the range [0, 2*Pi).
+    // Converts a radians measure to be in the range [0, 2*Pi), in constant time.
     static constexpr double normalize(double r) {
-        return (r < 0) ? normalize(r + TWO_PI) : ((r >= TWO_PI) ? normalize(r - TWO_PI) : r);
+        double result = r;
+        if (r >= 0.0 && r < TWO_PI) {
+            return r;
+        } else if (r >= -TWO_PI && r < 2.0 * TWO_PI) {
+            // Within a turn of the range (as for sums and differences): a single Cody-Waite step
+            // against 2*Pi split across two doubles. The first subtraction is exact.
+            result = (r < 0.0) ? (r + TWO_PI) + TWO_PI_LO : (r - TWO_PI) - TWO_PI_LO;
+        } else if (djehuti::abs(r) < CODY_WAITE_LIMIT) {
+            // Cody-Waite: subtract the nearest whole number of turns k, with 2*Pi split into
+            // three parts so that k times the first two is exact.
+            const double k = static_cast<double>(
+                static_cast<int64_t>(r * INV_TWO_PI + ((r < 0.0) ? -0.5 : 0.5)));
+            result = ((r - k * CODY_WAITE_1) - k * CODY_WAITE_2) - k * CODY_WAITE_3;
+            result = (result < 0.0) ? (result + TWO_PI) + TWO_PI_LO : result;
+        } else if (r - r == 0.0) {
+            result = reduce_turns(r);
+        } else {
+            return r - r;  // Infinities and NaNs have no angle.
+        }
+        // A result that rounds to TWO_PI (or the -TWO_PI_LO that is TWO_PI itself) is 0.
+        return (result >= 0.0 && result < TWO_PI) ? result : 0.0;
+    }
+
+    // Splits finite, nonzero |r| into m * 2^e, with m an integer in [2^52, 2^53).
+    static constexpr uint64_t decompose(double r, int &e) {
+        double m = djehuti::abs(r);
+        e = 0;
+        // Written as selects rather than ifs so that they compile to conditional moves.
+        for (int i = 0; i < 10; ++i) {
+            const bool down = (m * POW2_DOWN[i] >= 0x1p52);
+            m = down ? m * POW2_DOWN[i] : m;
+            e += down ? POW2_SHIFTS[i] : 0;
+        }
+        for (int i = 0; i < 10; ++i) {
+            const bool up = (m * POW2_UP[i] < 0x1p53);
+            m = up ? m * POW2_UP[i] : m;
+            e -= up ? POW2_SHIFTS[i] : 0;
+        }
+        return static_cast<uint64_t>(m);
+    }
+
+    // Returns the 64 bits of 1/(2*Pi) that start 'pos + 1' bits after the binary point.
+    // (-64 < pos <= 1152.)
+    static constexpr uint64_t inv_two_pi_bits(int pos) {
+        if (pos < 0) {
+            return INV_TWO_PI_BITS[0] >> -pos;
+        }
+        const int word = pos / 64;
+        const int bit = pos % 64;
+        if (bit == 0) {
+            return INV_TWO_PI_BITS[word];
+        }
+        return (INV_TWO_PI_BITS[word] << bit) | (INV_TWO_PI_BITS[word + 1] >> (64 - bit));
+    }
+
+    // Payne-Hanek reduction of any finite r (|r| >= 4) to [0, 2*Pi) against the true value of
+    // 2*Pi. r/(2*Pi) = m * 2^e * (1/(2*Pi)), and the bits of 1/(2*Pi) before position e only
+    // contribute whole turns, so 192 bits from there on give the fraction of a turn to 128 bits.
+    static constexpr double reduce_turns(double r) {
+        int e = 0;
+        const uint64_t m = decompose(r, e);
+        const uint128 p0 = static_cast<uint128>(m) * inv_two_pi_bits(e);
+        const uint128 p1 = static_cast<uint128>(m) * inv_two_pi_bits(e + 64);
+        const uint128 p2 = static_cast<uint128>(m) * inv_two_pi_bits(e + 128);
+        uint128 turns = (p0 << 64) + p1 + (p2 >> 64);  // Whole turns overflow away.
+        if (r < 0.0) {
+            turns = -turns;
+        }
+        const double fraction = static_cast<double>(static_cast<uint64_t>(turns >> 64)) * 0x1p-64 +
+                                static_cast<double>(static_cast<uint64_t>(turns)) * 0x1p-128;
+        return fraction * TWO_PI + fraction * TWO_PI_LO;
+    }
+
+    // Reduces a degrees measure exactly (as fmod does) to the range [0, 360), in constant time.
+    static constexpr double normalize_degrees(double d) {
+        if (d >= 0.0 && d < FULL_CIRCLE_DEG) {
+            return d;
+        } else if (d >= -FULL_CIRCLE_DEG && d < 0.0) {
+            const double result = d + FULL_CIRCLE_DEG;
+            return (result < FULL_CIRCLE_DEG) ? result : 0.0;
+        } else if (djehuti::abs(d) < 0x1p52) {
+            // Subtract whole turns; k * 360 is an integer, so this is exact, and a k that is off
+            // by one only leaves a result within a turn of the range, which is fixed up exactly.
+            const double k = static_cast<double>(static_cast<int64_t>(d * (1.0 / FULL_CIRCLE_DEG)));
+            const double rem = d - k * FULL_CIRCLE_DEG;
+            return (rem < 0.0) ? rem + FULL_CIRCLE_DEG
+                               : ((rem >= FULL_CIRCLE_DEG) ? rem - FULL_CIRCLE_DEG : rem);
+        } else if (d - d != 0.0) {
+            return d - d;  // Infinities and NaNs have no angle.
+        }
+        // |d| >= 2^52, so e >= 0: rem = m * 2^e mod 360, with 2^e mod 360 by repeated squaring.
+        constexpr uint64_t FULL_CIRCLE = 360u;
+        int e = 0;
+        const uint64_t m = decompose(d, e);
+        uint64_t pow2_mod = 1u;
+        uint64_t square = 2u;
+        for (int bit = 1; bit <= 512; bit <<= 1, square = square * square % FULL_CIRCLE) {
+            if ((e & bit) != 0) {
+                pow2_mod = pow2_mod * square % FULL_CIRCLE;
+            }
+        }
+        const double rem = static_cast<double>(m % FULL_CIRCLE * pow2_mod % FULL_CIRCLE);
+        return (d < 0.0 && rem != 0.0) ? FULL_CIRCLE_DEG - rem : rem;
     }
 
     // Return the ios_base storage index for the format selector for Angles.
@@ -0,0 +1,374 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/angle_batch.hh"
+
+#include <cmath>
+#include <type_traits>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace batch {
+
+// The vectorized code loads arrays of Angles as arrays of doubles.
+static_assert(sizeof(Angle) == sizeof(double) && std::is_standard_layout<Angle>::value,
+              "An Angle must be laid out as just its radians");
+
+namespace {
+
+// The scalar versions, for CPUs without AVX2, for the leftovers after the last full vector, and
+// for vectors holding values that the vectorized code doesn't handle.
+
+void sincos_scalar(const double *radians, size_t count, double *sines, double *cosines) {
+    for (size_t i = 0u; i < count; ++i) {
+        const double r = radians[i];
+        sines[i] = std::sin(r);
+        cosines[i] = std::cos(r);
+    }
+}
+
+void cartesian_to_polar_scalar(
+    const double *xs, const double *ys, size_t count, double *radii, Angle *angles) {
+    for (size_t i = 0u; i < count; ++i) {
+        const double x = xs[i];
+        const double y = ys[i];
+        radii[i] = std::hypot(x, y);
+        angles[i] = Angle::atan2(y, x);
+    }
+}
+
+#if HAVE_X86_SIMD
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+constexpr size_t LANES = 4u;
+
+// Pi/2 as the sum of three doubles, the first two with 33 significant bits (Cody-Waite).
+constexpr double PIO2_1 = 0x1.921fb544p+0;
+constexpr double PIO2_2 = 0x1.0b4611a6p-34;
+constexpr double PIO2_3 = 0x1.3198a2e037073p-69;
+// Inputs this large could lose accuracy in the Cody-Waite reduction, so go the slow way.
+constexpr double SINCOS_LIMIT = 1e5;
+
+// Minimax polynomials for sin and cos on [-Pi/4, Pi/4] (from fdlibm's __kernel_sin/cos).
+constexpr double S1 = -1.66666666666666324348e-01;
+constexpr double S2 = 8.33333333332248946124e-03;
+constexpr double S3 = -1.98412698298579493134e-04;
+constexpr double S4 = 2.75573137070700676789e-06;
+constexpr double S5 = -2.50507602534068634195e-08;
+constexpr double S6 = 1.58969099521155010221e-10;
+constexpr double C1 = 4.16666666666666019037e-02;
+constexpr double C2 = -1.38888888888741095749e-03;
+constexpr double C3 = 2.48015872894767294178e-05;
+constexpr double C4 = -2.75573143513906633035e-07;
+constexpr double C5 = 2.08757232129817482790e-09;
+constexpr double C6 = -1.13596475577881948265e-11;
+
+// Rational approximation of atan on [-0.17, 0.66] (from Cephes' atan).
+constexpr double ATAN_P0 = -8.750608600031904122785e-01;
+constexpr double ATAN_P1 = -1.615753718733365076637e+01;
+constexpr double ATAN_P2 = -7.500855792314704667340e+01;
+constexpr double ATAN_P3 = -1.228866684490136173410e+02;
+constexpr double ATAN_P4 = -6.485021904942025371773e+01;
+constexpr double ATAN_Q0 = 2.485846490142306297962e+01;
+constexpr double ATAN_Q1 = 1.650270098316988542046e+02;
+constexpr double ATAN_Q2 = 4.328810604912902668951e+02;
+constexpr double ATAN_Q3 = 4.853903996359136964868e+02;
+constexpr double ATAN_Q4 = 1.945506571482613964425e+02;
+constexpr double ATAN_SPLIT = 0.66;
+// The parts of Pi/2 and Pi that don't fit in a double.
+constexpr double PIO2_LO = 6.123233995736765886130e-17;
+constexpr double PI_LO = 2.0 * PIO2_LO;
+
+AVX2 inline __m256d load(const double *p) { return _mm256_loadu_pd(p); }
+AVX2 inline __m256d load(const Angle *p) {
+    return _mm256_loadu_pd(reinterpret_cast<const double *>(p));
+}
+AVX2 inline __m256d splat(double d) { return _mm256_set1_pd(d); }
+AVX2 inline __m256d abs(__m256d v) { return _mm256_andnot_pd(splat(-0.0), v); }
+
+// Computes the sine and cosine of four angles (each at most SINCOS_LIMIT in magnitude).
+AVX2 inline void sincos4(__m256d x, __m256d *sines, __m256d *cosines) {
+    // x = q*Pi/2 + r, with |r| <= Pi/4.
+    const __m256d q = _mm256_round_pd(_mm256_mul_pd(x, splat(M_2_PI)),
+                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(q, splat(PIO2_1), x);
+    r = _mm256_fnmadd_pd(q, splat(PIO2_2), r);
+    r = _mm256_fnmadd_pd(q, splat(PIO2_3), r);
+    const __m256d z = _mm256_mul_pd(r, r);
+
+    __m256d poly = _mm256_fmadd_pd(z, splat(S6), splat(S5));
+    poly = _mm256_fmadd_pd(poly, z, splat(S4));
+    poly = _mm256_fmadd_pd(poly, z, splat(S3));
+    poly = _mm256_fmadd_pd(poly, z, splat(S2));
+    poly = _mm256_fmadd_pd(poly, z, splat(S1));
+    const __m256d sin_r = _mm256_fmadd_pd(_mm256_mul_pd(r, z), poly, r);
+
+    poly = _mm256_fmadd_pd(z, splat(C6), splat(C5));
+    poly = _mm256_fmadd_pd(poly, z, splat(C4));
+    poly = _mm256_fmadd_pd(poly, z, splat(C3));
+    poly = _mm256_fmadd_pd(poly, z, splat(C2));
+    poly = _mm256_fmadd_pd(poly, z, splat(C1));
+    // 1 - z/2 + z^2*poly, arranged (as fdlibm does) to keep the bits lost in 1 - z/2.
+    const __m256d half_z = _mm256_mul_pd(z, splat(0.5));
+    const __m256d w = _mm256_sub_pd(splat(1.0), half_z);
+    const __m256d cos_r = _mm256_add_pd(
+        w,
+        _mm256_fmadd_pd(_mm256_mul_pd(z, z), poly,
+                        _mm256_sub_pd(_mm256_sub_pd(splat(1.0), w), half_z)));
+
+    // Odd quadrants swap sine and cosine; quadrants 2 and 3 negate the sine, 1 and 2 the cosine.
+    const __m256i quadrant = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q));
+    const __m256d odd = _mm256_castsi256_pd(_mm256_cmpeq_epi64(
+        _mm256_and_si256(quadrant, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1)));
+    const __m256d sin_sign = _mm256_castsi256_pd(
+        _mm256_slli_epi64(_mm256_and_si256(quadrant, _mm256_set1_epi64x(2)), 62));
+    const __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(
+        _mm256_and_si256(_mm256_add_epi64(quadrant, _mm256_set1_epi64x(1)),
+                         _mm256_set1_epi64x(2)),
+        62));
+    *sines = _mm256_xor_pd(_mm256_blendv_pd(sin_r, cos_r, odd), sin_sign);
+    *cosines = _mm256_xor_pd(_mm256_blendv_pd(cos_r, sin_r, odd), cos_sign);
+}
+
+// Returns true if any of the four values is too large (or not finite) for sincos4.
+AVX2 inline bool beyond_sincos_limit(__m256d x) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(abs(x), splat(SINCOS_LIMIT), _CMP_NLE_UQ)) != 0;
+}
+
+// The vectorized versions each handle whole vectors and return the number of items handled.
+
+template <typename In>
+AVX2 size_t sincos_avx2(const In *in, size_t count, double *sines, double *cosines) {
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d x = load(in + i);
+        if (beyond_sincos_limit(x)) {
+            const double *radians = reinterpret_cast<const double *>(in + i);
+            sincos_scalar(radians, LANES, sines + i, cosines + i);
+            continue;
+        }
+        __m256d s;
+        __m256d c;
+        sincos4(x, &s, &c);
+        _mm256_storeu_pd(sines + i, s);
+        _mm256_storeu_pd(cosines + i, c);
+    }
+    return i;
+}
+
+AVX2 size_t polar_to_cartesian_avx2(
+    const double *radii, const Angle *angles, size_t count, double *xs, double *ys) {
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d r = load(radii + i);
+        __m256d s;
+        __m256d c;
+        sincos4(load(angles + i), &s, &c);
+        _mm256_storeu_pd(xs + i, _mm256_mul_pd(r, c));
+        _mm256_storeu_pd(ys + i, _mm256_mul_pd(r, s));
+    }
+    return i;
+}
+
+AVX2 size_t cartesian_to_polar_avx2(
+    const double *xs, const double *ys, size_t count, double *radii, Angle *angles) {
+    const __m256d sign_bit = splat(-0.0);
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d x = load(xs + i);
+        const __m256d y = load(ys + i);
+        const __m256d ax = abs(x);
+        const __m256d ay = abs(y);
+        // Infinities and NaNs take the scalar path. Test both coordinates, because max and min
+        // return their second operand when the first is a NaN.
+        const __m256d special = _mm256_or_pd(_mm256_cmp_pd(ax, splat(HUGE_VAL), _CMP_NLT_UQ),
+                                             _mm256_cmp_pd(ay, splat(HUGE_VAL), _CMP_NLT_UQ));
+        if (_mm256_movemask_pd(special) != 0) {
+            cartesian_to_polar_scalar(xs + i, ys + i, LANES, radii + i, angles + i);
+            continue;
+        }
+        const __m256d big = _mm256_max_pd(ax, ay);
+        const __m256d small = _mm256_min_pd(ax, ay);
+        // t = small/big is in [0, 1] (taking 0/0 as 0).
+        const __m256d zero = _mm256_cmp_pd(big, _mm256_setzero_pd(), _CMP_EQ_OQ);
+        const __m256d t = _mm256_andnot_pd(zero, _mm256_div_pd(small, big));
+
+        // atan(t) = Pi/4 + atan((t - 1)/(t + 1)) for t above the split.
+        const __m256d upper = _mm256_cmp_pd(t, splat(ATAN_SPLIT), _CMP_GT_OQ);
+        const __m256d u = _mm256_blendv_pd(
+            t, _mm256_div_pd(_mm256_sub_pd(t, splat(1.0)), _mm256_add_pd(t, splat(1.0))), upper);
+        const __m256d z = _mm256_mul_pd(u, u);
+        __m256d p = _mm256_fmadd_pd(z, splat(ATAN_P0), splat(ATAN_P1));
+        p = _mm256_fmadd_pd(p, z, splat(ATAN_P2));
+        p = _mm256_fmadd_pd(p, z, splat(ATAN_P3));
+        p = _mm256_fmadd_pd(p, z, splat(ATAN_P4));
+        __m256d q = _mm256_add_pd(z, splat(ATAN_Q0));
+        q = _mm256_fmadd_pd(q, z, splat(ATAN_Q1));
+        q = _mm256_fmadd_pd(q, z, splat(ATAN_Q2));
+        q = _mm256_fmadd_pd(q, z, splat(ATAN_Q3));
+        q = _mm256_fmadd_pd(q, z, splat(ATAN_Q4));
+        __m256d a = _mm256_fmadd_pd(_mm256_mul_pd(u, z), _mm256_div_pd(p, q), u);
+        a = _mm256_add_pd(_mm256_and_pd(upper, splat(M_PI_4)),
+                          _mm256_add_pd(a, _mm256_and_pd(upper, splat(0.5 * PIO2_LO))));
+
+        // Unfold the octant, then the quadrant, then the half plane.
+        a = _mm256_blendv_pd(
+            a, _mm256_add_pd(_mm256_sub_pd(splat(M_PI_2), a), splat(PIO2_LO)),
+            _mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+        a = _mm256_blendv_pd(a, _mm256_add_pd(_mm256_sub_pd(splat(M_PI), a), splat(PI_LO)), x);
+        a = _mm256_or_pd(a, _mm256_and_pd(y, sign_bit));
+
+        const __m256d r = _mm256_mul_pd(big, _mm256_sqrt_pd(_mm256_fmadd_pd(t, t, splat(1.0))));
+        _mm256_storeu_pd(radii + i, r);
+        alignas(32) double radians[LANES];
+        _mm256_store_pd(radians, a);
+        for (size_t j = 0u; j < LANES; ++j) {
+            angles[i + j] = Angle::from_radians(radians[j]);
+        }
+    }
+    return i;
+}
+
+AVX2 size_t rotate_avx2(const Angle &angle, double *xs, double *ys, size_t count) {
+    const __m256d s = splat(angle.sin());
+    const __m256d c = splat(angle.cos());
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d x = load(xs + i);
+        const __m256d y = load(ys + i);
+        _mm256_storeu_pd(xs + i, _mm256_fmsub_pd(x, c, _mm256_mul_pd(y, s)));
+        _mm256_storeu_pd(ys + i, _mm256_fmadd_pd(x, s, _mm256_mul_pd(y, c)));
+    }
+    return i;
+}
+
+AVX2 size_t rotate_avx2(const Angle *angles, double *xs, double *ys, size_t count) {
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        __m256d s;
+        __m256d c;
+        sincos4(load(angles + i), &s, &c);
+        const __m256d x = load(xs + i);
+        const __m256d y = load(ys + i);
+        _mm256_storeu_pd(xs + i, _mm256_fmsub_pd(x, c, _mm256_mul_pd(y, s)));
+        _mm256_storeu_pd(ys + i, _mm256_fmadd_pd(x, s, _mm256_mul_pd(y, c)));
+    }
+    return i;
+}
+
+#undef AVX2
+
+#endif  // HAVE_X86_SIMD
+
+}  // namespace
+
+void sincos(const Angle *angles, size_t count, double *sines, double *cosines) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = sincos_avx2(angles, count, sines, cosines);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) {
+        sines[i] = angles[i].sin();
+        cosines[i] = angles[i].cos();
+    }
+}
+
+void sincos(const double *radians, size_t count, double *sines, double *cosines) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = sincos_avx2(radians, count, sines, cosines);
+    }
+#endif
+    sincos_scalar(radians + done, count - done, sines + done, cosines + done);
+}
+
+void polar_to_cartesian(
+    const double *radii, const Angle *angles, size_t count, double *xs, double *ys) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = polar_to_cartesian_avx2(radii, angles, count, xs, ys);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) {
+        const double r = radii[i];
+        const Angle &angle = angles[i];
+        xs[i] = r * angle.cos();
+        ys[i] = r * angle.sin();
+    }
+}
+
+void cartesian_to_polar(
+    const double *xs, const double *ys, size_t count, double *radii, Angle *angles) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = cartesian_to_polar_avx2(xs, ys, count, radii, angles);
+    }
+#endif
+    cartesian_to_polar_scalar(xs + done, ys + done, count - done, radii + done, angles + done);
+}
+
+void rotate(const Angle &angle, double *xs, double *ys, size_t count) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = rotate_avx2(angle, xs, ys, count);
+    }
+#endif
+    const double s = angle.sin();
+    const double c = angle.cos();
+    for (size_t i = done; i < count; ++i) {
+        const double x = xs[i];
+        const double y = ys[i];
+        xs[i] = x * c - y * s;
+        ys[i] = x * s + y * c;
+    }
+}
+
+void rotate(const Angle *angles, double *xs, double *ys, size_t count) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = rotate_avx2(angles, xs, ys, count);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) {
+        const double s = angles[i].sin();
+        const double c = angles[i].cos();
+        const double x = xs[i];
+        const double y = ys[i];
+        xs[i] = x * c - y * s;
+        ys[i] = x * s + y * c;
+    }
+}
+
+}  // namespace batch
+}  // namespace djehuti
@@ -0,0 +1,59 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "util/angle.hh"
+
+// Batch trigonometry over arrays of Angles (or raw radians). These use AVX2 when the CPU has it
+// and fall back to the standard library otherwise; the vectorized results are within a couple
+// of ulps of std::sin, std::cos, std::atan2 and std::hypot. Input and output arrays may be the
+// same array, but must not otherwise overlap.
+
+namespace djehuti {
+namespace batch {
+
+/// Compute sines[i] and cosines[i] for each of the count angles.
+void sincos(const Angle *angles, size_t count, double *sines, double *cosines);
+
+/// Compute sines[i] and cosines[i] for each of the count angles given in radians.
+/// Any finite radians are allowed, but very large ones (beyond 1e5) take the slow path.
+void sincos(const double *radians, size_t count, double *sines, double *cosines);
+
+/// Convert count polar coordinates to cartesian ones: xs[i] = radii[i] * angles[i].cos() and
+/// ys[i] = radii[i] * angles[i].sin().
+void polar_to_cartesian(
+    const double *radii, const Angle *angles, size_t count, double *xs, double *ys);
+
+/// Convert count cartesian coordinates to polar ones: radii[i] = std::hypot(xs[i], ys[i]) and
+/// angles[i] = Angle::atan2(ys[i], xs[i]).
+void cartesian_to_polar(
+    const double *xs, const double *ys, size_t count, double *radii, Angle *angles);
+
+/// Rotate the count points (xs[i], ys[i]) about the origin by the given angle, in place.
+void rotate(const Angle &angle, double *xs, double *ys, size_t count);
+
+/// Rotate each of the count points (xs[i], ys[i]) about the origin by angles[i], in place.
+void rotate(const Angle *angles, double *xs, double *ys, size_t count);
+
+}  // namespace batch
+}  // namespace djehuti
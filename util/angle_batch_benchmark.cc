@@ -0,0 +1,108 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "util/angle.hh"
+#include "util/angle_batch.hh"
+#include "util/benchmark.hh"
+
+// The batch trig kernels against the equivalent one-at-a-time loops.
+
+namespace djehuti {
+namespace {
+
+constexpr size_t COUNT = 4096u;
+
+std::vector<double> random_values(double lo, double hi, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> values(COUNT);
+    for (auto &v : values) {
+        v = dist(gen);
+    }
+    return values;
+}
+
+}  // namespace
+}  // namespace djehuti
+
+int main() {
+    using namespace djehuti;
+    std::vector<Angle> angles;
+    for (double r : random_values(0.0, 2.0 * M_PI, 1u)) {
+        angles.push_back(Angle::from_radians(r));
+    }
+    auto xs = random_values(-1.0, 1.0, 2u);
+    auto ys = random_values(-1.0, 1.0, 3u);
+    std::vector<double> a(COUNT);
+    std::vector<double> b(COUNT);
+
+    benchmark::run("sin+cos one at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            a[i] = angles[i].sin();
+            b[i] = angles[i].cos();
+        }
+        benchmark::do_not_optimize(a[0]);
+    }, COUNT);
+    benchmark::run("batch::sincos", [&] {
+        batch::sincos(angles.data(), COUNT, a.data(), b.data());
+        benchmark::do_not_optimize(a[0]);
+    }, COUNT);
+
+    std::vector<double> radii(COUNT, 2.0);
+    benchmark::run("polar to cartesian one at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            a[i] = radii[i] * angles[i].cos();
+            b[i] = radii[i] * angles[i].sin();
+        }
+        benchmark::do_not_optimize(a[0]);
+    }, COUNT);
+    benchmark::run("batch::polar_to_cartesian", [&] {
+        batch::polar_to_cartesian(radii.data(), angles.data(), COUNT, a.data(), b.data());
+        benchmark::do_not_optimize(a[0]);
+    }, COUNT);
+
+    std::vector<Angle> out(COUNT);
+    benchmark::run("cartesian to polar one at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            radii[i] = std::hypot(xs[i], ys[i]);
+            out[i] = Angle::atan2(ys[i], xs[i]);
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+    benchmark::run("batch::cartesian_to_polar", [&] {
+        batch::cartesian_to_polar(xs.data(), ys.data(), COUNT, radii.data(), out.data());
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+
+    const Angle turn = Angle::from_degrees(0.001);
+    benchmark::run("batch::rotate by one angle", [&] {
+        batch::rotate(turn, xs.data(), ys.data(), COUNT);
+        benchmark::do_not_optimize(xs[0]);
+    }, COUNT);
+    benchmark::run("batch::rotate by per-point angles", [&] {
+        batch::rotate(angles.data(), xs.data(), ys.data(), COUNT);
+        benchmark::do_not_optimize(xs[0]);
+    }, COUNT);
+    return 0;
+}
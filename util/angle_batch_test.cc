@@ -0,0 +1,172 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/angle_batch.hh"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace batch {
+
+// Odd sizes so that there are leftovers after the last full vector.
+constexpr size_t COUNT = 100003u;
+
+std::vector<double> random_values(double lo, double hi, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> values(COUNT);
+    for (auto &v : values) {
+        v = dist(gen);
+    }
+    return values;
+}
+
+TEST(AngleBatchTests, SinCosRadians) {
+    for (double limit : {1.0, 10.0, 1e4, 1e7}) {
+        const auto radians = random_values(-limit, limit, 1u);
+        std::vector<double> sines(COUNT);
+        std::vector<double> cosines(COUNT);
+        sincos(radians.data(), COUNT, sines.data(), cosines.data());
+        for (size_t i = 0u; i < COUNT; ++i) {
+            ASSERT_NEAR(sines[i], std::sin(radians[i]), 2.5e-16) << radians[i];
+            ASSERT_NEAR(cosines[i], std::cos(radians[i]), 2.5e-16) << radians[i];
+        }
+    }
+
+    // Multiples of Pi/2 (and tiny values) are where the reduction loses the most.
+    std::vector<double> special;
+    for (int k = -1000; k <= 1000; ++k) {
+        special.push_back(k * M_PI_2);
+        special.push_back(std::nextafter(k * M_PI_2, 0.0));
+        special.push_back(k * 1e-300);
+    }
+    std::vector<double> sines(special.size());
+    std::vector<double> cosines(special.size());
+    sincos(special.data(), special.size(), sines.data(), cosines.data());
+    for (size_t i = 0u; i < special.size(); ++i) {
+        EXPECT_NEAR(sines[i], std::sin(special[i]), 2.5e-16) << special[i];
+        EXPECT_NEAR(cosines[i], std::cos(special[i]), 2.5e-16) << special[i];
+    }
+    EXPECT_EQ(sines[special.size() - 1u], 1000 * 1e-300);
+}
+
+TEST(AngleBatchTests, SinCosAngles) {
+    std::vector<Angle> angles;
+    for (double r : random_values(-10.0, 10.0, 2u)) {
+        angles.push_back(Angle::from_radians(r));
+    }
+    std::vector<double> sines(COUNT);
+    std::vector<double> cosines(COUNT);
+    sincos(angles.data(), COUNT, sines.data(), cosines.data());
+    for (size_t i = 0u; i < COUNT; ++i) {
+        ASSERT_NEAR(sines[i], angles[i].sin(), 2.5e-16) << angles[i];
+        ASSERT_NEAR(cosines[i], angles[i].cos(), 2.5e-16) << angles[i];
+    }
+}
+
+TEST(AngleBatchTests, PolarCartesian) {
+    const auto xs = random_values(-100.0, 100.0, 3u);
+    auto ys = random_values(-100.0, 100.0, 4u);
+    // Include the axes, the origin and some signed zeros.
+    ys[0] = 0.0;
+    ys[1] = -0.0;
+    ys[2] = 1.0;
+    ys[3] = -1.0;
+    std::vector<double> special_xs{0.0, -0.0, 0.0, -0.0, 5.0, -5.0, 1e-300, 1e300, INFINITY};
+    std::vector<double> special_ys{0.0, 0.0, -3.0, -0.0, 0.0, -0.0, 1e-300, -1e300, 1.0};
+    std::vector<double> all_xs(xs);
+    std::vector<double> all_ys(ys);
+    all_xs.insert(all_xs.end(), special_xs.begin(), special_xs.end());
+    all_ys.insert(all_ys.end(), special_ys.begin(), special_ys.end());
+    const size_t n = all_xs.size();
+
+    std::vector<double> radii(n);
+    std::vector<Angle> angles(n);
+    cartesian_to_polar(all_xs.data(), all_ys.data(), n, radii.data(), angles.data());
+    for (size_t i = 0u; i < n; ++i) {
+        const double r = std::hypot(all_xs[i], all_ys[i]);
+        if (std::isinf(r)) {
+            EXPECT_EQ(radii[i], r);
+        } else {
+            EXPECT_NEAR(radii[i], r, r * 4.5e-16) << all_xs[i] << "," << all_ys[i];
+        }
+        const Angle expected = Angle::atan2(all_ys[i], all_xs[i]);
+        // Two ulps of an angle near 2*Pi.
+        EXPECT_TRUE(angles[i].almost_equal(expected, 1.8e-15))
+            << all_xs[i] << "," << all_ys[i] << ": " << Angle::output_radians << angles[i]
+            << " != " << expected;
+    }
+
+    // A NaN in either coordinate gives a NaN radius and angle, as std::hypot and std::atan2 do,
+    // whichever lane of a vector it's in.
+    for (size_t lane = 0u; lane < 4u; ++lane) {
+        std::vector<double> nan_xs(8u, 1.0);
+        std::vector<double> nan_ys(8u, 1.0);
+        nan_xs[lane] = NAN;
+        nan_ys[4u + lane] = NAN;
+        std::vector<double> nan_radii(8u);
+        std::vector<Angle> nan_angles(8u);
+        cartesian_to_polar(nan_xs.data(), nan_ys.data(), 8u, nan_radii.data(), nan_angles.data());
+        for (size_t i = 0u; i < 8u; ++i) {
+            const bool nan = i % 4u == lane;
+            EXPECT_EQ(std::isnan(nan_radii[i]), nan) << lane << ", " << i;
+            EXPECT_EQ(std::isnan(nan_angles[i].radians()), nan) << lane << ", " << i;
+        }
+    }
+
+    std::vector<double> xs2(COUNT);
+    std::vector<double> ys2(COUNT);
+    polar_to_cartesian(radii.data(), angles.data(), COUNT, xs2.data(), ys2.data());
+    for (size_t i = 0u; i < COUNT; ++i) {
+        EXPECT_NEAR(xs2[i], radii[i] * angles[i].cos(), 1e-13);
+        EXPECT_NEAR(ys2[i], radii[i] * angles[i].sin(), 1e-13);
+        EXPECT_NEAR(xs2[i], all_xs[i], 1e-12);
+        EXPECT_NEAR(ys2[i], all_ys[i], 1e-12);
+    }
+}
+
+TEST(AngleBatchTests, Rotate) {
+    const auto xs = random_values(-100.0, 100.0, 5u);
+    const auto ys = random_values(-100.0, 100.0, 6u);
+    const auto turn = Angle::from_degrees(30.0);
+
+    std::vector<double> rx(xs);
+    std::vector<double> ry(ys);
+    rotate(turn, rx.data(), ry.data(), COUNT);
+    for (size_t i = 0u; i < COUNT; ++i) {
+        EXPECT_NEAR(rx[i], xs[i] * turn.cos() - ys[i] * turn.sin(), 1e-13);
+        EXPECT_NEAR(ry[i], xs[i] * turn.sin() + ys[i] * turn.cos(), 1e-13);
+    }
+
+    // Rotating by the remaining 330 degrees, point by point, goes back where we started.
+    const std::vector<Angle> rest(COUNT, Angle::from_degrees(330.0));
+    rotate(rest.data(), rx.data(), ry.data(), COUNT);
+    for (size_t i = 0u; i < COUNT; ++i) {
+        EXPECT_NEAR(rx[i], xs[i], 1e-12);
+        EXPECT_NEAR(ry[i], ys[i], 1e-12);
+    }
+}
+
+}  // namespace batch
+}  // namespace djehuti
@@ -0,0 +1,93 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "util/angle.hh"
+#include "util/benchmark.hh"
+
+// Normalization cost of Angle over random inputs of various magnitudes, with std::fmod (against
+// the inexact double 2*Pi) as a baseline.
+
+namespace djehuti {
+namespace {
+
+constexpr size_t NUM_ANGLES = 4096u;
+
+std::vector<double> random_values(double lo, double hi, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> values(NUM_ANGLES);
+    for (auto &v : values) {
+        v = dist(gen);
+    }
+    return values;
+}
+
+void bench_magnitude(const char *label, double lo, double hi) {
+    const auto values = random_values(lo, hi, 1u);
+    std::string name = std::string("from_radians ") + label;
+    benchmark::run(name, [&values] {
+        for (double v : values) {
+            benchmark::do_not_optimize(Angle::from_radians(v));
+        }
+    }, NUM_ANGLES);
+    name = std::string("from_degrees ") + label;
+    benchmark::run(name, [&values] {
+        for (double v : values) {
+            benchmark::do_not_optimize(Angle::from_degrees(v));
+        }
+    }, NUM_ANGLES);
+    name = std::string("std::fmod ") + label;
+    benchmark::run(name, [&values] {
+        for (double v : values) {
+            benchmark::do_not_optimize(std::fmod(v, 2.0 * M_PI));
+        }
+    }, NUM_ANGLES);
+}
+
+}  // namespace
+}  // namespace djehuti
+
+int main() {
+    using namespace djehuti;
+    bench_magnitude("[0, 2pi)", 0.0, 2.0 * M_PI);
+    bench_magnitude("[-2pi, 4pi)", -2.0 * M_PI, 4.0 * M_PI);
+    bench_magnitude("[-1e3, 1e3]", -1e3, 1e3);
+    bench_magnitude("[-1e9, 1e9]", -1e9, 1e9);
+    bench_magnitude("[-1e300, 1e300]", -1e300, 1e300);
+
+    const auto a = random_values(0.0, 2.0 * M_PI, 1u);
+    const auto b = random_values(0.0, 2.0 * M_PI, 2u);
+    benchmark::run("operator+", [&a, &b] {
+        for (size_t i = 0u; i < NUM_ANGLES; ++i) {
+            benchmark::do_not_optimize(Angle::from_radians(a[i]) + Angle::from_radians(b[i]));
+        }
+    }, NUM_ANGLES);
+    benchmark::run("almost_equal", [&a, &b] {
+        for (size_t i = 0u; i < NUM_ANGLES; ++i) {
+            benchmark::do_not_optimize(
+                Angle::from_radians(a[i]).almost_equal(Angle::from_radians(b[i]), 0.5));
+        }
+    }, NUM_ANGLES);
+    return 0;
+}
@@ -20,6 +20,8 @@
 
 #include "util/angle.hh"
 
+#include <cfloat>
+#include <cmath>
 #include <sstream>
 
 #include "gtest/gtest.h"
@@ -47,6 +49,49 @@ TEST(AngleTests, Basic) {
     EXPECT_DOUBLE_EQ(0.6, Angle::atan2(4, 3).cos());
 }
 
+TEST(AngleTests, ExtremeMagnitudes) {
+    // std::sin does an exact argument reduction, so it is the reference for large radians.
+    for (double r : {1e6, -1e6, 1e9, 1e15, -1e15, 1e22, 1e100, -1e200, 1e300, DBL_MAX, -DBL_MAX}) {
+        const auto angle = Angle::from_radians(r);
+        EXPECT_GE(angle.radians(), 0.0) << r;
+        EXPECT_LT(angle.radians(), 2.0 * M_PI) << r;
+        EXPECT_NEAR(angle.sin(), std::sin(r), 1e-14) << r;
+        EXPECT_NEAR(angle.cos(), std::cos(r), 1e-14) << r;
+    }
+    // The famous one: sin(1e22) = -0.8522008497671888...
+    EXPECT_DOUBLE_EQ(Angle::from_radians(1e22).sin(), -0.8522008497671888);
+
+    // fmod is exact, so it is the reference for large degrees.
+    for (double d : {1e9, -1e9, 123456789.125, 1e15 + 0.5, -1e17, 1e300, -DBL_MAX}) {
+        const double expected = std::fmod(std::fmod(d, 360.0) + 360.0, 360.0);
+        EXPECT_NEAR(Angle::from_degrees(d).degrees(), expected, 1e-12) << d;
+    }
+    EXPECT_TRUE(Angle::from_degrees(1e9).almost_equal(280_deg));
+    EXPECT_TRUE(Angle::from_degrees(-1e9).almost_equal(80_deg));
+
+    // Just outside the range either way.
+    EXPECT_EQ(Angle::from_radians(-0.0).radians(), 0.0);
+    EXPECT_EQ(Angle::from_radians(2.0 * M_PI).radians(), 0.0);
+    EXPECT_EQ(Angle::from_radians(-1e-300).radians(), 0.0);
+    EXPECT_GT(Angle::from_radians(-2.0 * M_PI).radians(), 0.0);
+    EXPECT_EQ(Angle::from_degrees(-1e-300).radians(), 0.0);
+    EXPECT_TRUE(std::isnan(Angle::from_radians(INFINITY).radians()));
+    EXPECT_TRUE(std::isnan(Angle::from_degrees(NAN).radians()));
+
+    // almost_equal works the short way around the circle.
+    EXPECT_TRUE((359.9999_deg).almost_equal(0.0001_deg, 1e-5));
+    EXPECT_FALSE((359.9_deg).almost_equal(0.1_deg, 1e-5));
+    EXPECT_TRUE((10_deg).almost_equal(190_deg, M_PI));
+}
+
+TEST(AngleTests, Constexpr) {
+    constexpr Angle huge = Angle::from_degrees(1e300) + Angle::from_radians(-1e300);
+    static_assert(huge.radians() >= 0.0 && huge.radians() < 2.0 * M_PI, "not normalized");
+    constexpr double billion_deg = Angle::from_degrees(1e9).degrees();
+    static_assert(billion_deg > 279.99999 && billion_deg < 280.00001, "wrong reduction");
+    static_assert((359.9999_deg).almost_equal(0.0001_deg, 1e-5), "not the short way");
+}
+
 TEST(AngleTests, Output) {
     {
         std::ostringstream oss;
@@ -0,0 +1,286 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/async_log.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+
+namespace djehuti {
+
+constexpr size_t AsyncLog::MAX_TEXT;
+
+namespace {
+
+std::atomic<uint64_t> next_log_id{1u};
+
+size_t round_up_to_power_of_two(size_t n) {
+    size_t power = 1u;
+    while (power < n) {
+        power *= 2u;
+    }
+    return power;
+}
+
+AsyncLog::Options normalized(AsyncLog::Options options) {
+    options.records_per_thread =
+        round_up_to_power_of_two(std::max<size_t>(options.records_per_thread, 1u));
+    options.sample_every = std::max(options.sample_every, 1u);
+    return options;
+}
+
+// Writes all of the text to the file, or as much as we can.
+void write_all(int fd, std::string_view text) {
+    while (!text.empty()) {
+        const ssize_t written = ::write(fd, text.data(), text.size());
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+        text.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+}  // namespace
+
+// A single-producer, single-consumer ring of records. The head and the tail count records ever
+// added and removed, and each is written by only one side, on a cache line of its own.
+struct alignas(64) AsyncLog::Ring {
+    Ring(size_t capacity, uint32_t number, std::thread::id owner)
+        : records(new Record[capacity]), mask(capacity - 1u), number(number), owner(owner) {}
+
+    const std::unique_ptr<Record[]> records;
+    const size_t mask;
+    const uint32_t number;
+    const std::thread::id owner;
+
+    // The logging thread's side.
+    alignas(64) std::atomic<uint64_t> head{0u};
+    uint64_t tail_seen = 0u;  // What it last saw of the tail.
+    uint32_t until_sample = 1u;
+    std::atomic<uint64_t> dropped{0u};
+
+    // The background thread's side.
+    alignas(64) std::atomic<uint64_t> tail{0u};
+};
+
+AsyncLog::AsyncLog(int fd, Options options)
+    : fd_(fd), options_(normalized(options)), id_(next_log_id.fetch_add(1u)) {
+    writer_ = std::thread([this] { run(); });
+}
+
+std::unique_ptr<AsyncLog> AsyncLog::open(const std::string &path, Options options) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    auto log = std::make_unique<AsyncLog>(fd, options);
+    log->owned_fd_ = fd;
+    return log;
+}
+
+AsyncLog::~AsyncLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+    if (owned_fd_ >= 0) {
+        ::close(owned_fd_);
+    }
+}
+
+AsyncLog::Ring &AsyncLog::my_ring() {
+    struct Cached {
+        uint64_t log_id;
+        Ring *ring;
+    };
+    // A thread rarely logs to more than one or two logs, so a short list does.
+    thread_local std::vector<Cached> cache;
+    for (const Cached &cached : cache) {
+        if (cached.log_id == id_) {
+            return *cached.ring;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto me = std::this_thread::get_id();
+    Ring *ring = nullptr;
+    for (const auto &other : rings_) {
+        if (other->owner == me) {
+            ring = other.get();
+        }
+    }
+    if (ring == nullptr) {
+        rings_.push_back(std::make_unique<Ring>(options_.records_per_thread,
+                                                static_cast<uint32_t>(rings_.size()), me));
+        ring = rings_.back().get();
+    }
+    if (cache.size() >= 8u) {
+        cache.clear();  // Most likely logs that are gone.
+    }
+    cache.push_back(Cached{id_, ring});
+    return *ring;
+}
+
+bool AsyncLog::sample() {
+    Ring &ring = my_ring();
+    if (--ring.until_sample != 0u) {
+        return false;
+    }
+    ring.until_sample = options_.sample_every;
+    return true;
+}
+
+AsyncLog::Record *AsyncLog::reserve(Ring **ring_out) {
+    Ring &ring = my_ring();
+    *ring_out = &ring;
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail_seen > ring.mask) {
+        ring.tail_seen = ring.tail.load(std::memory_order_acquire);
+        while (head - ring.tail_seen > ring.mask) {
+            if (options_.overflow == Overflow::DROP) {
+                ring.dropped.fetch_add(1u, std::memory_order_relaxed);
+                return nullptr;
+            }
+            // Get the background thread to empty the rings now, rather than at its next turn.
+            if (!hurry_.exchange(true, std::memory_order_relaxed)) {
+                wake_.notify_one();
+            }
+            std::this_thread::yield();
+            ring.tail_seen = ring.tail.load(std::memory_order_acquire);
+        }
+    }
+    Record *record = &ring.records[head & ring.mask];
+    record->nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+    record->thread = ring.number;
+    return record;
+}
+
+void AsyncLog::commit(Ring *ring) {
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+}
+
+void AsyncLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t ticket = ++flush_requested_;
+    wake_.notify_one();
+    flushed_.wait(lock, [this, ticket] { return flush_done_ >= ticket; });
+}
+
+uint64_t AsyncLog::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t dropped = 0u;
+    for (const auto &ring : rings_) {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void AsyncLog::run() {
+    std::vector<Ring *> rings;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait_for(lock, options_.flush_interval, [this] {
+            return stopping_ || flush_requested_ > flush_done_ ||
+                   hurry_.load(std::memory_order_relaxed);
+        });
+        hurry_.store(false, std::memory_order_relaxed);
+        const bool stopping = stopping_;
+        const uint64_t flush_requested = flush_requested_;
+        rings.clear();
+        for (const auto &ring : rings_) {
+            rings.push_back(ring.get());
+        }
+        lock.unlock();
+
+        written_.fetch_add(drain(rings), std::memory_order_relaxed);
+
+        lock.lock();
+        flush_done_ = flush_requested;
+        flushed_.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+size_t AsyncLog::drain(const std::vector<Ring *> &rings) {
+    struct Pending {
+        const Record *record;
+        bool operator<(const Pending &other) const {
+            return record->nanos < other.record->nanos ||
+                   (record->nanos == other.record->nanos && record->thread < other.record->thread);
+        }
+    };
+    std::vector<Pending> pending;
+    std::vector<uint64_t> heads;
+    for (Ring *ring : rings) {
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (uint64_t i = ring->tail.load(std::memory_order_relaxed); i != head; ++i) {
+            pending.push_back(Pending{&ring->records[i & ring->mask]});
+        }
+        heads.push_back(head);
+    }
+    if (pending.empty()) {
+        return 0u;
+    }
+    std::sort(pending.begin(), pending.end());
+
+    // Lines look like "2019-06-01 12:34:56.789012 3 text", with the thread's number after the
+    // time. The date and time only change once a second, so they're only formatted then.
+    std::string text;
+    text.reserve(pending.size() * 64u);
+    time_t second = -1;
+    char date_time[32] = "";
+    for (const Pending &p : pending) {
+        const Record &record = *p.record;
+        const auto nanos = record.nanos;
+        if (nanos / 1000000000 != second) {
+            second = nanos / 1000000000;
+            struct tm tm;
+            ::localtime_r(&second, &tm);
+            std::strftime(date_time, sizeof(date_time), "%Y-%m-%d %H:%M:%S", &tm);
+        }
+        char prefix[64];
+        const int size = std::snprintf(prefix, sizeof(prefix), "%s.%06d %u ", date_time,
+                                       static_cast<int>(nanos % 1000000000 / 1000), record.thread);
+        text.append(prefix, static_cast<size_t>(size));
+        text.append(record.text, record.size);
+        text.push_back('\n');
+    }
+    write_all(fd_, text);
+
+    for (size_t i = 0u; i < rings.size(); ++i) {
+        rings[i]->tail.store(heads[i], std::memory_order_release);
+    }
+    return pending.size();
+}
+
+}  // namespace djehuti
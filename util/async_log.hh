@@ -0,0 +1,172 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace djehuti {
+
+/**
+ * An AsyncLog writes lines to a file without putting the file, or any lock, in the way of the
+ * threads that log them. Each logging thread copies its text into fixed-size records in a ring of
+ * its own; a background thread collects the records every flush_interval, puts them in time
+ * order, formats them into timestamped lines and writes them all out at once.
+ *
+ * When a thread's ring is full, the line is either dropped (and counted) or the thread waits for
+ * the background thread to catch up, as the options say. Rings belong to the log and live as long
+ * as it does, so it's meant for long-lived threads, such as a server's workers.
+ */
+class AsyncLog final {
+ public:
+    enum class Overflow { DROP, BLOCK };
+
+    struct Options {
+        /// The number of records in each thread's ring, rounded up to a power of two.
+        size_t records_per_thread = 4096u;
+        /// What to do when a thread's ring is full.
+        Overflow overflow = Overflow::DROP;
+        /// How often the background thread writes out what has been logged.
+        std::chrono::milliseconds flush_interval{10};
+        /// sample() is true once in this many calls on each thread.
+        uint32_t sample_every = 1u;
+    };
+
+    /// The most text a line holds; anything more is cut off.
+    static constexpr size_t MAX_TEXT = 240u;
+
+    /// Log to the file descriptor, which must stay open for as long as the log exists.
+    explicit AsyncLog(int fd) : AsyncLog(fd, Options()) {}
+    AsyncLog(int fd, Options options);
+
+    /// Log to the end of the file at the given path, or return null (with errno set) if we can't
+    /// open it.
+    static std::unique_ptr<AsyncLog> open(const std::string &path) {
+        return open(path, Options());
+    }
+    static std::unique_ptr<AsyncLog> open(const std::string &path, Options options);
+
+    AsyncLog(const AsyncLog &) = delete;
+    AsyncLog &operator=(const AsyncLog &) = delete;
+    /// Writes out everything logged and stops the background thread. Nothing may be logged
+    /// once destruction has begun.
+    ~AsyncLog();
+
+    /// Returns true once in every sample_every calls on this thread, to log a sample of a busy
+    /// stream of events.
+    bool sample();
+
+    /**
+     * Log a line made of the parts, each of which is a char, an integer or something that
+     * converts to a string_view. Returns false if the line was dropped because this thread's
+     * ring was full.
+     */
+    template <typename... Parts>
+    bool log(const Parts &... parts) {
+        Ring *ring;
+        Record *record = reserve(&ring);
+        if (record == nullptr) {
+            return false;
+        }
+        char *out = record->text;
+        char *const end = record->text + MAX_TEXT;
+        (put(out, end, parts), ...);
+        record->size = static_cast<uint32_t>(out - record->text);
+        commit(ring);
+        return true;
+    }
+
+    /// Wait until everything logged before the call has been written.
+    void flush();
+
+    /// Returns the number of lines dropped because a ring was full.
+    uint64_t dropped() const;
+    /// Returns the number of lines written.
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+ private:
+    struct Record {
+        int64_t nanos;    // Since the epoch.
+        uint32_t thread;  // The number of the ring it's in.
+        uint32_t size;
+        char text[MAX_TEXT];
+    };
+    struct Ring;
+
+    static void put(char *&out, char *end, std::string_view text) {
+        const size_t size = std::min(text.size(), static_cast<size_t>(end - out));
+        std::memcpy(out, text.data(), size);
+        out += size;
+    }
+    static void put(char *&out, char *end, char c) {
+        if (out != end) {
+            *out++ = c;
+        }
+    }
+    template <typename Int, typename = std::enable_if_t<std::is_integral<Int>::value>>
+    static void put(char *&out, char *end, Int value) {
+        const auto result = std::to_chars(out, end, value);
+        if (result.ec == std::errc()) {
+            out = result.ptr;
+        }
+    }
+
+    Ring &my_ring();
+    // Returns the next free record in this thread's ring, timestamped, or null if it's full and
+    // we're dropping.
+    Record *reserve(Ring **ring);
+    // Hands the reserved record over to the background thread.
+    static void commit(Ring *ring);
+    void run();
+    // Writes out the records in the rings, returning the number written.
+    size_t drain(const std::vector<Ring *> &rings);
+
+    const int fd_;
+    int owned_fd_ = -1;
+    const Options options_;
+    const uint64_t id_;  // Distinguishes this log in the threads' caches of their rings.
+
+    mutable std::mutex mutex_;  // Guards everything below it.
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    uint64_t flush_requested_ = 0u;
+    uint64_t flush_done_ = 0u;
+    bool stopping_ = false;
+
+    std::atomic<bool> hurry_{false};  // Set by a thread waiting for room in its ring.
+    std::atomic<uint64_t> written_{0u};
+    std::thread writer_;
+};
+
+}  // namespace djehuti
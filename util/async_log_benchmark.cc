@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/async_log.hh"
+#include "util/benchmark.hh"
+
+// The latency of a small simulated request on several threads, with a log line per request:
+// not logged at all, logged synchronously under a mutex (the way glog does it), and logged to
+// an AsyncLog.
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int THREADS = 4;
+constexpr int REQUESTS = 200000;
+
+// Stands in for handling a request: a little formatting.
+std::string handle(int thread, int request) {
+    char body[64];
+    const int size = std::snprintf(body, sizeof(body), "Hello, %d/%d", thread, request);
+    return std::string(body, static_cast<size_t>(size));
+}
+
+// Runs the requests on each thread, logging each with the given function, and prints
+// percentiles of their latency.
+void measure(const char *name, const std::function<void(int, int, const std::string &)> &log) {
+    std::vector<std::vector<double>> latencies(THREADS);
+    std::vector<std::thread> threads;
+    const auto start = clock_type::now();
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&log, &latencies, t] {
+            auto &mine = latencies[t];
+            mine.reserve(REQUESTS);
+            for (int i = 0; i < REQUESTS; ++i) {
+                const auto begin = clock_type::now();
+                const std::string body = handle(t, i);
+                log(t, i, body);
+                djehuti::benchmark::do_not_optimize(body);
+                mine.push_back(std::chrono::duration<double, std::nano>(clock_type::now() - begin)
+                                   .count());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto &mine : latencies) {
+        all.insert(all.end(), mine.begin(), mine.end());
+    }
+    std::sort(all.begin(), all.end());
+    const auto percentile = [&all](double p) {
+        return all[std::min(all.size() - 1u, static_cast<size_t>(p * all.size()))];
+    };
+    std::printf("%-32s %8.0f ns p50 %8.0f ns p99 %8.0f ns p99.9 %8.0f ns max %8.2f Mreq/s\n",
+                name, percentile(0.5), percentile(0.99), percentile(0.999), all.back(),
+                THREADS * REQUESTS / seconds / 1e6);
+}
+
+}  // namespace
+
+int main() {
+    using namespace djehuti;
+    char name[] = "/tmp/async_log_benchmark.XXXXXX";
+    const int fd = ::mkstemp(name);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    ::unlink(name);
+
+    measure("no logging", [](int, int, const std::string &) {});
+
+    std::mutex mutex;
+    measure("synchronous, under a mutex", [&mutex, fd](int t, int i, const std::string &body) {
+        char line[128];
+        const int size = std::snprintf(line, sizeof(line), "Served %d/%d: %s\n", t, i,
+                                       body.c_str());
+        std::lock_guard<std::mutex> lock(mutex);
+        benchmark::do_not_optimize(::write(fd, line, static_cast<size_t>(size)));
+    });
+
+    for (const auto overflow : {AsyncLog::Overflow::DROP, AsyncLog::Overflow::BLOCK}) {
+        AsyncLog::Options options;
+        options.overflow = overflow;
+        AsyncLog log(fd, options);
+        const bool drop = overflow == AsyncLog::Overflow::DROP;
+        measure(drop ? "AsyncLog, dropping" : "AsyncLog, blocking",
+                [&log](int t, int i, const std::string &body) {
+                    log.log("Served ", t, '/', i, ": ", body);
+                });
+        std::printf("%-32s %llu lines dropped\n", "",
+                    static_cast<unsigned long long>(log.dropped()));
+    }
+
+    AsyncLog::Options options;
+    options.sample_every = 100u;
+    AsyncLog log(fd, options);
+    measure("AsyncLog, 1% sampled", [&log](int t, int i, const std::string &body) {
+        if (log.sample()) {
+            log.log("Served ", t, '/', i, ": ", body);
+        }
+    });
+
+    ::close(fd);
+    return EXIT_SUCCESS;
+}
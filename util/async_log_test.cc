@@ -0,0 +1,209 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/async_log.hh"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+// A temporary file that's removed when it goes away.
+class TemporaryFile {
+ public:
+    TemporaryFile() : name_("/tmp/async_log_test.XXXXXX") { fd_ = ::mkstemp(&name_[0]); }
+    ~TemporaryFile() {
+        ::close(fd_);
+        ::unlink(name_.c_str());
+    }
+
+    int fd() const { return fd_; }
+    const std::string &name() const { return name_; }
+
+    // Returns the text of each line, without the time and thread number in front of it.
+    std::vector<std::string> lines() const {
+        std::ifstream in(name_);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(in, line)) {
+            // "YYYY-MM-DD HH:MM:SS.uuuuuu N text"
+            const size_t thread_end = line.find(' ', 27u);
+            lines.push_back(thread_end == std::string::npos ? line : line.substr(thread_end + 1u));
+        }
+        return lines;
+    }
+
+ private:
+    std::string name_;
+    int fd_;
+};
+
+TEST(AsyncLogTests, Parts) {
+    TemporaryFile file;
+    {
+        AsyncLog log(file.fd());
+        EXPECT_TRUE(log.log("plain"));
+        EXPECT_TRUE(log.log("GET ", std::string("/path"), ' ', 200, " in ", -17, "us"));
+        EXPECT_TRUE(log.log(std::string_view("view"), 'c', uint64_t{18446744073709551615u}));
+        EXPECT_TRUE(log.log(std::string(1000u, 'x')));
+        EXPECT_TRUE(log.log(std::string(AsyncLog::MAX_TEXT - 2u, 'y'), 12345));
+    }
+    const auto lines = file.lines();
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0], "plain");
+    EXPECT_EQ(lines[1], "GET /path 200 in -17us");
+    EXPECT_EQ(lines[2], "viewc18446744073709551615");
+    EXPECT_EQ(lines[3], std::string(AsyncLog::MAX_TEXT, 'x'));
+    // A number that doesn't fit is left out.
+    EXPECT_EQ(lines[4], std::string(AsyncLog::MAX_TEXT - 2u, 'y'));
+}
+
+TEST(AsyncLogTests, Format) {
+    TemporaryFile file;
+    {
+        AsyncLog log(file.fd());
+        log.log("hello");
+        log.flush();
+        EXPECT_EQ(log.written(), 1u);
+    }
+    std::ifstream in(file.name());
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    ASSERT_EQ(line.size(), 34u) << line;
+    EXPECT_EQ(line[4], '-');
+    EXPECT_EQ(line[10], ' ');
+    EXPECT_EQ(line[13], ':');
+    EXPECT_EQ(line[19], '.');
+    EXPECT_EQ(line.substr(26u), " 0 hello");
+}
+
+TEST(AsyncLogTests, ManyThreads) {
+    constexpr int THREADS = 4;
+    constexpr int LINES = 20000;
+    TemporaryFile file;
+    {
+        AsyncLog::Options options;
+        options.overflow = AsyncLog::Overflow::BLOCK;
+        options.records_per_thread = 64u;
+        AsyncLog log(file.fd(), options);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&log, t] {
+                for (int i = 0; i < LINES; ++i) {
+                    EXPECT_TRUE(log.log(t, ' ', i));
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        log.flush();
+        EXPECT_EQ(log.written(), static_cast<uint64_t>(THREADS * LINES));
+        EXPECT_EQ(log.dropped(), 0u);
+    }
+
+    // Everything is there, and each thread's lines are in order.
+    std::vector<int> next(THREADS, 0);
+    for (const std::string &line : file.lines()) {
+        std::istringstream in(line);
+        int t, i;
+        ASSERT_TRUE(in >> t >> i) << line;
+        ASSERT_EQ(i, next[t]) << t;
+        ++next[t];
+    }
+    EXPECT_EQ(next, std::vector<int>(THREADS, LINES));
+}
+
+TEST(AsyncLogTests, Drop) {
+    TemporaryFile file;
+    {
+        AsyncLog::Options options;
+        options.records_per_thread = 3u;  // Really 4.
+        options.flush_interval = std::chrono::hours(1);
+        AsyncLog log(file.fd(), options);
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ(log.log(i), i < 4);
+        }
+        EXPECT_EQ(log.dropped(), 6u);
+        log.flush();
+        EXPECT_TRUE(log.log(10));
+    }
+    EXPECT_EQ(file.lines(), (std::vector<std::string>{"0", "1", "2", "3", "10"}));
+}
+
+TEST(AsyncLogTests, Block) {
+    TemporaryFile file;
+    {
+        AsyncLog::Options options;
+        options.records_per_thread = 4u;
+        options.overflow = AsyncLog::Overflow::BLOCK;
+        options.flush_interval = std::chrono::hours(1);
+        AsyncLog log(file.fd(), options);
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_TRUE(log.log(i));
+        }
+    }
+    const auto lines = file.lines();
+    ASSERT_EQ(lines.size(), 100u);
+    EXPECT_EQ(lines[99], "99");
+}
+
+TEST(AsyncLogTests, Sample) {
+    TemporaryFile file;
+    AsyncLog::Options options;
+    options.sample_every = 3u;
+    AsyncLog log(file.fd(), options);
+    std::vector<bool> sampled;
+    for (int i = 0; i < 7; ++i) {
+        sampled.push_back(log.sample());
+    }
+    EXPECT_EQ(sampled, (std::vector<bool>{true, false, false, true, false, false, true}));
+
+    // Each thread counts for itself.
+    bool other = false;
+    std::thread([&log, &other] { other = log.sample(); }).join();
+    EXPECT_TRUE(other);
+}
+
+TEST(AsyncLogTests, Open) {
+    TemporaryFile file;
+    {
+        auto log = AsyncLog::open(file.name());
+        ASSERT_NE(log, nullptr);
+        log->log("first");
+    }
+    {
+        auto log = AsyncLog::open(file.name());
+        log->log("second");
+    }
+    EXPECT_EQ(file.lines(), (std::vector<std::string>{"first", "second"}));
+    EXPECT_EQ(AsyncLog::open("/nonexistent/directory/log"), nullptr);
+}
+
+}  // namespace djehuti
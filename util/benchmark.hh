@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+namespace djehuti {
+namespace benchmark {
+
+/// Keep the compiler from optimizing away the computation of value.
+template <typename T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Call fn() repeatedly for at least min_seconds and print its name and the time per call.
+ * If items_per_call or bytes_per_call are nonzero, also print the time per item and the
+ * throughput in items or bytes per second. Returns the mean number of seconds per call.
+ */
+template <typename Fn>
+double run(std::string_view name,
+           Fn &&fn,
+           size_t items_per_call = 0u,
+           size_t bytes_per_call = 0u,
+           double min_seconds = 0.5) {
+    using clock = std::chrono::steady_clock;
+    fn();  // Warm up.
+    size_t calls = 0u;
+    size_t batch = 1u;
+    double elapsed = 0.0;
+    const auto start = clock::now();
+    while (elapsed < min_seconds) {
+        for (size_t i = 0u; i < batch; ++i) {
+            fn();
+        }
+        calls += batch;
+        batch *= 2u;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    }
+    const double per_call = elapsed / static_cast<double>(calls);
+    std::printf("%-48.*s %12.1f ns/call", static_cast<int>(name.size()), name.data(),
+                per_call * 1e9);
+    if (items_per_call != 0u) {
+        std::printf(" %9.2f ns/item %9.2f Mitems/s",
+                    per_call * 1e9 / static_cast<double>(items_per_call),
+                    static_cast<double>(items_per_call) / per_call / 1e6);
+    }
+    if (bytes_per_call != 0u) {
+        std::printf(" %8.3f GB/s", static_cast<double>(bytes_per_call) / per_call / 1e9);
+    }
+    std::printf("\n");
+    return per_call;
+}
+
+}  // namespace benchmark
+}  // namespace djehuti
@@ -0,0 +1,96 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_angle.hh"
+
+#include <array>
+#include <cmath>
+
+namespace djehuti {
+namespace binary_angle {
+
+namespace {
+
+// The table holds the sine at TABLE_SIZE evenly-spaced points around the circle; the cosine
+// is the sine a quarter turn later.
+constexpr int TABLE_BITS = 10;
+constexpr size_t TABLE_SIZE = size_t(1u) << TABLE_BITS;
+constexpr size_t TABLE_MASK = TABLE_SIZE - 1u;
+constexpr size_t QUARTER_TURN = TABLE_SIZE / 4u;
+constexpr int STEP_SHIFT = 64 - TABLE_BITS;
+constexpr double RADIANS_PER_UNIT = 2.0 * M_PI / 0x1p64;
+
+// The sine of i/TABLE_SIZE turns for 0 <= i <= QUARTER_TURN. Arguments are kept below Pi/4 so
+// that the rounding of Pi matters as little as possible.
+double quarter_sine(size_t i) {
+    const auto radians = [](size_t j) { return M_PI * static_cast<double>(j) / (TABLE_SIZE / 2u); };
+    return (i <= QUARTER_TURN / 2u) ? std::sin(radians(i)) : std::cos(radians(QUARTER_TURN - i));
+}
+
+const std::array<double, TABLE_SIZE> &sine_table() {
+    static const auto table = [] {
+        std::array<double, TABLE_SIZE> t;
+        for (size_t i = 0u; i < TABLE_SIZE; ++i) {
+            const size_t quadrant = i / QUARTER_TURN;
+            const size_t q = i % QUARTER_TURN;
+            const double s = quarter_sine((quadrant % 2u == 0u) ? q : QUARTER_TURN - q);
+            t[i] = (quadrant < 2u) ? s : -s;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Splits turns into the nearest table point and the (signed) remainder in radians, which is at
+// most Pi/TABLE_SIZE, and returns the sine and cosine at each.
+struct Split {
+    double sin_point;
+    double cos_point;
+    double sin_rest;
+    double cos_rest;
+};
+
+Split split(uint64_t turns) {
+    const auto &table = sine_table();
+    const uint64_t point = (turns + (uint64_t(1u) << (STEP_SHIFT - 1))) >> STEP_SHIFT;
+    const auto rest = static_cast<int64_t>(turns - (point << STEP_SHIFT));
+    const double d = static_cast<double>(rest) * RADIANS_PER_UNIT;
+    const double d2 = d * d;
+    // Taylor series; with |d| < 0.0031 the next terms are below an ulp.
+    return Split{table[point & TABLE_MASK],
+                 table[(point + QUARTER_TURN) & TABLE_MASK],
+                 d * (1.0 - d2 / 6.0 * (1.0 - d2 / 20.0)),
+                 1.0 - d2 / 2.0 * (1.0 - d2 / 12.0)};
+}
+
+}  // namespace
+
+double sin(uint64_t turns) {
+    const Split s = split(turns);
+    return s.sin_point * s.cos_rest + s.cos_point * s.sin_rest;
+}
+
+double cos(uint64_t turns) {
+    const Split s = split(turns);
+    return s.cos_point * s.cos_rest - s.sin_point * s.sin_rest;
+}
+
+}  // namespace binary_angle
+}  // namespace djehuti
@@ -0,0 +1,208 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include "util/angle.hh"
+
+namespace djehuti {
+
+namespace binary_angle {
+
+// Table-based sine and cosine of a fraction of a turn, in units of 2^-64 turns.
+double sin(uint64_t turns);
+double cos(uint64_t turns);
+
+}  // namespace binary_angle
+
+/**
+ * A BinaryAngle is an angle stored as a fixed-point fraction of a turn (a "binary angle
+ * measurement"): the full circle is 2^N for an N-bit unsigned Word, so sums and differences
+ * wrap around the circle on integer overflow with no normalization step at all.
+ * It is an immutable copyable and movable value type, like Angle, and converts to and from
+ * Angle; the conversion from Angle rounds to the nearest unit.
+ */
+template <typename Word,
+          typename = std::enable_if_t<std::is_unsigned<Word>::value &&
+                                      (sizeof(Word) == 4u || sizeof(Word) == 8u)>>
+class BinaryAngle final {
+ public:
+    /// The number of bits in the measurement; the full circle is 2^BITS units.
+    static constexpr int BITS = std::numeric_limits<Word>::digits;
+
+    /// The default constructor returns a zero angle.
+    constexpr BinaryAngle() : units_(0u) {}
+    ~BinaryAngle() = default;
+
+    // Copyable and movable.
+    constexpr BinaryAngle(const BinaryAngle &) = default;
+    constexpr BinaryAngle(BinaryAngle &&) = default;
+    BinaryAngle &operator=(const BinaryAngle &) = default;
+    BinaryAngle &operator=(BinaryAngle &&) = default;
+
+    /// Angles (and so the _deg and _rad literals) convert implicitly, rounding to the nearest
+    /// unit: `BinaryAngle32 heading = 90_deg;`.
+    constexpr BinaryAngle(const Angle &angle) : units_(from_turns(angle.radians() / TWO_PI)) {}
+
+    /// Create a BinaryAngle from its raw measurement, in units of 2^-BITS turns.
+    static constexpr BinaryAngle from_units(Word units) { return BinaryAngle(units); }
+    /// Create a BinaryAngle from a measurement in radians.
+    static constexpr BinaryAngle from_radians(double radians) {
+        return BinaryAngle(Angle::from_radians(radians));
+    }
+    /// Create a BinaryAngle from a measurement in degrees.
+    static constexpr BinaryAngle from_degrees(double degrees) {
+        return BinaryAngle(Angle::from_degrees(degrees));
+    }
+
+    /// Return the raw measurement, in units of 2^-BITS turns.
+    constexpr Word units() const { return units_; }
+    /// Return the measurement as a fraction of a turn. Always in the range [0, 1).
+    constexpr double turns() const {
+        // The last few 64-bit measurements round up to a whole turn as doubles.
+        const double turns = static_cast<double>(units_) * UNIT_TURNS;
+        return (turns < LAST_TURNS) ? turns : LAST_TURNS;
+    }
+    /// Return the measurement in radians. Always in the range [0, 2*Pi).
+    constexpr double radians() const { return angle().radians(); }
+    /// Return the measurement in degrees. Always in the range [0, 360).
+    constexpr double degrees() const { return turns() * FULL_CIRCLE_DEG; }
+    /// Return the measurement as an Angle. For 32-bit BinaryAngles, converting back gives the
+    /// same BinaryAngle; 64-bit ones have more precision than an Angle can hold.
+    constexpr Angle angle() const { return Angle::from_radians(turns() * TWO_PI); }
+
+    /// Returns true if the two angles are within `tolerance` radians of one other.
+    constexpr bool almost_equal(const BinaryAngle &other,
+                                double tolerance = Angle::DEFAULT_TOLERANCE) const {
+        // The difference as a signed number of units is the short way around the circle.
+        const Word diff = units_ - other.units_;
+        const Word distance = (diff > HALF_TURN) ? Word(0u - diff) : diff;
+        return static_cast<double>(distance) * UNIT_TURNS * TWO_PI <= djehuti::abs(tolerance);
+    }
+
+    /// Returns true if the two angles are exactly equal.
+    constexpr bool operator==(const BinaryAngle &other) const { return units_ == other.units_; }
+    /// Returns false if the two angles are exactly equal.
+    constexpr bool operator!=(const BinaryAngle &other) const { return units_ != other.units_; }
+    /// Returns true if the angle is smaller than the other.
+    constexpr bool operator<(const BinaryAngle &other) const { return units_ < other.units_; }
+    /// Returns true if the angle is smaller than or equal to the other.
+    constexpr bool operator<=(const BinaryAngle &other) const { return units_ <= other.units_; }
+    /// Returns true if the angle is larger than the other.
+    constexpr bool operator>(const BinaryAngle &other) const { return units_ > other.units_; }
+    /// Returns true if the angle is larger than or equal to the other.
+    constexpr bool operator>=(const BinaryAngle &other) const { return units_ >= other.units_; }
+
+    /// Returns the sine of the angle (from a table; within 5e-16).
+    double sin() const { return binary_angle::sin(wide_units()); }
+    /// Returns the cosine of the angle (from a table; within 5e-16).
+    double cos() const { return binary_angle::cos(wide_units()); }
+
+ private:
+    static constexpr double TWO_PI = 2.0 * M_PI;
+    static constexpr double FULL_CIRCLE_DEG = 360.0;
+    static constexpr double FULL_TURN = 2.0 * static_cast<double>(Word(1u) << (BITS - 1));
+    static constexpr double UNIT_TURNS = 1.0 / FULL_TURN;
+    static constexpr double LAST_TURNS = 1.0 - 0x1p-53;  // The largest double below 1.
+    static constexpr Word HALF_TURN = Word(1u) << (BITS - 1);
+
+    explicit constexpr BinaryAngle(Word units) : units_(units) {}
+
+    // Rounds a fraction of a turn in [0, 1] to the nearest unit; a whole turn wraps to 0.
+    static constexpr Word from_turns(double turns) {
+        const double units = turns * FULL_TURN + 0.5;
+        return (units < FULL_TURN) ? static_cast<Word>(units) : Word(0u);
+    }
+
+    // The measurement in units of 2^-64 turns.
+    constexpr uint64_t wide_units() const { return static_cast<uint64_t>(units_) << (64 - BITS); }
+
+    /// The angle is stored as a fraction of a turn.
+    Word units_;
+};
+
+template <typename Word, typename Enable>
+constexpr int BinaryAngle<Word, Enable>::BITS;
+template <typename Word, typename Enable>
+constexpr double BinaryAngle<Word, Enable>::TWO_PI;
+template <typename Word, typename Enable>
+constexpr double BinaryAngle<Word, Enable>::FULL_CIRCLE_DEG;
+template <typename Word, typename Enable>
+constexpr double BinaryAngle<Word, Enable>::FULL_TURN;
+template <typename Word, typename Enable>
+constexpr double BinaryAngle<Word, Enable>::UNIT_TURNS;
+template <typename Word, typename Enable>
+constexpr double BinaryAngle<Word, Enable>::LAST_TURNS;
+template <typename Word, typename Enable>
+constexpr Word BinaryAngle<Word, Enable>::HALF_TURN;
+
+/// A binary angle with 2^32 units to the turn (about 1.5e-9 radians each).
+using BinaryAngle32 = BinaryAngle<uint32_t>;
+/// A binary angle with 2^64 units to the turn (about 3.4e-19 radians each).
+using BinaryAngle64 = BinaryAngle<uint64_t>;
+
+/// Returns the sum of the two angles, wrapping around the circle.
+template <typename Word, typename Enable>
+constexpr BinaryAngle<Word, Enable> operator+(const BinaryAngle<Word, Enable> &ang1,
+                                              const BinaryAngle<Word, Enable> &ang2) {
+    return BinaryAngle<Word, Enable>::from_units(ang1.units() + ang2.units());
+}
+
+/// Returns the difference between the two angles, wrapping around the circle. As for Angle, if
+/// ang2 is larger than ang1, the result is 360 degrees minus the difference.
+template <typename Word, typename Enable>
+constexpr BinaryAngle<Word, Enable> operator-(const BinaryAngle<Word, Enable> &ang1,
+                                              const BinaryAngle<Word, Enable> &ang2) {
+    return BinaryAngle<Word, Enable>::from_units(ang1.units() - ang2.units());
+}
+
+/// Returns the angle the other way around the circle (360 degrees minus the angle).
+template <typename Word, typename Enable>
+constexpr BinaryAngle<Word, Enable> operator-(const BinaryAngle<Word, Enable> &ang) {
+    return BinaryAngle<Word, Enable>::from_units(Word(0u) - ang.units());
+}
+
+/// Returns the angle multiplied by a whole number, wrapping around the circle.
+template <typename Word, typename Enable, typename T,
+          typename = std::enable_if_t<std::is_integral<T>::value>>
+constexpr BinaryAngle<Word, Enable> operator*(const BinaryAngle<Word, Enable> &ang, T mult) {
+    return BinaryAngle<Word, Enable>::from_units(ang.units() * static_cast<Word>(mult));
+}
+
+/// Returns the angle multiplied by a whole number, wrapping around the circle.
+template <typename Word, typename Enable, typename T,
+          typename = std::enable_if_t<std::is_integral<T>::value>>
+constexpr BinaryAngle<Word, Enable> operator*(T mult, const BinaryAngle<Word, Enable> &ang) {
+    return BinaryAngle<Word, Enable>::from_units(static_cast<Word>(mult) * ang.units());
+}
+
+/// The stream inserter outputs a BinaryAngle as the equivalent Angle, so the Angle output
+/// manipulators apply to it as well.
+template <typename Word, typename Enable>
+std::ostream &operator<<(std::ostream &os, const BinaryAngle<Word, Enable> &ang) {
+    return os << ang.angle();
+}
+
+}  // namespace djehuti
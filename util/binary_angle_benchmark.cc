@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <random>
+#include <vector>
+
+#include "util/angle.hh"
+#include "util/benchmark.hh"
+#include "util/binary_angle.hh"
+
+// Accumulation and trig with BinaryAngles against the same work with Angles.
+
+namespace djehuti {
+namespace {
+
+constexpr size_t NUM_ANGLES = 4096u;
+
+template <typename A>
+std::vector<A> random_angles() {
+    std::mt19937_64 gen(NUM_ANGLES);
+    std::uniform_real_distribution<double> dist(0.0, 360.0);
+    std::vector<A> angles;
+    angles.reserve(NUM_ANGLES);
+    for (size_t i = 0u; i < NUM_ANGLES; ++i) {
+        angles.push_back(A(Angle::from_degrees(dist(gen))));
+    }
+    return angles;
+}
+
+template <typename A>
+void bench(const char *type_name) {
+    const auto angles = random_angles<A>();
+    std::string name = std::string(type_name) + " accumulate";
+    benchmark::run(name, [&angles] {
+        A sum;
+        for (const auto &a : angles) {
+            sum = sum + a;
+        }
+        benchmark::do_not_optimize(sum);
+    }, NUM_ANGLES);
+    name = std::string(type_name) + " sin+cos";
+    benchmark::run(name, [&angles] {
+        for (const auto &a : angles) {
+            benchmark::do_not_optimize(a.sin());
+            benchmark::do_not_optimize(a.cos());
+        }
+    }, NUM_ANGLES);
+}
+
+}  // namespace
+}  // namespace djehuti
+
+int main() {
+    using namespace djehuti;
+    bench<Angle>("Angle");
+    bench<BinaryAngle32>("BinaryAngle32");
+    bench<BinaryAngle64>("BinaryAngle64");
+    return 0;
+}
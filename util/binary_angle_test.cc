@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_angle.hh"
+
+#include <cmath>
+#include <random>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using namespace djehuti::literals;
+
+namespace djehuti {
+
+TEST(BinaryAngleTests, Basic) {
+    constexpr BinaryAngle32 right = 90_deg;
+    static_assert(right.units() == 0x40000000u, "90 degrees is a quarter turn");
+    EXPECT_EQ(BinaryAngle64(180_deg).units(), 0x8000000000000000u);
+    EXPECT_EQ(BinaryAngle32(360_deg), BinaryAngle32());
+    EXPECT_EQ(BinaryAngle32::from_degrees(-90.0), 270_deg);
+    EXPECT_EQ(BinaryAngle32::from_radians(M_PI), 180_deg);
+    EXPECT_DOUBLE_EQ(BinaryAngle32(45_deg).degrees(), 45.0);
+    EXPECT_DOUBLE_EQ(BinaryAngle64(45_deg).turns(), 0.125);
+    EXPECT_TRUE(BinaryAngle32(1_rad).almost_equal(BinaryAngle32::from_radians(1.0), 1e-9));
+    EXPECT_LT(BinaryAngle32(10_deg), 20_deg);
+    EXPECT_GE(BinaryAngle64(350_deg), 20_deg);
+    EXPECT_NE(BinaryAngle32(90_deg), 270_deg);
+
+    // The last unit is just short of a whole turn, even when a double can't tell them apart.
+    for (const double turns : {BinaryAngle32::from_units(~uint32_t{0}).turns(),
+                               BinaryAngle64::from_units(~uint64_t{0}).turns()}) {
+        EXPECT_LT(turns, 1.0);
+        EXPECT_GT(turns, 1.0 - 1e-9);
+    }
+    EXPECT_LT(BinaryAngle64::from_units(~uint64_t{0}).degrees(), 360.0);
+    EXPECT_LT(BinaryAngle64::from_units(~uint64_t{0}).radians(), 2.0 * M_PI);
+}
+
+TEST(BinaryAngleTests, Wraparound) {
+    const BinaryAngle32 a = 350_deg;
+    const BinaryAngle32 b = 20_deg;
+    EXPECT_EQ(a + b, BinaryAngle32(10_deg));
+    EXPECT_EQ(b - a, BinaryAngle32(30_deg));
+    EXPECT_EQ(a - b, BinaryAngle32(330_deg));
+    EXPECT_EQ(-b, BinaryAngle32(340_deg));
+    EXPECT_EQ(BinaryAngle32(90_deg) * 4, BinaryAngle32(0_deg));
+    EXPECT_EQ(-1 * b, BinaryAngle32(340_deg));
+    EXPECT_EQ(BinaryAngle64(90_deg) * 5u, BinaryAngle64(90_deg));
+    EXPECT_TRUE(a.almost_equal(b, Angle::from_degrees(30.0).radians() + 1e-9));
+    EXPECT_FALSE(a.almost_equal(b, Angle::from_degrees(29.0).radians()));
+
+    // A million small steps land exactly where one big one does.
+    BinaryAngle32 sum;
+    const auto step = BinaryAngle32::from_units(4294967u);
+    for (int i = 0; i < 1000000; ++i) {
+        sum = sum + step;
+    }
+    EXPECT_EQ(sum, step * 1000000);
+}
+
+TEST(BinaryAngleTests, AngleConversion) {
+    std::mt19937 gen(32u);
+    for (int i = 0; i < 100000; ++i) {
+        const auto bam = BinaryAngle32::from_units(static_cast<uint32_t>(gen()));
+        EXPECT_EQ(BinaryAngle32(bam.angle()), bam);
+    }
+    for (double deg = -720.0; deg <= 720.0; deg += 0.25) {
+        const auto angle = Angle::from_degrees(deg);
+        EXPECT_TRUE(BinaryAngle32(angle).angle().almost_equal(angle, 2e-9)) << deg;
+        EXPECT_TRUE(BinaryAngle64(angle).angle().almost_equal(angle, 1e-15)) << deg;
+    }
+}
+
+TEST(BinaryAngleTests, Trig) {
+    std::mt19937_64 gen(64u);
+    for (int i = 0; i < 100000; ++i) {
+        const auto bam = BinaryAngle64::from_units(gen());
+        const long double r = bam.turns() * 2.0l * 3.141592653589793238462643383279503l;
+        EXPECT_NEAR(bam.sin(), std::sin(r), 5e-16) << r;
+        EXPECT_NEAR(bam.cos(), std::cos(r), 5e-16) << r;
+    }
+    EXPECT_EQ(BinaryAngle32(0_deg).sin(), 0.0);
+    EXPECT_EQ(BinaryAngle32(0_deg).cos(), 1.0);
+    EXPECT_DOUBLE_EQ(BinaryAngle32(90_deg).sin(), 1.0);
+    EXPECT_DOUBLE_EQ(BinaryAngle64(30_deg).sin(), 0.5);
+    EXPECT_DOUBLE_EQ(BinaryAngle64(60_deg).cos(), 0.5);
+    EXPECT_DOUBLE_EQ(BinaryAngle32(225_deg).cos(), -M_SQRT1_2);
+}
+
+TEST(BinaryAngleTests, Output) {
+    std::ostringstream oss;
+    oss << BinaryAngle32(90_deg) << "/" << Angle::output_degrees << BinaryAngle64(45_deg);
+    EXPECT_EQ(oss.str(), "90_deg/45");
+}
+
+}  // namespace djehuti
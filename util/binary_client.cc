@@ -0,0 +1,163 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_client.hh"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "util/socket.hh"
+
+namespace djehuti {
+
+std::unique_ptr<BinaryClient> BinaryClient::connect(const std::string &address, uint16_t port) {
+    const int fd = connect_tcp(address, port);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (::fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return nullptr;
+    }
+    return std::unique_ptr<BinaryClient>(new BinaryClient(fd));
+}
+
+BinaryClient::~BinaryClient() { ::close(fd_); }
+
+uint32_t BinaryClient::ping() {
+    binary::append_frame(&out_, next_id_, static_cast<uint8_t>(binary::Op::PING),
+                         std::string_view());
+    ++outstanding_;
+    return next_id_++;
+}
+
+uint32_t BinaryClient::convert(std::string_view dimension,
+                               std::string_view from,
+                               std::string_view to,
+                               const double *values,
+                               size_t count) {
+    binary::append_convert(&out_, next_id_, dimension, from, to, values, count);
+    ++outstanding_;
+    return next_id_++;
+}
+
+bool BinaryClient::flush() {
+    while (!out_.empty()) {
+        if (!transfer(false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BinaryClient::receive(binary::Frame *response) {
+    for (;;) {
+        size_t size;
+        const auto parse =
+            binary::parse_frame(std::string_view(in_).substr(in_used_), response, &size);
+        if (parse == binary::FrameParse::COMPLETE) {
+            in_used_ += size;
+            --outstanding_;
+            return true;
+        }
+        if (parse == binary::FrameParse::BAD) {
+            errno = EPROTO;
+            return false;
+        }
+        if (!transfer(true)) {
+            return false;
+        }
+    }
+}
+
+bool BinaryClient::transfer(bool reading) {
+    for (;;) {
+        bool progress = false;
+        if (out_sent_ < out_.size()) {
+            const ssize_t n =
+                ::send(fd_, out_.data() + out_sent_, out_.size() - out_sent_, MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            if (n > 0) {
+                out_sent_ += static_cast<size_t>(n);
+                progress = true;
+            }
+            if (out_sent_ == out_.size()) {
+                out_.clear();
+                out_sent_ = 0u;
+            }
+        }
+        if (reading || !progress) {
+            // Drop what's been returned, and read more.
+            in_.erase(0u, in_used_);
+            in_used_ = 0u;
+            const size_t have = in_.size();
+            in_.resize(std::max(have + (64u << 10), in_.capacity()));
+            const ssize_t n = ::read(fd_, &in_[have], in_.size() - have);
+            in_.resize(have + (n > 0 ? static_cast<size_t>(n) : 0u));
+            if (n == 0) {
+                errno = ECONNRESET;
+                return false;
+            }
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            progress = progress || n > 0;
+        }
+        if (progress) {
+            return true;
+        }
+        pollfd wait{fd_, static_cast<short>(POLLIN | (out_.empty() ? 0 : POLLOUT)), 0};
+        if (::poll(&wait, 1u, -1) < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+binary::Status BinaryClient::convert_now(std::string_view dimension,
+                                         std::string_view from,
+                                         std::string_view to,
+                                         const double *values,
+                                         size_t count,
+                                         std::vector<double> *out) {
+    const uint32_t id = convert(dimension, from, to, values, count);
+    binary::Frame response;
+    do {
+        if (!receive(&response)) {
+            return binary::Status::ERROR;
+        }
+    } while (response.id != id);
+    const auto status = static_cast<binary::Status>(response.code);
+    if (status == binary::Status::OK) {
+        out->resize(response.body.size() / sizeof(double));
+        binary::read_doubles(response.body, out->data());
+    }
+    return status;
+}
+
+}  // namespace djehuti
@@ -0,0 +1,104 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/binary_protocol.hh"
+
+namespace djehuti {
+
+/**
+ * A BinaryClient makes requests of a BinaryServer (such as dumb_server's --binary_port) over
+ * one connection, in the binary protocol (see util/binary_protocol.hh). Requests are queued, and
+ * sent together when the client is flushed or waits for a response, so pipelining them is just
+ * a matter of queueing several before receiving; the server answers a connection's requests in
+ * order. Responses are read (and kept until they're received) while requests are being sent,
+ * since the server stops reading a connection whose responses aren't being read, so any number
+ * can be pipelined. It isn't safe to use from more than one thread at once.
+ */
+class BinaryClient final {
+ public:
+    /// Connects to the server, returning null (with errno set) if we can't.
+    static std::unique_ptr<BinaryClient> connect(const std::string &address, uint16_t port);
+
+    BinaryClient(const BinaryClient &) = delete;
+    BinaryClient &operator=(const BinaryClient &) = delete;
+    ~BinaryClient();
+
+    /// Queues a PING, returning its id.
+    uint32_t ping();
+    /// Queues a CONVERT of the values, returning its id.
+    uint32_t convert(std::string_view dimension,
+                     std::string_view from,
+                     std::string_view to,
+                     const double *values,
+                     size_t count);
+
+    /// Sends everything queued. Returns false (with errno set) if the connection is broken.
+    bool flush();
+
+    /**
+     * Sends what's queued until the next response comes (and the rest with later calls), and
+     * returns it. Its body stays valid until the next call to flush() or receive(). Returns
+     * false if the connection is broken or closed, or the server sent something that isn't a
+     * response.
+     */
+    bool receive(binary::Frame *response);
+
+    /**
+     * Converts the values and waits for the answer (after those to anything queued before),
+     * putting the converted values in out. Returns the status, or ERROR if the connection
+     * broke.
+     */
+    binary::Status convert_now(std::string_view dimension,
+                               std::string_view from,
+                               std::string_view to,
+                               const double *values,
+                               size_t count,
+                               std::vector<double> *out);
+
+    /// Returns the number of requests sent or queued that haven't been answered.
+    size_t outstanding() const { return outstanding_; }
+
+ private:
+    explicit BinaryClient(int fd) : fd_(fd) {}
+
+    // Sends what it can of what's queued and, if reading or it can't send, reads what it can,
+    // waiting until it can do one or the other. Returns false (with errno set) if the
+    // connection is broken or closed.
+    bool transfer(bool reading);
+
+    const int fd_;  // Non-blocking.
+    uint32_t next_id_ = 0u;
+    size_t outstanding_ = 0u;
+    std::string out_;    // Requests queued.
+    size_t out_sent_ = 0u;  // How much of out_ has been sent.
+    std::string in_;     // What we've read.
+    size_t in_used_ = 0u;  // How much of in_ has been returned already.
+};
+
+}  // namespace djehuti
@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_protocol.hh"
+
+#include <cstring>
+
+namespace djehuti {
+namespace binary {
+
+namespace {
+
+constexpr bool LITTLE_ENDIAN_HOST = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+void write_u32(char *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+uint32_t read_u32(const char *in) {
+    uint32_t value = 0u;
+    for (int i = 0; i < 4; ++i) {
+        value |= uint32_t{static_cast<uint8_t>(in[i])} << (8 * i);
+    }
+    return value;
+}
+
+// Takes a name (a length byte and that many bytes) off the front of body.
+bool take_name(std::string_view *body, std::string_view *name) {
+    if (body->empty() || body->size() < 1u + static_cast<uint8_t>((*body)[0])) {
+        return false;
+    }
+    const size_t size = static_cast<uint8_t>((*body)[0]);
+    *name = body->substr(1u, size);
+    body->remove_prefix(1u + size);
+    return true;
+}
+
+void append_name(std::string *out, std::string_view name) {
+    out->push_back(static_cast<char>(name.size()));
+    out->append(name);
+}
+
+}  // namespace
+
+FrameParse parse_frame(std::string_view data, Frame *frame, size_t *size) {
+    if (data.size() < 4u) {
+        return FrameParse::INCOMPLETE;
+    }
+    const size_t length = read_u32(data.data());
+    if (length < HEADER_BYTES - 4u || length > MAX_FRAME_BYTES - 4u) {
+        return FrameParse::BAD;
+    }
+    if (data.size() < 4u + length) {
+        return FrameParse::INCOMPLETE;
+    }
+    frame->id = read_u32(data.data() + 4u);
+    frame->code = static_cast<uint8_t>(data[8]);
+    frame->body = data.substr(HEADER_BYTES, length - (HEADER_BYTES - 4u));
+    *size = 4u + length;
+    return FrameParse::COMPLETE;
+}
+
+void write_header(char *header, uint32_t id, uint8_t code, size_t body_size) {
+    write_u32(header, static_cast<uint32_t>(HEADER_BYTES - 4u + body_size));
+    write_u32(header + 4u, id);
+    header[8] = static_cast<char>(code);
+}
+
+void append_frame(std::string *out, uint32_t id, uint8_t code, std::string_view body) {
+    char header[HEADER_BYTES];
+    write_header(header, id, code, body.size());
+    out->append(header, sizeof(header)).append(body);
+}
+
+void append_convert(std::string *out,
+                    uint32_t id,
+                    std::string_view dimension,
+                    std::string_view from,
+                    std::string_view to,
+                    const double *values,
+                    size_t count) {
+    char header[HEADER_BYTES];
+    write_header(header, id, static_cast<uint8_t>(Op::CONVERT),
+                 3u + dimension.size() + from.size() + to.size() + count * sizeof(double));
+    out->append(header, sizeof(header));
+    append_name(out, dimension);
+    append_name(out, from);
+    append_name(out, to);
+    append_doubles(out, values, count);
+}
+
+bool parse_convert(std::string_view body, Convert *convert) {
+    if (!take_name(&body, &convert->dimension) || !take_name(&body, &convert->from) ||
+        !take_name(&body, &convert->to) || body.size() % sizeof(double) != 0u) {
+        return false;
+    }
+    convert->values = body;
+    return true;
+}
+
+void append_doubles(std::string *out, const double *values, size_t count) {
+    const size_t start = out->size();
+    out->resize(start + count * sizeof(double));
+    char *bytes = &(*out)[start];
+    if (LITTLE_ENDIAN_HOST) {
+        std::memcpy(bytes, values, count * sizeof(double));
+        return;
+    }
+    for (size_t i = 0u; i < count; ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        for (int b = 0; b < 8; ++b) {
+            bytes[i * 8u + b] = static_cast<char>(bits >> (8 * b));
+        }
+    }
+}
+
+void read_doubles(std::string_view bytes, double *values) {
+    const size_t count = bytes.size() / sizeof(double);
+    if (LITTLE_ENDIAN_HOST) {
+        std::memcpy(values, bytes.data(), count * sizeof(double));
+        return;
+    }
+    for (size_t i = 0u; i < count; ++i) {
+        uint64_t bits = 0u;
+        for (int b = 0; b < 8; ++b) {
+            bits |= uint64_t{static_cast<uint8_t>(bytes[i * 8u + b])} << (8 * b);
+        }
+        std::memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+}  // namespace binary
+}  // namespace djehuti
@@ -0,0 +1,117 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace djehuti {
+
+/**
+ * A compact binary protocol for high-rate callers, to save them (and us) formatting and parsing
+ * HTTP for requests that are a few bytes each. Every message is a frame: a 32-bit length of what
+ * follows, then a 32-bit id and a one-byte code, then a body. A request's code is its operation,
+ * and a response's is its status; a response carries the id of the request it answers, so a
+ * client can pipeline as many requests as it likes on a connection and match the answers up.
+ * Integers and doubles are little-endian.
+ *
+ * The operations are:
+ *
+ * - PING, with an empty body, answered with OK and an empty body.
+ * - CONVERT, whose body is three names (the dimension and the units to convert from and to, as
+ *   RuntimeConversion::find() takes them), each a length byte followed by that many bytes, and
+ *   then the values to convert, as doubles. It's answered with OK and the converted values.
+ *
+ * A response that isn't OK has a message for its body.
+ */
+namespace binary {
+
+enum class Op : uint8_t { PING = 0u, CONVERT = 1u };
+
+enum class Status : uint8_t {
+    OK = 0u,
+    BAD_REQUEST = 1u,
+    NOT_FOUND = 2u,
+    TOO_MANY_REQUESTS = 3u,
+    OVERLOADED = 4u,
+    ERROR = 5u,
+};
+
+/// The length, id and code that start every frame.
+constexpr size_t HEADER_BYTES = 9u;
+/// The biggest frame (counting its header) either side may send.
+constexpr size_t MAX_FRAME_BYTES = size_t{16} << 20;
+
+/// A request or response frame, with its body as a view into the bytes it was parsed from.
+struct Frame {
+    uint32_t id = 0u;
+    uint8_t code = 0u;  // An Op or a Status.
+    std::string_view body;
+};
+
+/// What parse_frame() makes of the bytes it's given.
+enum class FrameParse { INCOMPLETE, COMPLETE, BAD };
+
+/**
+ * Parses the frame at the start of data. If it's all there, fills in the frame and its size (so
+ * that the next starts after it) and returns COMPLETE; if the data stops short, returns
+ * INCOMPLETE; and if its length is impossible, BAD.
+ */
+FrameParse parse_frame(std::string_view data, Frame *frame, size_t *size);
+
+/// Writes the header (HEADER_BYTES of it) of a frame with a body of body_size bytes.
+void write_header(char *header, uint32_t id, uint8_t code, size_t body_size);
+
+/// Appends a whole frame to out.
+void append_frame(std::string *out, uint32_t id, uint8_t code, std::string_view body);
+
+/// The arguments of a CONVERT request.
+struct Convert {
+    std::string_view dimension;
+    std::string_view from;
+    std::string_view to;
+    std::string_view values;  // The doubles, as they were sent (so not necessarily aligned).
+
+    size_t count() const { return values.size() / sizeof(double); }
+};
+
+/// Appends a CONVERT request to out. The names must each be shorter than 256 bytes.
+void append_convert(std::string *out,
+                    uint32_t id,
+                    std::string_view dimension,
+                    std::string_view from,
+                    std::string_view to,
+                    const double *values,
+                    size_t count);
+
+/// Parses the body of a CONVERT request, returning false if it isn't one.
+bool parse_convert(std::string_view body, Convert *convert);
+
+/// Appends count doubles to out, as they go in a frame.
+void append_doubles(std::string *out, const double *values, size_t count);
+
+/// Reads the doubles in bytes (which must be a multiple of 8 long) into values.
+void read_doubles(std::string_view bytes, double *values);
+
+}  // namespace binary
+}  // namespace djehuti
@@ -0,0 +1,100 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_protocol.hh"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace binary {
+
+TEST(BinaryProtocolTest, Frames) {
+    std::string data;
+    append_frame(&data, 7u, static_cast<uint8_t>(Status::NOT_FOUND), "no such unit");
+    append_frame(&data, 0xfffffffeu, static_cast<uint8_t>(Op::PING), "");
+    EXPECT_EQ(data.size(), 2u * HEADER_BYTES + 12u);
+    // The length is of what follows it, little-endian.
+    EXPECT_EQ(data.substr(0u, 9u), std::string("\x11\0\0\0\x07\0\0\0\x02", 9u));
+
+    Frame frame;
+    size_t size;
+    ASSERT_EQ(parse_frame(data, &frame, &size), FrameParse::COMPLETE);
+    EXPECT_EQ(size, HEADER_BYTES + 12u);
+    EXPECT_EQ(frame.id, 7u);
+    EXPECT_EQ(frame.code, static_cast<uint8_t>(Status::NOT_FOUND));
+    EXPECT_EQ(frame.body, "no such unit");
+    const std::string_view rest = std::string_view(data).substr(size);
+    ASSERT_EQ(parse_frame(rest, &frame, &size), FrameParse::COMPLETE);
+    EXPECT_EQ(size, HEADER_BYTES);
+    EXPECT_EQ(frame.id, 0xfffffffeu);
+    EXPECT_TRUE(frame.body.empty());
+
+    // Every prefix of a frame is incomplete.
+    for (size_t n = 0u; n < HEADER_BYTES + 12u; ++n) {
+        EXPECT_EQ(parse_frame(std::string_view(data).substr(0u, n), &frame, &size),
+                  FrameParse::INCOMPLETE)
+            << n;
+    }
+
+    // A length too short to hold the id and code, or too long for any frame, is bad.
+    EXPECT_EQ(parse_frame(std::string("\x04\0\0\0\0\0\0\0\0", 9u), &frame, &size),
+              FrameParse::BAD);
+    EXPECT_EQ(parse_frame(std::string("\xff\xff\xff\x7f", 4u), &frame, &size), FrameParse::BAD);
+}
+
+TEST(BinaryProtocolTest, Convert) {
+    const std::vector<double> values = {0.0, -1.5, 1e300, 3.25};
+    std::string data;
+    append_convert(&data, 3u, "length", "m", "ft", values.data(), values.size());
+
+    Frame frame;
+    size_t size;
+    ASSERT_EQ(parse_frame(data, &frame, &size), FrameParse::COMPLETE);
+    EXPECT_EQ(size, data.size());
+    EXPECT_EQ(frame.id, 3u);
+    EXPECT_EQ(frame.code, static_cast<uint8_t>(Op::CONVERT));
+    Convert convert;
+    ASSERT_TRUE(parse_convert(frame.body, &convert));
+    EXPECT_EQ(convert.dimension, "length");
+    EXPECT_EQ(convert.from, "m");
+    EXPECT_EQ(convert.to, "ft");
+    ASSERT_EQ(convert.count(), values.size());
+    std::vector<double> read(convert.count());
+    read_doubles(convert.values, read.data());
+    EXPECT_EQ(read, values);
+
+    // No values is fine.
+    data.clear();
+    append_convert(&data, 4u, "mass", "kg", "lb", nullptr, 0u);
+    ASSERT_TRUE(parse_convert(std::string_view(data).substr(HEADER_BYTES), &convert));
+    EXPECT_EQ(convert.count(), 0u);
+
+    // Names that run off the end, or values that aren't whole doubles, aren't.
+    EXPECT_FALSE(parse_convert("", &convert));
+    EXPECT_FALSE(parse_convert(std::string("\x06len", 4u), &convert));
+    EXPECT_FALSE(parse_convert(std::string("\x01" "a\x01" "b\x01" "c" "1234567", 13u), &convert));
+    EXPECT_TRUE(parse_convert(std::string("\x01" "a\x01" "b\x01" "c" "12345678", 14u), &convert));
+}
+
+}  // namespace binary
+}  // namespace djehuti
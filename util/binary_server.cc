@@ -0,0 +1,358 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_server.hh"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace djehuti {
+
+namespace {
+
+// The most responses gathered into one writev, each a header and a body.
+constexpr size_t MAX_WRITE_RESPONSES = 64u;
+// Bodies kept for reuse, per thread.
+constexpr size_t MAX_SPARE_BODIES = 1024u;
+
+}  // namespace
+
+// One thread's epoll and its connections.
+class BinaryServer::Loop final : public ServerLoop {
+ public:
+    Loop(const Options &options, const Handler &handler, int listen_fd)
+        : options_(options), handler_(handler), listen_fd_(listen_fd), read_buffer_(64u << 10) {}
+
+    ~Loop() {
+        for (auto &c : connections_) {
+            ::close(c->fd);
+        }
+        if (wake_fd_ >= 0) {
+            ::close(wake_fd_);
+        }
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+        }
+        ::close(listen_fd_);
+    }
+
+    // Sets up the epoll, or returns false (with errno set).
+    bool init() override {
+        if (::fcntl(listen_fd_, F_SETFL, O_NONBLOCK) != 0) {
+            return false;
+        }
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0u, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (epoll_fd_ < 0 || wake_fd_ < 0) {
+            return false;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;  // The listening socket.
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) != 0) {
+            return false;
+        }
+        event.data.ptr = &wake_fd_;
+        return ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) == 0;
+    }
+
+    // Serves until woken.
+    void run() override;
+
+    // Tells run() to stop; safe from any thread.
+    void wake() override {
+        const uint64_t one = 1u;
+        if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+            // It's a counter, so it can only fail if it's full, and then it's awake anyway.
+        }
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.connections = connections_accepted_.load(std::memory_order_relaxed);
+        stats.requests = requests_.load(std::memory_order_relaxed);
+        stats.writes = writes_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+ private:
+    struct Response {
+        char header[binary::HEADER_BYTES];
+        std::string body;
+    };
+
+    struct Connection {
+        int fd = -1;
+        size_t index = 0u;  // Where it is in connections_.
+        std::string input;  // A request we've only had part of.
+        std::deque<Response> unsent;
+        size_t sent = 0u;  // Of the first unsent response, header and body together.
+        size_t unsent_bytes = 0u;
+        bool paused = false;  // We've stopped reading until it takes some of its responses.
+        bool eof = false;     // It's sent all it's going to.
+        bool closed = false;
+        char peer[INET6_ADDRSTRLEN] = "";
+    };
+
+    void accept_all();
+    void read_all(Connection *c);
+    void received(Connection *c, std::string_view data);
+    size_t serve(Connection *c, std::string_view data);
+    void flush(Connection *c);
+    void destroy(Connection *c);
+
+    const Options &options_;
+    const Handler &handler_;
+    const int listen_fd_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::vector<char> read_buffer_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<std::string> spare_bodies_;
+    std::atomic<uint64_t> connections_accepted_{0u};
+    std::atomic<uint64_t> requests_{0u};
+    std::atomic<uint64_t> writes_{0u};
+};
+
+void BinaryServer::Loop::run() {
+    epoll_event events[256];
+    for (;;) {
+        const int n = ::epoll_wait(epoll_fd_, events, static_cast<int>(std::size(events)), -1);
+        if (n < 0 && errno != EINTR) {
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                accept_all();
+                continue;
+            }
+            if (events[i].data.ptr == &wake_fd_) {
+                return;
+            }
+            auto *c = static_cast<Connection *>(events[i].data.ptr);
+            const uint32_t ready = events[i].events;
+            if ((ready & EPOLLERR) != 0u) {
+                c->closed = true;
+            }
+            if (!c->closed && (ready & EPOLLOUT) != 0u) {
+                flush(c);
+            }
+            // Read if there's something to, unless it isn't taking its responses; and once it
+            // has taken enough of them, read what we left.
+            const bool resume = c->paused && c->unsent_bytes <= options_.max_unsent_bytes;
+            if (!c->closed &&
+                (resume || (!c->paused && (ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0u))) {
+                c->paused = false;
+                read_all(c);
+            }
+            if (c->eof && c->unsent.empty()) {
+                c->closed = true;
+            }
+            if (c->closed) {
+                destroy(c);
+            }
+        }
+    }
+}
+
+void BinaryServer::Loop::accept_all() {
+    for (;;) {
+        sockaddr_in addr{};
+        socklen_t addr_size = sizeof(addr);
+        const int fd = ::accept4(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &addr_size,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN when we've taken them all; anything else, we'll hear about again.
+        }
+        const int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        auto c = std::make_unique<Connection>();
+        c->fd = fd;
+        if (::inet_ntop(AF_INET, &addr.sin_addr, c->peer, sizeof(c->peer)) == nullptr) {
+            c->peer[0] = '\0';
+        }
+        c->index = connections_.size();
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = c.get();
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.push_back(std::move(c));
+        connections_accepted_.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+void BinaryServer::Loop::read_all(Connection *c) {
+    while (!c->eof && !c->closed) {
+        if (c->unsent_bytes > options_.max_unsent_bytes) {
+            flush(c);
+            if (c->unsent_bytes > options_.max_unsent_bytes) {
+                c->paused = true;  // Until epoll says it has room for more.
+                return;
+            }
+        }
+        const ssize_t n = ::read(c->fd, read_buffer_.data(), read_buffer_.size());
+        if (n > 0) {
+            received(c, std::string_view(read_buffer_.data(), static_cast<size_t>(n)));
+        } else if (n == 0) {
+            c->eof = true;
+        } else if (errno == EAGAIN) {
+            break;
+        } else if (errno != EINTR) {
+            c->closed = true;
+        }
+    }
+    // Everything answered from what we've just read goes in one writev.
+    flush(c);
+}
+
+void BinaryServer::Loop::received(Connection *c, std::string_view data) {
+    serve_input(&c->input, data, [this, c](std::string_view input) { return serve(c, input); });
+}
+
+size_t BinaryServer::Loop::serve(Connection *c, std::string_view data) {
+    size_t used = 0u;
+    while (!c->closed) {
+        binary::Frame request;
+        size_t size;
+        const binary::FrameParse parse = binary::parse_frame(data.substr(used), &request, &size);
+        if (parse == binary::FrameParse::INCOMPLETE) {
+            break;
+        }
+        if (parse == binary::FrameParse::BAD) {
+            c->closed = true;
+            return data.size();
+        }
+        c->unsent.emplace_back();
+        Response &response = c->unsent.back();
+        if (!spare_bodies_.empty()) {
+            response.body.swap(spare_bodies_.back());
+            spare_bodies_.pop_back();
+        }
+        Reply reply(&response.body);
+        handler_(request, c->peer, &reply);
+        binary::write_header(response.header, request.id, static_cast<uint8_t>(reply.status()),
+                             response.body.size());
+        c->unsent_bytes += binary::HEADER_BYTES + response.body.size();
+        requests_.fetch_add(1u, std::memory_order_relaxed);
+        used += size;
+    }
+    return used;
+}
+
+void BinaryServer::Loop::flush(Connection *c) {
+    while (!c->unsent.empty() && !c->closed) {
+        iovec pieces[2u * MAX_WRITE_RESPONSES];
+        size_t count = 0u;
+        size_t skip = c->sent;  // What's gone of the first response.
+        for (size_t i = 0u; i < c->unsent.size() && i < MAX_WRITE_RESPONSES; ++i) {
+            Response &response = c->unsent[i];
+            if (skip < binary::HEADER_BYTES) {
+                pieces[count++] = {response.header + skip, binary::HEADER_BYTES - skip};
+                skip = 0u;
+            } else {
+                skip -= binary::HEADER_BYTES;
+            }
+            if (skip < response.body.size()) {
+                pieces[count++] = {&response.body[skip], response.body.size() - skip};
+            }
+            skip = 0u;
+        }
+        const ssize_t n = ::writev(c->fd, pieces, static_cast<int>(count));
+        writes_.fetch_add(1u, std::memory_order_relaxed);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                c->closed = true;
+            }
+            return;  // The rest goes when epoll says there's room.
+        }
+        size_t written = static_cast<size_t>(n);
+        c->unsent_bytes -= written;
+        while (written > 0u) {
+            Response &response = c->unsent.front();
+            const size_t left = binary::HEADER_BYTES + response.body.size() - c->sent;
+            if (written < left) {
+                c->sent += written;
+                break;
+            }
+            written -= left;
+            c->sent = 0u;
+            if (spare_bodies_.size() < MAX_SPARE_BODIES) {
+                response.body.clear();
+                spare_bodies_.push_back(std::move(response.body));
+            }
+            c->unsent.pop_front();
+        }
+    }
+}
+
+void BinaryServer::Loop::destroy(Connection *c) {
+    ::close(c->fd);
+    // Move the last connection into its place.
+    const size_t index = c->index;
+    connections_[index] = std::move(connections_.back());
+    connections_[index]->index = index;
+    connections_.pop_back();
+}
+
+BinaryServer::BinaryServer(Options options, Handler handler)
+    : options_(std::move(options)), handler_(std::move(handler)) {}
+
+BinaryServer::~BinaryServer() { stop(); }
+
+bool BinaryServer::start() {
+    return threads_.start(
+        {options_.address, options_.port, options_.num_threads, options_.pin_threads},
+        [this](int listen_fd) { return std::make_unique<Loop>(options_, handler_, listen_fd); });
+}
+
+void BinaryServer::wait() { threads_.wait(); }
+
+void BinaryServer::stop() { threads_.stop(); }
+
+BinaryServer::Stats BinaryServer::stats() const {
+    Stats total;
+    for (const auto &loop : threads_.loops()) {
+        const Stats stats = static_cast<const Loop &>(*loop).stats();
+        total.connections += stats.connections;
+        total.requests += stats.requests;
+        total.writes += stats.writes;
+    }
+    return total;
+}
+
+}  // namespace djehuti
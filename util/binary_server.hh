@@ -0,0 +1,112 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "util/binary_protocol.hh"
+#include "util/server_threads.hh"
+
+namespace djehuti {
+
+/**
+ * A BinaryServer answers requests in the binary protocol (see util/binary_protocol.hh). Each
+ * thread has an epoll and a listening socket of its own (with SO_REUSEPORT), and reads whatever
+ * its connections have sent, answers every whole request in it, and writes the responses with
+ * a single writev: each one's header and body are separate pieces of it, so a response body is
+ * never copied after the handler writes it.
+ *
+ * The handler is called on the thread that owns the connection, and must answer before it
+ * returns. A connection that sends a malformed frame is closed.
+ */
+class BinaryServer final {
+ public:
+    /// Where a handler writes its response: a status, and a body it appends to.
+    class Reply final {
+     public:
+        void set_status(binary::Status status) { status_ = status; }
+        binary::Status status() const { return status_; }
+        /// The body so far, empty to start with, for the handler to append to.
+        std::string *body() { return body_; }
+
+     private:
+        friend class BinaryServer;
+        explicit Reply(std::string *body) : body_(body) {}
+
+        binary::Status status_ = binary::Status::OK;
+        std::string *body_;
+    };
+
+    /// Answers a request from the peer (the client's address, as text).
+    using Handler = std::function<void(const binary::Frame &request,
+                                       std::string_view peer,
+                                       Reply *reply)>;
+
+    struct Options {
+        /// The address to listen on ("*" or "0.0.0.0" for any), and the port (0 to pick one).
+        std::string address = "0.0.0.0";
+        uint16_t port = 8081u;
+        /// The number of threads, or 0 for one per hardware thread.
+        size_t num_threads = 0u;
+        /// Whether to pin each thread to a CPU of its own (as far as they go).
+        bool pin_threads = false;
+        /// How much unsent response a connection may have before we stop reading its requests.
+        size_t max_unsent_bytes = size_t{4} << 20;
+    };
+
+    struct Stats {
+        uint64_t connections = 0u;
+        uint64_t requests = 0u;
+        uint64_t writes = 0u;  // Calls to writev.
+    };
+
+    BinaryServer(Options options, Handler handler);
+    BinaryServer(const BinaryServer &) = delete;
+    BinaryServer &operator=(const BinaryServer &) = delete;
+    /// Stops the server if it's running.
+    ~BinaryServer();
+
+    /// Opens the sockets and starts the threads serving them. Returns false (with errno set) if
+    /// we can't.
+    bool start();
+    /// Returns the port we're listening on, once we've started.
+    uint16_t port() const { return threads_.port(); }
+    /// Waits until the server is stopped (from another thread).
+    void wait();
+    /// Stops serving: the threads drop their connections and finish.
+    void stop();
+
+    /// Returns the counts so far, summed across the threads.
+    Stats stats() const;
+
+ private:
+    class Loop;
+
+    const Options options_;
+    const Handler handler_;
+    ServerThreads threads_;
+};
+
+}  // namespace djehuti
@@ -0,0 +1,173 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/binary_client.hh"
+#include "util/binary_server.hh"
+#include "util/http_request.hh"
+#include "util/http_response.hh"
+#include "util/socket.hh"
+#include "util/string_builder.hh"
+#include "util/unit_conversion.hh"
+#include "util/uring_http_server.hh"
+
+// Converting temperatures for a client on the same host, as dumb_server does: over HTTP with
+// the io_uring server (a GET with the values in its query, answered with a line per value), and
+// over the binary protocol. Each server has one thread, and the client one connection, with a
+// request at a time and then 32 pipelined. Times are per round of requests, and per request.
+
+namespace {
+
+using namespace djehuti;
+
+const units::RuntimeConversion CONVERSION =
+    *units::RuntimeConversion::find("temperature", "celsius", "fahrenheit");
+
+void serve_http(const HttpRequest &request, UringHttpServer::Response *response) {
+    thread_local std::vector<double> values;
+    thread_local string::StringBuilder out;
+    out.clear();
+    const auto v = query_param(request.query, "v");
+    if (!v || !units::convert_list(CONVERSION, *v, &values, &out)) {
+        response->send(400, "text/plain", "Bad request\n");
+        return;
+    }
+    response->send(200, "text/plain", out.str());
+}
+
+void serve_binary(const binary::Frame &request, std::string_view, BinaryServer::Reply *reply) {
+    thread_local std::vector<double> values;
+    binary::Convert convert;
+    if (!binary::parse_convert(request.body, &convert)) {
+        reply->set_status(binary::Status::BAD_REQUEST);
+        return;
+    }
+    values.resize(convert.count());
+    binary::read_doubles(convert.values, values.data());
+    CONVERSION.apply(values.data(), values.size(), values.data());
+    binary::append_doubles(reply->body(), values.data(), values.size());
+}
+
+// Sends the same request depth times at once, and reads all the responses.
+class HttpClient final {
+ public:
+    HttpClient(uint16_t port, const std::vector<double> &values, size_t depth)
+        : fd_(connect_tcp("127.0.0.1", port)) {
+        std::string request = "GET /convert/temperature?from=c&to=f&v=";
+        for (size_t i = 0u; i < values.size(); ++i) {
+            char number[32];
+            std::snprintf(number, sizeof(number), i == 0u ? "%.2f" : ",%.2f", values[i]);
+            request += number;
+        }
+        request += " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        for (size_t i = 0u; i < depth; ++i) {
+            requests_ += request;
+        }
+        depth_ = depth;
+    }
+    ~HttpClient() { ::close(fd_); }
+
+    void round() {
+        if (::write(fd_, requests_.data(), requests_.size()) !=
+            static_cast<ssize_t>(requests_.size())) {
+            std::abort();
+        }
+        for (size_t i = 0u; i < depth_; ++i) {
+            parser_.reset();
+            while (parser_.state() == HttpResponseParser::State::INCOMPLETE) {
+                if (pending_.empty()) {
+                    char buffer[64 << 10];
+                    const ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+                    if (n <= 0) {
+                        std::abort();
+                    }
+                    pending_.assign(buffer, static_cast<size_t>(n));
+                }
+                pending_.erase(0u, parser_.parse(pending_));
+            }
+            if (parser_.status() != 200) {
+                std::abort();
+            }
+        }
+    }
+
+ private:
+    const int fd_;
+    std::string requests_;
+    size_t depth_;
+    HttpResponseParser parser_;
+    std::string pending_;
+};
+
+}  // namespace
+
+int main() {
+    UringHttpServer::Options http_options;
+    http_options.address = "127.0.0.1";
+    http_options.port = 0u;
+    http_options.num_threads = 1u;
+    UringHttpServer http_server(http_options, serve_http);
+    BinaryServer::Options binary_options;
+    binary_options.address = "127.0.0.1";
+    binary_options.port = 0u;
+    binary_options.num_threads = 1u;
+    BinaryServer binary_server(binary_options, serve_binary);
+    if (!http_server.start() || !binary_server.start()) {
+        std::perror("Can't start the servers");
+        return EXIT_FAILURE;
+    }
+
+    for (const size_t count : {1u, 16u}) {
+        const std::vector<double> values(count, 21.5);
+        for (const size_t depth : {1u, 32u}) {
+            const std::string suffix =
+                ", " + std::to_string(count) + " values, depth " + std::to_string(depth);
+            HttpClient http(http_server.port(), values, depth);
+            benchmark::run("http" + suffix, [&] { http.round(); }, depth);
+
+            auto client = BinaryClient::connect("127.0.0.1", binary_server.port());
+            benchmark::run("binary" + suffix, [&] {
+                for (size_t i = 0u; i < depth; ++i) {
+                    client->convert("temperature", "celsius", "fahrenheit", values.data(), count);
+                }
+                binary::Frame response;
+                for (size_t i = 0u; i < depth; ++i) {
+                    if (!client->receive(&response) || response.code != 0u) {
+                        std::abort();
+                    }
+                }
+            }, depth);
+        }
+    }
+    const auto stats = binary_server.stats();
+    std::printf("binary: %llu requests in %llu writes\n",
+                static_cast<unsigned long long>(stats.requests),
+                static_cast<unsigned long long>(stats.writes));
+    http_server.stop();
+    binary_server.stop();
+    return EXIT_SUCCESS;
+}
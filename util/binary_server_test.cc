@@ -0,0 +1,248 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/binary_server.hh"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/binary_client.hh"
+#include "util/socket.hh"
+
+namespace djehuti {
+
+namespace {
+
+// Answers a PING with its id (as text), and "converts" by doubling, unless the dimension is
+// "missing" (which isn't found) or "big" (which answers with 64KiB of zeros).
+void handle(const binary::Frame &request, std::string_view, BinaryServer::Reply *reply) {
+    switch (static_cast<binary::Op>(request.code)) {
+        case binary::Op::PING:
+            reply->body()->append(std::to_string(request.id));
+            return;
+        case binary::Op::CONVERT: {
+            binary::Convert convert;
+            if (!binary::parse_convert(request.body, &convert)) {
+                reply->set_status(binary::Status::BAD_REQUEST);
+                return;
+            }
+            if (convert.dimension == "missing") {
+                reply->set_status(binary::Status::NOT_FOUND);
+                reply->body()->append("no such dimension");
+                return;
+            }
+            if (convert.dimension == "big") {
+                reply->body()->append(size_t{64} << 10, '\0');
+                return;
+            }
+            std::vector<double> values(convert.count());
+            binary::read_doubles(convert.values, values.data());
+            for (double &value : values) {
+                value *= 2.0;
+            }
+            binary::append_doubles(reply->body(), values.data(), values.size());
+            return;
+        }
+    }
+    reply->set_status(binary::Status::BAD_REQUEST);
+}
+
+BinaryServer::Options test_options() {
+    BinaryServer::Options options;
+    options.address = "127.0.0.1";
+    options.port = 0u;
+    options.num_threads = 2u;
+    options.max_unsent_bytes = 64u << 10;
+    return options;
+}
+
+}  // namespace
+
+TEST(BinaryServerTest, Pipelining) {
+    BinaryServer server(test_options(), handle);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    ASSERT_NE(server.port(), 0u);
+    auto client = BinaryClient::connect("127.0.0.1", server.port());
+    ASSERT_NE(client, nullptr);
+
+    std::vector<double> out;
+    const double values[] = {1.0, -2.5, 1e300};
+    EXPECT_EQ(client->convert_now("length", "m", "ft", values, 3u, &out), binary::Status::OK);
+    EXPECT_EQ(out, std::vector<double>({2.0, -5.0, 2e300}));
+    EXPECT_EQ(client->convert_now("missing", "m", "ft", values, 3u, &out),
+              binary::Status::NOT_FOUND);
+
+    // A thousand at once: they come back in order.
+    for (uint32_t i = 0u; i < 1000u; ++i) {
+        const double value = i;
+        EXPECT_EQ(i % 2u ? client->ping() : client->convert("d", "a", "b", &value, 1u), i + 2u);
+    }
+    EXPECT_EQ(client->outstanding(), 1000u);
+    for (uint32_t i = 0u; i < 1000u; ++i) {
+        binary::Frame response;
+        ASSERT_TRUE(client->receive(&response));
+        EXPECT_EQ(response.id, i + 2u);
+        EXPECT_EQ(response.code, static_cast<uint8_t>(binary::Status::OK));
+        if (i % 2u) {
+            EXPECT_EQ(response.body, std::to_string(i + 2u));
+        } else {
+            double value;
+            ASSERT_EQ(response.body.size(), sizeof(value));
+            binary::read_doubles(response.body, &value);
+            EXPECT_EQ(value, 2.0 * i);
+        }
+    }
+    EXPECT_EQ(client->outstanding(), 0u);
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.connections, 1u);
+    EXPECT_EQ(stats.requests, 1002u);
+    EXPECT_LT(stats.writes, 1002u);  // The pipelined responses went out together.
+    server.stop();
+}
+
+TEST(BinaryServerTest, Peer) {
+    BinaryServer server(test_options(), [](const binary::Frame &, std::string_view peer,
+                                           BinaryServer::Reply *reply) {
+        reply->body()->append(peer);
+    });
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    auto client = BinaryClient::connect("127.0.0.1", server.port());
+    ASSERT_NE(client, nullptr);
+    client->ping();
+    binary::Frame response;
+    ASSERT_TRUE(client->receive(&response));
+    EXPECT_EQ(response.body, "127.0.0.1");
+    server.stop();
+}
+
+TEST(BinaryServerTest, Backpressure) {
+    BinaryServer server(test_options(), handle);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    auto client = BinaryClient::connect("127.0.0.1", server.port());
+    ASSERT_NE(client, nullptr);
+
+    // Far more response than the socket buffers or max_unsent_bytes hold, asked for before we
+    // read any of it: the server has to stop reading, and pick up where it left off.
+    const double value = 1.0;
+    for (int i = 0; i < 200; ++i) {
+        client->convert("big", "a", "b", &value, 1u);
+    }
+    ASSERT_TRUE(client->flush());
+    for (uint32_t i = 0u; i < 200u; ++i) {
+        binary::Frame response;
+        ASSERT_TRUE(client->receive(&response));
+        EXPECT_EQ(response.id, i);
+        ASSERT_EQ(response.body.size(), size_t{64} << 10);
+    }
+    server.stop();
+}
+
+TEST(BinaryServerTest, PipeliningMoreThanTheServerHolds) {
+    // The server's default max_unsent_bytes, which the replies are far more than (as are the
+    // requests), with nothing received until they've all been sent: the client has to read
+    // replies while it writes, or the server stops reading and neither side gets anywhere.
+    BinaryServer::Options options = test_options();
+    options.max_unsent_bytes = BinaryServer::Options().max_unsent_bytes;
+    BinaryServer server(options, handle);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    auto client = BinaryClient::connect("127.0.0.1", server.port());
+    ASSERT_NE(client, nullptr);
+
+    std::vector<double> values(8192u);
+    for (size_t i = 0u; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i);
+    }
+    constexpr uint32_t COUNT = 512u;  // 32 MiB each way.
+    for (uint32_t i = 0u; i < COUNT; ++i) {
+        client->convert("length", "m", "ft", values.data(), values.size());
+    }
+    ASSERT_TRUE(client->flush()) << std::strerror(errno);
+    std::vector<double> out(values.size());
+    for (uint32_t i = 0u; i < COUNT; ++i) {
+        binary::Frame response;
+        ASSERT_TRUE(client->receive(&response)) << std::strerror(errno);
+        EXPECT_EQ(response.id, i);
+        ASSERT_EQ(response.body.size(), values.size() * sizeof(double));
+        binary::read_doubles(response.body, out.data());
+        EXPECT_EQ(out.back(), 2.0 * values.back());
+    }
+    EXPECT_EQ(client->outstanding(), 0u);
+    server.stop();
+}
+
+TEST(BinaryServerTest, BadFramesAndManyConnections) {
+    BinaryServer server(test_options(), handle);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    {
+        // A length too short for a header gets the connection closed.
+        const int fd = connect_tcp("127.0.0.1", server.port());
+        ASSERT_GE(fd, 0);
+        EXPECT_EQ(::write(fd, "\x01\0\0\0\0", 5u), 5);
+        char c;
+        EXPECT_EQ(::read(fd, &c, 1u), 0);
+        ::close(fd);
+    }
+    {
+        // A request a byte at a time.
+        std::string ping;
+        binary::append_frame(&ping, 9u, static_cast<uint8_t>(binary::Op::PING), "");
+        const int fd = connect_tcp("127.0.0.1", server.port());
+        ASSERT_GE(fd, 0);
+        for (const char c : ping) {
+            EXPECT_EQ(::write(fd, &c, 1u), 1);
+        }
+        char response[binary::HEADER_BYTES + 1u];
+        size_t got = 0u;
+        while (got < sizeof(response)) {
+            const ssize_t n = ::read(fd, response + got, sizeof(response) - got);
+            ASSERT_GT(n, 0);
+            got += static_cast<size_t>(n);
+        }
+        EXPECT_EQ(response[binary::HEADER_BYTES], '9');
+        ::close(fd);
+    }
+    {
+        // Many connections at once.
+        std::vector<std::unique_ptr<BinaryClient>> clients;
+        for (int i = 0; i < 40; ++i) {
+            clients.push_back(BinaryClient::connect("127.0.0.1", server.port()));
+            ASSERT_NE(clients.back(), nullptr);
+            clients.back()->ping();
+            ASSERT_TRUE(clients.back()->flush());
+        }
+        for (auto &client : clients) {
+            binary::Frame response;
+            ASSERT_TRUE(client->receive(&response));
+            EXPECT_EQ(response.body, "0");
+        }
+    }
+    server.stop();
+    server.stop();  // Stopping twice is harmless.
+}
+
+}  // namespace djehuti
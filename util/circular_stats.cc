@@ -0,0 +1,135 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/circular_stats.hh"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "util/angle_batch.hh"
+
+namespace djehuti {
+
+namespace {
+
+// Below this many Angles per thread, starting a thread costs more than it saves.
+constexpr size_t MIN_ANGLES_PER_THREAD = 1u << 16;
+
+// Reduce count Angles into result, in num_threads pieces when that's worthwhile. Each piece
+// starts from a copy of empty, is reduced with reduce(piece, angles, count), and is merged into
+// result in order (so the answer doesn't depend on thread timing).
+template <typename Reducer, typename ReduceFn>
+void parallel_add(Reducer &result, const Reducer &empty, const Angle *angles, size_t count,
+                  unsigned num_threads, ReduceFn reduce) {
+    if (num_threads == 0u) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const size_t pieces = std::min<size_t>(num_threads, count / MIN_ANGLES_PER_THREAD);
+    if (pieces <= 1u) {
+        reduce(result, angles, count);
+        return;
+    }
+    std::vector<Reducer> partials(pieces, empty);
+    std::vector<std::thread> threads;
+    threads.reserve(pieces - 1u);
+    const size_t per_piece = count / pieces;
+    for (size_t i = 1u; i < pieces; ++i) {
+        const size_t begin = i * per_piece;
+        const size_t n = (i + 1u == pieces) ? count - begin : per_piece;
+        threads.emplace_back([&, i, begin, n] { reduce(partials[i], angles + begin, n); });
+    }
+    reduce(partials[0], angles, per_piece);  // The calling thread does the first piece.
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (const auto &partial : partials) {
+        result.merge(partial);
+    }
+}
+
+}  // namespace
+
+void CircularStats::add(const Angle *angles, size_t count, unsigned num_threads) {
+    parallel_add(*this, CircularStats(), angles, count, num_threads,
+                 [](CircularStats &stats, const Angle *a, size_t n) { stats.add_serial(a, n); });
+}
+
+void CircularStats::add_serial(const Angle *angles, size_t count) {
+    // Take the sines and cosines a cache-friendly block at a time, with the vectorized kernel.
+    constexpr size_t BLOCK = 256u;
+    double sines[BLOCK];
+    double cosines[BLOCK];
+    for (size_t done = 0u; done < count; done += BLOCK) {
+        const size_t n = std::min(BLOCK, count - done);
+        batch::sincos(angles + done, n, sines, cosines);
+        // Sum each block plainly, then fold the block totals in with compensation. A block's
+        // sum is at most BLOCK in magnitude, so its own rounding error is negligible.
+        double sin_block = 0.0;
+        double cos_block = 0.0;
+        for (size_t i = 0u; i < n; ++i) {
+            sin_block += sines[i];
+            cos_block += cosines[i];
+        }
+        add_sum(sin_sum_, sin_block);
+        add_sum(cos_sum_, cos_block);
+    }
+    count_ += count;
+}
+
+double CircularStats::resultant_length() const {
+    if (count_ == 0u) {
+        return 0.0;
+    }
+    const double length = std::hypot(sin_sum_.total(), cos_sum_.total()) / count_;
+    return std::min(length, 1.0);  // Rounding can push a perfectly concentrated sample over 1.
+}
+
+double CircularStats::standard_deviation() const {
+    return std::sqrt(-2.0 * std::log(resultant_length()));
+}
+
+void AngularHistogram::add(const Angle *angles, size_t count, unsigned num_threads) {
+    parallel_add(*this, AngularHistogram(num_bins()), angles, count, num_threads,
+                 [](AngularHistogram &histogram, const Angle *a, size_t n) {
+                     for (size_t i = 0u; i < n; ++i) {
+                         histogram.add(a[i]);
+                     }
+                 });
+}
+
+void AngularHistogram::merge(const AngularHistogram &other) {
+    if (other.num_bins() != num_bins()) {
+        throw std::invalid_argument("AngularHistogram::merge: different numbers of bins");
+    }
+    for (size_t i = 0u; i < bins_.size(); ++i) {
+        bins_[i] += other.bins_[i];
+    }
+}
+
+uint64_t AngularHistogram::total() const {
+    uint64_t sum = 0u;
+    for (auto count : bins_) {
+        sum += count;
+    }
+    return sum;
+}
+
+}  // namespace djehuti
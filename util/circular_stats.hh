@@ -0,0 +1,170 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "util/angle.hh"
+#include "util/math.hh"
+
+namespace djehuti {
+
+/**
+ * CircularStats accumulates the circular statistics of a stream of Angles in constant memory:
+ * just the (compensated) sums of their sines and cosines. Naively averaging the angles
+ * themselves is wrong around the wrap (the mean of 350 and 10 degrees is 0, not 180).
+ * Accumulators can be merged, so a large dataset can be reduced in parallel pieces.
+ */
+class CircularStats final {
+ public:
+    /// The default constructor makes an empty accumulator.
+    CircularStats() = default;
+    ~CircularStats() = default;
+
+    // Copyable and movable.
+    CircularStats(const CircularStats &) = default;
+    CircularStats(CircularStats &&) = default;
+    CircularStats &operator=(const CircularStats &) = default;
+    CircularStats &operator=(CircularStats &&) = default;
+
+    /// Add one Angle.
+    void add(const Angle &angle) {
+        add_sum(sin_sum_, angle.sin());
+        add_sum(cos_sum_, angle.cos());
+        ++count_;
+    }
+
+    /// Add count Angles, splitting the work across num_threads threads (0 means one per
+    /// hardware thread; small arrays are always done on the calling thread).
+    void add(const Angle *angles, size_t count, unsigned num_threads = 0u);
+
+    /// Add everything that the other accumulator has seen.
+    void merge(const CircularStats &other) {
+        add_sum(sin_sum_, other.sin_sum_.sum);
+        add_sum(sin_sum_, other.sin_sum_.compensation);
+        add_sum(cos_sum_, other.cos_sum_.sum);
+        add_sum(cos_sum_, other.cos_sum_.compensation);
+        count_ += other.count_;
+    }
+
+    /// The number of Angles seen.
+    uint64_t count() const { return count_; }
+
+    /// The circular mean of the Angles seen: the direction of their resultant vector. This is
+    /// meaningless (and zero) if there are none, or if they cancel out (resultant_length() ~ 0).
+    Angle mean() const { return Angle::atan2(sin_sum_.total(), cos_sum_.total()); }
+
+    /// The mean resultant length, in [0, 1]: 1 if the Angles are all the same, near 0 if they
+    /// are spread evenly around the circle. Zero if there are none.
+    double resultant_length() const;
+
+    /// The circular variance, 1 - resultant_length(), in [0, 1].
+    double variance() const { return 1.0 - resultant_length(); }
+
+    /// The circular standard deviation in radians, sqrt(-2 ln(resultant_length())).
+    double standard_deviation() const;
+
+ private:
+    // A Neumaier (improved Kahan) compensated sum, so that billions of samples stay accurate.
+    struct Sum {
+        double sum = 0.0;
+        double compensation = 0.0;
+
+        double total() const { return sum + compensation; }
+    };
+
+    static void add_sum(Sum &s, double value) {
+        const double t = s.sum + value;
+        if (djehuti::abs(s.sum) >= djehuti::abs(value)) {
+            s.compensation += (s.sum - t) + value;
+        } else {
+            s.compensation += (value - t) + s.sum;
+        }
+        s.sum = t;
+    }
+
+    // Add count Angles on this thread.
+    void add_serial(const Angle *angles, size_t count);
+
+    Sum sin_sum_;
+    Sum cos_sum_;
+    uint64_t count_ = 0u;
+};
+
+/**
+ * An AngularHistogram counts Angles in num_bins equal sectors of the circle, the first starting
+ * at zero. Histograms with the same number of bins can be merged.
+ */
+class AngularHistogram final {
+ public:
+    /// Create an empty histogram with the given (nonzero) number of bins.
+    explicit AngularHistogram(size_t num_bins) : bins_(num_bins) {}
+    ~AngularHistogram() = default;
+
+    // Copyable and movable.
+    AngularHistogram(const AngularHistogram &) = default;
+    AngularHistogram(AngularHistogram &&) = default;
+    AngularHistogram &operator=(const AngularHistogram &) = default;
+    AngularHistogram &operator=(AngularHistogram &&) = default;
+
+    /// Add one Angle. NaN Angles (made from infinities or NaNs) are in no bin and aren't counted.
+    void add(const Angle &angle) {
+        const size_t b = bin(angle);
+        if (b < num_bins()) {
+            ++bins_[b];
+        }
+    }
+
+    /// Add count Angles, splitting the work across num_threads threads (0 means one per
+    /// hardware thread; small arrays are always done on the calling thread).
+    void add(const Angle *angles, size_t count, unsigned num_threads = 0u);
+
+    /// Add everything that the other histogram has seen. Throws std::invalid_argument if the
+    /// other histogram has a different number of bins.
+    void merge(const AngularHistogram &other);
+
+    /// The number of bins.
+    size_t num_bins() const { return bins_.size(); }
+    /// The number of Angles counted in the given bin.
+    uint64_t count(size_t bin) const { return bins_[bin]; }
+    /// The total number of Angles counted.
+    uint64_t total() const;
+    /// The bin that the given Angle falls in, or num_bins() if it's NaN.
+    size_t bin(const Angle &angle) const {
+        const double r = angle.radians();
+        if (!(r >= 0.0)) {
+            return num_bins();  // Converting NaN to an integer is undefined.
+        }
+        const size_t b = static_cast<size_t>(r * (num_bins() / (2.0 * M_PI)));
+        return (b < num_bins()) ? b : num_bins() - 1u;  // Rounding can push 2*Pi-ish to the end.
+    }
+    /// The Angle at which the given bin starts.
+    Angle bin_start(size_t bin) const {
+        return Angle::from_radians(2.0 * M_PI * static_cast<double>(bin) / num_bins());
+    }
+
+ private:
+    std::vector<uint64_t> bins_;
+};
+
+}  // namespace djehuti
@@ -0,0 +1,63 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "util/angle.hh"
+#include "util/benchmark.hh"
+#include "util/circular_stats.hh"
+
+// The streaming reducers one Angle at a time, in bulk, and across threads.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 1u << 22;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(0.0, 2.0 * M_PI);
+    std::vector<Angle> angles;
+    for (size_t i = 0u; i < COUNT; ++i) {
+        angles.push_back(Angle::from_radians(dist(gen)));
+    }
+
+    benchmark::run("CircularStats::add one at a time", [&] {
+        CircularStats stats;
+        for (const auto &angle : angles) {
+            stats.add(angle);
+        }
+        benchmark::do_not_optimize(stats);
+    }, COUNT);
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        benchmark::run("CircularStats::add bulk, " + std::to_string(threads) + " threads", [&] {
+            CircularStats stats;
+            stats.add(angles.data(), COUNT, threads);
+            benchmark::do_not_optimize(stats);
+        }, COUNT);
+    }
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        benchmark::run("AngularHistogram::add bulk, " + std::to_string(threads) + " threads", [&] {
+            AngularHistogram histogram(360u);
+            histogram.add(angles.data(), COUNT, threads);
+            benchmark::do_not_optimize(histogram);
+        }, COUNT);
+    }
+    return 0;
+}
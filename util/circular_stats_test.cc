@@ -0,0 +1,176 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/circular_stats.hh"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace djehuti::literals;
+
+namespace djehuti {
+
+// Angles scattered around a central direction with the given spread (in radians).
+std::vector<Angle> scattered(size_t count, double center, double spread, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(-spread, spread);
+    std::vector<Angle> angles;
+    for (size_t i = 0u; i < count; ++i) {
+        angles.push_back(Angle::from_radians(center + dist(gen)));
+    }
+    return angles;
+}
+
+TEST(CircularStatsTests, Basic) {
+    CircularStats stats;
+    EXPECT_EQ(stats.count(), 0u);
+    EXPECT_EQ(stats.resultant_length(), 0.0);
+
+    // The mean goes the short way around.
+    stats.add(350_deg);
+    stats.add(10_deg);
+    EXPECT_EQ(stats.count(), 2u);
+    EXPECT_TRUE(stats.mean().almost_equal(0_deg, 1e-12));
+    EXPECT_NEAR(stats.resultant_length(), std::cos(10 * M_PI / 180), 1e-15);
+
+    // All the same: no spread at all.
+    CircularStats same;
+    for (int i = 0; i < 1000; ++i) {
+        same.add(123_deg);
+    }
+    EXPECT_TRUE(same.mean().almost_equal(123_deg, 1e-12));
+    EXPECT_DOUBLE_EQ(same.resultant_length(), 1.0);
+    EXPECT_NEAR(same.variance(), 0.0, 1e-15);
+    EXPECT_NEAR(same.standard_deviation(), 0.0, 1e-7);
+
+    // Opposites cancel out.
+    CircularStats opposite;
+    opposite.add(0_deg);
+    opposite.add(90_deg);
+    opposite.add(180_deg);
+    opposite.add(270_deg);
+    EXPECT_NEAR(opposite.resultant_length(), 0.0, 1e-15);
+    EXPECT_NEAR(opposite.variance(), 1.0, 1e-15);
+}
+
+TEST(CircularStatsTests, Spread) {
+    // Uniform on [-s, s] has mean resultant length sin(s) / s.
+    const double spread = 0.5;
+    const auto angles = scattered(200000u, 0.1, spread, 1u);
+    CircularStats stats;
+    stats.add(angles.data(), angles.size(), 1u);
+    EXPECT_TRUE(stats.mean().almost_equal(Angle::from_radians(0.1), 5e-3));
+    EXPECT_NEAR(stats.resultant_length(), std::sin(spread) / spread, 2e-3);
+}
+
+TEST(CircularStatsTests, MergeAndThreads) {
+    const auto angles = scattered(1000003u, 3.0, 2.0, 2u);
+
+    CircularStats one_at_a_time;
+    for (const auto &angle : angles) {
+        one_at_a_time.add(angle);
+    }
+
+    // Two halves merged.
+    CircularStats first;
+    CircularStats second;
+    const size_t half = angles.size() / 2u;
+    first.add(angles.data(), half, 1u);
+    second.add(angles.data() + half, angles.size() - half, 1u);
+    first.merge(second);
+
+    EXPECT_EQ(first.count(), angles.size());
+    EXPECT_TRUE(first.mean().almost_equal(one_at_a_time.mean(), 1e-13));
+    EXPECT_NEAR(first.resultant_length(), one_at_a_time.resultant_length(), 1e-13);
+
+    // Any number of threads gets the same answer.
+    for (unsigned threads : {0u, 2u, 3u, 8u}) {
+        CircularStats stats;
+        stats.add(angles.data(), angles.size(), threads);
+        EXPECT_EQ(stats.count(), angles.size()) << threads;
+        EXPECT_TRUE(stats.mean().almost_equal(one_at_a_time.mean(), 1e-13)) << threads;
+        EXPECT_NEAR(stats.resultant_length(), one_at_a_time.resultant_length(), 1e-13) << threads;
+    }
+}
+
+TEST(AngularHistogramTests, Basic) {
+    AngularHistogram histogram(4u);
+    EXPECT_EQ(histogram.num_bins(), 4u);
+    EXPECT_EQ(histogram.total(), 0u);
+    EXPECT_TRUE(histogram.bin_start(1u).almost_equal(90_deg));
+
+    histogram.add(0_deg);
+    histogram.add(45_deg);
+    histogram.add(90_deg);
+    histogram.add(359.999999_deg);
+    histogram.add(Angle::from_radians(-1e-300));  // Normalizes to 0.
+    EXPECT_EQ(histogram.count(0u), 3u);
+    EXPECT_EQ(histogram.count(1u), 1u);
+    EXPECT_EQ(histogram.count(2u), 0u);
+    EXPECT_EQ(histogram.count(3u), 1u);
+    EXPECT_EQ(histogram.total(), 5u);
+
+    // The largest double below 2*Pi still lands in the last bin.
+    EXPECT_EQ(histogram.bin(Angle::from_radians(std::nextafter(2.0 * M_PI, 0.0))), 3u);
+
+    AngularHistogram other(4u);
+    other.add(200_deg);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(2u), 1u);
+    EXPECT_EQ(histogram.total(), 6u);
+
+    EXPECT_THROW(histogram.merge(AngularHistogram(5u)), std::invalid_argument);
+}
+
+TEST(AngularHistogramTests, NonFinite) {
+    AngularHistogram histogram(4u);
+    const Angle nan = Angle::from_radians(std::nan(""));
+    EXPECT_EQ(histogram.bin(nan), 4u);
+    EXPECT_EQ(histogram.bin(Angle::from_radians(INFINITY)), 4u);
+    EXPECT_EQ(histogram.bin(Angle::from_degrees(-INFINITY)), 4u);
+
+    const std::vector<Angle> angles = {nan, 90_deg, nan, Angle::from_radians(INFINITY)};
+    histogram.add(nan);
+    histogram.add(angles.data(), angles.size());
+    EXPECT_EQ(histogram.count(1u), 1u);
+    EXPECT_EQ(histogram.total(), 1u);
+}
+
+TEST(AngularHistogramTests, Threads) {
+    const auto angles = scattered(500009u, 0.0, M_PI, 3u);
+    AngularHistogram expected(360u);
+    for (const auto &angle : angles) {
+        expected.add(angle);
+    }
+    for (unsigned threads : {0u, 1u, 4u, 7u}) {
+        AngularHistogram histogram(360u);
+        histogram.add(angles.data(), angles.size(), threads);
+        EXPECT_EQ(histogram.total(), angles.size());
+        for (size_t i = 0u; i < 360u; ++i) {
+            ASSERT_EQ(histogram.count(i), expected.count(i)) << i << " with " << threads;
+        }
+    }
+}
+
+}  // namespace djehuti
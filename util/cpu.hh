@@ -0,0 +1,51 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "util/platform.hh"
+
+namespace djehuti {
+namespace cpu {
+
+/// Returns true if the CPU we're running on has AVX2 and FMA, so that code compiled with
+/// __attribute__((target("avx2,fma"))) can be run.
+inline bool has_avx2() {
+#if HAVE_X86_SIMD
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+/// Returns true if the CPU we're running on has SSE4.2, so that code compiled with
+/// __attribute__((target("sse4.2"))) can be run.
+inline bool has_sse42() {
+#if HAVE_X86_SIMD
+    static const bool sse42 = __builtin_cpu_supports("sse4.2");
+    return sse42;
+#else
+    return false;
+#endif
+}
+
+}  // namespace cpu
+}  // namespace djehuti
@@ -0,0 +1,164 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/http_request.hh"
+
+#include <algorithm>
+#include <charconv>
+
+namespace djehuti {
+
+namespace {
+
+bool equal_ignoring_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return (x | 0x20) == (y | 0x20);
+           });
+}
+
+bool contains_ignoring_case(std::string_view haystack, std::string_view needle) {
+    for (size_t i = 0u; i + needle.size() <= haystack.size(); ++i) {
+        if (equal_ignoring_case(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+}  // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    std::string_view rest = headers;
+    while (!rest.empty()) {
+        const size_t end = rest.find("\r\n");
+        const std::string_view line = rest.substr(0u, end);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 2u);
+        const size_t colon = line.find(':');
+        if (colon != std::string_view::npos && equal_ignoring_case(line.substr(0u, colon), name)) {
+            std::string_view value = line.substr(colon + 1u);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                value.remove_prefix(1u);
+            }
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+                value.remove_suffix(1u);
+            }
+            return value;
+        }
+    }
+    return std::string_view();
+}
+
+HttpParse parse_http_request(std::string_view data, HttpRequest *request, size_t *size) {
+    const size_t end = data.find("\r\n\r\n");
+    if (end == std::string_view::npos) {
+        return data.size() < MAX_HTTP_HEADER_BYTES ? HttpParse::INCOMPLETE : HttpParse::BAD;
+    }
+    if (end >= MAX_HTTP_HEADER_BYTES) {
+        return HttpParse::BAD;
+    }
+
+    // The request line: method, target and version, separated by single spaces.
+    const size_t line_end = data.find("\r\n");
+    const std::string_view line = data.substr(0u, line_end);
+    const size_t first_space = line.find(' ');
+    const size_t second_space = line.find(' ', first_space + 1u);
+    if (first_space == 0u || first_space == std::string_view::npos ||
+        second_space == std::string_view::npos) {
+        return HttpParse::BAD;
+    }
+    const std::string_view version = line.substr(second_space + 1u);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        return HttpParse::BAD;
+    }
+    HttpRequest parsed;
+    parsed.method = line.substr(0u, first_space);
+    const std::string_view target = line.substr(first_space + 1u, second_space - first_space - 1u);
+    const size_t question = target.find('?');
+    parsed.path = target.substr(0u, question);
+    if (question != std::string_view::npos) {
+        parsed.query = target.substr(question + 1u);
+    }
+    parsed.headers = line_end == end ? std::string_view()
+                                     : data.substr(line_end + 2u, end - line_end);
+
+    const std::string_view connection = parsed.header("Connection");
+    parsed.keep_alive = version == "HTTP/1.1" ? !contains_ignoring_case(connection, "close")
+                                              : contains_ignoring_case(connection, "keep-alive");
+    if (!parsed.header("Transfer-Encoding").empty()) {
+        return HttpParse::BAD;
+    }
+    size_t length = 0u;
+    const std::string_view content_length = parsed.header("Content-Length");
+    if (!content_length.empty()) {
+        const char *last = content_length.data() + content_length.size();
+        if (std::from_chars(content_length.data(), last, length).ptr != last) {
+            return HttpParse::BAD;
+        }
+    }
+    const size_t body_start = end + 4u;
+    if (data.size() - body_start < length) {
+        return HttpParse::INCOMPLETE;
+    }
+    parsed.body = data.substr(body_start, length);
+    *request = parsed;
+    *size = body_start + length;
+    return HttpParse::COMPLETE;
+}
+
+std::string url_decode(std::string_view text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0u; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            decoded += ' ';
+        } else if (text[i] == '%' && i + 2u < text.size() && hex_digit(text[i + 1u]) >= 0 &&
+                   hex_digit(text[i + 2u]) >= 0) {
+            decoded += static_cast<char>(hex_digit(text[i + 1u]) * 16 + hex_digit(text[i + 2u]));
+            i += 2u;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+std::optional<std::string> query_param(std::string_view query, std::string_view name) {
+    while (!query.empty()) {
+        const size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0u, amp);
+        query.remove_prefix(amp == std::string_view::npos ? query.size() : amp + 1u);
+        const size_t equals = pair.find('=');
+        if (url_decode(pair.substr(0u, equals)) == name) {
+            return url_decode(equals == std::string_view::npos ? std::string_view()
+                                                               : pair.substr(equals + 1u));
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace djehuti
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace djehuti {
+
+/// An HTTP/1.1 request, as views into the bytes it was parsed from.
+struct HttpRequest {
+    std::string_view method;
+    std::string_view path;   // The target up to the query.
+    std::string_view query;  // After the '?', if there is one.
+    std::string_view headers;  // The header lines, each ending in CRLF.
+    std::string_view body;
+    bool keep_alive = true;
+    /// The client's address, if the server that took the request fills it in.
+    std::string_view peer;
+
+    /// Returns the value of the first header with the name (in any case), or an empty view.
+    std::string_view header(std::string_view name) const;
+};
+
+/// What parse_http_request() makes of the bytes it's given.
+enum class HttpParse { INCOMPLETE, COMPLETE, BAD };
+
+/// The most header bytes parse_http_request() waits for before calling a request BAD.
+constexpr size_t MAX_HTTP_HEADER_BYTES = 64u << 10;
+
+/**
+ * Parses the request at the start of data. If it's all there, fills in the request and its size
+ * (so that the next pipelined request starts after it) and returns COMPLETE. If the data stops
+ * short, returns INCOMPLETE; if it isn't an HTTP/1.x request we can take, BAD. Bodies must have
+ * a Content-Length; chunked requests are BAD.
+ */
+HttpParse parse_http_request(std::string_view data, HttpRequest *request, size_t *size);
+
+/// Undoes %XX escapes and turns '+' into ' ', as in a query string. Bad escapes are kept as is.
+std::string url_decode(std::string_view text);
+
+/// Returns the (decoded) value of the first parameter with the name in the query, or nothing.
+std::optional<std::string> query_param(std::string_view query, std::string_view name);
+
+}  // namespace djehuti
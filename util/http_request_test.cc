@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/http_request.hh"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+TEST(HttpRequestTest, Pipelined) {
+    const std::string data =
+        "GET /convert/length?from=m&to=ft&v=1 HTTP/1.1\r\nHost: x\r\nAccept-Encoding: gzip\r\n\r\n"
+        "POST /analyze HTTP/1.1\r\ncontent-length: 5\r\nConnection: close\r\n\r\nhello"
+        "GET / HTTP/1.1\r\n";
+    HttpRequest request;
+    size_t size;
+    ASSERT_EQ(parse_http_request(data, &request, &size), HttpParse::COMPLETE);
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.path, "/convert/length");
+    EXPECT_EQ(request.query, "from=m&to=ft&v=1");
+    EXPECT_EQ(request.header("accept-encoding"), "gzip");
+    EXPECT_EQ(request.header("Host"), "x");
+    EXPECT_EQ(request.header("Cookie"), "");
+    EXPECT_EQ(request.body, "");
+    EXPECT_TRUE(request.keep_alive);
+
+    std::string_view rest = std::string_view(data).substr(size);
+    ASSERT_EQ(parse_http_request(rest, &request, &size), HttpParse::COMPLETE);
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.path, "/analyze");
+    EXPECT_EQ(request.query, "");
+    EXPECT_EQ(request.body, "hello");
+    EXPECT_FALSE(request.keep_alive);
+
+    rest = rest.substr(size);
+    EXPECT_EQ(parse_http_request(rest, &request, &size), HttpParse::INCOMPLETE);
+    EXPECT_EQ(parse_http_request("GET / HTTP/1.1\r\nContent-Length: 9\r\n\r\nshort", &request,
+                                 &size),
+              HttpParse::INCOMPLETE);
+}
+
+TEST(HttpRequestTest, KeepAlive) {
+    HttpRequest request;
+    size_t size;
+    ASSERT_EQ(parse_http_request("GET / HTTP/1.0\r\n\r\n", &request, &size), HttpParse::COMPLETE);
+    EXPECT_FALSE(request.keep_alive);
+    EXPECT_EQ(size, 18u);
+    ASSERT_EQ(parse_http_request("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", &request,
+                                 &size),
+              HttpParse::COMPLETE);
+    EXPECT_TRUE(request.keep_alive);
+}
+
+TEST(HttpRequestTest, Bad) {
+    HttpRequest request;
+    size_t size;
+    EXPECT_EQ(parse_http_request("GET /\r\n\r\n", &request, &size), HttpParse::BAD);
+    EXPECT_EQ(parse_http_request("GET / SPDY/3\r\n\r\n", &request, &size), HttpParse::BAD);
+    EXPECT_EQ(parse_http_request("GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n", &request, &size),
+              HttpParse::BAD);
+    EXPECT_EQ(parse_http_request("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", &request,
+                                 &size),
+              HttpParse::BAD);
+    EXPECT_EQ(parse_http_request(std::string(MAX_HTTP_HEADER_BYTES, 'x'), &request, &size),
+              HttpParse::BAD);
+}
+
+TEST(HttpRequestTest, Query) {
+    EXPECT_EQ(url_decode("a+b%20c%2x%"), "a b c%2x%");
+    EXPECT_EQ(query_param("from=m&to=ft&v=1%2C2", "v"), "1,2");
+    EXPECT_EQ(query_param("from=m&to=ft", "from"), "m");
+    EXPECT_EQ(query_param("flag&x=", "flag"), "");
+    EXPECT_EQ(query_param("flag&x=", "x"), "");
+    EXPECT_FALSE(query_param("from=m", "to"));
+    EXPECT_FALSE(query_param("", "to"));
+}
+
+}  // namespace djehuti
@@ -0,0 +1,227 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/http_response.hh"
+
+#include <algorithm>
+#include <charconv>
+
+namespace djehuti {
+
+constexpr size_t HttpResponseParser::MAX_HEADER_BYTES;
+
+namespace {
+
+bool equal_ignoring_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return (x | 0x20) == (y | 0x20);
+           });
+}
+
+bool contains_ignoring_case(std::string_view haystack, std::string_view needle) {
+    for (size_t i = 0u; i + needle.size() <= haystack.size(); ++i) {
+        if (equal_ignoring_case(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1u);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r' ||
+                          s.back() == '\n')) {
+        s.remove_suffix(1u);
+    }
+    return s;
+}
+
+}  // namespace
+
+size_t HttpResponseParser::read_line(std::string_view data, bool *whole) {
+    const size_t end = data.find('\n');
+    const size_t count = end == std::string_view::npos ? data.size() : end + 1u;
+    line_.append(data.data(), count);
+    *whole = end != std::string_view::npos;
+    return count;
+}
+
+size_t HttpResponseParser::parse(std::string_view data) {
+    size_t used = 0u;
+    while (state_ == State::INCOMPLETE && used < data.size()) {
+        const std::string_view rest = data.substr(used);
+        bool whole = false;
+        switch (phase_) {
+            case Phase::HEADERS: {
+                // Look for the blank line, which may straddle what we have and what's new.
+                const size_t before = headers_.size();
+                const size_t from = before < 3u ? 0u : before - 3u;
+                headers_.append(rest.data(), std::min(rest.size(), MAX_HEADER_BYTES));
+                const size_t end = headers_.find("\r\n\r\n", from);
+                if (end == std::string::npos) {
+                    used += std::min(rest.size(), MAX_HEADER_BYTES);
+                    if (headers_.size() >= MAX_HEADER_BYTES) {
+                        fail();
+                    }
+                    break;
+                }
+                headers_.resize(end + 4u);
+                used += end + 4u - before;
+                if (!parse_headers()) {
+                    fail();
+                }
+                break;
+            }
+            case Phase::BODY:
+            case Phase::CHUNK_DATA: {
+                const uint64_t count = std::min<uint64_t>(remaining_, rest.size());
+                used += count;
+                remaining_ -= count;
+                body_size_ += count;
+                if (remaining_ == 0u) {
+                    if (phase_ == Phase::BODY) {
+                        finish();
+                    } else {
+                        phase_ = Phase::CHUNK_END;
+                    }
+                }
+                break;
+            }
+            case Phase::UNTIL_CLOSE:
+                used += rest.size();
+                body_size_ += rest.size();
+                break;
+            case Phase::CHUNK_SIZE: {
+                used += read_line(rest, &whole);
+                if (!whole) {
+                    break;
+                }
+                // The size is in hex, and may be followed by extensions after a semicolon.
+                const std::string_view text = trim(line_);
+                const auto result =
+                    std::from_chars(text.data(), text.data() + text.size(), remaining_, 16);
+                line_.clear();
+                if (result.ptr == text.data() ||
+                    (result.ptr != text.data() + text.size() && *result.ptr != ';')) {
+                    fail();
+                } else {
+                    phase_ = remaining_ == 0u ? Phase::TRAILERS : Phase::CHUNK_DATA;
+                }
+                break;
+            }
+            case Phase::CHUNK_END:
+                used += read_line(rest, &whole);
+                if (whole) {
+                    if (trim(line_).empty()) {
+                        line_.clear();
+                        phase_ = Phase::CHUNK_SIZE;
+                    } else {
+                        fail();
+                    }
+                }
+                break;
+            case Phase::TRAILERS:
+                used += read_line(rest, &whole);
+                if (whole) {
+                    if (trim(line_).empty()) {
+                        finish();
+                    }
+                    line_.clear();
+                }
+                break;
+        }
+    }
+    return used;
+}
+
+bool HttpResponseParser::parse_headers() {
+    std::string_view text = headers_;
+    size_t end = text.find("\r\n");
+    std::string_view status_line = text.substr(0u, end);
+    if (status_line.substr(0u, 5u) != "HTTP/" || status_line.size() < 12u) {
+        return false;
+    }
+    const bool http10 = status_line.substr(0u, 8u) == "HTTP/1.0";
+    keep_alive_ = !http10;
+    const char *first = status_line.data() + 9;
+    if (std::from_chars(first, first + 3, status_).ptr != first + 3) {
+        return false;
+    }
+
+    bool has_length = false;
+    bool chunked = false;
+    for (text.remove_prefix(end + 2u); !text.empty() && text.substr(0u, 2u) != "\r\n";
+         text.remove_prefix(end + 2u)) {
+        end = text.find("\r\n");
+        const std::string_view line = text.substr(0u, end);
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        const std::string_view name = line.substr(0u, colon);
+        const std::string_view value = trim(line.substr(colon + 1u));
+        if (equal_ignoring_case(name, "Content-Length")) {
+            const auto result =
+                std::from_chars(value.data(), value.data() + value.size(), remaining_);
+            if (result.ptr != value.data() + value.size() || value.empty()) {
+                return false;
+            }
+            has_length = true;
+        } else if (equal_ignoring_case(name, "Transfer-Encoding")) {
+            chunked = contains_ignoring_case(value, "chunked");
+        } else if (equal_ignoring_case(name, "Connection")) {
+            if (contains_ignoring_case(value, "close")) {
+                keep_alive_ = false;
+            } else if (contains_ignoring_case(value, "keep-alive")) {
+                keep_alive_ = true;
+            }
+        }
+    }
+
+    // Informational, No Content and Not Modified responses never have a body.
+    if ((status_ >= 100 && status_ < 200) || status_ == 204 || status_ == 304) {
+        finish();
+    } else if (chunked) {
+        phase_ = Phase::CHUNK_SIZE;
+    } else if (has_length) {
+        phase_ = Phase::BODY;
+        if (remaining_ == 0u) {
+            finish();
+        }
+    } else {
+        phase_ = Phase::UNTIL_CLOSE;
+        keep_alive_ = false;
+    }
+    return true;
+}
+
+void HttpResponseParser::close() {
+    if (state_ == State::INCOMPLETE) {
+        if (phase_ == Phase::UNTIL_CLOSE) {
+            finish();
+        } else {
+            fail();
+        }
+    }
+}
+
+}  // namespace djehuti
@@ -0,0 +1,89 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace djehuti {
+
+/**
+ * An HttpResponseParser finds where each HTTP/1.1 response ends in the bytes read from a
+ * connection, however they happen to be split up, so that a client can keep the connection
+ * alive and pipeline requests on it. It keeps the status line and headers of the response it is
+ * reading, but only counts the body, which may have a Content-Length or be chunked.
+ *
+ * Feed it bytes with parse() until it says the response is complete (or that it isn't HTTP),
+ * then reset() it for the next one.
+ */
+class HttpResponseParser final {
+ public:
+    enum class State { INCOMPLETE, COMPLETE, FAILED };
+
+    /// The most header bytes we'll keep before giving up on a response.
+    static constexpr size_t MAX_HEADER_BYTES = 64u << 10;
+
+    /**
+     * Reads bytes off the front of data, stopping at the end of the response, and returns how
+     * many it read: all of them unless the response is complete (so whatever is left belongs to
+     * the next one) or it failed.
+     */
+    size_t parse(std::string_view data);
+
+    /**
+     * Tells the parser the connection was closed, which ends a response that has neither a
+     * Content-Length nor chunks. Any other incomplete response has failed.
+     */
+    void close();
+
+    /// Forget the response, to be ready for the next one on the connection.
+    void reset() { *this = HttpResponseParser(); }
+
+    State state() const { return state_; }
+    /// The status code, once the headers have been read.
+    int status() const { return status_; }
+    /// Whether the connection can be used for another request after this response.
+    bool keep_alive() const { return keep_alive_; }
+    /// The number of bytes in the body so far (after taking the chunks apart, if it's chunked).
+    uint64_t body_size() const { return body_size_; }
+
+ private:
+    enum class Phase { HEADERS, BODY, UNTIL_CLOSE, CHUNK_SIZE, CHUNK_DATA, CHUNK_END, TRAILERS };
+
+    // Reads a line (through its LF) into line_, returning the bytes read and whether it's whole.
+    size_t read_line(std::string_view data, bool *whole);
+    bool parse_headers();
+    void finish() { state_ = State::COMPLETE; }
+    void fail() { state_ = State::FAILED; }
+
+    State state_ = State::INCOMPLETE;
+    Phase phase_ = Phase::HEADERS;
+    std::string headers_;
+    std::string line_;
+    int status_ = 0;
+    bool keep_alive_ = true;
+    uint64_t body_size_ = 0u;
+    uint64_t remaining_ = 0u;  // In the body or the current chunk.
+};
+
+}  // namespace djehuti
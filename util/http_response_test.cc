@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/http_response.hh"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+namespace {
+
+using State = HttpResponseParser::State;
+
+// Parses the bytes a few at a time, and returns what's left after the response.
+std::string parse_in_pieces(HttpResponseParser *parser, const std::string &bytes, size_t piece) {
+    size_t offset = 0u;
+    while (offset < bytes.size() && parser->state() == State::INCOMPLETE) {
+        const std::string_view data = std::string_view(bytes).substr(offset, piece);
+        offset += parser->parse(data);
+    }
+    return bytes.substr(offset);
+}
+
+}  // namespace
+
+TEST(HttpResponseParserTest, ContentLength) {
+    const std::string two = "HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\nHello, World"
+                            "HTTP/1.1 404 Not Found\r\ncontent-length:3\r\n\r\nNo\n";
+    for (size_t piece : {1u, 2u, 5u, 1000u}) {
+        HttpResponseParser parser;
+        std::string rest = parse_in_pieces(&parser, two, piece);
+        EXPECT_EQ(parser.state(), State::COMPLETE) << piece;
+        EXPECT_EQ(parser.status(), 200);
+        EXPECT_EQ(parser.body_size(), 12u);
+        EXPECT_TRUE(parser.keep_alive());
+        parser.reset();
+        rest = parse_in_pieces(&parser, rest, piece);
+        EXPECT_EQ(parser.state(), State::COMPLETE) << piece;
+        EXPECT_EQ(parser.status(), 404);
+        EXPECT_EQ(parser.body_size(), 3u);
+        EXPECT_EQ(rest, "");
+    }
+}
+
+TEST(HttpResponseParserTest, Chunked) {
+    const std::string chunked =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n"
+        "5\r\nHello\r\n7;ext=1\r\n, World\r\n0\r\nX-Trailer: yes\r\n\r\nextra";
+    for (size_t piece : {1u, 3u, 1000u}) {
+        HttpResponseParser parser;
+        EXPECT_EQ(parse_in_pieces(&parser, chunked, piece), "extra") << piece;
+        EXPECT_EQ(parser.state(), State::COMPLETE);
+        EXPECT_EQ(parser.body_size(), 12u);
+        EXPECT_FALSE(parser.keep_alive());
+    }
+}
+
+TEST(HttpResponseParserTest, NoLength) {
+    HttpResponseParser parser;
+    EXPECT_EQ(parser.parse("HTTP/1.0 200 OK\r\n\r\nall of it"), 28u);
+    EXPECT_EQ(parser.state(), State::INCOMPLETE);
+    parser.close();
+    EXPECT_EQ(parser.state(), State::COMPLETE);
+    EXPECT_EQ(parser.body_size(), 9u);
+    EXPECT_FALSE(parser.keep_alive());
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("HTTP/1.1 204 No Content\r\n\r\nHTTP"), 27u);
+    EXPECT_EQ(parser.state(), State::COMPLETE);
+    EXPECT_EQ(parser.body_size(), 0u);
+}
+
+TEST(HttpResponseParserTest, Bad) {
+    HttpResponseParser parser;
+    parser.parse("SMTP 220 hello\r\n\r\n");
+    EXPECT_EQ(parser.state(), State::FAILED);
+
+    parser.reset();
+    parser.parse("HTTP/1.1 200 OK\r\nContent-Length: lots\r\n\r\n");
+    EXPECT_EQ(parser.state(), State::FAILED);
+
+    parser.reset();
+    parser.parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n");
+    EXPECT_EQ(parser.state(), State::FAILED);
+
+    parser.reset();
+    parser.parse("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort");
+    parser.close();
+    EXPECT_EQ(parser.state(), State::FAILED);
+
+    parser.reset();
+    parser.parse(std::string(HttpResponseParser::MAX_HEADER_BYTES, 'x'));
+    EXPECT_EQ(parser.state(), State::FAILED);
+}
+
+}  // namespace djehuti
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/mapped_file.hh"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+// Write the contents to a new temporary file and return its name.
+std::string temporary_file(const std::string &contents) {
+    char name[] = "/tmp/mapped_file_test.XXXXXX";
+    const int fd = ::mkstemp(name);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(::write(fd, contents.data(), contents.size()),
+              static_cast<ssize_t>(contents.size()));
+    ::close(fd);
+    return name;
+}
+
+TEST(MappedFileTests, Open) {
+    const std::string contents = "one\ntwo\nthree\n";
+    const std::string name = temporary_file(contents);
+    auto file = MappedFile::open(name);
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->size(), contents.size());
+    EXPECT_EQ(file->view(), contents);
+
+    // Moving it keeps the mapping.
+    const char *data = file->data();
+    MappedFile moved = std::move(*file);
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_EQ(moved.view(), contents);
+    EXPECT_EQ(file->data(), nullptr);
+    ::unlink(name.c_str());
+}
+
+TEST(MappedFileTests, Empty) {
+    const std::string name = temporary_file("");
+    const auto file = MappedFile::open(name);
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->size(), 0u);
+    EXPECT_TRUE(file->view().empty());
+    ::unlink(name.c_str());
+}
+
+TEST(MappedFileTests, Missing) {
+    errno = 0;
+    EXPECT_FALSE(MappedFile::open("/nonexistent/file").has_value());
+    EXPECT_EQ(errno, ENOENT);
+}
+
+}  // namespace djehuti
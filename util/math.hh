@@ -31,7 +31,7 @@ namespace djehuti {
 
 #define MAYBE_CONSTEXPR constexpr
 
-using abs = std::abs;
+using std::abs;
 
 #else  // HAVE_CONSTEXPR_CMATH
 
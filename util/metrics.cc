@@ -0,0 +1,327 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/metrics.hh"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace djehuti {
+namespace metrics {
+
+constexpr int Histogram::SUB_BUCKET_BITS;
+constexpr int Histogram::MAX_BITS;
+constexpr size_t Histogram::BUCKETS;
+
+uint64_t Counter::value() const {
+    uint64_t value = 0u;
+    for (const Shard &shard : shards_) {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+void Gauge::set(int64_t value) {
+    for (size_t i = 1u; i < SHARDS; ++i) {
+        shards_[i].value.store(0, std::memory_order_relaxed);
+    }
+    shards_[0].value.store(value, std::memory_order_relaxed);
+}
+
+int64_t Gauge::value() const {
+    int64_t value = 0;
+    for (const Shard &shard : shards_) {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+uint64_t Histogram::bucket_min(size_t bucket) {
+    constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const size_t shift = (bucket >> SUB_BUCKET_BITS) - 1u;
+    return uint64_t{SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1u))} << shift;
+}
+
+uint64_t Histogram::bucket_max(size_t bucket) {
+    if (bucket + 1u == BUCKETS) {
+        return UINT64_MAX;
+    }
+    return bucket_min(bucket + 1u) - 1u;
+}
+
+Histogram::Histogram() : shards_(new Shard[SHARDS]) {
+    for (size_t i = 0u; i < SHARDS; ++i) {
+        for (auto &count : shards_[i].counts) {
+            count.store(0u, std::memory_order_relaxed);
+        }
+        shards_[i].sum.store(0u, std::memory_order_relaxed);
+    }
+}
+
+Histogram::~Histogram() = default;
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.counts.assign(BUCKETS, 0u);
+    for (size_t i = 0u; i < SHARDS; ++i) {
+        for (size_t b = 0u; b < BUCKETS; ++b) {
+            snapshot.counts[b] += shards_[i].counts[b].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += shards_[i].sum.load(std::memory_order_relaxed);
+    }
+    for (const uint64_t count : snapshot.counts) {
+        snapshot.count += count;
+    }
+    return snapshot;
+}
+
+uint64_t Histogram::Snapshot::quantile(double q) const {
+    if (count == 0u) {
+        return 0u;
+    }
+    // The rank of the value we want, counting from 1.
+    const auto rank = std::max<uint64_t>(
+        1u, static_cast<uint64_t>(std::ceil(std::min(std::max(q, 0.0), 1.0) * count)));
+    uint64_t seen = 0u;
+    for (size_t b = 0u; b < counts.size(); ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            const uint64_t min = bucket_min(b);
+            if (b + 1u == BUCKETS) {
+                return min;  // The last bucket has no sensible middle.
+            }
+            return min + (bucket_max(b) - min) / 2u;
+        }
+    }
+    return bucket_min(BUCKETS - 1u);
+}
+
+namespace {
+
+enum Kind { COUNTER, GAUGE, HISTOGRAM };
+
+const char *const KIND_NAMES[] = {"counter", "gauge", "summary"};
+
+// Appends the labels as {name="value",...}, with an extra one at the end if it's given.
+void append_labels(std::string *out,
+                   const Labels &labels,
+                   const char *extra_name = nullptr,
+                   const std::string &extra_value = "") {
+    if (labels.empty() && extra_name == nullptr) {
+        return;
+    }
+    out->push_back('{');
+    bool first = true;
+    const auto append = [out, &first](const std::string &name, const std::string &value) {
+        if (!first) {
+            out->push_back(',');
+        }
+        first = false;
+        out->append(name);
+        out->append("=\"");
+        for (const char c : value) {
+            if (c == '\\' || c == '"') {
+                out->push_back('\\');
+                out->push_back(c);
+            } else if (c == '\n') {
+                out->append("\\n");
+            } else {
+                out->push_back(c);
+            }
+        }
+        out->push_back('"');
+    };
+    for (const auto &label : labels) {
+        append(label.first, label.second);
+    }
+    if (extra_name != nullptr) {
+        append(extra_name, extra_value);
+    }
+    out->push_back('}');
+}
+
+// Integer series are written exactly, however big they get.
+void append_value(std::string *out, uint64_t value) {
+    char text[32];
+    const int size = std::snprintf(text, sizeof(text), " %" PRIu64 "\n", value);
+    out->append(text, static_cast<size_t>(size));
+}
+
+void append_value(std::string *out, int64_t value) {
+    char text[32];
+    const int size = std::snprintf(text, sizeof(text), " %" PRId64 "\n", value);
+    out->append(text, static_cast<size_t>(size));
+}
+
+// Doubles are written with enough digits to read back exactly: 15 if that's enough (so 1.01 isn't
+// 1.0100000000000000), or else 17, which always is.
+void append_value(std::string *out, double value) {
+    char text[40];
+    int size = std::snprintf(text, sizeof(text), " %.15g\n", value);
+    if (std::strtod(text, nullptr) != value && !std::isnan(value)) {
+        size = std::snprintf(text, sizeof(text), " %.17g\n", value);
+    }
+    out->append(text, static_cast<size_t>(size));
+}
+
+// Histogram values, which are integers until they're scaled. Scales like 1e-3 aren't exact in
+// binary, so this divides by the reciprocal when that's a whole number: 1007 * 1e-3 is
+// 1.0070000000000001, but 1007 / 1e3 is 1.007.
+void append_scaled(std::string *out, uint64_t value, double scale) {
+    const double inverse = 1.0 / scale;
+    if (scale == 1.0) {
+        append_value(out, value);
+    } else if (inverse == std::round(inverse)) {
+        append_value(out, static_cast<double>(value) / inverse);
+    } else {
+        append_value(out, static_cast<double>(value) * scale);
+    }
+}
+
+}  // namespace
+
+struct Registry::Family {
+    struct Member {
+        Labels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    // Returns the member with the labels, creating it if need be.
+    Member &member(const Labels &labels) {
+        for (auto &member : members) {
+            if (member->labels == labels) {
+                return *member;
+            }
+        }
+        members.push_back(std::make_unique<Member>());
+        Member &member = *members.back();
+        member.labels = labels;
+        switch (kind) {
+            case COUNTER:
+                member.counter = std::make_unique<Counter>();
+                break;
+            case GAUGE:
+                member.gauge = std::make_unique<Gauge>();
+                break;
+            case HISTOGRAM:
+                member.histogram = std::make_unique<Histogram>();
+                break;
+        }
+        return member;
+    }
+
+    std::string name;
+    std::string help;
+    int kind;
+    double scale;
+    std::vector<std::unique_ptr<Member>> members;
+};
+
+Registry::Registry() = default;
+Registry::~Registry() = default;
+
+Registry::Family &Registry::family(const std::string &name,
+                                   const std::string &help,
+                                   int kind,
+                                   double scale) {
+    for (auto &family : families_) {
+        if (family->name == name) {
+            return *family;
+        }
+    }
+    families_.push_back(std::make_unique<Family>());
+    Family &family = *families_.back();
+    family.name = name;
+    family.help = help;
+    family.kind = kind;
+    family.scale = scale;
+    return family;
+}
+
+Counter &Registry::counter(const std::string &name, const std::string &help, const Labels &labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return *family(name, help, COUNTER, 1.0).member(labels).counter;
+}
+
+Gauge &Registry::gauge(const std::string &name, const std::string &help, const Labels &labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return *family(name, help, GAUGE, 1.0).member(labels).gauge;
+}
+
+Histogram &Registry::histogram(const std::string &name,
+                               const std::string &help,
+                               const Labels &labels,
+                               double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return *family(name, help, HISTOGRAM, scale).member(labels).histogram;
+}
+
+std::string Registry::render() const {
+    static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const auto &family : families_) {
+        out.append("# HELP ").append(family->name).append(" ").append(family->help);
+        out.append("\n# TYPE ").append(family->name).append(" ");
+        out.append(KIND_NAMES[family->kind]).append("\n");
+        for (const auto &member : family->members) {
+            switch (family->kind) {
+                case COUNTER:
+                    out.append(family->name);
+                    append_labels(&out, member->labels);
+                    append_value(&out, member->counter->value());
+                    break;
+                case GAUGE:
+                    out.append(family->name);
+                    append_labels(&out, member->labels);
+                    append_value(&out, member->gauge->value());
+                    break;
+                case HISTOGRAM: {
+                    const Histogram::Snapshot snapshot = member->histogram->snapshot();
+                    for (const double q : QUANTILES) {
+                        char quantile[16];
+                        std::snprintf(quantile, sizeof(quantile), "%g", q);
+                        out.append(family->name);
+                        append_labels(&out, member->labels, "quantile", quantile);
+                        append_scaled(&out, snapshot.quantile(q), family->scale);
+                    }
+                    out.append(family->name).append("_sum");
+                    append_labels(&out, member->labels);
+                    append_scaled(&out, snapshot.sum, family->scale);
+                    out.append(family->name).append("_count");
+                    append_labels(&out, member->labels);
+                    append_value(&out, snapshot.count);
+                    break;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+}  // namespace metrics
+}  // namespace djehuti
@@ -0,0 +1,183 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace djehuti {
+namespace metrics {
+
+/**
+ * Metrics are sharded so that recording never takes a lock and seldom shares a cache line: each
+ * thread is given one of SHARDS shards the first time it records anything, and adds to that
+ * shard with relaxed atomics. The shards are only added up when the metric is read, which is
+ * when it's scraped.
+ */
+constexpr size_t SHARDS = 16u;
+
+/// Returns the shard the calling thread records into.
+inline size_t shard() {
+    static std::atomic<size_t> next{0u};
+    thread_local const size_t mine = next.fetch_add(1u, std::memory_order_relaxed) % SHARDS;
+    return mine;
+}
+
+/// A count of events, which only goes up.
+class Counter final {
+ public:
+    void add(uint64_t n = 1u) {
+        shards_[shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+ private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0u};
+    };
+    Shard shards_[SHARDS];
+};
+
+/// A value that goes up and down, such as the number of requests in flight.
+class Gauge final {
+ public:
+    void add(int64_t n = 1) { shards_[shard()].value.fetch_add(n, std::memory_order_relaxed); }
+    void sub(int64_t n = 1) { add(-n); }
+    /// Sets the value, for a gauge that mirrors something kept elsewhere. An add() racing with
+    /// it may or may not count, but two set()s leave one value or the other, never their sum.
+    void set(int64_t value);
+    int64_t value() const;
+
+ private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    Shard shards_[SHARDS];
+};
+
+/**
+ * A Histogram counts values (such as latencies in nanoseconds) in logarithmic buckets, in the
+ * manner of an HDR histogram: values below 2^SUB_BUCKET_BITS each have a bucket of their own,
+ * and every power of two above that is split into 2^SUB_BUCKET_BITS equal buckets, so a bucket
+ * is never wider than 1/16 of the values in it. Values of 2^MAX_BITS and up all land in the last
+ * bucket.
+ */
+class Histogram final {
+ public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int MAX_BITS = 44;  // About 4.9 hours, in nanoseconds.
+    static constexpr size_t BUCKETS = size_t{MAX_BITS - SUB_BUCKET_BITS + 1}
+                                      << SUB_BUCKET_BITS;
+
+    /// Returns the bucket the value lands in.
+    static size_t bucket(uint64_t value) {
+        constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        const int exponent = 63 - __builtin_clzll(value);
+        if (exponent >= MAX_BITS) {
+            return BUCKETS - 1u;
+        }
+        const int shift = exponent - SUB_BUCKET_BITS;
+        return (static_cast<size_t>(shift + 1) << SUB_BUCKET_BITS) +
+               static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+    }
+    /// Returns the smallest value in the bucket.
+    static uint64_t bucket_min(size_t bucket);
+    /// Returns the largest value in the bucket.
+    static uint64_t bucket_max(size_t bucket);
+
+    Histogram();
+    ~Histogram();
+    Histogram(const Histogram &) = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+    void record(uint64_t value) {
+        Shard &mine = shards_[shard()];
+        mine.counts[bucket(value)].fetch_add(1u, std::memory_order_relaxed);
+        mine.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /// The buckets of all the shards added up.
+    struct Snapshot {
+        std::vector<uint64_t> counts;
+        uint64_t count = 0u;
+        uint64_t sum = 0u;
+
+        /// Returns the value at the given quantile (0 to 1), as the middle of the bucket it's
+        /// in, or 0 if there are no values.
+        uint64_t quantile(double q) const;
+    };
+    Snapshot snapshot() const;
+
+ private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counts[BUCKETS];
+        std::atomic<uint64_t> sum;
+    };
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/// Label names and values, such as {{"route", "/metrics"}}.
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * A Registry names metrics and renders them in the Prometheus text format. Metrics are created
+ * (under a lock) once, and then recorded into directly; they live as long as the Registry.
+ */
+class Registry final {
+ public:
+    Registry();
+    ~Registry();
+    Registry(const Registry &) = delete;
+    Registry &operator=(const Registry &) = delete;
+
+    /// Returns the metric with the name and labels, creating it if need be. All the metrics
+    /// with the same name must be of the same kind, and the help of the first is used.
+    Counter &counter(const std::string &name, const std::string &help, const Labels &labels = {});
+    Gauge &gauge(const std::string &name, const std::string &help, const Labels &labels = {});
+    /// A histogram is rendered as a summary, with values multiplied by scale (such as 1e-9 to
+    /// turn nanoseconds into the seconds Prometheus expects).
+    Histogram &histogram(const std::string &name,
+                         const std::string &help,
+                         const Labels &labels = {},
+                         double scale = 1.0);
+
+    /// Returns all the metrics in the Prometheus text exposition format.
+    std::string render() const;
+
+ private:
+    struct Family;
+    Family &family(const std::string &name, const std::string &help, int kind, double scale);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+};
+
+}  // namespace metrics
+}  // namespace djehuti
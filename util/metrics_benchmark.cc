@@ -0,0 +1,104 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <time.h>
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/metrics.hh"
+
+// The cost of recording into each kind of metric, on one thread and on several at once, against
+// a counter behind a mutex; and the cost of rendering them.
+
+namespace {
+
+// Returns the CPU time the calling thread has used, in seconds.
+double thread_seconds() {
+    timespec now;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+}
+
+// Runs fn(i) for i in [0, CALLS) on each of the threads at once, and prints the CPU time per
+// call (which doesn't count time spent waiting for a turn on a CPU).
+template <typename Fn>
+void on_threads(const std::string &name, int num_threads, Fn fn) {
+    constexpr int CALLS = 2000000;
+    std::vector<std::thread> threads;
+    std::vector<double> seconds(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&fn, &seconds, t] {
+            const double start = thread_seconds();
+            for (int i = 0; i < CALLS; ++i) {
+                fn(i);
+            }
+            seconds[t] = thread_seconds() - start;
+        });
+    }
+    double total = 0.0;
+    for (int t = 0; t < num_threads; ++t) {
+        threads[t].join();
+        total += seconds[t];
+    }
+    std::printf("%-48s %12.2f ns/call\n", name.c_str(), total * 1e9 / CALLS / num_threads);
+}
+
+}  // namespace
+
+int main() {
+    using namespace djehuti;
+    metrics::Registry registry;
+    auto &counter = registry.counter("requests_total", "Requests.", {{"route", "/"}});
+    auto &gauge = registry.gauge("in_flight", "Requests in flight.", {{"route", "/"}});
+    auto &histogram =
+        registry.histogram("latency_seconds", "Latency.", {{"route", "/"}}, 1e-9);
+    std::mutex mutex;
+    uint64_t locked_count = 0u;
+
+    for (const int threads : {1, 4}) {
+        const std::string suffix = threads == 1 ? ", 1 thread" : ", 4 threads";
+        on_threads("mutex counter" + suffix, threads, [&](int) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++locked_count;
+        });
+        on_threads("Counter::add" + suffix, threads, [&](int) { counter.add(); });
+        on_threads("Gauge::add and sub" + suffix, threads, [&](int) {
+            gauge.add();
+            gauge.sub();
+        });
+        on_threads("Histogram::record" + suffix, threads,
+                   [&](int i) { histogram.record(static_cast<uint64_t>(i) * 977u % 1000000u); });
+    }
+    benchmark::do_not_optimize(locked_count);
+
+    for (int route = 0; route < 20; ++route) {
+        registry.histogram("latency_seconds", "Latency.", {{"route", std::to_string(route)}}, 1e-9)
+            .record(1000u);
+    }
+    benchmark::run("render, 21 histograms", [&] {
+        benchmark::do_not_optimize(registry.render());
+    });
+    return 0;
+}
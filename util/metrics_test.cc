@@ -0,0 +1,179 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/metrics.hh"
+
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace metrics {
+
+TEST(MetricsTests, Buckets) {
+    // Every value is in its bucket, the buckets are in order, and none is wider than a
+    // sixteenth of its values.
+    size_t last = 0u;
+    for (uint64_t value = 0u; value < (1u << 20); ++value) {
+        const size_t b = Histogram::bucket(value);
+        ASSERT_LE(Histogram::bucket_min(b), value);
+        ASSERT_GE(Histogram::bucket_max(b), value);
+        ASSERT_TRUE(b == last || b == last + 1u) << value;
+        last = b;
+    }
+    std::mt19937_64 gen(1u);
+    for (int i = 0; i < 100000; ++i) {
+        const uint64_t value = gen() >> (gen() % 64u);
+        const size_t b = Histogram::bucket(value);
+        ASSERT_LT(b, Histogram::BUCKETS);
+        if (b + 1u < Histogram::BUCKETS) {
+            ASSERT_LE(Histogram::bucket_min(b), value);
+            ASSERT_GE(Histogram::bucket_max(b), value);
+            ASSERT_LE(Histogram::bucket_max(b) - Histogram::bucket_min(b),
+                      std::max<uint64_t>(Histogram::bucket_min(b) / 16u, 1u));
+        }
+    }
+    EXPECT_EQ(Histogram::bucket(15u), 15u);
+    EXPECT_EQ(Histogram::bucket(16u), 16u);
+    EXPECT_EQ(Histogram::bucket(uint64_t{1} << Histogram::MAX_BITS), Histogram::BUCKETS - 1u);
+    EXPECT_EQ(Histogram::bucket(UINT64_MAX), Histogram::BUCKETS - 1u);
+    EXPECT_EQ(Histogram::bucket((uint64_t{1} << Histogram::MAX_BITS) - 1u),
+              Histogram::BUCKETS - 1u);
+}
+
+TEST(MetricsTests, ManyThreads) {
+    Counter counter;
+    Gauge gauge;
+    Histogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 20; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                counter.add();
+                gauge.add(2);
+                gauge.sub();
+                histogram.record(100u);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.value(), 200000u);
+    EXPECT_EQ(gauge.value(), 200000);
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 200000u);
+    EXPECT_EQ(snapshot.sum, 20000000u);
+    EXPECT_EQ(snapshot.counts[Histogram::bucket(100u)], 200000u);
+}
+
+TEST(MetricsTests, GaugeSet) {
+    Gauge gauge;
+    gauge.add(100);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&gauge, t] {
+            for (int i = 0; i < 10000; ++i) {
+                gauge.set(t % 2 == 0 ? 7 : 11);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    // Racing set()s leave one value or the other, where add() to sync it could leave neither.
+    EXPECT_TRUE(gauge.value() == 7 || gauge.value() == 11) << gauge.value();
+    gauge.set(-3);
+    EXPECT_EQ(gauge.value(), -3);
+    gauge.add(5);
+    EXPECT_EQ(gauge.value(), 2);
+}
+
+TEST(MetricsTests, Quantiles) {
+    Histogram histogram;
+    EXPECT_EQ(histogram.snapshot().quantile(0.5), 0u);
+    for (uint64_t value = 1u; value <= 100000u; ++value) {
+        histogram.record(value);
+    }
+    const auto snapshot = histogram.snapshot();
+    for (const double q : {0.0, 0.01, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        const double expected = std::max(1.0, q * 100000.0);
+        EXPECT_NEAR(static_cast<double>(snapshot.quantile(q)), expected, expected / 32.0) << q;
+    }
+    // Small values are exact.
+    Histogram small;
+    small.record(3u);
+    small.record(7u);
+    EXPECT_EQ(small.snapshot().quantile(0.5), 3u);
+    EXPECT_EQ(small.snapshot().quantile(0.51), 7u);
+}
+
+TEST(MetricsTests, Render) {
+    Registry registry;
+    registry.counter("requests_total", "Requests served.", {{"route", "/"}}).add(3u);
+    registry.counter("requests_total", "Ignored.", {{"route", "/say \"hi\""}}).add();
+    EXPECT_EQ(&registry.counter("requests_total", "", {{"route", "/"}}),
+              &registry.counter("requests_total", "", {{"route", "/"}}));
+    registry.gauge("in_flight", "Requests in flight.").add(2);
+    Histogram &latency = registry.histogram("latency_seconds", "Latency.", {{"route", "/"}}, 1e-3);
+    latency.record(10u);
+    latency.record(1000u);
+
+    EXPECT_EQ(registry.render(),
+              "# HELP requests_total Requests served.\n"
+              "# TYPE requests_total counter\n"
+              "requests_total{route=\"/\"} 3\n"
+              "requests_total{route=\"/say \\\"hi\\\"\"} 1\n"
+              "# HELP in_flight Requests in flight.\n"
+              "# TYPE in_flight gauge\n"
+              "in_flight 2\n"
+              "# HELP latency_seconds Latency.\n"
+              "# TYPE latency_seconds summary\n"
+              "latency_seconds{route=\"/\",quantile=\"0.5\"} 0.01\n"
+              "latency_seconds{route=\"/\",quantile=\"0.9\"} 1.007\n"
+              "latency_seconds{route=\"/\",quantile=\"0.99\"} 1.007\n"
+              "latency_seconds{route=\"/\",quantile=\"0.999\"} 1.007\n"
+              "latency_seconds_sum{route=\"/\"} 1.01\n"
+              "latency_seconds_count{route=\"/\"} 2\n");
+}
+
+TEST(MetricsTests, RenderPrecision) {
+    Registry registry;
+    // Integers too big for a double to hold exactly.
+    registry.counter("big_total", "Big.").add((uint64_t{1} << 60) + 1u);
+    registry.gauge("big", "Big.").set(-(int64_t{1} << 60) - 1);
+    Histogram &unscaled = registry.histogram("unscaled", "Unscaled.");
+    unscaled.record(123456789012u);
+    // And a scaled sum that needs all 17 digits to read back.
+    Histogram &scaled = registry.histogram("scaled", "Scaled.", {}, 0.3);
+    scaled.record(3u);
+
+    const std::string text = registry.render();
+    EXPECT_NE(text.find("big_total 1152921504606846977\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("big -1152921504606846977\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("unscaled_sum 123456789012\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("scaled_sum 0.89999999999999991\n"), std::string::npos) << text;
+}
+
+}  // namespace metrics
+}  // namespace djehuti
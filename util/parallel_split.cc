@@ -0,0 +1,144 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/parallel_split.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace djehuti {
+namespace string {
+
+ParallelSplitter::ParallelSplitter(std::string_view text,
+                                   const SeparatorSet &separators,
+                                   Options options)
+    : text_(text), separators_(separators), options_(options) {
+    if (options_.chunk_size == 0u) {
+        options_.chunk_size = 1u;
+    }
+    if (options_.num_threads == 0u) {
+        options_.num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options_.max_chunks_in_flight == 0u) {
+        options_.max_chunks_in_flight = 2u * options_.num_threads;
+    }
+    num_chunks_ = (text_.size() + options_.chunk_size - 1u) / options_.chunk_size;
+}
+
+size_t ParallelSplitter::chunk_start(size_t index) const {
+    if (index == 0u) {
+        return 0u;
+    }
+    if (index >= num_chunks_) {
+        return text_.size();
+    }
+    for (size_t pos = index * options_.chunk_size; pos < text_.size(); ++pos) {
+        if (separators_.contains(text_[pos])) {
+            return pos + 1u;
+        }
+    }
+    return text_.size();
+}
+
+std::string_view ParallelSplitter::chunk(size_t index) const {
+    const size_t start = chunk_start(index);
+    return text_.substr(start, chunk_start(index + 1u) - start);
+}
+
+void ParallelSplitter::for_each_chunk(
+    const std::function<void(const std::vector<std::string_view> &)> &fn) const {
+    const size_t window =
+        std::min(options_.max_chunks_in_flight, std::max<size_t>(num_chunks_, 1u));
+    const size_t num_threads = std::min(options_.num_threads, window);
+    // Chunk i is split into slots[i % window]; ready[i % window] says when it's done.
+    std::vector<std::vector<std::string_view>> slots(window);
+    std::vector<bool> ready(window, false);
+    std::mutex mutex;
+    std::condition_variable split_cv;      // The workers wait on this for room in the window.
+    std::condition_variable delivered_cv;  // The caller waits on this for the next chunk.
+    size_t next_to_split = 0u;
+    size_t next_to_deliver = 0u;
+    bool stop = false;
+
+    const auto work = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            split_cv.wait(lock, [&] {
+                return stop || next_to_split >= num_chunks_ ||
+                       next_to_split < next_to_deliver + window;
+            });
+            if (stop || next_to_split >= num_chunks_) {
+                return;
+            }
+            const size_t index = next_to_split++;
+            lock.unlock();
+            auto &parts = slots[index % window];
+            parts.clear();
+            split_into(chunk(index), separators_, &parts);
+            lock.lock();
+            ready[index % window] = true;
+            if (index == next_to_deliver) {
+                delivered_cv.notify_one();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (size_t i = 0u; i < num_threads; ++i) {
+        workers.emplace_back(work);
+    }
+
+    std::exception_ptr failure;
+    try {
+        for (size_t index = 0u; index < num_chunks_; ++index) {
+            const size_t slot = index % window;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                delivered_cv.wait(lock, [&] { return ready[slot]; });
+            }
+            fn(slots[slot]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[slot] = false;
+                ++next_to_deliver;
+            }
+            split_cv.notify_one();
+        }
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    split_cv.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+}  // namespace string
+}  // namespace djehuti
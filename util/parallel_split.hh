@@ -0,0 +1,94 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "util/string_scan.hh"
+
+namespace djehuti {
+namespace string {
+
+/**
+ * A ParallelSplitter splits a big text (such as a MappedFile) into its non-empty parts, with the
+ * same semantics as split_view(), using several threads. The text is cut into chunks of about
+ * chunk_size bytes, each ending just after a separator so that no part straddles two chunks;
+ * worker threads split the chunks into string_views with split_into(), and the calling thread
+ * gets them back in their original order.
+ *
+ * At most max_chunks_in_flight chunks are split ahead of the one being delivered, and each of
+ * those reuses the vector of the chunk before it, so memory stays bounded however big the text.
+ */
+class ParallelSplitter final {
+ public:
+    struct Options {
+        /// The size the text is cut into, before moving each cut to just after a separator.
+        size_t chunk_size = size_t{4} << 20;
+        /// The number of worker threads, or 0 for one per hardware thread.
+        size_t num_threads = 0u;
+        /// The most chunks split but not yet delivered, or 0 for twice the number of threads.
+        size_t max_chunks_in_flight = 0u;
+    };
+
+    /// The text must outlive the ParallelSplitter.
+    ParallelSplitter(std::string_view text, const SeparatorSet &separators)
+        : ParallelSplitter(text, separators, Options()) {}
+    ParallelSplitter(std::string_view text, const SeparatorSet &separators, Options options);
+
+    /// Returns the number of chunks the text is cut into.
+    size_t num_chunks() const { return num_chunks_; }
+    /// Returns the text of the given chunk (which may be empty, if a part is longer than
+    /// chunk_size).
+    std::string_view chunk(size_t index) const;
+
+    /**
+     * Call fn on this thread with the parts of each chunk in turn, in order; the parts are
+     * views into the text, and the vector is good until fn returns. If fn throws, the workers
+     * are stopped and the exception is passed on.
+     */
+    void for_each_chunk(const std::function<void(const std::vector<std::string_view> &)> &fn) const;
+
+    /// Call fn on this thread with each part of the text, in order.
+    template <typename Fn>
+    void for_each(Fn &&fn) const {
+        for_each_chunk([&fn](const std::vector<std::string_view> &parts) {
+            for (std::string_view part : parts) {
+                fn(part);
+            }
+        });
+    }
+
+ private:
+    // Returns where chunk index starts: just after the first separator at or after
+    // index * chunk_size (or the end of the text).
+    size_t chunk_start(size_t index) const;
+
+    std::string_view text_;
+    SeparatorSet separators_;
+    Options options_;
+    size_t num_chunks_;
+};
+
+}  // namespace string
+}  // namespace djehuti
@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/mapped_file.hh"
+#include "util/parallel_split.hh"
+#include "util/string_scan.hh"
+
+// Splitting a big mapped file of CSV-ish lines with a ParallelSplitter, across thread counts.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t SIZE = size_t{256} << 20;
+    char name[] = "/tmp/parallel_split_benchmark.XXXXXX";
+    const int fd = ::mkstemp(name);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    {
+        std::mt19937_64 gen(1u);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(0, 16);
+        std::string block;
+        for (size_t written = 0u; written < SIZE; written += block.size()) {
+            block.clear();
+            while (block.size() < (1u << 20)) {
+                for (int n = length(gen); n > 0; --n) {
+                    block.push_back(static_cast<char>(letter(gen)));
+                }
+                block.push_back(length(gen) < 2 ? '\n' : ',');
+            }
+            if (::write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+                std::perror("write");
+                return 1;
+            }
+        }
+    }
+    ::close(fd);
+    const auto file = MappedFile::open(name);
+    ::unlink(name);
+    if (!file) {
+        std::perror("open");
+        return 1;
+    }
+    const std::string_view text = file->view();
+    const string::SeparatorSet separators(",\n");
+    std::vector<std::string_view> serial;
+    const size_t parts = string::split_into(text, separators, &serial);
+
+    benchmark::run("split_into, one thread", [&] {
+        serial.clear();
+        benchmark::do_not_optimize(string::split_into(text, separators, &serial));
+    }, parts, text.size(), 2.0);
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1u; threads <= 2u * hardware; threads *= 2u) {
+        string::ParallelSplitter::Options options;
+        options.num_threads = threads;
+        const string::ParallelSplitter splitter(text, separators, options);
+        const std::string label = "ParallelSplitter, " + std::to_string(threads) + " threads";
+        benchmark::run(label, [&] {
+            size_t total = 0u;
+            splitter.for_each_chunk([&total](const std::vector<std::string_view> &chunk_parts) {
+                total += chunk_parts.size();
+            });
+            benchmark::do_not_optimize(total);
+        }, parts, text.size(), 2.0);
+    }
+    return 0;
+}
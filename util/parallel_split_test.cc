@@ -0,0 +1,121 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/parallel_split.hh"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace string {
+
+// Lines of random fields, some empty, some longer than the chunks.
+std::string random_lines(size_t size, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> length(0, 12);
+    std::bernoulli_distribution long_field(0.001);
+    std::string text;
+    while (text.size() < size) {
+        const int n = long_field(gen) ? 5000 : length(gen);
+        for (int i = 0; i < n; ++i) {
+            text.push_back(static_cast<char>(letter(gen)));
+        }
+        text.push_back(length(gen) < 3 ? '\n' : ',');
+    }
+    return text;
+}
+
+std::vector<std::string_view> serial_split(std::string_view text, const SeparatorSet &separators) {
+    std::vector<std::string_view> parts;
+    split_into(text, separators, &parts);
+    return parts;
+}
+
+TEST(ParallelSplitTests, Chunks) {
+    const std::string text = "aaaa\nbb\nccccccc\n\nd";
+    ParallelSplitter::Options options;
+    options.chunk_size = 4u;
+    const ParallelSplitter splitter(text, SeparatorSet('\n'), options);
+    ASSERT_EQ(splitter.num_chunks(), 5u);
+    // Each chunk ends just after a separator, and together they cover the text.
+    EXPECT_EQ(splitter.chunk(0u), "aaaa\n");
+    EXPECT_EQ(splitter.chunk(1u), "bb\nccccccc\n");
+    // Chunk 2 would have started in the middle of the c's, and chunk 1 took them.
+    EXPECT_EQ(splitter.chunk(2u), "");
+    EXPECT_EQ(splitter.chunk(3u), "\n");
+    EXPECT_EQ(splitter.chunk(4u), "d");
+}
+
+TEST(ParallelSplitTests, SameAsSerial) {
+    const std::string text = random_lines(1u << 18, 1u);
+    const SeparatorSet separators(",\n");
+    const auto expected = serial_split(text, separators);
+    for (size_t threads : {1u, 2u, 3u, 8u}) {
+        for (size_t chunk_size : {size_t{7}, size_t{1000}, size_t{65536}, size_t{10} << 20}) {
+            ParallelSplitter::Options options;
+            options.num_threads = threads;
+            options.chunk_size = chunk_size;
+            options.max_chunks_in_flight = threads + 1u;
+            const ParallelSplitter splitter(text, separators, options);
+            std::vector<std::string_view> parts;
+            parts.reserve(expected.size());
+            splitter.for_each([&parts](std::string_view part) { parts.push_back(part); });
+            ASSERT_EQ(parts, expected) << threads << " threads, chunk size " << chunk_size;
+            // The parts are views into the text.
+            ASSERT_EQ(parts.front().data(), expected.front().data());
+        }
+    }
+}
+
+TEST(ParallelSplitTests, Empty) {
+    const ParallelSplitter empty("", SeparatorSet('\n'));
+    EXPECT_EQ(empty.num_chunks(), 0u);
+    size_t calls = 0u;
+    empty.for_each_chunk([&calls](const std::vector<std::string_view> &) { ++calls; });
+    EXPECT_EQ(calls, 0u);
+
+    const ParallelSplitter separators("\n\n\n", SeparatorSet('\n'));
+    separators.for_each([&calls](std::string_view) { ++calls; });
+    EXPECT_EQ(calls, 0u);
+}
+
+TEST(ParallelSplitTests, Throws) {
+    const std::string text = random_lines(1u << 18, 2u);
+    ParallelSplitter::Options options;
+    options.num_threads = 4u;
+    options.chunk_size = 1024u;
+    const ParallelSplitter splitter(text, SeparatorSet(",\n"), options);
+    size_t chunks = 0u;
+    EXPECT_THROW(splitter.for_each_chunk([&chunks](const std::vector<std::string_view> &) {
+        if (++chunks == 10u) {
+            throw std::runtime_error("enough");
+        }
+    }),
+                 std::runtime_error);
+    EXPECT_EQ(chunks, 10u);
+}
+
+}  // namespace string
+}  // namespace djehuti
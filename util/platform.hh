@@ -33,3 +33,14 @@
 #error "I don't know what compiler you're using."
 
 #endif // __clang__/__GNUC__
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// We can compile x86 SIMD code (and choose whether to run it at run time; see util/cpu.hh).
+#define HAVE_X86_SIMD 1
+
+#else
+
+#define HAVE_X86_SIMD 0
+
+#endif  // __x86_64__/__i386__
@@ -0,0 +1,331 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+// Compile-time units and quantities. A Unit is an affine map onto its dimension's base unit
+// (value in base units = value * scale + offset), with the scale an exact std::ratio times a
+// power of Pi and the offset an exact std::ratio. Converting between two units composes their
+// maps at compile time, so any conversion costs at most one multiply (or divide) and one add,
+// whatever the units, and one subtract more between units with offsets (which go by way of their
+// dimension's anchor, so that it comes out exactly). A Quantity is a value in a Unit; Quantities
+// convert implicitly to other units of the same dimension, and mixing dimensions doesn't compile.
+//
+// Angle, Temperature, Frequency and Interval take their unit conversions from here, and each
+// can be made from and converted to Quantities of its dimension.
+
+namespace djehuti {
+namespace units {
+
+/// A scale factor of Ratio * Pi^PI_POWER. The factor of Pi lets angle units be exact ratios of
+/// one another (degrees to turns is 1/360, with no rounding).
+template <typename Ratio, int PI_POWER = 0>
+struct Scale {
+    using ratio = typename Ratio::type;
+    static constexpr int pi_power = PI_POWER;
+};
+
+/// A unit of the given dimension: value in base units = value * ScaleT + Offset.
+template <typename Dimension, typename ScaleT, typename Offset = std::ratio<0>>
+struct Unit {
+    using dimension = Dimension;
+    using scale = ScaleT;
+    using offset = typename Offset::type;
+};
+
+// The dimensions. Conversions to or from a unit with an offset go through the dimension's
+// anchor, a point (in base units) that they all map exactly onto one another: converting x is
+// (x - anchor in From) * scale + anchor in To. For temperatures it's the freezing point of
+// water, so 0 C, 32 F and 273.15 K are the same exactly, and so (with the scale of 9/5 exact
+// in doubles) are 100 C and 212 F.
+struct AngleDimension {
+    using anchor = std::ratio<0>;
+};
+struct TemperatureDimension {
+    using anchor = std::ratio<27315, 100>;
+};
+struct FrequencyDimension {
+    using anchor = std::ratio<0>;
+};
+struct IntervalDimension {
+    using anchor = std::ratio<0>;
+};
+
+// Angles. The base unit is radians.
+using Radians = Unit<AngleDimension, Scale<std::ratio<1>>>;
+using Degrees = Unit<AngleDimension, Scale<std::ratio<1, 180>, 1>>;
+using Turns = Unit<AngleDimension, Scale<std::ratio<2>, 1>>;
+using Gradians = Unit<AngleDimension, Scale<std::ratio<1, 200>, 1>>;
+
+// Temperatures. The base unit is Kelvin.
+using Kelvin = Unit<TemperatureDimension, Scale<std::ratio<1>>>;
+using Celsius = Unit<TemperatureDimension, Scale<std::ratio<1>>, std::ratio<27315, 100>>;
+using Fahrenheit = Unit<TemperatureDimension, Scale<std::ratio<5, 9>>, std::ratio<45967, 180>>;
+using Rankine = Unit<TemperatureDimension, Scale<std::ratio<5, 9>>>;
+
+// Frequencies. The base unit is Hertz.
+using Hertz = Unit<FrequencyDimension, Scale<std::ratio<1>>>;
+using Kilohertz = Unit<FrequencyDimension, Scale<std::kilo>>;
+using Megahertz = Unit<FrequencyDimension, Scale<std::mega>>;
+using PerMinute = Unit<FrequencyDimension, Scale<std::ratio<1, 60>>>;  // RPM, BPM.
+
+// Intervals. The base unit is semitones.
+using Semitones = Unit<IntervalDimension, Scale<std::ratio<1>>>;
+using Cents = Unit<IntervalDimension, Scale<std::ratio<1, 100>>>;
+using Octaves = Unit<IntervalDimension, Scale<std::ratio<12>>>;
+
+/// True if the two units measure the same dimension.
+template <typename U1, typename U2>
+constexpr bool same_dimension = std::is_same<typename U1::dimension, typename U2::dimension>::value;
+
+/// True if the unit is a plain multiple of the base unit (no offset), so that its values can
+/// be added and scaled. (Two Celsius temperatures can't be meaningfully added.)
+template <typename U>
+constexpr bool is_linear = U::offset::num == 0;
+
+namespace detail {
+
+constexpr double pi_power(int power) {
+    double result = 1.0;
+    for (; power > 0; --power) {
+        result *= M_PI;
+    }
+    for (; power < 0; ++power) {
+        result /= M_PI;
+    }
+    return result;
+}
+
+template <typename R>
+constexpr double ratio_value = static_cast<double>(R::num) / static_cast<double>(R::den);
+
+// Multiply by the exact ratio times Pi^PI_POWER, rounding only once: dividing by the
+// denominator when the numerator is 1 (so cents to semitones is x / 100, not x * 0.01).
+template <typename R, int PI_POWER>
+constexpr double scale(double x) {
+    if constexpr (R::num == 1 && R::den == 1 && PI_POWER == 0) {
+        return x;
+    } else if constexpr (PI_POWER != 0) {
+        return x * (ratio_value<R> * pi_power(PI_POWER));
+    } else if constexpr (R::den == 1) {
+        return x * static_cast<double>(R::num);
+    } else if constexpr (R::num == 1) {
+        return x / static_cast<double>(R::den);
+    } else {
+        return x * ratio_value<R>;
+    }
+}
+
+}  // namespace detail
+
+/// The composition of From's map to the base unit with the inverse of To's, folded at compile
+/// time: value in To = (value in From - subtrahend) * multiplier + addend.
+template <typename From, typename To>
+struct Conversion {
+    static_assert(same_dimension<From, To>, "Can't convert between units of different dimensions");
+    using ratio = std::ratio_divide<typename From::scale::ratio, typename To::scale::ratio>;
+    static constexpr int pi_power = From::scale::pi_power - To::scale::pi_power;
+    // Between linear units, the anchor is zero: there's nothing to subtract or add.
+    using anchor = std::conditional_t<is_linear<From> && is_linear<To>,
+                                      std::ratio<0>,
+                                      typename From::dimension::anchor>;
+    static_assert(anchor::num == 0 || (From::scale::pi_power == 0 && To::scale::pi_power == 0),
+                  "Offsets are only supported in units without a factor of Pi");
+    // The anchor in From units, and in To units.
+    using shift = std::ratio_divide<std::ratio_subtract<anchor, typename From::offset>,
+                                    typename From::scale::ratio>;
+    using offset = std::ratio_divide<std::ratio_subtract<anchor, typename To::offset>,
+                                     typename To::scale::ratio>;
+
+    /// The subtrahend, as a double.
+    static constexpr double subtrahend = detail::ratio_value<shift>;
+    /// The multiplier, as a double.
+    static constexpr double multiplier = detail::ratio_value<ratio> * detail::pi_power(pi_power);
+    /// The addend, as a double.
+    static constexpr double addend = detail::ratio_value<offset>;
+
+    /// Convert a value (a point on the scale, like a temperature reading).
+    static constexpr double apply(double x) {
+        double shifted = x;
+        if constexpr (shift::num != 0) {
+            shifted = x - subtrahend;
+        }
+        const double scaled = detail::scale<ratio, pi_power>(shifted);
+        if constexpr (offset::num == 0) {
+            return scaled;  // Don't add zero; that would turn -0 into +0.
+        } else {
+            return scaled + addend;
+        }
+    }
+
+    /// Convert a difference between two values (like a temperature change), which ignores the
+    /// offsets.
+    static constexpr double apply_difference(double x) { return detail::scale<ratio, pi_power>(x); }
+};
+
+/// Convert a value from one unit to another.
+template <typename From, typename To>
+constexpr double convert(double x) {
+    return Conversion<From, To>::apply(x);
+}
+
+/// Convert a difference between values from one unit to another.
+template <typename From, typename To>
+constexpr double convert_difference(double x) {
+    return Conversion<From, To>::apply_difference(x);
+}
+
+}  // namespace units
+
+/**
+ * A Quantity is a value in a Unit. It is an immutable copyable and movable value type, no
+ * bigger than its Rep. Quantities convert implicitly to other units of the same dimension; they
+ * can be compared whatever their units (of the same dimension), and added and scaled if their
+ * units are linear.
+ */
+template <typename U, typename Rep = double>
+class Quantity final {
+ public:
+    using unit = U;
+    using rep = Rep;
+
+    /// The default constructor gives zero (in this unit).
+    constexpr Quantity() : value_(0) {}
+    /// Make a Quantity of the given value in this unit.
+    constexpr explicit Quantity(Rep value) : value_(value) {}
+    /// Convert a Quantity in another unit of the same dimension.
+    template <typename U2, typename = std::enable_if_t<units::same_dimension<U, U2>>>
+    constexpr Quantity(const Quantity<U2, Rep> &other)
+        : value_(static_cast<Rep>(units::convert<U2, U>(other.value()))) {}
+    ~Quantity() = default;
+
+    // Copyable and movable.
+    constexpr Quantity(const Quantity &) = default;
+    constexpr Quantity(Quantity &&) = default;
+    Quantity &operator=(const Quantity &) = default;
+    Quantity &operator=(Quantity &&) = default;
+
+    /// Return the value in this unit.
+    constexpr Rep value() const { return value_; }
+
+    /// Return the value in another unit.
+    template <typename To>
+    constexpr Rep in() const {
+        return static_cast<Rep>(units::convert<U, To>(value_));
+    }
+
+ private:
+    Rep value_;
+};
+
+/// Convert a Quantity to another unit.
+template <typename To, typename From, typename Rep>
+constexpr Quantity<To, Rep> quantity_cast(const Quantity<From, Rep> &q) {
+    return Quantity<To, Rep>(q);
+}
+
+// Comparisons convert the right-hand side to the left-hand side's unit.
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator==(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return a.value() == Quantity<U1, Rep>(b).value();
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator!=(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return !(a == b);
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator<(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return a.value() < Quantity<U1, Rep>(b).value();
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator<=(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return a.value() <= Quantity<U1, Rep>(b).value();
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator>(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return b < a;
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2>>>
+constexpr bool operator>=(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return b <= a;
+}
+
+// Arithmetic, for linear units only. Sums and differences are in the left-hand side's unit.
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2> && units::is_linear<U1> &&
+                                      units::is_linear<U2>>>
+constexpr Quantity<U1, Rep> operator+(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return Quantity<U1, Rep>(a.value() + Quantity<U1, Rep>(b).value());
+}
+
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2> && units::is_linear<U1> &&
+                                      units::is_linear<U2>>>
+constexpr Quantity<U1, Rep> operator-(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return Quantity<U1, Rep>(a.value() - Quantity<U1, Rep>(b).value());
+}
+
+template <typename U, typename Rep, typename = std::enable_if_t<units::is_linear<U>>>
+constexpr Quantity<U, Rep> operator-(const Quantity<U, Rep> &a) {
+    return Quantity<U, Rep>(-a.value());
+}
+
+template <typename U, typename Rep, typename = std::enable_if_t<units::is_linear<U>>>
+constexpr Quantity<U, Rep> operator*(const Quantity<U, Rep> &a, Rep factor) {
+    return Quantity<U, Rep>(a.value() * factor);
+}
+
+template <typename U, typename Rep, typename = std::enable_if_t<units::is_linear<U>>>
+constexpr Quantity<U, Rep> operator*(Rep factor, const Quantity<U, Rep> &a) {
+    return Quantity<U, Rep>(factor * a.value());
+}
+
+template <typename U, typename Rep, typename = std::enable_if_t<units::is_linear<U>>>
+constexpr Quantity<U, Rep> operator/(const Quantity<U, Rep> &a, Rep divisor) {
+    return Quantity<U, Rep>(a.value() / divisor);
+}
+
+/// The ratio of two Quantities of the same (linear) dimension is a plain number.
+template <typename U1, typename U2, typename Rep,
+          typename = std::enable_if_t<units::same_dimension<U1, U2> && units::is_linear<U1> &&
+                                      units::is_linear<U2>>>
+constexpr Rep operator/(const Quantity<U1, Rep> &a, const Quantity<U2, Rep> &b) {
+    return a.value() / Quantity<U1, Rep>(b).value();
+}
+
+}  // namespace djehuti
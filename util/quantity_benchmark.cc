@@ -0,0 +1,74 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <random>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/quantity.hh"
+#include "util/temperature.hh"
+
+// Quantity conversions against the same arithmetic written out by hand. These should run at
+// the same speed (the compiler should make the same code of them).
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 4096u;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-40.0, 120.0);
+    std::vector<double> fahrenheit(COUNT);
+    for (auto &f : fahrenheit) {
+        f = dist(gen);
+    }
+    std::vector<double> out(COUNT);
+
+    benchmark::run("F to C by hand", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = fahrenheit[i] * (5.0 / 9.0) + (-160.0 / 9.0);
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+    benchmark::run("F to C by Quantity", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = Quantity<units::Celsius>(Quantity<units::Fahrenheit>(fahrenheit[i])).value();
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+    benchmark::run("F to C by Temperature (by way of Kelvin)", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = Temperature::from_fahrenheit(fahrenheit[i]).celsius();
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+
+    benchmark::run("degrees to turns by hand", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = fahrenheit[i] / 360.0;
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+    benchmark::run("degrees to turns by Quantity", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = Quantity<units::Degrees>(fahrenheit[i]).in<units::Turns>();
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/quantity.hh"
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "util/angle.hh"
+#include "util/temperature.hh"
+
+namespace djehuti {
+
+using namespace units;
+
+// Whether a + b compiles.
+template <typename A, typename B, typename = void>
+struct can_add : std::false_type {};
+template <typename A, typename B>
+struct can_add<A, B, std::void_t<decltype(std::declval<A>() + std::declval<B>())>>
+    : std::true_type {};
+
+// Whether a < b compiles.
+template <typename A, typename B, typename = void>
+struct can_compare : std::false_type {};
+template <typename A, typename B>
+struct can_compare<A, B, std::void_t<decltype(std::declval<A>() < std::declval<B>())>>
+    : std::true_type {};
+
+// Mixing dimensions doesn't compile, and neither does adding affine quantities.
+static_assert(std::is_convertible<Quantity<Degrees>, Quantity<Turns>>::value, "");
+static_assert(!std::is_convertible<Quantity<Degrees>, Quantity<Kelvin>>::value, "");
+static_assert(can_add<Quantity<Degrees>, Quantity<Radians>>::value, "");
+static_assert(!can_add<Quantity<Degrees>, Quantity<Hertz>>::value, "");
+static_assert(!can_add<Quantity<Celsius>, Quantity<Celsius>>::value, "");
+static_assert(can_add<Quantity<Kelvin>, Quantity<Rankine>>::value, "");
+static_assert(can_compare<Quantity<Celsius>, Quantity<Fahrenheit>>::value, "");
+static_assert(!can_compare<Quantity<Cents>, Quantity<Kilohertz>>::value, "");
+
+// A Quantity is just its value, so it costs nothing to pass around.
+static_assert(sizeof(Quantity<Celsius>) == sizeof(double), "");
+static_assert(std::is_trivially_copyable<Quantity<Celsius>>::value, "");
+
+// Conversions fold to one multiply (or divide) and one add, with exact ratios where they exist,
+// and a subtract more between units with offsets.
+static_assert(Conversion<Degrees, Turns>::pi_power == 0, "Pi should cancel");
+static_assert(std::is_same<Conversion<Degrees, Turns>::ratio, std::ratio<1, 360>>::value, "");
+static_assert(std::is_same<Conversion<Fahrenheit, Celsius>::ratio, std::ratio<5, 9>>::value, "");
+static_assert(std::is_same<Conversion<Fahrenheit, Celsius>::shift, std::ratio<32>>::value, "");
+static_assert(std::is_same<Conversion<Fahrenheit, Celsius>::offset, std::ratio<0>>::value, "");
+static_assert(Conversion<Celsius, Fahrenheit>::multiplier == 1.8, "");
+static_assert(Conversion<Celsius, Fahrenheit>::addend == 32.0, "");
+static_assert(convert<Fahrenheit, Celsius>(212.0) == 100.0, "");
+static_assert(convert<Celsius, Fahrenheit>(-40.0) == -40.0, "");
+static_assert(convert<Celsius, Fahrenheit>(0.0) == 32.0, "");
+static_assert(convert<Celsius, Fahrenheit>(100.0) == 212.0, "");
+static_assert(convert<Fahrenheit, Celsius>(32.0) == 0.0, "");
+static_assert(convert<Fahrenheit, Kelvin>(32.0) == 273.15, "");
+static_assert(convert<Kelvin, Fahrenheit>(273.15) == 32.0, "");
+static_assert(convert<Degrees, Turns>(90.0) == 0.25, "");
+static_assert(convert<Octaves, Cents>(1.0) == 1200.0, "");
+static_assert(convert_difference<Celsius, Fahrenheit>(10.0) == 18.0, "");
+
+TEST(QuantityTests, Basic) {
+    constexpr Quantity<Celsius> body(37.0);
+    constexpr Quantity<Fahrenheit> body_f = body;
+    EXPECT_NEAR(body_f.value(), 98.6, 1e-12);
+    EXPECT_NEAR(body.in<Kelvin>(), 310.15, 1e-12);
+    EXPECT_NEAR(quantity_cast<Rankine>(body).value(), 558.27, 1e-12);
+    EXPECT_TRUE(Quantity<Celsius>(100.0) > Quantity<Fahrenheit>(211.0));
+    EXPECT_TRUE(Quantity<Kelvin>(0.0) < Quantity<Celsius>(-273.0));
+    EXPECT_EQ(Quantity<Celsius>(-40.0), Quantity<Fahrenheit>(-40.0));
+
+    constexpr auto turn = Quantity<Degrees>(270.0) + Quantity<Turns>(0.25);
+    static_assert(turn.value() == 360.0, "");
+    EXPECT_NEAR(Quantity<Radians>(turn).value(), 2.0 * M_PI, 1e-15);
+    EXPECT_EQ((Quantity<Gradians>(100.0) - Quantity<Degrees>(45.0)).value(), 50.0);
+    EXPECT_EQ((2.0 * Quantity<Cents>(50.0)).value(), 100.0);
+    EXPECT_EQ((Quantity<Octaves>(1.0) / 4.0).in<Semitones>(), 3.0);
+    EXPECT_EQ(Quantity<Kilohertz>(1.0) / Quantity<Hertz>(250.0), 4.0);
+    EXPECT_EQ(Quantity<PerMinute>(120.0).in<Hertz>(), 2.0);
+    EXPECT_EQ((-Quantity<Semitones>(3.0)).value(), -3.0);
+
+    // -0 stays -0 through conversions that have no offset.
+    EXPECT_TRUE(std::signbit(convert<Semitones, Cents>(-0.0)));
+}
+
+TEST(QuantityTests, Classes) {
+    EXPECT_TRUE(Temperature::from_quantity(Quantity<Fahrenheit>(212.0))
+                    .almost_equal(Temperature::boiling()));
+    EXPECT_NEAR(Temperature::body_temp().as<Fahrenheit>().value(), 98.6, 1e-12);
+    EXPECT_EQ(Temperature::freezing().as<Celsius>(), Quantity<Celsius>(0.0));
+    // The reference points come out exactly, even by way of Kelvin.
+    EXPECT_EQ(Temperature::from_celsius(0.0).fahrenheit(), 32.0);
+    EXPECT_EQ(Temperature::from_celsius(100.0).fahrenheit(), 212.0);
+    EXPECT_EQ(Temperature::from_fahrenheit(32.0).celsius(), 0.0);
+    EXPECT_EQ(Temperature::from_fahrenheit(212.0).celsius(), 100.0);
+
+    EXPECT_TRUE(Angle::from_quantity(Quantity<Turns>(1.25))
+                    .almost_equal(Angle::from_degrees(90.0), 1e-15));
+    EXPECT_EQ(Angle::from_quantity(Quantity<Degrees>(1e9)).degrees(),
+              Angle::from_degrees(1e9).degrees());
+    EXPECT_NEAR(Angle::from_radians(M_PI).as<Gradians>().value(), 200.0, 1e-12);
+}
+
+}  // namespace djehuti
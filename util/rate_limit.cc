@@ -0,0 +1,88 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/rate_limit.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace djehuti {
+
+namespace {
+
+int64_t interval_for(double rate) {
+    return rate > 0.0 ? std::max<int64_t>(1, std::llround(1e9 / rate)) : 0;
+}
+
+int64_t tolerance_for(double rate, double burst) {
+    return rate > 0.0 ? std::llround(std::max(0.0, burst - 1.0) * 1e9 / rate) : 0;
+}
+
+}  // namespace
+
+TokenBucket::TokenBucket(double rate, double burst)
+    : interval_(interval_for(rate)), tolerance_(tolerance_for(rate, burst)) {}
+
+bool TokenBucket::take(std::atomic<int64_t> *full_at,
+                       int64_t interval,
+                       int64_t tolerance,
+                       Clock::time_point now) {
+    const int64_t t =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    int64_t expected = full_at->load(std::memory_order_relaxed);
+    for (;;) {
+        // A bucket that filled up in the past is just full; it doesn't save up more.
+        const int64_t from = std::max(expected, t);
+        if (from - t > tolerance) {
+            return false;
+        }
+        if (full_at->compare_exchange_weak(expected, from + interval,
+                                           std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+KeyedTokenBuckets::KeyedTokenBuckets(Options options)
+    : interval_(interval_for(options.rate)),
+      tolerance_(tolerance_for(options.rate, options.burst)),
+      mask_([&options] {
+          size_t slots = 1u;
+          while (slots < options.num_slots) {
+              slots <<= 1;
+          }
+          return slots - 1u;
+      }()),
+      full_at_(new std::atomic<int64_t>[mask_ + 1u]) {
+    for (size_t i = 0u; i <= mask_; ++i) {
+        full_at_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool KeyedTokenBuckets::try_take(std::string_view key, Clock::time_point now) {
+    if (interval_ == 0) {
+        return true;
+    }
+    const size_t slot = std::hash<std::string_view>()(key) & mask_;
+    return TokenBucket::take(&full_at_[slot], interval_, tolerance_, now);
+}
+
+}  // namespace djehuti
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace djehuti {
+
+/**
+ * A TokenBucket lets through rate requests a second on average, and bursts of up to burst at
+ * once. Rather than a count of tokens refilled over time it keeps a single number, the time at
+ * which the bucket will next be full (the "theoretical arrival time" of the generic cell rate
+ * algorithm, which behaves exactly like a token bucket), so that taking a token is one
+ * compare-and-swap and any number of threads can share a bucket without a lock.
+ */
+class TokenBucket final {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    /// A bucket with a rate of 0 (or less) lets everything through.
+    TokenBucket(double rate, double burst);
+
+    TokenBucket(const TokenBucket &) = delete;
+    TokenBucket &operator=(const TokenBucket &) = delete;
+
+    /// Takes a token if there is one, and returns whether there was.
+    bool try_take(Clock::time_point now = Clock::now()) {
+        return interval_ == 0 || take(&full_at_, interval_, tolerance_, now);
+    }
+
+ private:
+    friend class KeyedTokenBuckets;
+
+    // The GCRA step: takes a token from the bucket that'll be full at *full_at, if it has one.
+    static bool take(std::atomic<int64_t> *full_at,
+                     int64_t interval,
+                     int64_t tolerance,
+                     Clock::time_point now);
+
+    const int64_t interval_;   // Nanoseconds per token, or 0 if there's no limit.
+    const int64_t tolerance_;  // How far ahead of now full_at_ may get: burst - 1 tokens' worth.
+    std::atomic<int64_t> full_at_{0};
+};
+
+/**
+ * KeyedTokenBuckets keeps a TokenBucket per key (a client's address, say), all with the same
+ * rate and burst, without a lock or any allocation after it's made: keys are hashed into a fixed
+ * table of buckets. Keys that land in the same slot share a bucket, which can only make their
+ * limit stricter, so the table should be a good deal bigger than the number of keys expected to
+ * be busy at once.
+ */
+class KeyedTokenBuckets final {
+ public:
+    using Clock = TokenBucket::Clock;
+
+    struct Options {
+        /// The rate (per second) and burst allowed each key. A rate of 0 lets everything through.
+        double rate = 0.0;
+        double burst = 1.0;
+        /// The number of buckets, rounded up to a power of two.
+        size_t num_slots = 4096u;
+    };
+
+    KeyedTokenBuckets() : KeyedTokenBuckets(Options()) {}
+    explicit KeyedTokenBuckets(Options options);
+
+    KeyedTokenBuckets(const KeyedTokenBuckets &) = delete;
+    KeyedTokenBuckets &operator=(const KeyedTokenBuckets &) = delete;
+
+    /// Takes a token from the key's bucket if there is one, and returns whether there was.
+    bool try_take(std::string_view key, Clock::time_point now = Clock::now());
+
+    size_t num_slots() const { return mask_ + 1u; }
+
+ private:
+    const int64_t interval_;
+    const int64_t tolerance_;
+    const size_t mask_;
+    std::unique_ptr<std::atomic<int64_t>[]> full_at_;
+};
+
+}  // namespace djehuti
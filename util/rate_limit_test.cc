@@ -0,0 +1,110 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/rate_limit.hh"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+const TokenBucket::Clock::time_point START = TokenBucket::Clock::time_point() + 1h;
+
+}  // namespace
+
+TEST(TokenBucketTest, RateAndBurst) {
+    TokenBucket bucket(100.0, 5.0);  // One token every 10 ms.
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(bucket.try_take(START)) << i;
+    }
+    EXPECT_FALSE(bucket.try_take(START));
+    EXPECT_FALSE(bucket.try_take(START + 9ms));
+    EXPECT_TRUE(bucket.try_take(START + 10ms));
+    EXPECT_FALSE(bucket.try_take(START + 10ms));
+
+    // A long pause fills it up again, but no further than the burst.
+    const auto later = START + 10s;
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(bucket.try_take(later)) << i;
+    }
+    EXPECT_FALSE(bucket.try_take(later));
+
+    // Once it's empty, it lets through exactly the rate.
+    int taken = 0;
+    for (auto t = later + 10ms; t < later + 1010ms; t += 1ms) {
+        taken += bucket.try_take(t) ? 1 : 0;
+    }
+    EXPECT_EQ(taken, 100);
+
+    TokenBucket unlimited(0.0, 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(unlimited.try_take(START));
+    }
+}
+
+TEST(TokenBucketTest, Threads) {
+    // Threads racing for the tokens get exactly the burst between them.
+    TokenBucket bucket(1.0, 1000.0);
+    std::atomic<int> taken{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&bucket, &taken] {
+            for (int j = 0; j < 1000; ++j) {
+                taken += bucket.try_take(START) ? 1 : 0;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(taken.load(), 1000);
+}
+
+TEST(KeyedTokenBucketsTest, PerKey) {
+    KeyedTokenBuckets::Options options;
+    options.rate = 10.0;
+    options.burst = 2.0;
+    options.num_slots = 1000u;
+    KeyedTokenBuckets buckets(options);
+    EXPECT_EQ(buckets.num_slots(), 1024u);
+
+    EXPECT_TRUE(buckets.try_take("10.0.0.1", START));
+    EXPECT_TRUE(buckets.try_take("10.0.0.1", START));
+    EXPECT_FALSE(buckets.try_take("10.0.0.1", START));
+    // Another key has its own bucket (unless it shares a slot, which these don't).
+    EXPECT_TRUE(buckets.try_take("10.0.0.2", START));
+    EXPECT_TRUE(buckets.try_take("10.0.0.1", START + 100ms));
+
+    KeyedTokenBuckets unlimited;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(unlimited.try_take("x", START));
+    }
+}
+
+}  // namespace djehuti
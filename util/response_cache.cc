@@ -0,0 +1,209 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/response_cache.hh"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace djehuti {
+
+namespace {
+
+// What a cached response costs beyond its key and bodies: the node, its map entry and the
+// Response itself, roughly.
+constexpr size_t OVERHEAD_BYTES = 256u;
+
+size_t cost(const std::string &key, const ResponseCache::Response &response) {
+    return key.size() + response.content_type.size() + response.body.size() +
+           response.gzipped.size() + OVERHEAD_BYTES;
+}
+
+}  // namespace
+
+ResponseCache::ResponseCache(Options options)
+    : options_(options),
+      shard_bytes_(options.max_bytes / std::max<size_t>(1u, options.num_shards)),
+      shards_(std::max<size_t>(1u, options.num_shards)) {}
+
+std::string ResponseCache::make_key(std::string_view method,
+                                    std::string_view resource,
+                                    std::string_view query,
+                                    std::string_view body) {
+    const uint64_t lengths[] = {query.size(), body.size()};
+    std::string key;
+    key.reserve(sizeof(lengths) + method.size() + resource.size() + query.size() + body.size() +
+                2u);
+    key.append(reinterpret_cast<const char *>(lengths), sizeof(lengths));
+    key.append(method).append(1u, ' ').append(resource).append(1u, '?').append(query).append(body);
+    return key;
+}
+
+bool ResponseCache::cacheable(std::string_view method,
+                              std::string_view resource,
+                              std::string_view query,
+                              std::string_view body) const {
+    return 2u * sizeof(uint64_t) + method.size() + resource.size() + query.size() + body.size() +
+               2u <=
+           options_.max_key_bytes;
+}
+
+ResponseCache::Shard &ResponseCache::shard_for(std::string_view key) {
+    return shards_[std::hash<std::string_view>()(key) % shards_.size()];
+}
+
+void ResponseCache::Shard::erase(std::list<Node>::iterator it) {
+    index.erase(it->key);
+    stats.bytes -= it->bytes;
+    --stats.entries;
+    lru.erase(it);
+}
+
+std::shared_ptr<const ResponseCache::Response> ResponseCache::find(std::string_view key,
+                                                                   Clock::time_point now) {
+    Shard &shard = shard_for(key);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    const auto found = shard.index.find(key);
+    if (found == shard.index.end()) {
+        ++shard.stats.misses;
+        return nullptr;
+    }
+    const auto it = found->second;
+    if (it->expires <= now) {
+        shard.erase(it);
+        ++shard.stats.expirations;
+        ++shard.stats.misses;
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it);
+    ++shard.stats.hits;
+    if (!it->gzip_pending) {
+        return it->response;
+    }
+    it->gzip_pending = false;  // Whoever finds it first gzips it; the rest needn't wait.
+    std::shared_ptr<const Response> response = it->response;
+    lock.unlock();
+    return gzip_found(&shard, key, std::move(response));
+}
+
+std::shared_ptr<const ResponseCache::Response> ResponseCache::gzip_found(
+    Shard *shard, std::string_view key, std::shared_ptr<const Response> response) {
+    std::string gzipped = gzip(response->body);
+    if (gzipped.empty() || gzipped.size() >= response->body.size()) {
+        return response;
+    }
+    auto with_gzip = std::make_shared<Response>(*response);
+    with_gzip->gzipped = std::move(gzipped);
+    const size_t more_bytes = with_gzip->gzipped.size();
+
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    const auto found = shard->index.find(key);
+    if (found == shard->index.end() || found->second->response != response ||
+        found->second->bytes + more_bytes > shard_bytes_) {
+        return with_gzip;  // It's gone or been replaced since, or it would no longer fit.
+    }
+    const auto it = found->second;
+    it->response = with_gzip;
+    it->bytes += more_bytes;
+    shard->stats.bytes += more_bytes;
+    while (shard->stats.bytes > shard_bytes_) {
+        shard->erase(std::prev(shard->lru.end()));
+        ++shard->stats.evictions;
+    }
+    return with_gzip;
+}
+
+std::shared_ptr<const ResponseCache::Response> ResponseCache::insert(std::string key,
+                                                                     Response response,
+                                                                     Clock::time_point now) {
+    const bool gzip_pending = options_.gzip && response.gzipped.empty() &&
+                              response.body.size() >= options_.min_gzip_bytes;
+    const size_t bytes = cost(key, response);
+    auto cached = std::make_shared<const Response>(std::move(response));
+
+    Shard &shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        shard.erase(found->second);
+    }
+    if (bytes > shard_bytes_ || key.size() > options_.max_key_bytes) {
+        return cached;
+    }
+    while (shard.stats.bytes + bytes > shard_bytes_) {
+        shard.erase(std::prev(shard.lru.end()));
+        ++shard.stats.evictions;
+    }
+    shard.lru.push_front(Node{std::move(key), cached, now + options_.ttl, bytes, gzip_pending});
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    shard.stats.bytes += bytes;
+    ++shard.stats.entries;
+    ++shard.stats.insertions;
+    return cached;
+}
+
+void ResponseCache::clear() {
+    for (Shard &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.lru.clear();
+        shard.stats.entries = 0u;
+        shard.stats.bytes = 0u;
+    }
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+    Stats total;
+    for (const Shard &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total.hits += shard.stats.hits;
+        total.misses += shard.stats.misses;
+        total.insertions += shard.stats.insertions;
+        total.evictions += shard.stats.evictions;
+        total.expirations += shard.stats.expirations;
+        total.entries += shard.stats.entries;
+        total.bytes += shard.stats.bytes;
+    }
+    return total;
+}
+
+std::string ResponseCache::gzip(std::string_view data) {
+    z_stream stream{};
+    // 16 more window bits asks for a gzip header and trailer rather than zlib's.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::string();
+    }
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    const int result = deflate(&stream, Z_FINISH);
+    out.resize(result == Z_STREAM_END ? stream.total_out : 0u);
+    deflateEnd(&stream);
+    return out;
+}
+
+}  // namespace djehuti
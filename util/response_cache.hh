@@ -0,0 +1,166 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace djehuti {
+
+/**
+ * A ResponseCache keeps rendered responses in memory, so that a server can answer a repeated
+ * request without working it out again. Responses are looked up by a key made from the request
+ * (see make_key()), live for at most a TTL, and are evicted least recently used first once the
+ * cache holds max_bytes. The cache is split into shards by key, each with its own lock and its
+ * own share of the bytes, so that threads looking up different keys seldom wait for each other.
+ *
+ * A cached response can come with a gzipped copy, so that hits from clients that accept gzip are
+ * served without compressing anything either. It's made the first time the response is found
+ * rather than when it's inserted, so a miss costs no more than rendering, and only responses
+ * that are asked for again get compressed.
+ */
+class ResponseCache final {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        /// The most the cache holds, counting keys and bodies (and a little for bookkeeping).
+        size_t max_bytes = size_t{64} << 20;
+        /// How long a response is served from the cache after it's inserted.
+        std::chrono::milliseconds ttl{60000};
+        /// The number of shards, each with max_bytes / num_shards of the bytes.
+        size_t num_shards = 16u;
+        /// Whether to keep a gzipped copy of each response at least min_gzip_bytes long (that
+        /// compresses to something smaller).
+        bool gzip = false;
+        size_t min_gzip_bytes = 256u;
+        /// Requests with longer keys (see make_key()) aren't cached: copying a big body into a
+        /// key, and comparing it on every lookup, would cost more than the cache saves.
+        size_t max_key_bytes = size_t{16} << 10;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string content_type;
+        std::string body;
+        /// The body gzipped, or empty if there's no compressed copy.
+        std::string gzipped;
+    };
+
+    struct Stats {
+        uint64_t hits = 0u;
+        uint64_t misses = 0u;
+        uint64_t insertions = 0u;
+        uint64_t evictions = 0u;
+        uint64_t expirations = 0u;
+        size_t entries = 0u;
+        size_t bytes = 0u;
+    };
+
+    ResponseCache() : ResponseCache(Options()) {}
+    explicit ResponseCache(Options options);
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    /**
+     * Returns the key for a request: its method, resource, query and body, with the lengths of
+     * the query and body so that no two requests share one. The whole body is kept (rather than a
+     * hash of it, which a client could find collisions for to be served another's response); it
+     * counts against max_bytes with the rest of the key, and cacheable() says whether it's short
+     * enough to be worth making.
+     */
+    static std::string make_key(std::string_view method,
+                                std::string_view resource,
+                                std::string_view query,
+                                std::string_view body);
+
+    /// Returns whether the request's key would be no longer than max_key_bytes, without making it.
+    bool cacheable(std::string_view method,
+                   std::string_view resource,
+                   std::string_view query,
+                   std::string_view body) const;
+
+    /**
+     * Returns the response cached under the key, or null if there isn't one that's still good.
+     * The first time a response is found, its gzipped copy is made (outside the lock) if the
+     * options ask for one, and it's returned with it.
+     */
+    std::shared_ptr<const Response> find(std::string_view key,
+                                         Clock::time_point now = Clock::now());
+
+    /**
+     * Caches the response under the key (replacing whatever was there), and returns what was
+     * cached. A response too big for its shard, or with a key longer than max_key_bytes, is
+     * returned but not kept.
+     */
+    std::shared_ptr<const Response> insert(std::string key,
+                                           Response response,
+                                           Clock::time_point now = Clock::now());
+
+    /// Forget everything.
+    void clear();
+
+    /// Returns the counts so far, summed across the shards.
+    Stats stats() const;
+
+    /// Returns the data gzipped (with the default compression level), as a whole gzip file.
+    static std::string gzip(std::string_view data);
+
+ private:
+    struct Node {
+        std::string key;
+        std::shared_ptr<const Response> response;
+        Clock::time_point expires;
+        size_t bytes;
+        bool gzip_pending;  // The response is to be gzipped when it's next found.
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru;  // Most recently used first.
+        std::unordered_map<std::string_view, std::list<Node>::iterator> index;  // Into lru.
+        Stats stats;
+
+        void erase(std::list<Node>::iterator it);
+    };
+
+    Shard &shard_for(std::string_view key);
+    // Gzips a response just found under the key, and puts the result in its place if it's still
+    // there. Returns the response, gzipped copy and all if that helped.
+    std::shared_ptr<const Response> gzip_found(Shard *shard,
+                                               std::string_view key,
+                                               std::shared_ptr<const Response> response);
+
+    const Options options_;
+    const size_t shard_bytes_;
+    std::vector<Shard> shards_;
+};
+
+}  // namespace djehuti
@@ -0,0 +1,77 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/response_cache.hh"
+#include "util/string_builder.hh"
+#include "util/unit_conversion.hh"
+
+// Answering a repeated /convert request for 1,000 temperatures: rendering the response each
+// time (and gzipping it, for clients that take gzip), against looking it up in a ResponseCache
+// that already has it, gzipped copy and all.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 1000u;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-50.0, 150.0);
+    std::string body;
+    for (size_t i = 0u; i < COUNT; ++i) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.2f\n", dist(gen));
+        body += number;
+    }
+    const auto conversion = *units::RuntimeConversion::find("temperature", "celsius", "fahrenheit");
+    std::vector<double> values;
+    string::StringBuilder out;
+    const auto render = [&] {
+        out.clear();
+        units::convert_list(conversion, body, &values, &out);
+        ResponseCache::Response response;
+        response.content_type = "text/plain";
+        response.body = out.str();
+        return response;
+    };
+
+    benchmark::run("uncached", [&] { benchmark::do_not_optimize(render().body); }, 1u);
+    benchmark::run("uncached, gzipped", [&] {
+        benchmark::do_not_optimize(ResponseCache::gzip(render().body));
+    }, 1u);
+
+    ResponseCache::Options options;
+    options.gzip = true;
+    ResponseCache cache(options);
+    const auto key = [&] {
+        return ResponseCache::make_key("POST", "/convert/temperature", "from=celsius&to=fahrenheit",
+                                       body);
+    };
+    cache.insert(key(), render());
+    cache.find(key());  // Which makes the gzipped copy.
+    benchmark::run("cached", [&] { benchmark::do_not_optimize(cache.find(key())->body); }, 1u);
+    benchmark::run("cached, gzipped", [&] {
+        benchmark::do_not_optimize(cache.find(key())->gzipped);
+    }, 1u);
+    return 0;
+}
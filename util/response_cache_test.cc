@@ -0,0 +1,209 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/response_cache.hh"
+
+#include <zlib.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+namespace {
+
+ResponseCache::Response text(std::string body) {
+    ResponseCache::Response response;
+    response.content_type = "text/plain";
+    response.body = std::move(body);
+    return response;
+}
+
+std::string gunzip(const std::string &data) {
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+    std::string out(1u << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return out;
+}
+
+}  // namespace
+
+TEST(ResponseCacheTest, Keys) {
+    const std::string a = ResponseCache::make_key("GET", "/convert/length", "from=m&to=ft", "");
+    EXPECT_EQ(a, ResponseCache::make_key("GET", "/convert/length", "from=m&to=ft", ""));
+    EXPECT_NE(a, ResponseCache::make_key("POST", "/convert/length", "from=m&to=ft", ""));
+    EXPECT_NE(a, ResponseCache::make_key("GET", "/convert/length", "from=ft&to=m", ""));
+    EXPECT_NE(a, ResponseCache::make_key("GET", "/convert/length", "from=m&to=ft", "1"));
+    // The resource and query can't run into each other.
+    EXPECT_NE(ResponseCache::make_key("GET", "/a?b", "", ""),
+              ResponseCache::make_key("GET", "/a", "b", ""));
+    EXPECT_NE(ResponseCache::make_key("GET", "/a?b", "c", ""),
+              ResponseCache::make_key("GET", "/a", "b?c", ""));
+    // Nor can the query and body, and bodies are told apart byte for byte.
+    EXPECT_NE(ResponseCache::make_key("POST", "/a", "b", "c"),
+              ResponseCache::make_key("POST", "/a", "bc", ""));
+    EXPECT_NE(ResponseCache::make_key("POST", "/a", "", std::string(1000u, 'x') + "y"),
+              ResponseCache::make_key("POST", "/a", "", std::string(1000u, 'x') + "z"));
+}
+
+TEST(ResponseCacheTest, HitsAndMisses) {
+    ResponseCache cache;
+    const auto now = ResponseCache::Clock::now();
+    EXPECT_EQ(cache.find("k", now), nullptr);
+    cache.insert("k", text("hello"), now);
+    const auto found = cache.find("k", now);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->body, "hello");
+    EXPECT_EQ(found->status, 200);
+    EXPECT_TRUE(found->gzipped.empty());
+
+    cache.insert("k", text("goodbye"), now);
+    EXPECT_EQ(cache.find("k", now)->body, "goodbye");
+    EXPECT_EQ(found->body, "hello");  // What was found stays good.
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.insertions, 2u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, 7u);
+
+    cache.clear();
+    EXPECT_EQ(cache.find("k", now), nullptr);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+TEST(ResponseCacheTest, Expires) {
+    ResponseCache::Options options;
+    options.ttl = std::chrono::seconds(10);
+    ResponseCache cache(options);
+    const auto now = ResponseCache::Clock::now();
+    cache.insert("k", text("hello"), now);
+    EXPECT_NE(cache.find("k", now + std::chrono::seconds(9)), nullptr);
+    EXPECT_EQ(cache.find("k", now + std::chrono::seconds(10)), nullptr);
+    EXPECT_EQ(cache.find("k", now), nullptr);  // It's gone, not just hidden.
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.expirations, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsed) {
+    ResponseCache::Options options;
+    options.num_shards = 1u;
+    options.max_bytes = 3u * (1000u + 300u);
+    ResponseCache cache(options);
+    const auto now = ResponseCache::Clock::now();
+    for (const char *key : {"a", "b", "c"}) {
+        cache.insert(key, text(std::string(1000u, 'x')), now);
+    }
+    EXPECT_NE(cache.find("a", now), nullptr);  // Now b is the least recently used.
+    cache.insert("d", text(std::string(1000u, 'x')), now);
+    EXPECT_NE(cache.find("a", now), nullptr);
+    EXPECT_EQ(cache.find("b", now), nullptr);
+    EXPECT_NE(cache.find("c", now), nullptr);
+    EXPECT_NE(cache.find("d", now), nullptr);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_LE(cache.stats().bytes, options.max_bytes);
+
+    // Too big to keep, but still handed back.
+    const auto big = cache.insert("e", text(std::string(10000u, 'x')), now);
+    EXPECT_EQ(big->body.size(), 10000u);
+    EXPECT_EQ(cache.find("e", now), nullptr);
+    EXPECT_EQ(cache.stats().entries, 3u);
+}
+
+TEST(ResponseCacheTest, Gzip) {
+    ResponseCache::Options options;
+    options.gzip = true;
+    options.min_gzip_bytes = 100u;
+    ResponseCache cache(options);
+    std::string body;
+    for (int i = 0; i < 1000; ++i) {
+        body += std::to_string(i) + "\n";
+    }
+    // Nothing's gzipped until it's found, so a miss costs no more than it would anyway.
+    EXPECT_TRUE(cache.insert("k", text(body))->gzipped.empty());
+    const size_t bytes = cache.stats().bytes;
+    const auto cached = cache.find("k");
+    ASSERT_FALSE(cached->gzipped.empty());
+    EXPECT_LT(cached->gzipped.size(), body.size());
+    EXPECT_EQ(gunzip(cached->gzipped), body);
+    EXPECT_EQ(cache.stats().bytes, bytes + cached->gzipped.size());
+    EXPECT_EQ(cache.find("k"), cached);  // It's only gzipped once.
+
+    cache.insert("short", text("too short to bother"));
+    EXPECT_TRUE(cache.find("short")->gzipped.empty());
+    EXPECT_EQ(gunzip(ResponseCache::gzip("")), "");
+}
+
+TEST(ResponseCacheTest, LongKeys) {
+    ResponseCache::Options options;
+    options.max_key_bytes = 100u;
+    ResponseCache cache(options);
+    const std::string body(73u, 'x');  // For a key of exactly 100 bytes, with its two lengths.
+    EXPECT_TRUE(cache.cacheable("POST", "/a", "b=c", body));
+    EXPECT_EQ(ResponseCache::make_key("POST", "/a", "b=c", body).size(), 100u);
+    EXPECT_FALSE(cache.cacheable("POST", "/a", "b=cd", body));
+
+    // One that's inserted anyway is handed back, but not kept.
+    const std::string key = ResponseCache::make_key("POST", "/a", "b=cd", body);
+    EXPECT_EQ(cache.insert(key, text("hello"))->body, "hello");
+    EXPECT_EQ(cache.find(key), nullptr);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(ResponseCacheTest, Threads) {
+    ResponseCache::Options options;
+    options.max_bytes = 1u << 16;
+    ResponseCache cache(options);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 10000; ++i) {
+                const std::string key = std::to_string((i * 7 + t) % 500);
+                const auto found = cache.find(key);
+                if (found == nullptr) {
+                    cache.insert(key, text(key));
+                } else {
+                    EXPECT_EQ(found->body, key);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 40000u);
+    EXPECT_LE(stats.bytes, options.max_bytes);
+}
+
+}  // namespace djehuti
@@ -0,0 +1,106 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/server_threads.hh"
+
+#include <cerrno>
+#include <future>
+#include <utility>
+
+#include "util/affinity.hh"
+#include "util/socket.hh"
+
+namespace djehuti {
+
+ServerThreads::~ServerThreads() { stop(); }
+
+bool ServerThreads::start(const Options &options, const MakeLoop &make_loop) {
+    const size_t num_threads = options.num_threads != 0u
+                                   ? options.num_threads
+                                   : std::max(1u, std::thread::hardware_concurrency());
+    const std::vector<int> cpus = options.pin_threads ? allowed_cpus() : std::vector<int>();
+    if (options.pin_threads && cpus.empty()) {
+        return false;  // We can't tell where we may run, so we can't pin anything.
+    }
+    // The first socket picks the port, if we're to pick one, and the rest share it.
+    port_ = options.port;
+    for (size_t i = 0u; i < num_threads; ++i) {
+        const int fd = listen_tcp(options.address, port_);
+        if (fd < 0) {
+            loops_.clear();
+            return false;
+        }
+        if (port_ == 0u) {
+            port_ = local_port(fd);
+        }
+        loops_.push_back(make_loop(fd));
+    }
+
+    // Each loop is set up on its own thread, which is the only one that uses it.
+    std::vector<std::future<int>> ready;
+    for (size_t i = 0u; i < num_threads; ++i) {
+        std::promise<int> promise;
+        ready.push_back(promise.get_future());
+        ServerLoop *loop = loops_[i].get();
+        const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        threads_.emplace_back([loop, cpu](std::promise<int> promise) {
+            if (cpu >= 0 && !pin_current_thread(cpu)) {
+                promise.set_value(errno);
+                return;
+            }
+            if (!loop->init()) {
+                promise.set_value(errno);
+                return;
+            }
+            promise.set_value(0);
+            loop->run();
+        }, std::move(promise));
+    }
+    int error = 0;
+    for (auto &result : ready) {
+        error = std::max(error, result.get());
+    }
+    if (error != 0) {
+        stop();
+        threads_.clear();
+        loops_.clear();
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void ServerThreads::wait() {
+    std::lock_guard<std::mutex> lock(join_mutex_);
+    for (std::thread &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void ServerThreads::stop() {
+    for (auto &loop : loops_) {
+        loop->wake();
+    }
+    wait();
+}
+
+}  // namespace djehuti
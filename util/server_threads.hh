@@ -0,0 +1,117 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace djehuti {
+
+/// An event loop that serves one listening socket, on a thread of its own.
+class ServerLoop {
+ public:
+    virtual ~ServerLoop() = default;
+
+    /// Gets ready to serve, on the loop's own thread. Returns false (with errno set) if it can't.
+    virtual bool init() = 0;
+    /// Serves until woken.
+    virtual void run() = 0;
+    /// Tells run() to stop; safe from any thread.
+    virtual void wake() = 0;
+};
+
+/**
+ * ServerThreads is what a server with a ServerLoop per thread (like UringHttpServer and
+ * BinaryServer) needs around its loops: a listening socket for each, all on one port (with
+ * SO_REUSEPORT, so that the kernel spreads connections over them), the threads that run them,
+ * each pinned to a CPU of its own if asked, and a way to stop them and wait for them.
+ */
+class ServerThreads final {
+ public:
+    struct Options {
+        /// The address to listen on ("*" or "0.0.0.0" for any), and the port (0 to pick one).
+        std::string address;
+        uint16_t port = 0u;
+        /// The number of threads, or 0 for one per hardware thread.
+        size_t num_threads = 0u;
+        /// Whether to pin each thread to a CPU of its own (as far as they go).
+        bool pin_threads = false;
+    };
+
+    /// Makes the loop that serves a listening socket, which it takes.
+    using MakeLoop = std::function<std::unique_ptr<ServerLoop>(int listen_fd)>;
+
+    ServerThreads() = default;
+    ServerThreads(const ServerThreads &) = delete;
+    ServerThreads &operator=(const ServerThreads &) = delete;
+    /// Stops the threads if they're running.
+    ~ServerThreads();
+
+    /**
+     * Opens the sockets, makes a loop for each, and starts the threads, returning once every
+     * loop has init()ed. Returns false (with errno set) if we're to pin the threads but can't
+     * tell which CPUs we may use, if a socket can't be opened, or if a thread can't be pinned or
+     * its loop can't init(), having stopped any threads it started.
+     */
+    bool start(const Options &options, const MakeLoop &make_loop);
+    /// Returns the port we're listening on, once we've started.
+    uint16_t port() const { return port_; }
+    /// Returns the loops, once we've started, for the server to sum their stats.
+    const std::vector<std::unique_ptr<ServerLoop>> &loops() const { return loops_; }
+    /// Waits until the threads are stopped (from another thread).
+    void wait();
+    /// Wakes every loop, and waits for the threads to finish.
+    void stop();
+
+ private:
+    uint16_t port_ = 0u;
+    std::vector<std::unique_ptr<ServerLoop>> loops_;
+    std::mutex join_mutex_;
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * Hands what a connection has just sent to serve, which answers every whole request at the start
+ * of what it's given and returns how many bytes of it they took. input is what was left of a
+ * partial request last time: if there's none, data is served where it is, and only what's left
+ * of it is kept.
+ */
+template <typename Serve>
+void serve_input(std::string *input, std::string_view data, Serve &&serve) {
+    if (input->empty()) {
+        const size_t used = serve(data);
+        input->assign(data.substr(std::min(used, data.size())));
+    } else {
+        input->append(data);
+        const size_t used = serve(std::string_view(*input));
+        input->erase(0u, used);
+    }
+}
+
+}  // namespace djehuti
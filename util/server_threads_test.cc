@@ -0,0 +1,157 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/server_threads.hh"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/socket.hh"
+
+namespace djehuti {
+
+namespace {
+
+// What the test loops did, between them.
+struct Record {
+    std::mutex mutex;
+    std::condition_variable woken;
+    bool awake = false;
+    std::vector<std::thread::id> init_threads;
+    std::atomic<int> runs_done{0};
+    std::atomic<int> destroyed{0};
+};
+
+class TestLoop final : public ServerLoop {
+ public:
+    TestLoop(int listen_fd, bool fail, Record *record)
+        : listen_fd_(listen_fd), fail_(fail), record_(record) {}
+    ~TestLoop() override {
+        ::close(listen_fd_);
+        ++record_->destroyed;
+    }
+
+    bool init() override {
+        std::lock_guard<std::mutex> lock(record_->mutex);
+        record_->init_threads.push_back(std::this_thread::get_id());
+        if (fail_) {
+            errno = EADDRNOTAVAIL;
+            return false;
+        }
+        return true;
+    }
+
+    void run() override {
+        std::unique_lock<std::mutex> lock(record_->mutex);
+        record_->woken.wait(lock, [this] { return record_->awake; });
+        ++record_->runs_done;
+    }
+
+    void wake() override {
+        std::lock_guard<std::mutex> lock(record_->mutex);
+        record_->awake = true;
+        record_->woken.notify_all();
+    }
+
+ private:
+    const int listen_fd_;
+    const bool fail_;
+    Record *record_;
+};
+
+}  // namespace
+
+TEST(ServerThreadsTest, StartAndStop) {
+    Record record;
+    ServerThreads threads;
+    ASSERT_TRUE(threads.start({"127.0.0.1", 0u, 3u, false}, [&record](int listen_fd) {
+        return std::make_unique<TestLoop>(listen_fd, false, &record);
+    }));
+    EXPECT_NE(threads.port(), 0u);
+    EXPECT_EQ(threads.loops().size(), 3u);
+    {
+        std::lock_guard<std::mutex> lock(record.mutex);
+        ASSERT_EQ(record.init_threads.size(), 3u);
+        for (const std::thread::id &id : record.init_threads) {
+            EXPECT_NE(id, std::this_thread::get_id());  // Each loop init()s on its own thread.
+        }
+    }
+    const int client = connect_tcp("127.0.0.1", threads.port());
+    EXPECT_GE(client, 0);
+    ::close(client);
+
+    threads.stop();
+    EXPECT_EQ(record.runs_done.load(), 3);
+    threads.stop();  // Again is harmless.
+}
+
+TEST(ServerThreadsTest, InitFails) {
+    Record record;
+    int made = 0;
+    ServerThreads threads;
+    EXPECT_FALSE(threads.start({"127.0.0.1", 0u, 3u, false}, [&](int listen_fd) {
+        return std::make_unique<TestLoop>(listen_fd, ++made == 2, &record);
+    }));
+    EXPECT_EQ(errno, EADDRNOTAVAIL);
+    // The loops that did start have been stopped, and all of them let go.
+    EXPECT_EQ(record.runs_done.load(), 2);
+    EXPECT_EQ(record.destroyed.load(), 3);
+    EXPECT_TRUE(threads.loops().empty());
+}
+
+TEST(ServerThreadsTest, ServeInput) {
+    // Serves whole lines, and returns how much they took.
+    std::vector<std::string> served;
+    const auto serve = [&served](std::string_view data) {
+        const size_t end = data.rfind('\n');
+        if (end == std::string_view::npos) {
+            return size_t{0};
+        }
+        served.emplace_back(data.substr(0u, end + 1u));
+        return end + 1u;
+    };
+    std::string input;
+    serve_input(&input, "ab\ncd", serve);
+    EXPECT_EQ(input, "cd");
+    serve_input(&input, "e\nf", serve);
+    EXPECT_EQ(input, "f");
+    serve_input(&input, "\n", serve);
+    EXPECT_EQ(input, "");
+    EXPECT_EQ(served, (std::vector<std::string>{"ab\n", "cde\n", "f\n"}));
+
+    // With nothing left over, the data is served where it is.
+    const std::string data = "gh\n";
+    serve_input(&input, data, [&data](std::string_view in) {
+        EXPECT_EQ(in.data(), data.data());
+        return in.size();
+    });
+    EXPECT_EQ(input, "");
+}
+
+}  // namespace djehuti
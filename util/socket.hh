@@ -0,0 +1,43 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace djehuti {
+
+/**
+ * Opens a TCP socket listening on the IPv4 address ("*" or empty for any) and port (0 for one
+ * the kernel picks), with SO_REUSEADDR, and SO_REUSEPORT so that several sockets (one per
+ * thread, say) can share the port and have the kernel spread connections over them. Returns
+ * the socket, or -1 (with errno set).
+ */
+int listen_tcp(const std::string &address, uint16_t port);
+
+/// Returns the port a socket is bound to, or 0 if it isn't.
+uint16_t local_port(int fd);
+
+/// Connects to the IPv4 address and port, with TCP_NODELAY, returning the socket or -1 (with
+/// errno set).
+int connect_tcp(const std::string &address, uint16_t port);
+
+}  // namespace djehuti
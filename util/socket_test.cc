@@ -0,0 +1,61 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/socket.hh"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+TEST(SocketTest, ListenAndConnect) {
+    const int listener = listen_tcp("127.0.0.1", 0u);
+    ASSERT_GE(listener, 0);
+    const uint16_t port = local_port(listener);
+    EXPECT_NE(port, 0u);
+
+    // Another socket can share the port.
+    const int other = listen_tcp("127.0.0.1", port);
+    EXPECT_GE(other, 0);
+    ::close(other);
+
+    const int client = connect_tcp("127.0.0.1", port);
+    ASSERT_GE(client, 0);
+    const int server = ::accept(listener, nullptr, nullptr);
+    ASSERT_GE(server, 0);
+    EXPECT_EQ(::write(client, "hi", 2u), 2);
+    char buffer[2];
+    EXPECT_EQ(::read(server, buffer, sizeof(buffer)), 2);
+    EXPECT_EQ(std::string(buffer, 2u), "hi");
+    ::close(server);
+    ::close(client);
+    ::close(listener);
+
+    EXPECT_EQ(listen_tcp("not an address", 0u), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(connect_tcp("127.0.0.1", port), -1);  // No one's listening now.
+}
+
+}  // namespace djehuti
@@ -20,7 +20,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace djehuti {
@@ -32,11 +38,204 @@ namespace string {
  */
 std::vector<std::string> split(const std::string &whole, char separator);
 
+// Delimiters for split_view and split_into. Each has a find(text, pos) method that returns the
+// position of the first separator in text at or after pos (or npos), and a length() method that
+// returns the length of the separator.
+
+/// Separates at a single character.
+class ByChar final {
+ public:
+    constexpr explicit ByChar(char c) : c_(c) {}
+    size_t find(std::string_view text, size_t pos) const { return text.find(c_, pos); }
+    constexpr size_t length() const { return 1u; }
+
+ private:
+    char c_;
+};
+
+/// Separates at a whole string ("::", "\r\n"). An empty string never matches.
+class ByString final {
+ public:
+    constexpr explicit ByString(std::string_view separator) : separator_(separator) {}
+    size_t find(std::string_view text, size_t pos) const {
+        return separator_.empty() ? std::string_view::npos : text.find(separator_, pos);
+    }
+    constexpr size_t length() const { return separator_.size(); }
+
+ private:
+    std::string_view separator_;
+};
+
+/// Separates at any one of a set of characters (ByAnyChar(" \t\r\n") for whitespace).
+class ByAnyChar final {
+ public:
+    constexpr explicit ByAnyChar(std::string_view chars) : set_{} {
+        for (char c : chars) {
+            const auto u = static_cast<unsigned char>(c);
+            set_[u >> 6] |= uint64_t{1} << (u & 63u);
+        }
+    }
+    size_t find(std::string_view text, size_t pos) const {
+        for (; pos < text.size(); ++pos) {
+            if (contains(text[pos])) {
+                return pos;
+            }
+        }
+        return std::string_view::npos;
+    }
+    constexpr size_t length() const { return 1u; }
+    /// Returns true if c is one of the separators.
+    constexpr bool contains(char c) const {
+        const auto u = static_cast<unsigned char>(c);
+        return (set_[u >> 6] >> (u & 63u)) & 1u;
+    }
+
+ private:
+    uint64_t set_[4];
+};
+
+/**
+ * A lazy forward range over the non-empty parts of a string, as string_views into it. Making
+ * one or iterating over it never allocates; the string must outlive it. Get one from
+ * split_view().
+ */
+template <typename Delimiter>
+class SplitView final {
+ public:
+    class iterator final {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view *;
+        using reference = const std::string_view &;
+
+        /// The default iterator is the end.
+        iterator() = default;
+
+        reference operator*() const { return part_; }
+        pointer operator->() const { return &part_; }
+
+        iterator &operator++() {
+            advance();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator before = *this;
+            advance();
+            return before;
+        }
+
+        bool operator==(const iterator &other) const { return part_.data() == other.part_.data(); }
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+     private:
+        friend class SplitView;
+
+        iterator(const SplitView *view, size_t pos) : view_(view), next_(pos) { advance(); }
+
+        // Move on to the next non-empty part at or after next_, or to the end.
+        void advance() {
+            const std::string_view text = view_->text_;
+            while (next_ <= text.size()) {
+                const size_t separator = view_->delimiter_.find(text, next_);
+                const size_t end = (separator == std::string_view::npos) ? text.size() : separator;
+                const size_t start = next_;
+                next_ = (separator == std::string_view::npos)
+                            ? text.size() + 1u
+                            : separator + view_->delimiter_.length();
+                if (end != start) {
+                    part_ = text.substr(start, end - start);
+                    return;
+                }
+            }
+            part_ = std::string_view();
+        }
+
+        const SplitView *view_ = nullptr;
+        std::string_view part_;  // Its data() is null at the end.
+        size_t next_ = 0u;
+    };
+    using const_iterator = iterator;
+
+    SplitView(std::string_view text, Delimiter delimiter) : text_(text), delimiter_(delimiter) {}
+
+    iterator begin() const { return iterator(this, 0u); }
+    iterator end() const { return iterator(); }
+    /// Returns true if there are no non-empty parts.
+    bool empty() const { return begin() == end(); }
+
+ private:
+    std::string_view text_;
+    Delimiter delimiter_;
+};
+
+/// Return a lazy range over the non-empty parts of whole, separated by the given character.
+/// for (std::string_view part : split_view(line, ',')) { ... }
+inline SplitView<ByChar> split_view(std::string_view whole, char separator) {
+    return SplitView<ByChar>(whole, ByChar(separator));
+}
+
+/// Return a lazy range over the non-empty parts of whole, separated by the given string.
+inline SplitView<ByString> split_view(std::string_view whole, std::string_view separator) {
+    return SplitView<ByString>(whole, ByString(separator));
+}
+
+/// Return a lazy range over the non-empty parts of whole, separated by the given Delimiter
+/// (ByChar, ByString, ByAnyChar or one of your own).
+template <typename Delimiter,
+          typename = std::enable_if_t<std::is_class<Delimiter>::value &&
+                                      !std::is_convertible<Delimiter, std::string_view>::value>>
+SplitView<Delimiter> split_view(std::string_view whole, Delimiter delimiter) {
+    return SplitView<Delimiter>(whole, delimiter);
+}
+
+/// Append the non-empty parts of whole to the given container (of string_views, or anything
+/// constructible from one), and return how many there were. Separators are as for split_view.
+template <typename Separator, typename Container>
+size_t split_into(std::string_view whole, Separator separator, Container *parts) {
+    size_t count = 0u;
+    for (std::string_view part : split_view(whole, separator)) {
+        parts->emplace_back(part);
+        ++count;
+    }
+    return count;
+}
+
+/// Return the length of join(first, last, separator) without joining them.
+template <typename Iterator>
+size_t joined_size(Iterator first, Iterator last, std::string_view separator) {
+    size_t size = 0u;
+    size_t count = 0u;
+    for (; first != last; ++first, ++count) {
+        size += std::string_view(*first).size();
+    }
+    return (count == 0u) ? 0u : size + separator.size() * (count - 1u);
+}
+
+/// Join the strings in [first, last) (anything convertible to string_view) together, separated
+/// by the separator. This works out the size first, so it allocates just once.
+template <typename Iterator>
+std::string join(Iterator first, Iterator last, std::string_view separator) {
+    std::string joined(joined_size(first, last, separator), '\0');
+    char *out = joined.data();
+    for (Iterator it = first; it != last; ++it) {
+        if (it != first) {
+            std::memcpy(out, separator.data(), separator.size());
+            out += separator.size();
+        }
+        const std::string_view part(*it);
+        std::memcpy(out, part.data(), part.size());
+        out += part.size();
+    }
+    return joined;
+}
+
 /// Join the given strings together, separated by the separator.
 std::string join(const std::vector<std::string> &parts, const std::string &separator);
 
 /// Join the given strings together, separated by the separator.
-std::string join(const std::vector<std::string> &parts, char separator) {
+inline std::string join(const std::vector<std::string> &parts, char separator) {
     return join(parts, std::string(1u, separator));
 }
 
@@ -0,0 +1,166 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/string.hh"
+#include "util/string_builder.hh"
+
+// The string_view splitters and the single-allocation joins against the istringstream split and
+// ostringstream join that used to back string::split and string::join.
+
+namespace {
+
+std::vector<std::string> istringstream_split(const std::string &whole, char separator) {
+    std::vector<std::string> parts;
+    std::istringstream iss(whole);
+    std::string part;
+    while (std::getline(iss, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+std::string ostringstream_join(const std::vector<std::string> &parts,
+                               const std::string &separator) {
+    std::ostringstream oss;
+    bool first = true;
+    for (const auto &part : parts) {
+        if (!first) {
+            oss << separator;
+        }
+        first = false;
+        oss << part;
+    }
+    return oss.str();
+}
+
+}  // namespace
+
+int main() {
+    using namespace djehuti;
+    // About 1 MB of words of 1 to 16 letters, separated by one or two spaces or a newline.
+    constexpr size_t SIZE = 1u << 20;
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<int> length(1, 16);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> separator(0, 7);
+    std::string text;
+    text.reserve(SIZE + 32u);
+    while (text.size() < SIZE) {
+        for (int n = length(gen); n > 0; --n) {
+            text.push_back(static_cast<char>(letter(gen)));
+        }
+        switch (separator(gen)) {
+            case 0:
+                text.append("  ");
+                break;
+            case 1:
+                text.push_back('\n');
+                break;
+            default:
+                text.push_back(' ');
+                break;
+        }
+    }
+    std::string colons = text;
+    for (char &c : colons) {
+        if (c == ' ') {
+            c = ':';
+        }
+    }
+    const size_t words = string::split(text, ' ').size();
+
+    benchmark::run("istringstream split", [&] {
+        benchmark::do_not_optimize(istringstream_split(text, ' ').size());
+    }, words, text.size());
+    benchmark::run("string::split", [&] {
+        benchmark::do_not_optimize(string::split(text, ' ').size());
+    }, words, text.size());
+    std::vector<std::string_view> views;
+    benchmark::run("string::split_into, reused vector of views", [&] {
+        views.clear();
+        benchmark::do_not_optimize(string::split_into(text, ' ', &views));
+    }, words, text.size());
+    benchmark::run("string::split_view, char", [&] {
+        size_t total = 0u;
+        for (std::string_view part : string::split_view(text, ' ')) {
+            total += part.size();
+        }
+        benchmark::do_not_optimize(total);
+    }, words, text.size());
+    benchmark::run("string::split_view, \"::\"", [&] {
+        size_t total = 0u;
+        for (std::string_view part : string::split_view(colons, "::")) {
+            total += part.size();
+        }
+        benchmark::do_not_optimize(total);
+    }, words, text.size());
+    benchmark::run("string::split_view, ByAnyChar(\" \\n\")", [&] {
+        size_t total = 0u;
+        for (std::string_view part : string::split_view(text, string::ByAnyChar(" \n"))) {
+            total += part.size();
+        }
+        benchmark::do_not_optimize(total);
+    }, words, text.size());
+
+    // Joining the words of the same text back together, and building a small HTTP response.
+    const std::vector<std::string> word_strings = string::split(text, ' ');
+    const std::vector<std::string_view> word_views(views.begin(), views.end());
+    benchmark::run("ostringstream join", [&] {
+        benchmark::do_not_optimize(ostringstream_join(word_strings, " ").size());
+    }, words, text.size());
+    benchmark::run("string::join", [&] {
+        benchmark::do_not_optimize(string::join(word_strings, " ").size());
+    }, words, text.size());
+    benchmark::run("string::join, string_views", [&] {
+        benchmark::do_not_optimize(string::join(word_views.begin(), word_views.end(), " ").size());
+    }, words, text.size());
+    string::StringBuilder builder;
+    benchmark::run("StringBuilder::append_join, reused", [&] {
+        builder.clear();
+        builder.append_join(word_views.begin(), word_views.end(), " ");
+        benchmark::do_not_optimize(builder.size());
+    }, words, text.size());
+
+    const std::string body = "{\"celsius\":37,\"fahrenheit\":98.6}";
+    benchmark::run("small response, ostringstream", [&] {
+        std::ostringstream oss;
+        oss << "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+            << body.size() << "\r\n\r\n" << body;
+        benchmark::do_not_optimize(oss.str().size());
+    });
+    benchmark::run("small response, StringBuilder", [&] {
+        string::StringBuilder response;
+        response.append("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: ")
+            .append(body.size())
+            .append("\r\n\r\n")
+            .append(body);
+        benchmark::do_not_optimize(response.size());
+    });
+    return 0;
+}
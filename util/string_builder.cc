@@ -0,0 +1,57 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_builder.hh"
+
+#include <algorithm>
+
+namespace djehuti {
+namespace string {
+
+constexpr size_t StringBuilder::INLINE_CAPACITY;
+constexpr size_t StringBuilder::MAX_INTEGER_CHARS;
+constexpr size_t StringBuilder::MAX_DOUBLE_CHARS;
+
+void StringBuilder::grow(size_t capacity) {
+    capacity = std::max(capacity, 2u * capacity_);
+    char *data = new char[capacity];
+    std::memcpy(data, data_, size_);
+    release();
+    data_ = data;
+    capacity_ = capacity;
+}
+
+void StringBuilder::take(StringBuilder *other) {
+    size_ = other->size_;
+    if (other->data_ == other->inline_) {
+        data_ = inline_;
+        capacity_ = INLINE_CAPACITY;
+        std::memcpy(inline_, other->inline_, size_);
+    } else {
+        data_ = other->data_;
+        capacity_ = other->capacity_;
+        other->data_ = other->inline_;
+        other->capacity_ = INLINE_CAPACITY;
+    }
+    other->size_ = 0u;
+}
+
+}  // namespace string
+}  // namespace djehuti
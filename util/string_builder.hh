@@ -0,0 +1,158 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace djehuti {
+namespace string {
+
+/**
+ * A buffer for building strings a piece at a time, such as HTTP responses. Short strings are
+ * built in a buffer inside the StringBuilder, so they don't allocate at all, and clear() keeps
+ * whatever capacity it has grown to, so one StringBuilder reused for each response stops
+ * allocating once it is big enough for the biggest. Unlike a std::ostringstream, appending
+ * numbers doesn't depend on a locale.
+ */
+class StringBuilder final {
+ public:
+    /// How many bytes fit in the buffer inside the StringBuilder.
+    static constexpr size_t INLINE_CAPACITY = 232u;
+
+    StringBuilder() = default;
+    StringBuilder(const StringBuilder &) = delete;
+    StringBuilder &operator=(const StringBuilder &) = delete;
+    StringBuilder(StringBuilder &&other) noexcept { take(&other); }
+    StringBuilder &operator=(StringBuilder &&other) noexcept {
+        if (this != &other) {
+            release();
+            take(&other);
+        }
+        return *this;
+    }
+    ~StringBuilder() { release(); }
+
+    StringBuilder &append(std::string_view s) {
+        if (s.size() > capacity_ - size_) {
+            grow(size_ + s.size());
+        }
+        std::memcpy(data_ + size_, s.data(), s.size());
+        size_ += s.size();
+        return *this;
+    }
+    StringBuilder &append(const char *s) { return append(std::string_view(s)); }
+    StringBuilder &append(const std::string &s) { return append(std::string_view(s)); }
+    StringBuilder &append(char c) {
+        if (size_ == capacity_) {
+            grow(size_ + 1u);
+        }
+        data_[size_++] = c;
+        return *this;
+    }
+    /// Append count copies of c.
+    StringBuilder &append(size_t count, char c) {
+        if (count > capacity_ - size_) {
+            grow(size_ + count);
+        }
+        std::memset(data_ + size_, c, count);
+        size_ += count;
+        return *this;
+    }
+    /// Append an integer in decimal.
+    template <typename Int,
+              typename = std::enable_if_t<std::is_integral<Int>::value &&
+                                          !std::is_same<Int, char>::value &&
+                                          !std::is_same<Int, bool>::value>>
+    StringBuilder &append(Int value) {
+        return append_chars(value, MAX_INTEGER_CHARS);
+    }
+    /// Append a double in the shortest form that reads back as the same double.
+    StringBuilder &append(double value) { return append_chars(value, MAX_DOUBLE_CHARS); }
+
+    /// Append the strings in [first, last), separated by the separator, as string::join does.
+    template <typename Iterator>
+    StringBuilder &append_join(Iterator first, Iterator last, std::string_view separator) {
+        for (Iterator it = first; it != last; ++it) {
+            if (it != first) {
+                append(separator);
+            }
+            append(std::string_view(*it));
+        }
+        return *this;
+    }
+
+    /// Make sure there is room for at least capacity bytes without allocating.
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            grow(capacity);
+        }
+    }
+    /// Empty the StringBuilder, keeping its capacity.
+    void clear() { size_ = 0u; }
+
+    bool empty() const { return size_ == 0u; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    /// Returns the contents, which are not NUL-terminated.
+    const char *data() const { return data_; }
+    /// Returns a view of the contents, which is good until the StringBuilder is next changed.
+    std::string_view view() const { return std::string_view(data_, size_); }
+    /// Returns a copy of the contents.
+    std::string str() const { return std::string(data_, size_); }
+
+ private:
+    // Enough for any 64-bit integer, and for any double in its shortest form.
+    static constexpr size_t MAX_INTEGER_CHARS = 20u;
+    static constexpr size_t MAX_DOUBLE_CHARS = 24u;
+
+    template <typename T>
+    StringBuilder &append_chars(T value, size_t max_chars) {
+        if (max_chars > capacity_ - size_) {
+            grow(size_ + max_chars);
+        }
+        size_ = std::to_chars(data_ + size_, data_ + capacity_, value).ptr - data_;
+        return *this;
+    }
+
+    // Reallocate with room for at least capacity bytes, at least doubling the capacity.
+    void grow(size_t capacity);
+    // Take other's contents, leaving it empty.
+    void take(StringBuilder *other);
+    // Free the allocated buffer, if there is one.
+    void release() {
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+    }
+
+    char *data_ = inline_;
+    size_t size_ = 0u;
+    size_t capacity_ = INLINE_CAPACITY;
+    char inline_[INLINE_CAPACITY];
+};
+
+}  // namespace string
+}  // namespace djehuti
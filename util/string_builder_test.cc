@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_builder.hh"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace string {
+
+TEST(StringBuilderTests, Append) {
+    StringBuilder builder;
+    EXPECT_TRUE(builder.empty());
+    builder.append("HTTP/1.1 ").append(200).append(' ').append(std::string("OK")).append(2u, '!');
+    EXPECT_EQ(builder.view(), "HTTP/1.1 200 OK!!");
+    EXPECT_EQ(builder.size(), 17u);
+
+    builder.clear();
+    builder.append(std::numeric_limits<int64_t>::min())
+        .append(',')
+        .append(std::numeric_limits<uint64_t>::max())
+        .append(',')
+        .append(0.1)
+        .append(',')
+        .append(-1.7976931348623157e308)
+        .append(',')
+        .append(static_cast<unsigned char>(7));
+    EXPECT_EQ(builder.str(), "-9223372036854775808,18446744073709551615,0.1,"
+                             "-1.7976931348623157e+308,7");
+}
+
+TEST(StringBuilderTests, Grow) {
+    StringBuilder builder;
+    EXPECT_EQ(builder.capacity(), StringBuilder::INLINE_CAPACITY);
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        builder.append(i).append(' ');
+        expected += std::to_string(i) + ' ';
+    }
+    EXPECT_EQ(builder.view(), expected);
+    EXPECT_GE(builder.capacity(), expected.size());
+
+    // Clearing keeps the capacity, so building it again doesn't allocate.
+    const size_t capacity = builder.capacity();
+    const char *data = builder.data();
+    builder.clear();
+    EXPECT_TRUE(builder.empty());
+    EXPECT_EQ(builder.capacity(), capacity);
+    builder.append(expected);
+    EXPECT_EQ(builder.data(), data);
+    EXPECT_EQ(builder.view(), expected);
+
+    StringBuilder reserved;
+    reserved.reserve(10000u);
+    EXPECT_GE(reserved.capacity(), 10000u);
+    EXPECT_TRUE(reserved.empty());
+}
+
+TEST(StringBuilderTests, Move) {
+    StringBuilder small;
+    small.append("small");
+    StringBuilder moved_small(std::move(small));
+    EXPECT_EQ(moved_small.view(), "small");
+
+    StringBuilder big;
+    big.append(1000u, 'x');
+    const char *data = big.data();
+    StringBuilder moved_big(std::move(big));
+    EXPECT_EQ(moved_big.data(), data);
+    EXPECT_EQ(moved_big.size(), 1000u);
+    EXPECT_TRUE(big.empty());
+    EXPECT_EQ(big.capacity(), StringBuilder::INLINE_CAPACITY);
+
+    moved_small = std::move(moved_big);
+    EXPECT_EQ(moved_small.data(), data);
+    moved_big.append("still usable");
+    EXPECT_EQ(moved_big.view(), "still usable");
+}
+
+TEST(StringBuilderTests, AppendJoin) {
+    const std::vector<std::string> parts{"a", "b", "c"};
+    StringBuilder builder;
+    builder.append('[').append_join(parts.begin(), parts.end(), ", ").append(']');
+    EXPECT_EQ(builder.view(), "[a, b, c]");
+    builder.clear();
+    builder.append_join(parts.end(), parts.end(), ", ");
+    EXPECT_TRUE(builder.empty());
+}
+
+}  // namespace string
+}  // namespace djehuti
@@ -0,0 +1,195 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_scan.hh"
+
+#include <algorithm>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace string {
+
+constexpr size_t SeparatorSet::MAX_VECTOR_SIZE;
+constexpr size_t ScanSplitView::iterator::BLOCK_MASKS;
+constexpr size_t ScanSplitView::iterator::BLOCK_SIZE;
+
+SeparatorSet::SeparatorSet(std::string_view separators) : table_(separators) {
+    for (int u = 0; u < 256; ++u) {
+        const char c = static_cast<char>(u);
+        if (table_.contains(c)) {
+            if (size_ < MAX_VECTOR_SIZE) {
+                chars_[size_] = c;
+            }
+            ++size_;
+        }
+    }
+}
+
+namespace {
+
+// Scans the count bytes of text (at most 64) into one mask.
+uint64_t scan_scalar(const char *text, size_t count, const SeparatorSet &separators) {
+    uint64_t mask = 0u;
+    for (size_t i = 0u; i < count; ++i) {
+        mask |= uint64_t{separators.contains(text[i])} << i;
+    }
+    return mask;
+}
+
+#if HAVE_X86_SIMD
+
+#define AVX2 __attribute__((target("avx2")))
+#define SSE42 __attribute__((target("sse4.2")))
+
+// Each of these scans as many whole 64-byte blocks as there are in the text, and returns how
+// many bytes that was.
+
+AVX2 size_t scan_avx2(const char *text, size_t size, const SeparatorSet &separators,
+                      uint64_t *masks) {
+    const size_t blocks = size / 64u;
+    const size_t count = separators.size();
+    if (count == 1u) {
+        const __m256i c = _mm256_set1_epi8(separators.chars()[0]);
+        for (size_t b = 0u; b < blocks; ++b) {
+            const char *p = text + 64u * b;
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+            const uint32_t lo_bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c));
+            const uint32_t hi_bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c));
+            masks[b] = uint64_t{lo_bits} | (uint64_t{hi_bits} << 32);
+        }
+        return 64u * blocks;
+    }
+    __m256i chars[SeparatorSet::MAX_VECTOR_SIZE];
+    for (size_t i = 0u; i < count; ++i) {
+        chars[i] = _mm256_set1_epi8(separators.chars()[i]);
+    }
+    for (size_t b = 0u; b < blocks; ++b) {
+        const char *p = text + 64u * b;
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+        __m256i lo_matches = _mm256_cmpeq_epi8(lo, chars[0]);
+        __m256i hi_matches = _mm256_cmpeq_epi8(hi, chars[0]);
+        for (size_t i = 1u; i < count; ++i) {
+            lo_matches = _mm256_or_si256(lo_matches, _mm256_cmpeq_epi8(lo, chars[i]));
+            hi_matches = _mm256_or_si256(hi_matches, _mm256_cmpeq_epi8(hi, chars[i]));
+        }
+        const uint32_t lo_bits = _mm256_movemask_epi8(lo_matches);
+        const uint32_t hi_bits = _mm256_movemask_epi8(hi_matches);
+        masks[b] = uint64_t{lo_bits} | (uint64_t{hi_bits} << 32);
+    }
+    return 64u * blocks;
+}
+
+// Single separators are compared directly; sets use PCMPESTRM's "equal any" mode, which matches
+// each of 16 bytes against up to 16 separators at once.
+SSE42 size_t scan_sse42(const char *text, size_t size, const SeparatorSet &separators,
+                        uint64_t *masks) {
+    const size_t blocks = size / 64u;
+    if (separators.size() == 1u) {
+        const __m128i c = _mm_set1_epi8(separators.chars()[0]);
+        for (size_t b = 0u; b < blocks; ++b) {
+            uint64_t mask = 0u;
+            for (size_t i = 0u; i < 4u; ++i) {
+                const __m128i v =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 64u * b + 16u * i));
+                const uint32_t bits = _mm_movemask_epi8(_mm_cmpeq_epi8(v, c));
+                mask |= uint64_t{bits} << (16u * i);
+            }
+            masks[b] = mask;
+        }
+        return 64u * blocks;
+    }
+    constexpr int MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(separators.chars()));
+    const int count = static_cast<int>(separators.size());
+    for (size_t b = 0u; b < blocks; ++b) {
+        uint64_t mask = 0u;
+        for (size_t i = 0u; i < 4u; ++i) {
+            const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 64u * b + 16u * i));
+            const uint32_t bits = _mm_cvtsi128_si32(_mm_cmpestrm(chars, count, v, 16, MODE));
+            mask |= uint64_t{bits & 0xffffu} << (16u * i);
+        }
+        masks[b] = mask;
+    }
+    return 64u * blocks;
+}
+
+// These would clash with the ScanLevels.
+#undef AVX2
+#undef SSE42
+
+#endif  // HAVE_X86_SIMD
+
+}  // namespace
+
+ScanLevel best_scan_level() {
+    if (cpu::has_avx2()) {
+        return ScanLevel::AVX2;
+    }
+    if (cpu::has_sse42()) {
+        return ScanLevel::SSE42;
+    }
+    return ScanLevel::SCALAR;
+}
+
+void scan_separators(const char *text, size_t size, const SeparatorSet &separators,
+                     uint64_t *masks, ScanLevel level) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (separators.size() != 0u && separators.size() <= SeparatorSet::MAX_VECTOR_SIZE) {
+        level = std::min(level, best_scan_level());
+        if (level == ScanLevel::AVX2) {
+            done = scan_avx2(text, size, separators, masks);
+        } else if (level == ScanLevel::SSE42) {
+            done = scan_sse42(text, size, separators, masks);
+        }
+    }
+#endif
+    for (; done < size; done += 64u) {
+        const size_t count = std::min<size_t>(size - done, 64u);
+        masks[done / 64u] = scan_scalar(text + done, count, separators);
+    }
+}
+
+void scan_separators(const char *text, size_t size, const SeparatorSet &separators,
+                     uint64_t *masks) {
+    static const ScanLevel best = best_scan_level();
+    scan_separators(text, size, separators, masks, best);
+}
+
+void ScanSplitView::iterator::scan_block() {
+    const std::string_view text = view_->text_;
+    const size_t size = std::min(text.size() - base_, BLOCK_SIZE);
+    std::fill(masks_, masks_ + BLOCK_MASKS, 0u);
+    scan_separators(text.data() + base_, size, view_->separators_, masks_);
+    word_ = 0u;
+    bits_ = masks_[0];
+}
+
+}  // namespace string
+}  // namespace djehuti
@@ -0,0 +1,193 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#include "util/string.hh"
+
+// Separator scanning for tokenizing big inputs. scan_separators() turns a run of text into
+// bitmasks of where the separators are, 64 bytes at a time, using AVX2 or SSE4.2 when the CPU
+// has them; split_view() over a SeparatorSet walks those masks instead of searching for each
+// separator in turn.
+
+namespace djehuti {
+namespace string {
+
+/// A set of separator bytes to scan for. Sets of up to MAX_VECTOR_SIZE distinct bytes are
+/// scanned with SIMD; bigger ones are scanned a byte at a time.
+class SeparatorSet final {
+ public:
+    static constexpr size_t MAX_VECTOR_SIZE = 16u;
+
+    explicit SeparatorSet(char separator) : table_(std::string_view(&separator, 1u)), size_(1u) {
+        chars_[0] = separator;
+    }
+    explicit SeparatorSet(std::string_view separators);
+
+    /// Returns true if c is one of the separators.
+    bool contains(char c) const { return table_.contains(c); }
+    /// Returns the number of distinct separators.
+    size_t size() const { return size_; }
+    /// Returns the distinct separators, if there are no more than MAX_VECTOR_SIZE of them.
+    const char *chars() const { return chars_; }
+
+ private:
+    ByAnyChar table_;
+    size_t size_ = 0u;
+    char chars_[MAX_VECTOR_SIZE] = {};
+};
+
+/// The ways scan_separators() can run, from slowest to fastest.
+enum class ScanLevel { SCALAR, SSE42, AVX2 };
+
+/// Returns the fastest ScanLevel this CPU supports.
+ScanLevel best_scan_level();
+
+/**
+ * Find the separators in the size bytes of text: set bit (i % 64) of masks[i / 64] if text[i] is
+ * one of them, and clear it if not. This writes (size + 63) / 64 masks; the bits past the end of
+ * the text in the last one are clear.
+ */
+void scan_separators(const char *text, size_t size, const SeparatorSet &separators,
+                     uint64_t *masks);
+
+/// As above, but scanning at the given level (or the best one the CPU supports, if it's lower),
+/// for testing and benchmarking.
+void scan_separators(const char *text, size_t size, const SeparatorSet &separators,
+                     uint64_t *masks, ScanLevel level);
+
+/**
+ * A lazy forward range over the non-empty parts of a string separated by any of a SeparatorSet,
+ * as string_views into it. It finds the separators a block at a time with scan_separators(), so
+ * it is much faster than a SplitView when the parts are short. It never allocates; the string
+ * must outlive it. Get one from split_view().
+ */
+class ScanSplitView final {
+ public:
+    class iterator final {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view *;
+        using reference = const std::string_view &;
+
+        /// The default iterator is the end.
+        iterator() = default;
+
+        reference operator*() const { return part_; }
+        pointer operator->() const { return &part_; }
+
+        iterator &operator++() {
+            advance();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator before = *this;
+            advance();
+            return before;
+        }
+
+        bool operator==(const iterator &other) const { return part_.data() == other.part_.data(); }
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+     private:
+        friend class ScanSplitView;
+
+        // The iterator scans this many bytes at a time.
+        static constexpr size_t BLOCK_MASKS = 4u;
+        static constexpr size_t BLOCK_SIZE = 64u * BLOCK_MASKS;
+
+        explicit iterator(const ScanSplitView *view) : view_(view) {
+            scan_block();
+            advance();
+        }
+
+        // Scan the block of text starting at base_ into masks_.
+        void scan_block();
+        // Move on to the next non-empty part at or after next_, or to the end.
+        void advance() {
+            const std::string_view text = view_->text_;
+            for (;;) {
+                while (bits_ == 0u) {
+                    if (++word_ == BLOCK_MASKS) {
+                        if (base_ + BLOCK_SIZE >= text.size()) {
+                            // That was the last block, so the rest is the last part.
+                            if (next_ < text.size()) {
+                                part_ = text.substr(next_);
+                                next_ = text.size();
+                            } else {
+                                part_ = std::string_view();
+                            }
+                            word_ = BLOCK_MASKS - 1u;
+                            return;
+                        }
+                        base_ += BLOCK_SIZE;
+                        scan_block();
+                    }
+                    bits_ = masks_[word_];
+                }
+                const size_t separator = base_ + 64u * word_ + __builtin_ctzll(bits_);
+                bits_ &= bits_ - 1u;
+                if (separator != next_) {
+                    part_ = text.substr(next_, separator - next_);
+                    next_ = separator + 1u;
+                    return;
+                }
+                next_ = separator + 1u;
+            }
+        }
+
+        const ScanSplitView *view_ = nullptr;
+        std::string_view part_;  // Its data() is null at the end.
+        size_t next_ = 0u;       // Where the next part starts.
+        size_t base_ = 0u;       // Where the block in masks_ starts.
+        size_t word_ = 0u;       // Which of masks_ bits_ came from.
+        uint64_t bits_ = 0u;     // The separators in masks_[word_] we haven't used yet.
+        uint64_t masks_[BLOCK_MASKS] = {};
+    };
+    using const_iterator = iterator;
+
+    ScanSplitView(std::string_view text, const SeparatorSet &separators)
+        : text_(text), separators_(separators) {}
+
+    iterator begin() const { return iterator(this); }
+    iterator end() const { return iterator(); }
+    /// Returns true if there are no non-empty parts.
+    bool empty() const { return begin() == end(); }
+
+ private:
+    std::string_view text_;
+    SeparatorSet separators_;
+};
+
+/// Return a lazy range over the non-empty parts of whole, separated by any of the separators.
+/// split_into(whole, separators, &parts) also uses this.
+inline ScanSplitView split_view(std::string_view whole, const SeparatorSet &separators) {
+    return ScanSplitView(whole, separators);
+}
+
+}  // namespace string
+}  // namespace djehuti
@@ -0,0 +1,92 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/string.hh"
+#include "util/string_scan.hh"
+
+// Separator scanning at each level, and splitting with it against the SplitView delimiters.
+
+int main() {
+    using namespace djehuti;
+    using string::ScanLevel;
+    // About 16 MB of CSV-ish lines: fields of 1 to 16 letters separated by commas, some empty.
+    constexpr size_t SIZE = 16u << 20;
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<int> length(0, 16);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> fields(4, 12);
+    std::string text;
+    text.reserve(SIZE + 256u);
+    while (text.size() < SIZE) {
+        for (int f = fields(gen); f > 0; --f) {
+            for (int n = length(gen); n > 0; --n) {
+                text.push_back(static_cast<char>(letter(gen)));
+            }
+            text.push_back(f > 1 ? ',' : '\n');
+        }
+    }
+    const string::SeparatorSet comma(',');
+    const string::SeparatorSet comma_or_newline(",\n");
+    std::vector<std::string_view> all_parts;
+    const size_t parts = string::split_into(text, comma_or_newline, &all_parts);
+    std::vector<uint64_t> masks((text.size() + 63u) / 64u);
+
+    const std::pair<const char *, ScanLevel> levels[] = {
+        {"scalar", ScanLevel::SCALAR}, {"SSE4.2", ScanLevel::SSE42}, {"AVX2", ScanLevel::AVX2}};
+    for (const auto &level : levels) {
+        const std::string name = std::string("scan_separators ") + level.first;
+        benchmark::run(name + ", ','", [&] {
+            string::scan_separators(text.data(), text.size(), comma, masks.data(), level.second);
+            benchmark::do_not_optimize(masks[0]);
+        }, text.size(), text.size());
+        benchmark::run(name + ", \",\\n\"", [&] {
+            string::scan_separators(
+                text.data(), text.size(), comma_or_newline, masks.data(), level.second);
+            benchmark::do_not_optimize(masks[0]);
+        }, text.size(), text.size());
+    }
+
+    const auto count = [](const auto &view) {
+        size_t total = 0u;
+        for (std::string_view part : view) {
+            total += part.size();
+        }
+        benchmark::do_not_optimize(total);
+    };
+    benchmark::run("split_view, ','", [&] {
+        count(string::split_view(text, ','));
+    }, parts, text.size());
+    benchmark::run("split_view, SeparatorSet(',')", [&] {
+        count(string::split_view(text, comma));
+    }, parts, text.size());
+    benchmark::run("split_view, ByAnyChar(\",\\n\")", [&] {
+        count(string::split_view(text, string::ByAnyChar(",\n")));
+    }, parts, text.size());
+    benchmark::run("split_view, SeparatorSet(\",\\n\")", [&] {
+        count(string::split_view(text, comma_or_newline));
+    }, parts, text.size());
+    return 0;
+}
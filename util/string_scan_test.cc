@@ -0,0 +1,166 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_scan.hh"
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace string {
+
+using Views = std::vector<std::string_view>;
+
+constexpr ScanLevel LEVELS[] = {ScanLevel::SCALAR, ScanLevel::SSE42, ScanLevel::AVX2};
+
+// Random text of the given size, made mostly of the given separators so that there are lots of
+// runs of them and lots of empty parts, with the rest drawn from all 256 byte values.
+std::string random_text(std::mt19937_64 &gen, size_t size, const std::string &separators) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<size_t> which(0u, separators.size() - 1u);
+    std::bernoulli_distribution is_separator(0.3);
+    std::string text(size, '\0');
+    for (char &c : text) {
+        c = is_separator(gen) ? separators[which(gen)] : static_cast<char>(byte(gen));
+    }
+    return text;
+}
+
+// Random separators, including NULs and bytes with the high bit set.
+std::string random_separators(std::mt19937_64 &gen, size_t count) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string separators;
+    for (size_t i = 0u; i < count; ++i) {
+        separators.push_back(static_cast<char>(byte(gen)));
+    }
+    return separators;
+}
+
+TEST(StringScanTests, SeparatorSet) {
+    const SeparatorSet one(',');
+    EXPECT_EQ(one.size(), 1u);
+    EXPECT_TRUE(one.contains(','));
+    EXPECT_FALSE(one.contains(';'));
+
+    const SeparatorSet whitespace(" \t\r\n \t");
+    EXPECT_EQ(whitespace.size(), 4u);
+    EXPECT_TRUE(whitespace.contains('\r'));
+    EXPECT_FALSE(whitespace.contains('\0'));
+
+    const SeparatorSet digits_and_letters("0123456789abcdefghijklmnopqrstuvwxyz");
+    EXPECT_EQ(digits_and_letters.size(), 36u);
+    EXPECT_TRUE(digits_and_letters.contains('z'));
+}
+
+TEST(StringScanTests, ScanSeparators) {
+    const std::string text = "a,b,,c" + std::string(64u, 'x') + ",";
+    std::vector<uint64_t> masks(2u, ~uint64_t{0});
+    for (ScanLevel level : LEVELS) {
+        scan_separators(text.data(), text.size(), SeparatorSet(','), masks.data(), level);
+        EXPECT_EQ(masks[0], 0b11010u);
+        EXPECT_EQ(masks[1], uint64_t{1} << (text.size() - 1u - 64u));
+    }
+}
+
+TEST(StringScanTests, ScanSeparatorsEmptySet) {
+    // Nothing is a separator, not even NUL: the vector paths have no byte to compare with.
+    const SeparatorSet none("");
+    EXPECT_EQ(none.size(), 0u);
+    const std::string text(100u, '\0');
+    std::vector<uint64_t> masks(2u, ~uint64_t{0});
+    for (ScanLevel level : LEVELS) {
+        scan_separators(text.data(), text.size(), none, masks.data(), level);
+        EXPECT_EQ(masks[0], 0u);
+        EXPECT_EQ(masks[1], 0u);
+    }
+}
+
+TEST(StringScanTests, ScanSeparatorsFuzz) {
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<size_t> size(0u, 300u);
+    std::uniform_int_distribution<size_t> offset(0u, 63u);
+    std::uniform_int_distribution<size_t> count(1u, 20u);
+    for (int trial = 0; trial < 2000; ++trial) {
+        const std::string separators = random_separators(gen, count(gen));
+        const SeparatorSet set(separators);
+        // Start somewhere in the middle, so that the loads aren't aligned.
+        const size_t start = offset(gen);
+        const std::string text = random_text(gen, start + size(gen), separators);
+        const char *p = text.data() + start;
+        const size_t n = text.size() - start;
+        const size_t words = (n + 63u) / 64u;
+
+        std::vector<uint64_t> expected(words);
+        for (size_t i = 0u; i < n; ++i) {
+            if (separators.find(p[i]) != std::string::npos) {
+                expected[i / 64u] |= uint64_t{1} << (i % 64u);
+            }
+        }
+        for (ScanLevel level : LEVELS) {
+            std::vector<uint64_t> masks(words + 1u, 0x5555u);
+            scan_separators(p, n, set, masks.data(), level);
+            ASSERT_EQ(masks[words], 0x5555u) << "wrote past the end";
+            masks.resize(words);
+            ASSERT_EQ(masks, expected) << trial << " at level " << static_cast<int>(level);
+        }
+    }
+}
+
+TEST(StringScanTests, SplitView) {
+    using ::testing::ElementsAre;
+
+    const SeparatorSet whitespace(" \t\r\n");
+    const auto words = split_view(" one\ttwo \r\nthree\n", whitespace);
+    EXPECT_THAT(Views(words.begin(), words.end()), ElementsAre("one", "two", "three"));
+    EXPECT_TRUE(split_view("", whitespace).empty());
+    EXPECT_TRUE(split_view(std::string(1000u, ' '), whitespace).empty());
+
+    // Parts that span blocks.
+    const std::string long_part(700u, 'x');
+    const std::string text = "a " + long_part + "\n" + std::string(300u, '\t') + "b";
+    const auto parts = split_view(text, whitespace);
+    EXPECT_THAT(Views(parts.begin(), parts.end()), ElementsAre("a", long_part, "b"));
+
+    std::vector<std::string> strings;
+    EXPECT_EQ(split_into("x,,y,z,", SeparatorSet(','), &strings), 3u);
+    EXPECT_THAT(strings, ElementsAre("x", "y", "z"));
+}
+
+TEST(StringScanTests, SplitViewFuzz) {
+    std::mt19937_64 gen(2u);
+    std::uniform_int_distribution<size_t> size(0u, 2000u);
+    std::uniform_int_distribution<size_t> count(1u, 20u);
+    for (int trial = 0; trial < 1000; ++trial) {
+        const std::string separators = random_separators(gen, count(gen));
+        const std::string text = random_text(gen, size(gen), separators);
+        const auto expected = split_view(text, ByAnyChar(separators));
+        const auto parts = split_view(text, SeparatorSet(separators));
+        ASSERT_EQ(Views(parts.begin(), parts.end()), Views(expected.begin(), expected.end()))
+            << trial;
+    }
+}
+
+}  // namespace string
+}  // namespace djehuti
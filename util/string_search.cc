@@ -0,0 +1,424 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_search.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace string {
+
+namespace {
+
+constexpr size_t NPOS = std::string_view::npos;
+
+// Returns c in lower case, if it's an ASCII letter.
+inline unsigned char lower(char c) {
+    const auto u = static_cast<unsigned char>(c);
+    return (static_cast<unsigned>(u - 'A') < 26u) ? (u | 0x20u) : u;
+}
+
+// Returns the first position where a and b differ, ignoring case, or size.
+size_t mismatch_ignore_case_scalar(const char *a, const char *b, size_t size) {
+    for (size_t i = 0u; i < size; ++i) {
+        if (lower(a[i]) != lower(b[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Finds the maximal suffix of needle under the byte order (or its reverse), for the Two-Way
+// factorization. Returns the position just before the suffix and sets *period to its period.
+ptrdiff_t maximal_suffix(std::string_view needle, bool reversed, size_t *period) {
+    const auto *x = reinterpret_cast<const unsigned char *>(needle.data());
+    const auto m = static_cast<ptrdiff_t>(needle.size());
+    ptrdiff_t suffix = -1;
+    ptrdiff_t j = 0;
+    ptrdiff_t k = 1;
+    ptrdiff_t p = 1;
+    while (j + k < m) {
+        const unsigned char a = x[j + k];
+        const unsigned char b = x[suffix + k];
+        if (reversed ? (a > b) : (a < b)) {
+            j += k;
+            k = 1;
+            p = j - suffix;
+        } else if (a == b) {
+            if (k != p) {
+                ++k;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            suffix = j;
+            j = suffix + 1;
+            k = p = 1;
+        }
+    }
+    *period = static_cast<size_t>(p);
+    return suffix;
+}
+
+#if HAVE_X86_SIMD
+
+#define AVX2 __attribute__((target("avx2")))
+
+// The first/last-byte filter gives up and leaves the rest to Two-Way once it has spent this many
+// bytes of comparisons on false alarms, plus this many per byte of haystack it has covered.
+constexpr size_t VERIFY_ALLOWANCE = 4096u;
+constexpr size_t VERIFY_PER_BYTE = 8u;
+
+// Searches haystack from pos for the needle (at least two bytes long) by its first and last
+// bytes. Returns the position of the match, or npos if there is none; if the candidates are
+// mostly false alarms, stops and sets *resume to where Two-Way should carry on from.
+AVX2 size_t find_avx2(std::string_view haystack, std::string_view needle, size_t pos,
+                      size_t *resume) {
+    const size_t m = needle.size();
+    const char *h = haystack.data();
+    const __m256i first = _mm256_set1_epi8(needle.front());
+    const __m256i last = _mm256_set1_epi8(needle.back());
+    const size_t start = pos;
+    size_t spent = 0u;
+    for (; pos + m + 31u <= haystack.size(); pos += 32u) {
+        const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + pos));
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + pos + m - 1u));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(f, first), _mm256_cmpeq_epi8(l, last))));
+        while (mask != 0u) {
+            const size_t candidate = pos + __builtin_ctz(mask);
+            if (std::memcmp(h + candidate + 1u, needle.data() + 1u, m - 2u) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1u;
+            spent += m;
+        }
+        if (spent > VERIFY_ALLOWANCE + VERIFY_PER_BYTE * (pos - start)) {
+            *resume = pos + 32u;
+            return NPOS;
+        }
+    }
+    *resume = pos;
+    return NPOS;
+}
+
+// Returns v with its ASCII letters in lower case.
+AVX2 inline __m256i lower(__m256i v) {
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+AVX2 inline __m256i load_lower(const char *p) {
+    return lower(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+}
+
+// As find_avx2, but ignoring case and without giving up.
+AVX2 size_t find_ignore_case_avx2(std::string_view haystack, std::string_view needle, size_t pos,
+                                  size_t *resume) {
+    const size_t m = needle.size();
+    const char *h = haystack.data();
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(lower(needle.front())));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(lower(needle.back())));
+    for (; pos + m + 31u <= haystack.size(); pos += 32u) {
+        const __m256i f = load_lower(h + pos);
+        const __m256i l = load_lower(h + pos + m - 1u);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(f, first), _mm256_cmpeq_epi8(l, last))));
+        while (mask != 0u) {
+            const size_t candidate = pos + __builtin_ctz(mask);
+            if (mismatch_ignore_case_scalar(h + candidate + 1u, needle.data() + 1u, m - 2u) ==
+                m - 2u) {
+                return candidate;
+            }
+            mask &= mask - 1u;
+        }
+    }
+    *resume = pos;
+    return NPOS;
+}
+
+// Returns the first position where a and b differ, ignoring case, up to a multiple of 32; the
+// caller checks the rest.
+AVX2 size_t mismatch_ignore_case_avx2(const char *a, const char *b, size_t size) {
+    size_t i = 0u;
+    for (; i + 32u <= size; i += 32u) {
+        const uint32_t same = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(load_lower(a + i), load_lower(b + i))));
+        if (same != 0xffffffffu) {
+            return i + __builtin_ctz(~same);
+        }
+    }
+    return i;
+}
+
+#undef AVX2
+
+#endif  // HAVE_X86_SIMD
+
+// Returns the first position where a and b differ, ignoring case, or size.
+size_t mismatch_ignore_case(const char *a, const char *b, size_t size) {
+    size_t i = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        i = mismatch_ignore_case_avx2(a, b, size);
+        if (i + 32u <= size) {
+            return i;
+        }
+    }
+#endif
+    return i + mismatch_ignore_case_scalar(a + i, b + i, size - i);
+}
+
+}  // namespace
+
+Searcher::Searcher(std::string_view needle) : needle_(needle) {
+    if (needle_.size() < 2u) {
+        return;
+    }
+    size_t forward_period;
+    size_t reverse_period;
+    const ptrdiff_t forward = maximal_suffix(needle_, false, &forward_period);
+    const ptrdiff_t reverse = maximal_suffix(needle_, true, &reverse_period);
+    if (forward > reverse) {
+        critical_ = forward;
+        period_ = forward_period;
+    } else {
+        critical_ = reverse;
+        period_ = reverse_period;
+    }
+    // The needle is periodic if u is a suffix of its first period.
+    const auto u_size = static_cast<size_t>(critical_ + 1);
+    periodic_ = (period_ + u_size <= needle_.size()) &&
+                std::memcmp(needle_.data(), needle_.data() + period_, u_size) == 0;
+    if (!periodic_) {
+        // Then a safe shift is more than either half.
+        period_ = std::max(u_size, needle_.size() - u_size) + 1u;
+    }
+}
+
+size_t Searcher::find(std::string_view haystack, size_t pos) const {
+    const size_t m = needle_.size();
+    if (pos > haystack.size() || m > haystack.size() - pos) {
+        return NPOS;
+    }
+    if (m == 0u) {
+        return pos;
+    }
+    if (m == 1u) {
+        return haystack.find(needle_.front(), pos);
+    }
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        const size_t found = find_avx2(haystack, needle_, pos, &pos);
+        if (found != NPOS) {
+            return found;
+        }
+    }
+#endif
+    return find_two_way(haystack, pos);
+}
+
+size_t Searcher::find_two_way(std::string_view haystack, size_t pos) const {
+    const auto *x = reinterpret_cast<const unsigned char *>(needle_.data());
+    const auto *y = reinterpret_cast<const unsigned char *>(haystack.data());
+    const auto m = static_cast<ptrdiff_t>(needle_.size());
+    const auto n = static_cast<ptrdiff_t>(haystack.size());
+    const auto period = static_cast<ptrdiff_t>(period_);
+    auto j = static_cast<ptrdiff_t>(pos);
+    if (periodic_) {
+        // How much of the needle's start is known to match after a shift by the period.
+        ptrdiff_t memory = -1;
+        while (j <= n - m) {
+            ptrdiff_t i = std::max(critical_, memory) + 1;
+            while (i < m && x[i] == y[i + j]) {
+                ++i;
+            }
+            if (i >= m) {
+                i = critical_;
+                while (i > memory && x[i] == y[i + j]) {
+                    --i;
+                }
+                if (i <= memory) {
+                    return static_cast<size_t>(j);
+                }
+                j += period;
+                memory = m - period - 1;
+            } else {
+                j += i - critical_;
+                memory = -1;
+            }
+        }
+    } else {
+        while (j <= n - m) {
+            ptrdiff_t i = critical_ + 1;
+            while (i < m && x[i] == y[i + j]) {
+                ++i;
+            }
+            if (i >= m) {
+                i = critical_;
+                while (i >= 0 && x[i] == y[i + j]) {
+                    --i;
+                }
+                if (i < 0) {
+                    return static_cast<size_t>(j);
+                }
+                j += period;
+            } else {
+                j += i - critical_;
+            }
+        }
+    }
+    return NPOS;
+}
+
+namespace {
+
+std::string first_bytes(const std::vector<std::string_view> &patterns) {
+    std::string bytes;
+    for (std::string_view pattern : patterns) {
+        if (!pattern.empty()) {
+            bytes.push_back(pattern.front());
+        }
+    }
+    return bytes;
+}
+
+}  // namespace
+
+MultiSearcher::MultiSearcher(const std::vector<std::string_view> &patterns)
+    : patterns_(patterns.begin(), patterns.end()),
+      first_bytes_(first_bytes(patterns)),
+      starts_(257u, 0u) {
+    for (size_t i = 0u; i < patterns_.size(); ++i) {
+        if (patterns_[i].empty()) {
+            empty_pattern_ = std::min(empty_pattern_, i);
+        } else {
+            ++starts_[static_cast<unsigned char>(patterns_[i].front()) + 1u];
+        }
+    }
+    for (size_t b = 1u; b < starts_.size(); ++b) {
+        starts_[b] += starts_[b - 1u];
+    }
+    by_first_byte_.resize(starts_.back());
+    std::vector<size_t> next(starts_.begin(), starts_.end() - 1);
+    for (size_t i = 0u; i < patterns_.size(); ++i) {
+        if (!patterns_[i].empty()) {
+            by_first_byte_[next[static_cast<unsigned char>(patterns_[i].front())]++] = i;
+        }
+    }
+}
+
+size_t MultiSearcher::match_at(std::string_view haystack, size_t pos) const {
+    const auto b = static_cast<unsigned char>(haystack[pos]);
+    const std::string_view rest = haystack.substr(pos);
+    for (size_t k = starts_[b]; k < starts_[b + 1u]; ++k) {
+        const std::string &pattern = patterns_[by_first_byte_[k]];
+        if (pattern.size() <= rest.size() &&
+            std::memcmp(pattern.data(), rest.data(), pattern.size()) == 0) {
+            return by_first_byte_[k];
+        }
+    }
+    return NPOS;
+}
+
+MultiSearcher::Match MultiSearcher::find(std::string_view haystack, size_t pos) const {
+    Match match;
+    if (pos > haystack.size() || patterns_.empty()) {
+        return match;
+    }
+    if (empty_pattern_ != NPOS) {
+        // The empty pattern matches right here, but an earlier pattern might too.
+        match.position = pos;
+        match.pattern = (pos < haystack.size()) ? std::min(empty_pattern_, match_at(haystack, pos))
+                                                : empty_pattern_;
+        return match;
+    }
+    constexpr size_t BLOCK_MASKS = 4u;
+    uint64_t masks[BLOCK_MASKS];
+    for (size_t base = pos; base < haystack.size(); base += 64u * BLOCK_MASKS) {
+        const size_t size = std::min(haystack.size() - base, 64u * BLOCK_MASKS);
+        scan_separators(haystack.data() + base, size, first_bytes_, masks);
+        for (size_t w = 0u; w < (size + 63u) / 64u; ++w) {
+            for (uint64_t bits = masks[w]; bits != 0u; bits &= bits - 1u) {
+                const size_t candidate = base + 64u * w + __builtin_ctzll(bits);
+                const size_t pattern = match_at(haystack, candidate);
+                if (pattern != NPOS) {
+                    match.position = candidate;
+                    match.pattern = pattern;
+                    return match;
+                }
+            }
+        }
+    }
+    return match;
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && mismatch_ignore_case(a.data(), b.data(), a.size()) == a.size();
+}
+
+int compare_ignore_case(std::string_view a, std::string_view b) {
+    const size_t size = std::min(a.size(), b.size());
+    const size_t i = mismatch_ignore_case(a.data(), b.data(), size);
+    if (i < size) {
+        return static_cast<int>(lower(a[i])) - static_cast<int>(lower(b[i]));
+    }
+    return (a.size() < b.size()) ? -1 : (a.size() > b.size()) ? 1 : 0;
+}
+
+size_t find_ignore_case(std::string_view haystack, std::string_view needle, size_t pos) {
+    const size_t m = needle.size();
+    if (pos > haystack.size() || m > haystack.size() - pos) {
+        return NPOS;
+    }
+    if (m == 0u) {
+        return pos;
+    }
+#if HAVE_X86_SIMD
+    if (m >= 2u && cpu::has_avx2()) {
+        const size_t found = find_ignore_case_avx2(haystack, needle, pos, &pos);
+        if (found != NPOS) {
+            return found;
+        }
+    }
+#endif
+    const unsigned char first = lower(needle.front());
+    for (; pos + m <= haystack.size(); ++pos) {
+        if (lower(haystack[pos]) == first &&
+            mismatch_ignore_case_scalar(haystack.data() + pos + 1u, needle.data() + 1u, m - 1u) ==
+                m - 1u) {
+            return pos;
+        }
+    }
+    return NPOS;
+}
+
+}  // namespace string
+}  // namespace djehuti
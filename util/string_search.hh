@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/string_scan.hh"
+
+// Substring search. These find the same things std::string_view::find does, but much faster on
+// long haystacks: with AVX2 they look for the first and last bytes of the needle 32 positions
+// at a time and check only the candidates, and they switch to the Two-Way algorithm (which takes
+// time linear in the haystack whatever the needle) if the candidates turn out to be mostly
+// false alarms.
+
+namespace djehuti {
+namespace string {
+
+/// A search for one needle, prepared once and used for as many haystacks as you like. The
+/// needle must outlive the Searcher.
+class Searcher final {
+ public:
+    explicit Searcher(std::string_view needle);
+
+    /// Return the position of the first occurrence of the needle in haystack at or after pos,
+    /// or npos if there is none.
+    size_t find(std::string_view haystack, size_t pos = 0u) const;
+
+ private:
+    // Search with Two-Way, starting at pos.
+    size_t find_two_way(std::string_view haystack, size_t pos) const;
+
+    std::string_view needle_;
+    // The Two-Way factorization: the needle is split at critical_ + 1 into u and v; period_ is
+    // the period of v (of the whole needle, if periodic_).
+    ptrdiff_t critical_ = -1;
+    size_t period_ = 1u;
+    bool periodic_ = false;
+};
+
+/// Return the position of the first occurrence of needle in haystack at or after pos, or npos.
+/// (It isn't just called find so that it can't be confused with std::find.)
+inline size_t find_substring(std::string_view haystack, std::string_view needle, size_t pos = 0u) {
+    return Searcher(needle).find(haystack, pos);
+}
+
+/**
+ * A search for whichever of a small set of patterns comes first. Candidates are found by
+ * scanning for the patterns' first bytes with scan_separators(), so it works best when there
+ * are no more than SeparatorSet::MAX_VECTOR_SIZE distinct first bytes, and when they aren't
+ * too common in the haystack.
+ */
+class MultiSearcher final {
+ public:
+    struct Match {
+        /// Where the match starts, or npos if there isn't one.
+        size_t position = std::string_view::npos;
+        /// Which pattern matched: of those that match at position, the first one given.
+        size_t pattern = 0u;
+    };
+
+    explicit MultiSearcher(const std::vector<std::string_view> &patterns);
+
+    /// Return the first match in haystack at or after pos.
+    Match find(std::string_view haystack, size_t pos = 0u) const;
+
+ private:
+    // Return the first pattern that matches at pos, or npos.
+    size_t match_at(std::string_view haystack, size_t pos) const;
+
+    std::vector<std::string> patterns_;
+    SeparatorSet first_bytes_;
+    // The indexes of the patterns starting with byte b are by_first_byte_[starts_[b]] up to
+    // by_first_byte_[starts_[b + 1]], in order.
+    std::vector<size_t> by_first_byte_;
+    std::vector<size_t> starts_;
+    // The first empty pattern, if there is one (it matches everywhere).
+    size_t empty_pattern_ = std::string_view::npos;
+};
+
+/// Return true if a and b are the same, ignoring the case of ASCII letters.
+bool equals_ignore_case(std::string_view a, std::string_view b);
+
+/// Compare a and b as if all their ASCII letters were lower case, returning a negative number,
+/// zero or a positive number as a comes before, is the same as or comes after b (comparing
+/// bytes as unsigned).
+int compare_ignore_case(std::string_view a, std::string_view b);
+
+/// Return the position of the first occurrence of needle in haystack at or after pos, ignoring
+/// the case of ASCII letters, or npos. This doesn't fall back to Two-Way, so a needle whose first
+/// and last bytes are everywhere in the haystack takes time proportional to both their lengths.
+size_t find_ignore_case(std::string_view haystack, std::string_view needle, size_t pos = 0u);
+
+}  // namespace string
+}  // namespace djehuti
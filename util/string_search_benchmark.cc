@@ -0,0 +1,93 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/string_search.hh"
+
+// Substring searches on long haystacks, against std::string_view::find and glibc's memmem, with
+// ordinary needles and with adversarial ones that defeat first/last-byte filtering.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t SIZE = 16u << 20;
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string text(SIZE, ' ');
+    for (char &c : text) {
+        if (gen() % 6u != 0u) {
+            c = static_cast<char>(letter(gen));
+        }
+    }
+    const std::string needle = "needle in a haystack";
+    const std::string adversarial_text(SIZE, 'a');
+    const std::string adversarial = std::string(31u, 'a') + "b" + std::string(32u, 'a');
+
+    const auto compare = [](const std::string &label, const std::string &haystack,
+                            const std::string &needle) {
+        benchmark::run(label + ", std::string_view::find", [&] {
+            benchmark::do_not_optimize(std::string_view(haystack).find(needle));
+        }, 0u, haystack.size());
+        benchmark::run(label + ", memmem", [&] {
+            benchmark::do_not_optimize(
+                ::memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+        }, 0u, haystack.size());
+        const string::Searcher searcher(needle);
+        benchmark::run(label + ", Searcher", [&] {
+            benchmark::do_not_optimize(searcher.find(haystack));
+        }, 0u, haystack.size());
+    };
+    compare("absent", text, needle);
+    compare("adversarial", adversarial_text, adversarial);
+
+    const string::MultiSearcher multi({"ERROR", "FATAL", "panic", "Exception", "timeout"});
+    benchmark::run("MultiSearcher, 5 absent patterns", [&] {
+        benchmark::do_not_optimize(multi.find(text).position);
+    }, 0u, text.size());
+    benchmark::run("5 absent patterns, std::string_view::find each", [&] {
+        size_t first = std::string_view::npos;
+        for (std::string_view pattern : {"ERROR", "FATAL", "panic", "Exception", "timeout"}) {
+            first = std::min(first, std::string_view(text).find(pattern));
+        }
+        benchmark::do_not_optimize(first);
+    }, 0u, text.size());
+
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 0x20) : c;
+    });
+    benchmark::run("find_ignore_case, absent", [&] {
+        benchmark::do_not_optimize(string::find_ignore_case(upper, needle));
+    }, 0u, upper.size());
+    benchmark::run("equals_ignore_case, 16 MB", [&] {
+        benchmark::do_not_optimize(string::equals_ignore_case(text, upper));
+    }, 0u, text.size());
+    benchmark::run("strncasecmp, 16 MB", [&] {
+        benchmark::do_not_optimize(::strncasecmp(text.data(), upper.data(), text.size()));
+    }, 0u, text.size());
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/string_search.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace string {
+
+std::string random_string(std::mt19937_64 &gen, size_t size, const std::string &alphabet) {
+    std::uniform_int_distribution<size_t> which(0u, alphabet.size() - 1u);
+    std::string s(size, '\0');
+    for (char &c : s) {
+        c = alphabet[which(gen)];
+    }
+    return s;
+}
+
+TEST(StringSearchTests, Find) {
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(find_substring(text, "fox"), 16u);
+    EXPECT_EQ(find_substring(text, "the"), 31u);
+    EXPECT_EQ(find_substring(text, "dog"), 40u);
+    EXPECT_EQ(find_substring(text, "cat"), std::string_view::npos);
+    EXPECT_EQ(find_substring(text, "T"), 0u);
+    EXPECT_EQ(find_substring(text, ""), 0u);
+    EXPECT_EQ(find_substring(text, "", text.size()), text.size());
+    EXPECT_EQ(find_substring(text, "", text.size() + 1u), std::string_view::npos);
+    EXPECT_EQ(find_substring(text, "o", 13u), 17u);
+    EXPECT_EQ(find_substring(text, text), 0u);
+    EXPECT_EQ(find_substring("ab", "abc"), std::string_view::npos);
+
+    // A Searcher can be used again and again.
+    const Searcher searcher("o");
+    std::vector<size_t> found;
+    for (size_t pos = searcher.find(text); pos != std::string_view::npos;
+         pos = searcher.find(text, pos + 1u)) {
+        found.push_back(pos);
+    }
+    EXPECT_EQ(found, (std::vector<size_t>{12u, 17u, 26u, 41u}));
+}
+
+TEST(StringSearchTests, FindFuzz) {
+    // Small alphabets make for lots of partial matches, and periodic needles.
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<size_t> haystack_size(0u, 500u);
+    std::uniform_int_distribution<size_t> needle_size(0u, 40u);
+    for (const std::string alphabet : {"ab", "abc", "a\xff", "abcdefghijklmnopqrstuvwxyz"}) {
+        for (int trial = 0; trial < 3000; ++trial) {
+            const std::string haystack = random_string(gen, haystack_size(gen), alphabet);
+            std::string needle = random_string(gen, needle_size(gen), alphabet);
+            if (trial % 3 == 0 && !haystack.empty()) {
+                // Make sure it's there (maybe).
+                const size_t start = gen() % haystack.size();
+                needle = haystack.substr(start, needle.size());
+            }
+            const size_t pos = (trial % 5 == 0) ? gen() % (haystack.size() + 2u) : 0u;
+            ASSERT_EQ(find_substring(haystack, needle, pos),
+                      std::string_view(haystack).find(needle, pos))
+                << "'" << haystack << "' '" << needle << "' " << pos;
+        }
+    }
+}
+
+TEST(StringSearchTests, FindAdversarial) {
+    // Every position looks like a match by its first and last bytes, so this only finishes
+    // quickly (and correctly) through Two-Way.
+    const std::string haystack(1u << 20, 'a');
+    const std::string needle = std::string(100u, 'a') + "b" + std::string(100u, 'a');
+    EXPECT_EQ(find_substring(haystack, needle), std::string_view::npos);
+    const std::string with_match = haystack + needle;
+    EXPECT_EQ(find_substring(with_match, needle), haystack.size());
+    const std::string periodic = "abababababababababababababababababababab";
+    const std::string text = std::string(10000u, 'a') + "ababababababababababab" + periodic;
+    EXPECT_EQ(find_substring(text, periodic), std::string_view(text).find(periodic));
+}
+
+TEST(StringSearchTests, MultiSearcher) {
+    const MultiSearcher searcher({"ERROR", "WARN", "FATAL", "ERR"});
+    const std::string log = "INFO ok\nWARN disk\nERROR: bad\nFATAL!";
+    auto match = searcher.find(log);
+    EXPECT_EQ(match.position, 8u);
+    EXPECT_EQ(match.pattern, 1u);
+    match = searcher.find(log, match.position + 1u);
+    EXPECT_EQ(match.position, 18u);
+    EXPECT_EQ(match.pattern, 0u);  // ERR matches there too, but comes later.
+    match = searcher.find(log, match.position + 1u);
+    EXPECT_EQ(match.position, 29u);
+    EXPECT_EQ(match.pattern, 2u);
+    EXPECT_EQ(searcher.find(log, match.position + 1u).position, std::string_view::npos);
+    EXPECT_EQ(searcher.find("ERR").pattern, 3u);
+    EXPECT_EQ(searcher.find("").position, std::string_view::npos);
+
+    EXPECT_EQ(MultiSearcher({}).find("anything").position, std::string_view::npos);
+    const MultiSearcher with_empty({"x", ""});
+    EXPECT_EQ(with_empty.find("abc", 1u).position, 1u);
+    EXPECT_EQ(with_empty.find("abc", 1u).pattern, 1u);
+    EXPECT_EQ(with_empty.find("axc", 1u).pattern, 0u);
+}
+
+TEST(StringSearchTests, MultiSearcherFuzz) {
+    std::mt19937_64 gen(2u);
+    std::uniform_int_distribution<size_t> haystack_size(0u, 2000u);
+    std::uniform_int_distribution<size_t> pattern_size(1u, 6u);
+    std::uniform_int_distribution<size_t> pattern_count(1u, 20u);
+    for (int trial = 0; trial < 2000; ++trial) {
+        const std::string alphabet = (trial % 2 == 0) ? "abcd" : "abcdefghijklmnopqrstuvwxyz";
+        const std::string haystack = random_string(gen, haystack_size(gen), alphabet);
+        std::vector<std::string> patterns(pattern_count(gen));
+        for (auto &pattern : patterns) {
+            pattern = random_string(gen, pattern_size(gen), alphabet);
+        }
+        const MultiSearcher searcher(
+            std::vector<std::string_view>(patterns.begin(), patterns.end()));
+        // The first match is the least position, and then the first pattern at that position.
+        MultiSearcher::Match expected;
+        for (size_t i = 0u; i < patterns.size(); ++i) {
+            const size_t pos = haystack.find(patterns[i]);
+            if (pos < expected.position) {
+                expected.position = pos;
+                expected.pattern = i;
+            }
+        }
+        const auto match = searcher.find(haystack);
+        ASSERT_EQ(match.position, expected.position) << trial;
+        if (expected.position != std::string_view::npos) {
+            ASSERT_EQ(match.pattern, expected.pattern) << trial;
+        }
+    }
+}
+
+TEST(StringSearchTests, IgnoreCase) {
+    EXPECT_TRUE(equals_ignore_case("Content-Length", "content-length"));
+    EXPECT_TRUE(equals_ignore_case("", ""));
+    EXPECT_FALSE(equals_ignore_case("Content-Length", "Content-Lengths"));
+    EXPECT_FALSE(equals_ignore_case("[", "{"));  // They differ by 0x20, but aren't letters.
+    EXPECT_FALSE(equals_ignore_case("\xc0", "\xe0"));
+    const std::string long_a = std::string(100u, 'x') + "ABCDEFGHIJKLMNOPQRSTUVWXYZ@[`{";
+    const std::string long_b = std::string(100u, 'X') + "abcdefghijklmnopqrstuvwxyz@[`{";
+    EXPECT_TRUE(equals_ignore_case(long_a, long_b));
+
+    EXPECT_EQ(compare_ignore_case("apple", "APPLE"), 0);
+    EXPECT_LT(compare_ignore_case("apple", "Banana"), 0);
+    EXPECT_GT(compare_ignore_case("Cherry", "banana"), 0);
+    EXPECT_LT(compare_ignore_case("app", "APPLE"), 0);
+    EXPECT_GT(compare_ignore_case("apples", "APPLE"), 0);
+    EXPECT_LT(compare_ignore_case("a", "\xe9"), 0);  // Bytes compare as unsigned.
+    EXPECT_GT(compare_ignore_case(long_a + "b", long_b + "A"), 0);
+
+    const std::string header = "Host: example.com\r\nCONTENT-TYPE: text/html\r\n";
+    EXPECT_EQ(find_ignore_case(header, "content-type"), 19u);
+    EXPECT_EQ(find_ignore_case(header, "HOST"), 0u);
+    EXPECT_EQ(find_ignore_case(header, "host", 1u), std::string_view::npos);
+    EXPECT_EQ(find_ignore_case(header, "x"), 7u);
+    EXPECT_EQ(find_ignore_case(header, ""), 0u);
+}
+
+TEST(StringSearchTests, IgnoreCaseFuzz) {
+    std::mt19937_64 gen(3u);
+    std::uniform_int_distribution<size_t> haystack_size(0u, 300u);
+    std::uniform_int_distribution<size_t> needle_size(0u, 20u);
+    const std::string alphabet = "aAbB[{@`zZ";
+    const auto lower = [](std::string s) {
+        for (char &c : s) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return s;
+    };
+    for (int trial = 0; trial < 5000; ++trial) {
+        const std::string a = random_string(gen, haystack_size(gen), alphabet);
+        const std::string b = random_string(gen, needle_size(gen), alphabet);
+        ASSERT_EQ(find_ignore_case(a, b), lower(a).find(lower(b))) << a << " " << b;
+        const int compared = compare_ignore_case(a, b);
+        const int expected = lower(a).compare(lower(b));
+        ASSERT_EQ(compared < 0, expected < 0) << a << " " << b;
+        ASSERT_EQ(compared > 0, expected > 0) << a << " " << b;
+        ASSERT_EQ(equals_ignore_case(a, a), true);
+        ASSERT_EQ(equals_ignore_case(lower(a), a), true);
+    }
+}
+
+}  // namespace string
+}  // namespace djehuti
@@ -20,6 +20,10 @@
 
 #include "util/string.hh"
 
+#include <deque>
+#include <iterator>
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -35,6 +39,26 @@ TEST(StringTests, Join) {
 
     const std::vector<std::string> four{"a", "b", "c", "d"};
     EXPECT_EQ(join(four, ':'), "a:b:c:d");
+
+    const std::vector<std::string> none;
+    EXPECT_EQ(join(none, ", "), "");
+    const std::vector<std::string> empties{"", "", ""};
+    EXPECT_EQ(join(empties, ", "), ", , ");
+}
+
+TEST(StringTests, JoinRange) {
+    const std::vector<std::string_view> views{"GET", "/index.html", "HTTP/1.1"};
+    EXPECT_EQ(join(views.begin(), views.end(), " "), "GET /index.html HTTP/1.1");
+    EXPECT_EQ(joined_size(views.begin(), views.end(), " "), 24u);
+    EXPECT_EQ(join(views.begin() + 1, views.begin() + 1, " "), "");
+    EXPECT_EQ(joined_size(views.begin(), views.begin(), " "), 0u);
+
+    const char *const words[] = {"one", "two", "three"};
+    EXPECT_EQ(join(std::begin(words), std::end(words), "::"), "one::two::three");
+
+    // Splitting and joining again gives back the string without the empty parts.
+    const auto parts = split_view("::a:b:c::d::", ':');
+    EXPECT_EQ(join(parts.begin(), parts.end(), ":"), "a:b:c:d");
 }
 
 TEST(StringTests, Split) {
@@ -52,5 +76,58 @@ TEST(StringTests, Split) {
     EXPECT_THAT(four, ::testing::ContainerEq(expected_four));
 }
 
+TEST(StringTests, SplitView) {
+    using ::testing::ElementsAre;
+    using Views = std::vector<std::string_view>;
+
+    const std::string text = "::a:b:c::d::";
+    const auto parts = split_view(text, ':');
+    EXPECT_THAT(Views(parts.begin(), parts.end()), ElementsAre("a", "b", "c", "d"));
+    // The parts point into the original string.
+    EXPECT_EQ(parts.begin()->data(), text.data() + 2);
+    EXPECT_TRUE(split_view("", ':').empty());
+    EXPECT_TRUE(split_view(":::", ':').empty());
+    EXPECT_FALSE(split_view(":x:", ':').empty());
+
+    // Multi-character separators, including overlapping and partial ones.
+    const auto by_string = split_view("a::b:::c::::d:", "::");
+    EXPECT_THAT(Views(by_string.begin(), by_string.end()), ElementsAre("a", "b", ":c", "d:"));
+    const auto crlf = split_view("GET / HTTP/1.1\r\nHost: x\r\n\r\n", "\r\n");
+    EXPECT_THAT(Views(crlf.begin(), crlf.end()), ElementsAre("GET / HTTP/1.1", "Host: x"));
+    const auto no_separator = split_view("abc", "");
+    EXPECT_THAT(Views(no_separator.begin(), no_separator.end()), ElementsAre("abc"));
+
+    // Any of a set of characters.
+    const auto words = split_view(" one\ttwo \r\nthree\n", ByAnyChar(" \t\r\n"));
+    EXPECT_THAT(Views(words.begin(), words.end()), ElementsAre("one", "two", "three"));
+    const auto high = split_view("a\xff" "b\x80" "c", ByAnyChar("\x80\xff"));
+    EXPECT_THAT(Views(high.begin(), high.end()), ElementsAre("a", "b", "c"));
+
+    // The iterators are forward iterators: copies iterate independently.
+    auto it = words.begin();
+    auto copy = it++;
+    EXPECT_EQ(*copy, "one");
+    EXPECT_EQ(*it, "two");
+    EXPECT_EQ(*++copy, "two");
+    EXPECT_EQ(it, copy);
+    EXPECT_EQ(std::distance(words.begin(), words.end()), 3);
+}
+
+TEST(StringTests, SplitInto) {
+    using ::testing::ElementsAre;
+
+    std::vector<std::string_view> views{"already"};
+    EXPECT_EQ(split_into("x,,y,z", ',', &views), 3u);
+    EXPECT_THAT(views, ElementsAre("already", "x", "y", "z"));
+
+    std::deque<std::string> strings;
+    EXPECT_EQ(split_into("1 -> 2 -> 3", " -> ", &strings), 3u);
+    EXPECT_THAT(strings, ElementsAre("1", "2", "3"));
+
+    std::vector<std::string> none;
+    EXPECT_EQ(split_into(" \t ", ByAnyChar(" \t"), &none), 0u);
+    EXPECT_TRUE(none.empty());
+}
+
 }  // namespace string
 }  // namespace djehuti
@@ -30,8 +30,6 @@ constexpr double Temperature::BOILING_C;
 constexpr double Temperature::FREEZING_K;
 constexpr double Temperature::BOILING_K;
 constexpr double Temperature::BODY_TEMP_C;
-constexpr double Temperature::KF_FACTOR;
-constexpr double Temperature::FK_FACTOR;
 
 const Temperature &Temperature::freezing() {
     static const Temperature freeze(FREEZING_K);
@@ -24,6 +24,7 @@
 #include <iostream>
 
 #include "util/math.hh"
+#include "util/quantity.hh"
 
 namespace djehuti {
 
@@ -59,6 +60,12 @@ class Temperature final {
     /// Return the temperature expressed in degrees Fahrenheit.
     constexpr double fahrenheit() const { return Temperature::k_to_f(kelvin_); }
 
+    /// Return the temperature as a Quantity in the given unit (units::Celsius, ...).
+    template <typename U>
+    constexpr Quantity<U> as() const {
+        return Quantity<units::Kelvin>(kelvin_);
+    }
+
     /// Return a Temperature from a Kelvin measurement.
     static constexpr Temperature from_kelvin(double k) { return Temperature(k); }
 
@@ -75,6 +82,12 @@ class Temperature final {
         return Temperature(Temperature::f_to_k(f));
     }
 
+    /// Return a Temperature from a Quantity in any temperature unit.
+    template <typename U>
+    static constexpr Temperature from_quantity(const Quantity<U> &temp) {
+        return Temperature(temp.template in<units::Kelvin>());
+    }
+
     /// Returns the freezing point of water at standard sea level.
     static const Temperature &freezing();
 
@@ -97,7 +110,9 @@ class Temperature final {
     /// Returns a new Temperature, offset from this by the given centigrade measure (= Celsius).
     constexpr Temperature plus_centigrade(double c) const { return plus_kelvin(c); }
     /// Returns a new Temperature, offset from this by the given Fahrenheit measure.
-    constexpr Temperature plus_fahrenheit(double f) const { return plus_kelvin(f * FK_FACTOR); }
+    constexpr Temperature plus_fahrenheit(double f) const {
+        return plus_kelvin(units::convert_difference<units::Fahrenheit, units::Kelvin>(f));
+    }
 
     /// Returns a new Temperature, offset from this by the given Kelvin measure.
     constexpr Temperature minus_kelvin(double k) const { return plus_kelvin(-k); }
@@ -154,20 +169,18 @@ class Temperature final {
     static constexpr double BOILING_K = FREEZING_K + (BOILING_C - FREEZING_C);
     static constexpr double BODY_TEMP_C = 37.0;
 
-    // Conversion factors.
-    static constexpr double KF_FACTOR = ((BOILING_F - FREEZING_F) / (BOILING_K - FREEZING_K));
-    static constexpr double FK_FACTOR = ((BOILING_K - FREEZING_K) / (BOILING_F - FREEZING_F));
-
     // Internal unit conversions.
-    static inline constexpr double c_to_k(double c) { return c + (FREEZING_K - FREEZING_C); }
-    static inline constexpr double k_to_c(double k) { return k + (FREEZING_C - FREEZING_K); }
-
+    static inline constexpr double c_to_k(double c) {
+        return units::convert<units::Celsius, units::Kelvin>(c);
+    }
+    static inline constexpr double k_to_c(double k) {
+        return units::convert<units::Kelvin, units::Celsius>(k);
+    }
     static inline constexpr double f_to_k(double f) {
-        return (f - FREEZING_F) * FK_FACTOR + FREEZING_K;
+        return units::convert<units::Fahrenheit, units::Kelvin>(f);
     }
-
     static inline constexpr double k_to_f(double k) {
-        return (k - FREEZING_K) * KF_FACTOR + FREEZING_F;
+        return units::convert<units::Kelvin, units::Fahrenheit>(k);
     }
 
     // Return the ios_base storage index for the format selector for Temperature.
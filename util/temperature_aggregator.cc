@@ -0,0 +1,303 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_aggregator.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace djehuti {
+
+namespace {
+
+// How many times a reader tries for a consistent copy of a bucket that is being written to
+// before it settles for what it has.
+constexpr unsigned MAX_READ_ATTEMPTS = 4u;
+
+// The epoch of a bucket that has never been written.
+constexpr int64_t NO_EPOCH = std::numeric_limits<int64_t>::min();
+
+// Division rounding toward negative infinity, so that negative timestamps bucket correctly.
+int64_t floor_div(int64_t a, int64_t b) {
+    const int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1u;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// Spread sensor ids over the table (the splitmix64 finalizer).
+uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31);
+}
+
+}  // namespace
+
+// One time bucket of one sensor's window. Only the lane's Writer changes it: seq is odd while
+// it is being changed, and the fields are atomics only so that readers may look at them.
+struct TemperatureAggregator::Bucket {
+    std::atomic<uint32_t> seq{0u};
+    std::atomic<int64_t> epoch{NO_EPOCH};
+    std::atomic<uint32_t> count{0u};
+    std::atomic<double> min{INFINITY};
+    std::atomic<double> max{-INFINITY};
+    std::atomic<double> sum{0.0};
+};
+
+// One sensor's window in one lane: its ring of buckets, and their histograms end to end.
+struct TemperatureAggregator::Window {
+    Window(uint64_t sensor, size_t num_buckets, size_t num_bins)
+        : id(sensor),
+          buckets(new Bucket[num_buckets]),
+          bins(new std::atomic<uint32_t>[num_buckets * num_bins]()) {}
+
+    const uint64_t id;
+    std::unique_ptr<Bucket[]> buckets;
+    std::unique_ptr<std::atomic<uint32_t>[]> bins;
+};
+
+// A lane is one Writer's table of Windows, open-addressed with linear probing. The Writer only
+// ever adds to it (publishing each new Window with a release store), so readers can probe it.
+struct TemperatureAggregator::Lane {
+    explicit Lane(size_t max_sensors)
+        : mask(round_up_pow2(2u * max_sensors) - 1u),
+          table(new std::atomic<Window *>[mask + 1u]()) {}
+
+    ~Lane() {
+        for (size_t i = 0u; i <= mask; ++i) {
+            delete table[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Return the sensor's Window, or nullptr if this lane has none.
+    Window *find(uint64_t sensor) const {
+        for (size_t i = mix(sensor) & mask;; i = (i + 1u) & mask) {
+            Window *window = table[i].load(std::memory_order_acquire);
+            if (window == nullptr || window->id == sensor) {
+                return window;
+            }
+        }
+    }
+
+    const size_t mask;
+    std::unique_ptr<std::atomic<Window *>[]> table;
+    // The rest belong to the Writer.
+    std::atomic<bool> in_use{false};
+    size_t num_windows = 0u;
+};
+
+TemperatureAggregator::TemperatureAggregator() : TemperatureAggregator(Options()) {}
+
+TemperatureAggregator::TemperatureAggregator(const Options &options) : options_(options) {
+    options_.bucket_width = std::max<int64_t>(options_.bucket_width, 1);
+    options_.num_buckets = std::max<size_t>(options_.num_buckets, 1u);
+    options_.histogram_bins = std::max<size_t>(options_.histogram_bins, 1u);
+    for (size_t i = 0u; i < options_.max_writers; ++i) {
+        lanes_.emplace_back(new Lane(options_.max_sensors));
+    }
+}
+
+TemperatureAggregator::~TemperatureAggregator() = default;
+
+TemperatureAggregator::Writer TemperatureAggregator::writer() {
+    for (auto &lane : lanes_) {
+        bool expected = false;
+        if (!lane->in_use.load(std::memory_order_relaxed) &&
+            lane->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return Writer(this, lane.get());
+        }
+    }
+    return Writer();
+}
+
+TemperatureAggregator::Writer::~Writer() {
+    if (lane_ != nullptr) {
+        lane_->in_use.store(false, std::memory_order_release);
+    }
+}
+
+TemperatureAggregator::Writer::Writer(Writer &&other) noexcept
+    : aggregator_(other.aggregator_), lane_(other.lane_) {
+    other.lane_ = nullptr;
+}
+
+TemperatureAggregator::Writer &TemperatureAggregator::Writer::operator=(Writer &&other) noexcept {
+    if (this != &other) {
+        if (lane_ != nullptr) {
+            lane_->in_use.store(false, std::memory_order_release);
+        }
+        aggregator_ = other.aggregator_;
+        lane_ = other.lane_;
+        other.lane_ = nullptr;
+    }
+    return *this;
+}
+
+bool TemperatureAggregator::Writer::add(uint64_t sensor, int64_t time, const Temperature &temp) {
+    if (lane_ == nullptr || !std::isfinite(temp.kelvin())) {
+        return false;  // A NaN would have no histogram bin, and either would spoil the sum.
+    }
+    const Options &options = aggregator_->options_;
+    Lane &lane = *lane_;
+
+    // Find the sensor's Window, making it if need be.
+    Window *window = nullptr;
+    for (size_t i = mix(sensor) & lane.mask;; i = (i + 1u) & lane.mask) {
+        window = lane.table[i].load(std::memory_order_relaxed);
+        if (window == nullptr) {
+            if (lane.num_windows == options.max_sensors) {
+                return false;
+            }
+            window = new Window(sensor, options.num_buckets, options.histogram_bins);
+            lane.table[i].store(window, std::memory_order_release);
+            ++lane.num_windows;
+            break;
+        }
+        if (window->id == sensor) {
+            break;
+        }
+    }
+
+    const int64_t epoch = floor_div(time, options.bucket_width);
+    const auto num_buckets = static_cast<int64_t>(options.num_buckets);
+    const size_t slot = static_cast<size_t>(((epoch % num_buckets) + num_buckets) % num_buckets);
+    Bucket &bucket = window->buckets[slot];
+    std::atomic<uint32_t> *bins = &window->bins[slot * options.histogram_bins];
+    const int64_t bucket_epoch = bucket.epoch.load(std::memory_order_relaxed);
+    if (bucket_epoch > epoch) {
+        return false;
+    }
+
+    const double kelvin = temp.kelvin();
+    const double bin_width = (options.histogram_max.kelvin() - options.histogram_min.kelvin()) /
+                             options.histogram_bins;
+    const double position = (kelvin - options.histogram_min.kelvin()) / bin_width;
+    const size_t bin = (position <= 0.0) ? 0u
+                       : (position >= options.histogram_bins - 1u)
+                           ? options.histogram_bins - 1u
+                           : static_cast<size_t>(position);
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    const uint32_t seq = bucket.seq.load(relaxed);
+    bucket.seq.store(seq + 1u, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (bucket_epoch != epoch) {
+        // The bucket held an older time; start it over.
+        bucket.epoch.store(epoch, relaxed);
+        bucket.count.store(0u, relaxed);
+        bucket.min.store(INFINITY, relaxed);
+        bucket.max.store(-INFINITY, relaxed);
+        bucket.sum.store(0.0, relaxed);
+        for (size_t i = 0u; i < options.histogram_bins; ++i) {
+            bins[i].store(0u, relaxed);
+        }
+    }
+    bucket.count.store(bucket.count.load(relaxed) + 1u, relaxed);
+    bucket.min.store(std::min(bucket.min.load(relaxed), kelvin), relaxed);
+    bucket.max.store(std::max(bucket.max.load(relaxed), kelvin), relaxed);
+    bucket.sum.store(bucket.sum.load(relaxed) + kelvin, relaxed);
+    bins[bin].store(bins[bin].load(relaxed) + 1u, relaxed);
+    bucket.seq.store(seq + 2u, std::memory_order_release);
+    return true;
+}
+
+TemperatureAggregator::Snapshot TemperatureAggregator::snapshot(uint64_t sensor,
+                                                                int64_t now) const {
+    Snapshot snapshot;
+    const size_t num_bins = options_.histogram_bins;
+    snapshot.histogram.assign(num_bins, 0u);
+    snapshot.histogram_min_kelvin = options_.histogram_min.kelvin();
+    snapshot.bin_width_kelvin =
+        (options_.histogram_max.kelvin() - options_.histogram_min.kelvin()) / num_bins;
+
+    const int64_t last_epoch = floor_div(now, options_.bucket_width);
+    const int64_t first_epoch = last_epoch - static_cast<int64_t>(options_.num_buckets) + 1;
+    std::vector<uint32_t> bins(num_bins);
+    constexpr auto relaxed = std::memory_order_relaxed;
+    for (const auto &lane : lanes_) {
+        const Window *window = lane->find(sensor);
+        if (window == nullptr) {
+            continue;
+        }
+        for (size_t slot = 0u; slot < options_.num_buckets; ++slot) {
+            const Bucket &bucket = window->buckets[slot];
+            const std::atomic<uint32_t> *bucket_bins = &window->bins[slot * num_bins];
+            int64_t epoch;
+            uint32_t count;
+            double min, max, sum;
+            for (unsigned attempt = 1u;; ++attempt) {
+                const uint32_t seq = bucket.seq.load(std::memory_order_acquire);
+                epoch = bucket.epoch.load(relaxed);
+                count = bucket.count.load(relaxed);
+                min = bucket.min.load(relaxed);
+                max = bucket.max.load(relaxed);
+                sum = bucket.sum.load(relaxed);
+                if (epoch >= first_epoch && epoch <= last_epoch) {
+                    for (size_t i = 0u; i < num_bins; ++i) {
+                        bins[i] = bucket_bins[i].load(relaxed);
+                    }
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (((seq & 1u) == 0u && bucket.seq.load(relaxed) == seq) ||
+                    attempt == MAX_READ_ATTEMPTS) {
+                    break;
+                }
+            }
+            if (epoch < first_epoch || epoch > last_epoch || count == 0u) {
+                continue;
+            }
+            snapshot.count += count;
+            snapshot.min = std::min(snapshot.min, Temperature::from_kelvin(min));
+            snapshot.max = std::max(snapshot.max, Temperature::from_kelvin(max));
+            snapshot.kelvin_sum += sum;
+            for (size_t i = 0u; i < num_bins; ++i) {
+                snapshot.histogram[i] += bins[i];
+            }
+        }
+    }
+    return snapshot;
+}
+
+Temperature TemperatureAggregator::Snapshot::percentile(double percent) const {
+    if (count == 0u) {
+        return Temperature::from_kelvin(NAN);
+    }
+    const double target = std::min(std::max(percent, 0.0), 100.0) / 100.0 * count;
+    double seen = 0.0;
+    size_t bin = 0u;
+    for (; bin + 1u < histogram.size() && seen + histogram[bin] < target; ++bin) {
+        seen += histogram[bin];
+    }
+    const double fraction = (histogram[bin] == 0u) ? 0.0 : (target - seen) / histogram[bin];
+    const double kelvin = histogram_min_kelvin + (bin + fraction) * bin_width_kelvin;
+    // The ends of the histogram hold everything beyond them, so the true extremes are better.
+    return std::min(std::max(Temperature::from_kelvin(kelvin), min), max);
+}
+
+}  // namespace djehuti
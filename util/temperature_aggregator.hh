@@ -0,0 +1,155 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "util/temperature.hh"
+
+namespace djehuti {
+
+/**
+ * A TemperatureAggregator keeps rolling-window statistics (count, min, max, mean and
+ * percentiles) of the Temperatures reported by many sensors, fed by many threads at once.
+ *
+ * Each ingest thread takes a Writer, which owns a lane of the aggregator: its own table of
+ * per-sensor windows, so adding a sample never contends with other threads and never waits.
+ * A window is a ring of num_buckets buckets of bucket_width time units each; a bucket that
+ * comes around again is cleared by the next sample that lands in it. Each bucket is guarded
+ * by a sequence counter that only its writer changes, so readers take snapshots without
+ * blocking writers, and retry a bucket a bounded number of times, so without waiting for them
+ * either. The price is that a bucket whose writer was busy with it (or was preempted in the
+ * middle of updating it) for all of those tries may be seen with its latest samples counted in
+ * some statistics and not yet in others.
+ *
+ * Memory is allocated when a lane first sees a sensor, so it is proportional to the number of
+ * (lane, sensor) pairs actually in use. Ingest threads that each handle their own sensors use
+ * the least.
+ */
+class TemperatureAggregator final {
+ public:
+    struct Options {
+        /// The width of each time bucket, in the units of the timestamps passed to add().
+        int64_t bucket_width = 1;
+        /// The number of buckets in each window.
+        size_t num_buckets = 60u;
+        /// The most Writers that can exist at once.
+        size_t max_writers = 64u;
+        /// The most sensors that each Writer can report on.
+        size_t max_sensors = 4096u;
+        /// The range of the histograms used for percentiles (samples outside are clamped).
+        Temperature histogram_min = Temperature::from_celsius(-50.0);
+        Temperature histogram_max = Temperature::from_celsius(150.0);
+        /// The number of histogram bins; more bins give more precise percentiles.
+        size_t histogram_bins = 200u;
+    };
+
+    /// The statistics for one sensor's window. With no samples, min is hotter than anything,
+    /// max is colder than anything, and the mean and percentiles are NaN.
+    struct Snapshot {
+        size_t count = 0u;
+        Temperature min = Temperature::from_kelvin(INFINITY);
+        Temperature max = Temperature::from_kelvin(-INFINITY);
+        double kelvin_sum = 0.0;
+        std::vector<uint64_t> histogram;
+        double histogram_min_kelvin = 0.0;
+        double bin_width_kelvin = 0.0;
+
+        /// Return the mean of the samples.
+        Temperature mean() const { return Temperature::from_kelvin(kelvin_sum / count); }
+
+        /// Return the given percentile (0 to 100) of the samples, interpolated within the
+        /// histogram bin that it falls in.
+        Temperature percentile(double percent) const;
+    };
+
+    class Writer;
+
+    /// Create an aggregator with the default Options.
+    TemperatureAggregator();
+    /// Create an aggregator with the given Options.
+    explicit TemperatureAggregator(const Options &options);
+    ~TemperatureAggregator();
+
+    // Neither copyable nor movable (Writers point to it).
+    TemperatureAggregator(const TemperatureAggregator &) = delete;
+    TemperatureAggregator(TemperatureAggregator &&) = delete;
+    TemperatureAggregator &operator=(const TemperatureAggregator &) = delete;
+    TemperatureAggregator &operator=(TemperatureAggregator &&) = delete;
+
+    /// Return the aggregator's Options.
+    const Options &options() const { return options_; }
+
+    /// Return a Writer for the calling thread to use, or an empty one if there are already
+    /// max_writers Writers. A lane is reused (with its data) once its Writer is destroyed.
+    Writer writer();
+
+    /// Return the statistics for the given sensor over the window ending at now (the
+    /// num_buckets buckets up to and including the one that now falls in).
+    Snapshot snapshot(uint64_t sensor, int64_t now) const;
+
+ private:
+    struct Bucket;
+    struct Window;
+    struct Lane;
+
+    Options options_;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+};
+
+/// A Writer adds samples to a TemperatureAggregator. Each one should be used by only one
+/// thread at a time; it can be moved to another thread.
+class TemperatureAggregator::Writer final {
+ public:
+    /// An empty Writer, which can't add anything.
+    Writer() = default;
+    ~Writer();
+
+    // Movable, not copyable.
+    Writer(const Writer &) = delete;
+    Writer(Writer &&other) noexcept;
+    Writer &operator=(const Writer &) = delete;
+    Writer &operator=(Writer &&other) noexcept;
+
+    /// Returns true unless the Writer is empty.
+    explicit operator bool() const { return lane_ != nullptr; }
+
+    /// Add a sample for the given sensor at the given time. Returns false (and adds nothing) if
+    /// the Writer is empty, if the temperature is infinite or NaN, if it already has max_sensors
+    /// other sensors, or if the sample is too old for the bucket it belongs in (which has already
+    /// moved on to a later time).
+    bool add(uint64_t sensor, int64_t time, const Temperature &temp);
+
+ private:
+    friend class TemperatureAggregator;
+
+    Writer(const TemperatureAggregator *aggregator, Lane *lane)
+        : aggregator_(aggregator), lane_(lane) {}
+
+    const TemperatureAggregator *aggregator_ = nullptr;
+    Lane *lane_ = nullptr;
+};
+
+}  // namespace djehuti
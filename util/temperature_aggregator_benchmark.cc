@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/temperature.hh"
+#include "util/temperature_aggregator.hh"
+
+// Ingest throughput from 1 to 64 threads, each feeding its own share of the sensors (the way
+// ingest usually splits), and then every thread feeding every sensor.
+
+namespace djehuti {
+namespace {
+
+constexpr size_t SAMPLES_PER_THREAD = 200000u;
+constexpr uint64_t SENSORS = 1024u;
+
+void ingest(TemperatureAggregator &aggregator, unsigned threads, bool shared_sensors) {
+    std::vector<std::thread> workers;
+    for (unsigned t = 0u; t < threads; ++t) {
+        workers.emplace_back([&aggregator, t, threads, shared_sensors] {
+            auto writer = aggregator.writer();
+            const uint64_t per_thread = shared_sensors ? SENSORS : SENSORS / threads;
+            const uint64_t first = shared_sensors ? 0u : t * per_thread;
+            for (size_t i = 0u; i < SAMPLES_PER_THREAD; ++i) {
+                writer.add(first + i % per_thread, static_cast<int64_t>(i / 1000u),
+                           Temperature::from_kelvin(250.0 + static_cast<double>(i % 100u)));
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace
+}  // namespace djehuti
+
+int main() {
+    using namespace djehuti;
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    for (bool shared : {false, true}) {
+        for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+            TemperatureAggregator aggregator;
+            ingest(aggregator, threads, shared);  // Warm up (allocate the windows).
+            const std::string name = std::string(shared ? "shared" : "own") + " sensors, " +
+                                     std::to_string(threads) + " threads";
+            benchmark::run(name, [&] { ingest(aggregator, threads, shared); },
+                           threads * SAMPLES_PER_THREAD);
+        }
+    }
+
+    TemperatureAggregator aggregator;
+    ingest(aggregator, 8u, true);
+    benchmark::run("snapshot, 8 lanes", [&] {
+        auto snapshot = aggregator.snapshot(1u, 199);
+        benchmark::do_not_optimize(snapshot);
+    });
+    return 0;
+}
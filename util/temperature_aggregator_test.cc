@@ -0,0 +1,199 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_aggregator.hh"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+TEST(TemperatureAggregatorTests, Basic) {
+    TemperatureAggregator aggregator;
+    auto writer = aggregator.writer();
+    ASSERT_TRUE(writer);
+
+    auto snapshot = aggregator.snapshot(7u, 100);
+    EXPECT_EQ(snapshot.count, 0u);
+    EXPECT_TRUE(std::isnan(snapshot.percentile(50.0).kelvin()));
+
+    // 1 to 100 degrees Celsius, spread over the last ten seconds.
+    for (int c = 1; c <= 100; ++c) {
+        EXPECT_TRUE(writer.add(7u, 91 + c % 10, Temperature::from_celsius(c)));
+    }
+    writer.add(8u, 100, Temperature::boiling());
+
+    snapshot = aggregator.snapshot(7u, 100);
+    EXPECT_EQ(snapshot.count, 100u);
+    EXPECT_TRUE(snapshot.min.almost_equal(Temperature::from_celsius(1.0)));
+    EXPECT_TRUE(snapshot.max.almost_equal(Temperature::from_celsius(100.0)));
+    EXPECT_TRUE(snapshot.mean().almost_equal(Temperature::from_celsius(50.5)));
+    // The default histogram has one-degree bins.
+    EXPECT_NEAR(snapshot.percentile(50.0).celsius(), 50.0, 1.0);
+    EXPECT_NEAR(snapshot.percentile(90.0).celsius(), 90.0, 1.0);
+    EXPECT_EQ(snapshot.percentile(0.0), snapshot.min);
+    EXPECT_EQ(snapshot.percentile(100.0), snapshot.max);
+
+    EXPECT_EQ(aggregator.snapshot(8u, 100).count, 1u);
+    EXPECT_EQ(aggregator.snapshot(9u, 100).count, 0u);
+}
+
+TEST(TemperatureAggregatorTests, RollingWindow) {
+    TemperatureAggregator::Options options;
+    options.bucket_width = 10;
+    options.num_buckets = 6;  // One minute of ten-second buckets.
+    TemperatureAggregator aggregator(options);
+    auto writer = aggregator.writer();
+
+    // One sample a second from time -30 on, at (time + 100) Kelvin.
+    for (int64_t t = -30; t < 120; ++t) {
+        ASSERT_TRUE(writer.add(1u, t, Temperature::from_kelvin(t + 100.0)));
+    }
+    // The window ending at 119 is the buckets [60, 120).
+    auto snapshot = aggregator.snapshot(1u, 119);
+    EXPECT_EQ(snapshot.count, 60u);
+    EXPECT_EQ(snapshot.min.kelvin(), 160.0);
+    EXPECT_EQ(snapshot.max.kelvin(), 219.0);
+    // The window ending at 75 is the buckets [20, 80), but [20, 60) have been reused.
+    EXPECT_EQ(aggregator.snapshot(1u, 75).count, 20u);
+    // And far in the future, there's nothing.
+    EXPECT_EQ(aggregator.snapshot(1u, 1000).count, 0u);
+
+    // Too late for a bucket that has moved on; but fine for the current ones.
+    EXPECT_FALSE(writer.add(1u, 50, Temperature::freezing()));
+    EXPECT_TRUE(writer.add(1u, 110, Temperature::freezing()));
+    EXPECT_EQ(aggregator.snapshot(1u, 119).count, 61u);
+
+    // Negative times go in the right buckets too.
+    for (int64_t t = -60; t < 0; ++t) {
+        ASSERT_TRUE(writer.add(2u, t, Temperature::freezing()));
+    }
+    EXPECT_EQ(aggregator.snapshot(2u, -1).count, 60u);
+    EXPECT_EQ(aggregator.snapshot(2u, -11).count, 50u);
+}
+
+TEST(TemperatureAggregatorTests, Limits) {
+    TemperatureAggregator::Options options;
+    options.max_writers = 2u;
+    options.max_sensors = 3u;
+    TemperatureAggregator aggregator(options);
+    {
+        auto first = aggregator.writer();
+        auto second = aggregator.writer();
+        auto third = aggregator.writer();
+        EXPECT_TRUE(first);
+        EXPECT_TRUE(second);
+        EXPECT_FALSE(third);
+        EXPECT_FALSE(third.add(1u, 0, Temperature::freezing()));
+
+        for (uint64_t sensor = 0u; sensor < 3u; ++sensor) {
+            EXPECT_TRUE(first.add(sensor, 0, Temperature::freezing()));
+        }
+        EXPECT_FALSE(first.add(3u, 0, Temperature::freezing()));
+        EXPECT_TRUE(first.add(2u, 0, Temperature::freezing()));
+        EXPECT_TRUE(second.add(3u, 0, Temperature::freezing()));
+
+        auto moved = std::move(first);
+        EXPECT_FALSE(first);
+        EXPECT_TRUE(moved);
+    }
+    // The lanes are free again, and keep their data.
+    auto writer = aggregator.writer();
+    EXPECT_TRUE(writer);
+    EXPECT_EQ(aggregator.snapshot(2u, 0).count, 2u);
+    EXPECT_EQ(aggregator.snapshot(3u, 0).count, 1u);
+}
+
+TEST(TemperatureAggregatorTests, NonFinite) {
+    TemperatureAggregator aggregator;
+    auto writer = aggregator.writer();
+    EXPECT_FALSE(writer.add(1u, 0, Temperature::from_kelvin(std::nan(""))));
+    EXPECT_FALSE(writer.add(1u, 0, Temperature::from_kelvin(INFINITY)));
+    EXPECT_FALSE(writer.add(1u, 0, Temperature::from_celsius(-INFINITY)));
+    EXPECT_TRUE(writer.add(1u, 0, Temperature::freezing()));
+
+    const auto snapshot = aggregator.snapshot(1u, 0);
+    EXPECT_EQ(snapshot.count, 1u);
+    EXPECT_EQ(snapshot.max, Temperature::freezing());
+    EXPECT_EQ(snapshot.mean(), Temperature::freezing());
+}
+
+TEST(TemperatureAggregatorTests, Stress) {
+    constexpr int THREADS = 8;
+    constexpr int SAMPLES = 200000;
+    constexpr uint64_t SENSORS = 16u;
+    TemperatureAggregator::Options options;
+    options.histogram_bins = 16u;
+    TemperatureAggregator aggregator(options);
+
+    std::atomic<bool> done(false);
+    std::atomic<int> bad_snapshots(0);
+    std::thread reader([&] {
+        std::vector<size_t> last_count(SENSORS, 0u);
+        while (!done.load()) {
+            for (uint64_t sensor = 0u; sensor < SENSORS; ++sensor) {
+                const auto snapshot = aggregator.snapshot(sensor, 59);
+                // Nothing rotates out, so counts only go up. (The other statistics can be a
+                // sample or two out of step with the count, if a writer was mid-update.)
+                bool ok = snapshot.count >= last_count[sensor];
+                if (snapshot.count != 0u) {
+                    ok = ok && snapshot.min <= snapshot.max;
+                }
+                if (!ok) {
+                    ++bad_snapshots;
+                }
+                last_count[sensor] = snapshot.count;
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([&aggregator, t] {
+            auto writer = aggregator.writer();
+            for (int i = 0; i < SAMPLES; ++i) {
+                // Whole Kelvins from 250 to 349, so that the sums are exact.
+                writer.add(static_cast<uint64_t>(i) % SENSORS, i % 60,
+                           Temperature::from_kelvin(250 + (i + t) % 100));
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(bad_snapshots.load(), 0);
+
+    size_t total = 0u;
+    for (uint64_t sensor = 0u; sensor < SENSORS; ++sensor) {
+        const auto snapshot = aggregator.snapshot(sensor, 59);
+        total += snapshot.count;
+        EXPECT_EQ(snapshot.min.kelvin(), 250.0);
+        EXPECT_EQ(snapshot.max.kelvin(), 349.0);
+    }
+    EXPECT_EQ(total, static_cast<size_t>(THREADS) * SAMPLES);
+}
+
+}  // namespace djehuti
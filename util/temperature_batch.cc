@@ -0,0 +1,315 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_batch.hh"
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace batch {
+
+// Columns of Temperatures are loaded and stored as columns of Kelvin.
+static_assert(sizeof(Temperature) == sizeof(double) && std::is_standard_layout<Temperature>::value,
+              "A Temperature must be laid out as just its Kelvin");
+
+namespace {
+
+/**
+ * Each of Temperature's conversions to or from Kelvin, as (x - sub) * mul + add, so that one loop
+ * can do any of them. The constants are the ones that Temperature's own conversions use (from
+ * util/quantity.hh), and subtracting zero and multiplying by one are exact, which is what makes
+ * the vectorized results bit-for-bit equal to the scalar ones.
+ */
+struct TemperatureKernels {
+    struct Step {
+        bool skip;  // Kelvin needs no conversion at all (and x + 0 would turn -0 into +0).
+        double sub;
+        double mul;
+        double add;
+    };
+
+    struct Conversion {
+        TemperatureScale from;
+        TemperatureScale to;
+        Step to_kelvin;
+        Step from_kelvin;
+        double from_per_degree;
+        double to_per_degree;
+    };
+
+    template <typename From, typename To>
+    static constexpr Step step() {
+        using C = units::Conversion<From, To>;
+        // A ratio like 1/100 would be a divide in the scalar code.
+        static_assert(C::ratio::num != 1 || C::ratio::den == 1, "The kernels only multiply");
+        return {std::is_same<From, To>::value, C::subtrahend, C::multiplier, C::addend};
+    }
+
+    static constexpr Step to_kelvin(TemperatureScale from) {
+        switch (from) {
+            case TemperatureScale::CELSIUS:
+                return step<units::Celsius, units::Kelvin>();
+            case TemperatureScale::FAHRENHEIT:
+                return step<units::Fahrenheit, units::Kelvin>();
+            default:
+                return step<units::Kelvin, units::Kelvin>();
+        }
+    }
+
+    static constexpr Step from_kelvin(TemperatureScale to) {
+        switch (to) {
+            case TemperatureScale::CELSIUS:
+                return step<units::Kelvin, units::Celsius>();
+            case TemperatureScale::FAHRENHEIT:
+                return step<units::Kelvin, units::Fahrenheit>();
+            default:
+                return step<units::Kelvin, units::Kelvin>();
+        }
+    }
+
+    static constexpr double apply(const Step &step, double x) {
+        return step.skip ? x : (x - step.sub) * step.mul + step.add;
+    }
+
+    static constexpr Conversion conversion(TemperatureScale from, int32_t from_per_degree,
+                                           TemperatureScale to, int32_t to_per_degree) {
+        return {from,
+                to,
+                to_kelvin(from),
+                from_kelvin(to),
+                static_cast<double>(from_per_degree),
+                static_cast<double>(to_per_degree)};
+    }
+
+    // The scalar conversion goes through the Temperature class itself.
+    static double convert(const Conversion &conv, double x) {
+        Temperature temp;
+        switch (conv.from) {
+            case TemperatureScale::CELSIUS:
+                temp = Temperature::from_celsius(x);
+                break;
+            case TemperatureScale::FAHRENHEIT:
+                temp = Temperature::from_fahrenheit(x);
+                break;
+            default:
+                temp = Temperature::from_kelvin(x);
+                break;
+        }
+        switch (conv.to) {
+            case TemperatureScale::CELSIUS:
+                return temp.celsius();
+            case TemperatureScale::FAHRENHEIT:
+                return temp.fahrenheit();
+            default:
+                return temp.kelvin();
+        }
+    }
+};
+
+using Conversion = TemperatureKernels::Conversion;
+
+// Make sure that the Steps really do mirror the Temperature class.
+constexpr bool mirrors(TemperatureScale from, TemperatureScale to, double x, double expected) {
+    return TemperatureKernels::apply(
+               TemperatureKernels::from_kelvin(to),
+               TemperatureKernels::apply(TemperatureKernels::to_kelvin(from), x)) == expected;
+}
+static_assert(mirrors(TemperatureScale::FAHRENHEIT, TemperatureScale::CELSIUS, 98.6,
+                      Temperature::from_fahrenheit(98.6).celsius()),
+              "F to C doesn't match Temperature");
+static_assert(mirrors(TemperatureScale::CELSIUS, TemperatureScale::FAHRENHEIT, 37.1,
+                      Temperature::from_celsius(37.1).fahrenheit()),
+              "C to F doesn't match Temperature");
+static_assert(mirrors(TemperatureScale::KELVIN, TemperatureScale::KELVIN, -0.0,
+                      Temperature::from_kelvin(-0.0).kelvin()),
+              "K to K doesn't match Temperature");
+
+constexpr double INT32_LO = std::numeric_limits<int32_t>::min();
+constexpr double INT32_HI = std::numeric_limits<int32_t>::max();
+
+template <typename T>
+inline double widen(const Conversion &conv, T x) {
+    if constexpr (std::is_integral<T>::value) {
+        return static_cast<double>(x) / conv.from_per_degree;
+    } else {
+        return static_cast<double>(x);
+    }
+}
+
+template <typename T>
+inline T narrow(const Conversion &conv, double x) {
+    if constexpr (std::is_integral<T>::value) {
+        x *= conv.to_per_degree;
+        // Clamp the way the vector code does; NaNs fail the first comparison.
+        if (!(x >= INT32_LO)) {
+            x = INT32_LO;
+        } else if (x > INT32_HI) {
+            x = INT32_HI;
+        }
+        return static_cast<T>(std::nearbyint(x));
+    } else {
+        return static_cast<T>(x);
+    }
+}
+
+// The scalar version, for CPUs without AVX2 and for the leftovers after the last full vector.
+template <typename In, typename Out>
+void convert_scalar(const Conversion &conv, const In *in, size_t count, Out *out) {
+    for (size_t i = 0u; i < count; ++i) {
+        out[i] = narrow<Out>(conv, TemperatureKernels::convert(conv, widen(conv, in[i])));
+    }
+}
+
+#if HAVE_X86_SIMD
+
+// No FMA here: fusing the multiply and add would round differently from the scalar class.
+#define AVX2 __attribute__((target("avx2")))
+
+constexpr size_t LANES = 4u;
+
+AVX2 inline __m256d splat(double d) { return _mm256_set1_pd(d); }
+
+AVX2 inline __m256d load(const double *p) { return _mm256_loadu_pd(p); }
+AVX2 inline __m256d load(const float *p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+AVX2 inline __m256d load(const int32_t *p) {
+    return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+AVX2 inline void store(double *p, __m256d v) { _mm256_storeu_pd(p, v); }
+AVX2 inline void store(float *p, __m256d v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+AVX2 inline void store(int32_t *p, __m256d v) {
+    // MAXPD returns its second operand when either is NaN, so NaNs clamp to the bottom.
+    v = _mm256_min_pd(_mm256_max_pd(v, splat(INT32_LO)), splat(INT32_HI));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_cvtpd_epi32(v));
+}
+
+// A Step with its constants already splatted.
+struct VectorStep {
+    AVX2 explicit VectorStep(const TemperatureKernels::Step &step)
+        : sub(splat(step.sub)), mul(splat(step.mul)), add(splat(step.add)) {}
+
+    AVX2 __m256d operator()(__m256d x) const {
+        return _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(x, sub), mul), add);
+    }
+
+    __m256d sub;
+    __m256d mul;
+    __m256d add;
+};
+
+// Each of these returns the number of elements that it handled. The steps to be skipped are
+// template parameters so that the loop has no branches in it.
+
+template <bool TO_KELVIN, bool FROM_KELVIN, typename In, typename Out>
+AVX2 size_t convert_avx2(const Conversion &conv, const In *in, size_t count, Out *out) {
+    const VectorStep to_kelvin(conv.to_kelvin);
+    const VectorStep from_kelvin(conv.from_kelvin);
+    const __m256d from_per_degree = splat(conv.from_per_degree);
+    const __m256d to_per_degree = splat(conv.to_per_degree);
+    size_t i = 0u;
+    for (; i + LANES <= count; i += LANES) {
+        __m256d x = load(in + i);
+        if constexpr (std::is_integral<In>::value) {
+            x = _mm256_div_pd(x, from_per_degree);
+        }
+        if constexpr (TO_KELVIN) {
+            x = to_kelvin(x);
+        }
+        if constexpr (FROM_KELVIN) {
+            x = from_kelvin(x);
+        }
+        if constexpr (std::is_integral<Out>::value) {
+            x = _mm256_mul_pd(x, to_per_degree);
+        }
+        store(out + i, x);
+    }
+    return i;
+}
+
+template <typename In, typename Out>
+AVX2 size_t convert_avx2(const Conversion &conv, const In *in, size_t count, Out *out) {
+    if (conv.to_kelvin.skip) {
+        return conv.from_kelvin.skip ? convert_avx2<false, false>(conv, in, count, out)
+                                     : convert_avx2<false, true>(conv, in, count, out);
+    }
+    return conv.from_kelvin.skip ? convert_avx2<true, false>(conv, in, count, out)
+                                 : convert_avx2<true, true>(conv, in, count, out);
+}
+
+#endif  // HAVE_X86_SIMD
+
+template <typename In, typename Out>
+void convert_any(const Conversion &conv, const In *in, size_t count, Out *out) {
+    size_t done = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        done = convert_avx2(conv, in, count, out);
+    }
+#endif
+    convert_scalar(conv, in + done, count - done, out + done);
+}
+
+}  // namespace
+
+void convert(TemperatureScale from, TemperatureScale to, const double *in, size_t count,
+             double *out) {
+    convert_any(TemperatureKernels::conversion(from, 1, to, 1), in, count, out);
+}
+
+void convert(TemperatureScale from, TemperatureScale to, const float *in, size_t count,
+             float *out) {
+    convert_any(TemperatureKernels::conversion(from, 1, to, 1), in, count, out);
+}
+
+void convert(TemperatureScale from, int32_t from_per_degree, TemperatureScale to,
+             int32_t to_per_degree, const int32_t *in, size_t count, int32_t *out) {
+    convert_any(TemperatureKernels::conversion(from, from_per_degree, to, to_per_degree), in,
+                count, out);
+}
+
+void convert(TemperatureScale from, int32_t from_per_degree, TemperatureScale to,
+             const int32_t *in, size_t count, double *out) {
+    convert_any(TemperatureKernels::conversion(from, from_per_degree, to, 1), in, count, out);
+}
+
+void convert(TemperatureScale from, TemperatureScale to, int32_t to_per_degree,
+             const double *in, size_t count, int32_t *out) {
+    convert_any(TemperatureKernels::conversion(from, 1, to, to_per_degree), in, count, out);
+}
+
+void to_scale(const Temperature *temps, size_t count, TemperatureScale to, double *out) {
+    convert(TemperatureScale::KELVIN, to, reinterpret_cast<const double *>(temps), count, out);
+}
+
+void from_scale(TemperatureScale from, const double *in, size_t count, Temperature *temps) {
+    convert(from, TemperatureScale::KELVIN, in, count, reinterpret_cast<double *>(temps));
+}
+
+}  // namespace batch
+}  // namespace djehuti
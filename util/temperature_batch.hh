@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util/temperature.hh"
+
+// Batch unit conversions over columns of temperatures. Every result is bit-for-bit what the
+// Temperature class gives one value at a time (for example, converting Celsius to Fahrenheit
+// gives Temperature::from_celsius(x).fahrenheit()), but these use AVX2 when the CPU has it.
+// Input and output arrays may be the same array (where the element types match), but must not
+// otherwise overlap.
+
+namespace djehuti {
+
+/// The scales that a column of temperatures can be expressed in.
+enum class TemperatureScale {
+    KELVIN,
+    CELSIUS,
+    FAHRENHEIT,
+};
+
+namespace batch {
+
+/// Convert count temperatures from one scale to another.
+void convert(TemperatureScale from, TemperatureScale to, const double *in, size_t count,
+             double *out);
+
+/// Convert count temperatures from one scale to another. The arithmetic is done in double, and
+/// rounded to float only at the end.
+void convert(TemperatureScale from, TemperatureScale to, const float *in, size_t count,
+             float *out);
+
+// Scaled-integer columns hold whole numbers of 1/per_degree degrees; for instance, with
+// per_degree = 100, 3715 is 37.15 degrees. A scaled integer x is read as (x / per_degree), and
+// a result y is written as y * per_degree rounded to the nearest integer (ties to even).
+// Results outside the range of int32_t saturate, and NaNs are written as INT32_MIN.
+
+/// Convert count scaled-integer temperatures from one scale to another.
+void convert(TemperatureScale from, int32_t from_per_degree, TemperatureScale to,
+             int32_t to_per_degree, const int32_t *in, size_t count, int32_t *out);
+
+/// Convert count scaled-integer temperatures to doubles in another scale.
+void convert(TemperatureScale from, int32_t from_per_degree, TemperatureScale to,
+             const int32_t *in, size_t count, double *out);
+
+/// Convert count double temperatures to scaled integers in another scale.
+void convert(TemperatureScale from, TemperatureScale to, int32_t to_per_degree,
+             const double *in, size_t count, int32_t *out);
+
+/// Express count Temperatures in the given scale.
+void to_scale(const Temperature *temps, size_t count, TemperatureScale to, double *out);
+
+/// Make count Temperatures from values in the given scale.
+void from_scale(TemperatureScale from, const double *in, size_t count, Temperature *temps);
+
+}  // namespace batch
+}  // namespace djehuti
@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/temperature.hh"
+#include "util/temperature_batch.hh"
+
+// The batch temperature conversions against the equivalent one-at-a-time loops.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 4096u;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-40.0, 50.0);
+    std::vector<double> celsius(COUNT);
+    std::vector<float> celsius_f(COUNT);
+    std::vector<int32_t> centi_celsius(COUNT);
+    for (size_t i = 0u; i < COUNT; ++i) {
+        celsius[i] = dist(gen);
+        celsius_f[i] = static_cast<float>(celsius[i]);
+        centi_celsius[i] = static_cast<int32_t>(celsius[i] * 100.0);
+    }
+    std::vector<double> out(COUNT);
+    std::vector<float> out_f(COUNT);
+    std::vector<int32_t> out_i(COUNT);
+    constexpr auto C = TemperatureScale::CELSIUS;
+    constexpr auto F = TemperatureScale::FAHRENHEIT;
+
+    benchmark::run("C to F one at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            out[i] = Temperature::from_celsius(celsius[i]).fahrenheit();
+        }
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT, COUNT * sizeof(double));
+    benchmark::run("batch::convert C to F, double", [&] {
+        batch::convert(C, F, celsius.data(), COUNT, out.data());
+        benchmark::do_not_optimize(out[0]);
+    }, COUNT, COUNT * sizeof(double));
+    benchmark::run("batch::convert C to F, float", [&] {
+        batch::convert(C, F, celsius_f.data(), COUNT, out_f.data());
+        benchmark::do_not_optimize(out_f[0]);
+    }, COUNT, COUNT * sizeof(float));
+    benchmark::run("C to F centi-degrees one at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            const double f = Temperature::from_celsius(centi_celsius[i] / 100.0).fahrenheit();
+            out_i[i] = static_cast<int32_t>(std::nearbyint(f * 100.0));
+        }
+        benchmark::do_not_optimize(out_i[0]);
+    }, COUNT, COUNT * sizeof(int32_t));
+    benchmark::run("batch::convert C to F, centi-degrees", [&] {
+        batch::convert(C, 100, F, 100, centi_celsius.data(), COUNT, out_i.data());
+        benchmark::do_not_optimize(out_i[0]);
+    }, COUNT, COUNT * sizeof(int32_t));
+    return 0;
+}
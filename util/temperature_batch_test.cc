@@ -0,0 +1,202 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_batch.hh"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace batch {
+
+// Odd sizes so that there are leftovers after the last full vector.
+constexpr size_t COUNT = 10007u;
+
+constexpr TemperatureScale SCALES[] = {
+    TemperatureScale::KELVIN,
+    TemperatureScale::CELSIUS,
+    TemperatureScale::FAHRENHEIT,
+};
+
+// The one-at-a-time answer, straight from the Temperature class.
+double expected(TemperatureScale from, TemperatureScale to, double x) {
+    Temperature temp;
+    switch (from) {
+        case TemperatureScale::KELVIN:
+            temp = Temperature::from_kelvin(x);
+            break;
+        case TemperatureScale::CELSIUS:
+            temp = Temperature::from_celsius(x);
+            break;
+        case TemperatureScale::FAHRENHEIT:
+            temp = Temperature::from_fahrenheit(x);
+            break;
+    }
+    switch (to) {
+        case TemperatureScale::KELVIN:
+            return temp.kelvin();
+        case TemperatureScale::CELSIUS:
+            return temp.celsius();
+        case TemperatureScale::FAHRENHEIT:
+            return temp.fahrenheit();
+    }
+    return 0.0;
+}
+
+int32_t expected_scaled(double y, int32_t per_degree) {
+    y *= per_degree;
+    if (!(y >= std::numeric_limits<int32_t>::min())) {
+        return std::numeric_limits<int32_t>::min();
+    }
+    if (y > std::numeric_limits<int32_t>::max()) {
+        return std::numeric_limits<int32_t>::max();
+    }
+    return static_cast<int32_t>(std::nearbyint(y));
+}
+
+template <typename T>
+bool same_bits(T a, T b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+std::vector<double> test_values() {
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-500.0, 1500.0);
+    std::vector<double> values = {0.0, -0.0, 273.15, -273.15, 32.0, -40.0, 98.6, 1e300, -1e300,
+                                  std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<double>::denorm_min()};
+    while (values.size() < COUNT) {
+        values.push_back(dist(gen));
+    }
+    return values;
+}
+
+TEST(TemperatureBatchTests, Doubles) {
+    const auto in = test_values();
+    std::vector<double> out(COUNT);
+    for (auto from : SCALES) {
+        for (auto to : SCALES) {
+            convert(from, to, in.data(), COUNT, out.data());
+            for (size_t i = 0u; i < COUNT; ++i) {
+                ASSERT_TRUE(same_bits(out[i], expected(from, to, in[i])))
+                    << in[i] << " " << static_cast<int>(from) << "->" << static_cast<int>(to);
+            }
+        }
+    }
+
+    // In place, and NaN stays NaN.
+    std::vector<double> values = {98.6, NAN, 212.0, -459.67, 50.0};
+    convert(TemperatureScale::FAHRENHEIT, TemperatureScale::CELSIUS, values.data(),
+            values.size(), values.data());
+    EXPECT_TRUE(same_bits(values[0], Temperature::from_fahrenheit(98.6).celsius()));
+    EXPECT_TRUE(std::isnan(values[1]));
+    EXPECT_DOUBLE_EQ(values[2], 100.0);
+    EXPECT_NEAR(values[3], -273.15, 1e-12);
+    EXPECT_DOUBLE_EQ(values[4], 10.0);
+}
+
+TEST(TemperatureBatchTests, Floats) {
+    const auto values = test_values();
+    std::vector<float> in(values.begin(), values.end());
+    std::vector<float> out(COUNT);
+    for (auto from : SCALES) {
+        for (auto to : SCALES) {
+            convert(from, to, in.data(), COUNT, out.data());
+            for (size_t i = 0u; i < COUNT; ++i) {
+                const auto want = static_cast<float>(expected(from, to, in[i]));
+                ASSERT_TRUE(same_bits(out[i], want)) << in[i];
+            }
+        }
+    }
+}
+
+TEST(TemperatureBatchTests, ScaledIntegers) {
+    std::mt19937_64 gen(2u);
+    std::uniform_int_distribution<int32_t> dist(-50000, 150000);
+    std::vector<int32_t> in = {0, 1, -1, 27315, -27315, 3700, 5, -5, 15, 25,
+                               std::numeric_limits<int32_t>::max(),
+                               std::numeric_limits<int32_t>::min()};
+    while (in.size() < COUNT) {
+        in.push_back(dist(gen));
+    }
+    std::vector<int32_t> out(COUNT);
+    std::vector<double> doubles(COUNT);
+    for (int32_t from_per : {1, 10, 100}) {
+        for (int32_t to_per : {1, 100, 1000000}) {
+            for (auto from : SCALES) {
+                for (auto to : SCALES) {
+                    convert(from, from_per, to, to_per, in.data(), COUNT, out.data());
+                    for (size_t i = 0u; i < COUNT; ++i) {
+                        const double y = expected(from, to, static_cast<double>(in[i]) / from_per);
+                        ASSERT_EQ(out[i], expected_scaled(y, to_per)) << in[i];
+                    }
+                }
+            }
+        }
+    }
+
+    // Centi-degrees Celsius to doubles in Fahrenheit, and back to deci-degrees.
+    convert(TemperatureScale::CELSIUS, 100, TemperatureScale::FAHRENHEIT, in.data(), COUNT,
+            doubles.data());
+    for (size_t i = 0u; i < COUNT; ++i) {
+        ASSERT_TRUE(same_bits(doubles[i], Temperature::from_celsius(in[i] / 100.0).fahrenheit()));
+    }
+    convert(TemperatureScale::FAHRENHEIT, TemperatureScale::CELSIUS, 10, doubles.data(), COUNT,
+            out.data());
+    for (size_t i = 0u; i < COUNT; ++i) {
+        ASSERT_EQ(out[i],
+                  expected_scaled(Temperature::from_fahrenheit(doubles[i]).celsius(), 10));
+    }
+
+    // Saturation, rounding ties to even, and NaN.
+    const std::vector<double> edges = {1e12, -1e12, 0.25, 0.75, -0.25, 0.125, NAN, INFINITY};
+    std::vector<int32_t> scaled(edges.size());
+    convert(TemperatureScale::KELVIN, TemperatureScale::KELVIN, 10, edges.data(), edges.size(),
+            scaled.data());
+    EXPECT_EQ(scaled[0], std::numeric_limits<int32_t>::max());
+    EXPECT_EQ(scaled[1], std::numeric_limits<int32_t>::min());
+    EXPECT_EQ(scaled[2], 2);
+    EXPECT_EQ(scaled[3], 8);
+    EXPECT_EQ(scaled[4], -2);
+    EXPECT_EQ(scaled[5], 1);
+    EXPECT_EQ(scaled[6], std::numeric_limits<int32_t>::min());
+    EXPECT_EQ(scaled[7], std::numeric_limits<int32_t>::max());
+}
+
+TEST(TemperatureBatchTests, TemperatureArrays) {
+    const auto values = test_values();
+    std::vector<Temperature> temps(COUNT);
+    from_scale(TemperatureScale::FAHRENHEIT, values.data(), COUNT, temps.data());
+    std::vector<double> out(COUNT);
+    to_scale(temps.data(), COUNT, TemperatureScale::CELSIUS, out.data());
+    for (size_t i = 0u; i < COUNT; ++i) {
+        ASSERT_TRUE(same_bits(temps[i].kelvin(), Temperature::from_fahrenheit(values[i]).kelvin()));
+        ASSERT_TRUE(same_bits(out[i], temps[i].celsius()));
+    }
+}
+
+}  // namespace batch
+}  // namespace djehuti
@@ -0,0 +1,321 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_series.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace djehuti {
+
+constexpr size_t TemperatureSeries::DEFAULT_SAMPLES_PER_BLOCK;
+
+namespace {
+
+// The format of a block: the first timestamp and the first reading's bits, 64 bits each, and
+// then for each further sample its timestamp and then its reading.
+//
+// A timestamp is encoded as the change in the delta from the previous sample (dod):
+//   0                  dod == 0
+//   10   + 7 bits      dod in [-64, 63]
+//   110  + 9 bits      dod in [-256, 255]
+//   1110 + 12 bits     dod in [-2048, 2047]
+//   1111 + 64 bits     anything else
+// A reading is encoded as x, its bits XOR the previous reading's bits:
+//   0                  x == 0 (the same reading)
+//   10   + bits        x fits in the previous window; just its meaningful bits
+//   11   + 5 bits of leading zeros + 6 bits of (length - 1) + length meaningful bits
+
+// No XOR window yet.
+constexpr unsigned NO_WINDOW = 64u;
+// The most leading zeros that fit in the 5-bit field.
+constexpr unsigned MAX_LEADING = 31u;
+
+// The (control bits, number of control bits, number of value bits) for each dod size class.
+struct DodClass {
+    uint64_t control;
+    unsigned control_bits;
+    unsigned value_bits;
+};
+constexpr DodClass DOD_CLASSES[] = {
+    {0b10u, 2u, 7u},
+    {0b110u, 3u, 9u},
+    {0b1110u, 4u, 12u},
+    {0b1111u, 4u, 64u},
+};
+
+inline uint64_t double_bits(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+inline double bits_double(uint64_t bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+inline int64_t sign_extend(uint64_t value, unsigned bits) {
+    return static_cast<int64_t>(value << (64u - bits)) >> (64u - bits);
+}
+
+// Reads a bitstream written by TemperatureSeries::put. It relies on the zero word at the end.
+class BitReader final {
+ public:
+    explicit BitReader(const uint64_t *words) : words_(words) {}
+
+    // The next 64 bits, without consuming them.
+    uint64_t peek() const {
+        const size_t word = pos_ >> 6;
+        const unsigned offset = pos_ & 63u;
+        uint64_t bits = words_[word] << offset;
+        if (offset != 0u) {
+            bits |= words_[word + 1u] >> (64u - offset);
+        }
+        return bits;
+    }
+
+    void skip(unsigned n) { pos_ += n; }
+
+    // Consume and return the next n (1 to 64) bits.
+    uint64_t read(unsigned n) {
+        const uint64_t bits = peek() >> (64u - n);
+        pos_ += n;
+        return bits;
+    }
+
+ private:
+    const uint64_t *words_;
+    size_t pos_ = 0u;
+};
+
+}  // namespace
+
+TemperatureSeries::TemperatureSeries(size_t samples_per_block)
+    : samples_per_block_(std::max<size_t>(samples_per_block, 1u)) {}
+
+void TemperatureSeries::put(uint64_t value, unsigned n) {
+    Block &block = blocks_.back();
+    if (n < 64u) {
+        value &= (uint64_t{1} << n) - 1u;
+    }
+    const size_t word = block.bits >> 6;
+    const unsigned free = 64u - (block.bits & 63u);
+    if (block.words.size() < word + 3u) {
+        block.words.resize(word + 3u);  // The next word or two, and the padding.
+    }
+    if (n <= free) {
+        block.words[word] |= value << (free - n);
+    } else {
+        block.words[word] |= value >> (n - free);
+        block.words[word + 1u] |= value << (64u - (n - free));
+    }
+    block.bits += n;
+}
+
+void TemperatureSeries::start_block(int64_t time, const Temperature &temp) {
+    if (!blocks_.empty()) {
+        // The full block won't grow any more.
+        Block &full = blocks_.back();
+        full.words.resize(((full.bits + 63u) >> 6) + 1u);
+        full.words.shrink_to_fit();
+    }
+    blocks_.emplace_back();
+    Block &block = blocks_.back();
+    block.first_time = time;
+    block.words.reserve(16u);
+    prev_bits_ = double_bits(temp.kelvin());
+    put(static_cast<uint64_t>(time), 64u);
+    put(prev_bits_, 64u);
+    prev_delta_ = 0;
+    prev_leading_ = NO_WINDOW;
+    prev_trailing_ = 0u;
+}
+
+bool TemperatureSeries::append(int64_t time, const Temperature &temp) {
+    if (size_ != 0u && time < prev_time_) {
+        return false;
+    }
+    if (blocks_.empty() || blocks_.back().summary.count == samples_per_block_) {
+        start_block(time, temp);
+    } else {
+        // Unsigned, so that wildly spaced timestamps wrap instead of overflowing.
+        const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(time) -
+                                                   static_cast<uint64_t>(prev_time_));
+        const int64_t dod = static_cast<int64_t>(static_cast<uint64_t>(delta) -
+                                                 static_cast<uint64_t>(prev_delta_));
+        if (dod == 0) {
+            put(0u, 1u);
+        } else {
+            for (const auto &dod_class : DOD_CLASSES) {
+                const int64_t limit = int64_t{1} << (dod_class.value_bits - 1u);
+                if (dod_class.value_bits == 64u || (dod >= -limit && dod < limit)) {
+                    put(dod_class.control, dod_class.control_bits);
+                    put(static_cast<uint64_t>(dod), dod_class.value_bits);
+                    break;
+                }
+            }
+        }
+        prev_delta_ = delta;
+
+        const uint64_t bits = double_bits(temp.kelvin());
+        const uint64_t x = bits ^ prev_bits_;
+        if (x == 0u) {
+            put(0u, 1u);
+        } else {
+            const unsigned leading = std::min<unsigned>(__builtin_clzll(x), MAX_LEADING);
+            const unsigned trailing = __builtin_ctzll(x);
+            if (prev_leading_ != NO_WINDOW && leading >= prev_leading_ &&
+                trailing >= prev_trailing_) {
+                put(0b10u, 2u);
+                put(x >> prev_trailing_, 64u - prev_leading_ - prev_trailing_);
+            } else {
+                const unsigned length = 64u - leading - trailing;
+                put(0b11u, 2u);
+                put(leading, 5u);
+                put(length - 1u, 6u);
+                put(x >> trailing, length);
+                prev_leading_ = leading;
+                prev_trailing_ = trailing;
+            }
+        }
+        prev_bits_ = bits;
+    }
+    Block &block = blocks_.back();
+    block.last_time = time;
+    block.summary.add(temp);
+    prev_time_ = time;
+    ++size_;
+    return true;
+}
+
+size_t TemperatureSeries::memory_bytes() const {
+    size_t bytes = sizeof(*this) + blocks_.capacity() * sizeof(Block);
+    for (const auto &block : blocks_) {
+        bytes += block.words.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+void TemperatureSeries::decode_block(size_t block, int64_t *times, Temperature *temps) const {
+    const Block &b = blocks_[block];
+    const size_t count = b.summary.count;
+    BitReader reader(b.words.data());
+    uint64_t time = reader.read(64u);
+    uint64_t bits = reader.read(64u);
+    times[0] = static_cast<int64_t>(time);
+    temps[0] = Temperature::from_kelvin(bits_double(bits));
+
+    uint64_t delta = 0u;
+    unsigned leading = 0u;
+    unsigned length = 0u;
+    for (size_t i = 1u; i < count; ++i) {
+        uint64_t peek = reader.peek();
+        if (peek >> 63) {
+            // The number of leading ones (up to four) picks the class.
+            const unsigned ones = std::min<unsigned>(__builtin_clzll(~peek), 4u);
+            const DodClass &dod_class = DOD_CLASSES[ones - 1u];
+            reader.skip(dod_class.control_bits);
+            delta += static_cast<uint64_t>(
+                sign_extend(reader.read(dod_class.value_bits), dod_class.value_bits));
+        } else {
+            reader.skip(1u);
+        }
+        time += delta;
+        times[i] = static_cast<int64_t>(time);
+
+        peek = reader.peek();
+        if (peek >> 63) {
+            if ((peek >> 62) == 0b11u) {
+                // A new window: 2 control bits, 5 of leading zeros, 6 of length - 1.
+                leading = (peek >> 57) & 31u;
+                length = ((peek >> 51) & 63u) + 1u;
+                reader.skip(13u);
+            } else {
+                reader.skip(2u);
+            }
+            bits ^= reader.read(length) << (64u - leading - length);
+        } else {
+            reader.skip(1u);
+        }
+        temps[i] = Temperature::from_kelvin(bits_double(bits));
+    }
+}
+
+size_t TemperatureSeries::read_block(size_t block, int64_t begin, int64_t end,
+                                     std::vector<int64_t> *times,
+                                     std::vector<Temperature> *temps) const {
+    // Decode the whole block onto the ends of the vectors, then trim it to the range.
+    const size_t start = times->size();
+    const size_t count = block_size(block);
+    times->resize(start + count);
+    temps->resize(start + count);
+    decode_block(block, times->data() + start, temps->data() + start);
+    const auto first = std::lower_bound(times->begin() + start, times->end(), begin);
+    const auto last = std::lower_bound(first, times->end(), end);
+    const size_t skip = first - (times->begin() + start);
+    const size_t kept = last - first;
+    if (skip != 0u) {
+        std::copy(first, last, times->begin() + start);
+        std::copy(temps->begin() + start + skip, temps->begin() + start + skip + kept,
+                  temps->begin() + start);
+    }
+    times->resize(start + kept);
+    temps->resize(start + kept);
+    return kept;
+}
+
+size_t TemperatureSeries::read(int64_t begin, int64_t end, std::vector<int64_t> *times,
+                               std::vector<Temperature> *temps) const {
+    // The blocks are in time order, so find the first one that ends at or after begin.
+    auto it = std::lower_bound(
+        blocks_.begin(), blocks_.end(), begin,
+        [](const Block &block, int64_t time) { return block.last_time < time; });
+    size_t total = 0u;
+    for (; it != blocks_.end() && it->first_time < end; ++it) {
+        total += read_block(it - blocks_.begin(), begin, end, times, temps);
+    }
+    return total;
+}
+
+TemperatureSeries::Summary TemperatureSeries::summarize(int64_t begin, int64_t end) const {
+    Summary summary;
+    auto it = std::lower_bound(
+        blocks_.begin(), blocks_.end(), begin,
+        [](const Block &block, int64_t time) { return block.last_time < time; });
+    std::vector<int64_t> times;
+    std::vector<Temperature> temps;
+    for (; it != blocks_.end() && it->first_time < end; ++it) {
+        if (it->first_time >= begin && it->last_time < end) {
+            summary.merge(it->summary);  // The whole block is in range; no need to decode it.
+        } else {
+            times.clear();
+            temps.clear();
+            read_block(it - blocks_.begin(), begin, end, &times, &temps);
+            for (const auto &temp : temps) {
+                summary.add(temp);
+            }
+        }
+    }
+    return summary;
+}
+
+}  // namespace djehuti
@@ -0,0 +1,149 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "util/temperature.hh"
+
+namespace djehuti {
+
+/**
+ * A TemperatureSeries is an append-only, in-memory series of timestamped Temperatures, stored
+ * compressed the way Facebook's Gorilla does it: timestamps as deltas of deltas, and readings
+ * as the XOR of each with the one before. A steady once-a-second probe whose reading changes
+ * every few samples takes a byte or two per sample instead of sixteen.
+ *
+ * Samples are grouped into blocks of up to samples_per_block. Each block also keeps the first
+ * and last timestamps and the min/max/mean of its readings, so time-range queries and
+ * summaries only decode the blocks at the edges of the range. Timestamps are in whatever units
+ * the caller likes, and must not decrease.
+ */
+class TemperatureSeries final {
+ public:
+    /// This is the default number of samples per block.
+    static constexpr size_t DEFAULT_SAMPLES_PER_BLOCK = 1024u;
+
+    /// The summary statistics of some samples. With no samples, min is hotter than anything,
+    /// max is colder than anything, and the mean is NaN.
+    struct Summary {
+        size_t count = 0u;
+        Temperature min = Temperature::from_kelvin(INFINITY);
+        Temperature max = Temperature::from_kelvin(-INFINITY);
+        double kelvin_sum = 0.0;
+
+        /// Return the mean of the samples.
+        Temperature mean() const { return Temperature::from_kelvin(kelvin_sum / count); }
+
+        /// Add one sample.
+        void add(const Temperature &temp) {
+            ++count;
+            min = (temp < min) ? temp : min;
+            max = (max < temp) ? temp : max;
+            kelvin_sum += temp.kelvin();
+        }
+
+        /// Add all of the other Summary's samples.
+        void merge(const Summary &other) {
+            count += other.count;
+            min = (other.min < min) ? other.min : min;
+            max = (max < other.max) ? other.max : max;
+            kelvin_sum += other.kelvin_sum;
+        }
+    };
+
+    /// Create an empty series.
+    explicit TemperatureSeries(size_t samples_per_block = DEFAULT_SAMPLES_PER_BLOCK);
+    ~TemperatureSeries() = default;
+
+    // Copyable and movable.
+    TemperatureSeries(const TemperatureSeries &) = default;
+    TemperatureSeries(TemperatureSeries &&) = default;
+    TemperatureSeries &operator=(const TemperatureSeries &) = default;
+    TemperatureSeries &operator=(TemperatureSeries &&) = default;
+
+    /// Append a sample. Returns false (and appends nothing) if time is before the last sample.
+    bool append(int64_t time, const Temperature &temp);
+
+    /// The number of samples in the series.
+    size_t size() const { return size_; }
+    /// Returns true if there are no samples in the series.
+    bool empty() const { return size_ == 0u; }
+    /// The approximate number of bytes of memory that the series is using.
+    size_t memory_bytes() const;
+
+    /// The number of blocks in the series. Only the last one is still being appended to.
+    size_t num_blocks() const { return blocks_.size(); }
+    /// The number of samples in the given block.
+    size_t block_size(size_t block) const { return blocks_[block].summary.count; }
+    /// The timestamp of the first sample in the given block.
+    int64_t block_first_time(size_t block) const { return blocks_[block].first_time; }
+    /// The timestamp of the last sample in the given block.
+    int64_t block_last_time(size_t block) const { return blocks_[block].last_time; }
+    /// The summary of the samples in the given block.
+    const Summary &block_summary(size_t block) const { return blocks_[block].summary; }
+    /// Decode the given block into block_size(block) times and temps.
+    void decode_block(size_t block, int64_t *times, Temperature *temps) const;
+
+    /// Append the samples with begin <= time < end to times and temps. Returns how many there
+    /// were.
+    size_t read(int64_t begin, int64_t end, std::vector<int64_t> *times,
+                std::vector<Temperature> *temps) const;
+
+    /// Summarize the samples with begin <= time < end.
+    Summary summarize(int64_t begin, int64_t end) const;
+
+ private:
+    struct Block {
+        int64_t first_time = 0;
+        int64_t last_time = 0;
+        Summary summary;
+        // The bitstream, most significant bit first, always followed by a zero word so that
+        // the decoder can read 64 bits from any position without checking.
+        std::vector<uint64_t> words;
+        size_t bits = 0u;
+    };
+
+    // Append n (at most 64) bits to the last block.
+    void put(uint64_t value, unsigned n);
+    // Start a new block with the given sample.
+    void start_block(int64_t time, const Temperature &temp);
+    // Decode the parts of the given block with begin <= time < end, appending them.
+    size_t read_block(size_t block, int64_t begin, int64_t end, std::vector<int64_t> *times,
+                      std::vector<Temperature> *temps) const;
+
+    size_t samples_per_block_;
+    size_t size_ = 0u;
+    std::vector<Block> blocks_;
+
+    // The encoder's state for the last block: the previous timestamp and delta, the previous
+    // reading's bits, and the position of the last explicitly-written XOR window.
+    int64_t prev_time_ = 0;
+    int64_t prev_delta_ = 0;
+    uint64_t prev_bits_ = 0u;
+    unsigned prev_leading_ = 0u;
+    unsigned prev_trailing_ = 0u;
+};
+
+}  // namespace djehuti
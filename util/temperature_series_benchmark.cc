@@ -0,0 +1,91 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/temperature.hh"
+#include "util/temperature_series.hh"
+
+// Compression ratio, and encoding, decoding and summary speeds, for a day of once-a-second
+// readings from a probe that drifts a hundredth of a degree every few seconds.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 86400u;
+    std::mt19937_64 gen(1u);
+    std::vector<int64_t> times;
+    std::vector<Temperature> temps;
+    int64_t time = 1560000000;
+    int centi = 2150;
+    for (size_t i = 0u; i < COUNT; ++i) {
+        time += (gen() % 100u == 0u) ? 2 : 1;
+        if (gen() % 8u == 0u) {
+            centi += static_cast<int>(gen() % 9u) - 4;
+        }
+        times.push_back(time);
+        temps.push_back(Temperature::from_celsius(centi / 100.0));
+    }
+
+    TemperatureSeries series;
+    for (size_t i = 0u; i < COUNT; ++i) {
+        series.append(times[i], temps[i]);
+    }
+    const size_t raw = COUNT * (sizeof(int64_t) + sizeof(Temperature));
+    std::printf("%zu samples: %zu bytes raw, %zu compressed (%.1fx, %.2f bytes/sample)\n", COUNT,
+                raw, series.memory_bytes(), static_cast<double>(raw) / series.memory_bytes(),
+                static_cast<double>(series.memory_bytes()) / COUNT);
+
+    benchmark::run("append", [&] {
+        TemperatureSeries s;
+        for (size_t i = 0u; i < COUNT; ++i) {
+            s.append(times[i], temps[i]);
+        }
+        benchmark::do_not_optimize(s);
+    }, COUNT);
+
+    // Throughput is measured in bytes of decoded output.
+    std::vector<int64_t> out_times(COUNT);
+    std::vector<Temperature> out_temps(COUNT);
+    benchmark::run("decode_block, all blocks", [&] {
+        size_t done = 0u;
+        for (size_t b = 0u; b < series.num_blocks(); ++b) {
+            series.decode_block(b, out_times.data() + done, out_temps.data() + done);
+            done += series.block_size(b);
+        }
+        benchmark::do_not_optimize(out_temps[0]);
+    }, COUNT, raw);
+
+    benchmark::run("read, middle half", [&] {
+        out_times.clear();
+        out_temps.clear();
+        series.read(times[COUNT / 4u], times[3u * COUNT / 4u], &out_times, &out_temps);
+        benchmark::do_not_optimize(out_temps[0]);
+    }, COUNT / 2u, raw / 2u);
+
+    benchmark::run("summarize, middle half", [&] {
+        auto summary = series.summarize(times[COUNT / 4u], times[3u * COUNT / 4u]);
+        benchmark::do_not_optimize(summary);
+    }, COUNT / 2u);
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/temperature_series.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+// A probe read once a second (with an occasional hiccup), in centi-degrees Celsius, that
+// drifts a little every few seconds.
+void probe_samples(size_t count, std::vector<int64_t> *times, std::vector<Temperature> *temps) {
+    std::mt19937_64 gen(1u);
+    std::uniform_int_distribution<int> change(-4, 4);
+    int64_t time = 1560000000;
+    int centi = 2150;
+    for (size_t i = 0u; i < count; ++i) {
+        time += (gen() % 100u == 0u) ? 2 : 1;
+        if (gen() % 8u == 0u) {
+            centi += change(gen);
+        }
+        times->push_back(time);
+        temps->push_back(Temperature::from_celsius(centi / 100.0));
+    }
+}
+
+void expect_round_trip(const TemperatureSeries &series, const std::vector<int64_t> &times,
+                       const std::vector<Temperature> &temps) {
+    ASSERT_EQ(series.size(), times.size());
+    std::vector<int64_t> got_times;
+    std::vector<Temperature> got_temps;
+    for (size_t b = 0u; b < series.num_blocks(); ++b) {
+        const size_t start = got_times.size();
+        got_times.resize(start + series.block_size(b));
+        got_temps.resize(start + series.block_size(b));
+        series.decode_block(b, got_times.data() + start, got_temps.data() + start);
+    }
+    ASSERT_EQ(got_times, times);
+    for (size_t i = 0u; i < temps.size(); ++i) {
+        const double want = temps[i].kelvin();
+        const double got = got_temps[i].kelvin();
+        ASSERT_EQ(std::memcmp(&want, &got, sizeof want), 0) << i;
+    }
+}
+
+TEST(TemperatureSeriesTests, RoundTrip) {
+    std::vector<int64_t> times;
+    std::vector<Temperature> temps;
+    probe_samples(10000u, &times, &temps);
+    TemperatureSeries series;
+    EXPECT_TRUE(series.empty());
+    for (size_t i = 0u; i < times.size(); ++i) {
+        ASSERT_TRUE(series.append(times[i], temps[i]));
+    }
+    EXPECT_EQ(series.num_blocks(), 10u);
+    EXPECT_EQ(series.block_size(9u), 10000u - 9u * TemperatureSeries::DEFAULT_SAMPLES_PER_BLOCK);
+    expect_round_trip(series, times, temps);
+
+    // Sixteen bytes a sample raw; this should be a tenth of that or better.
+    EXPECT_LT(series.memory_bytes() * 10u, times.size() * 16u) << series.memory_bytes();
+}
+
+TEST(TemperatureSeriesTests, AwkwardValues) {
+    // Every timestamp size class, repeats, negative times, and readings that change every bit.
+    std::mt19937_64 gen(2u);
+    std::vector<int64_t> times;
+    std::vector<Temperature> temps;
+    int64_t time = -5000000000;
+    for (int i = 0; i < 5000; ++i) {
+        const int kind = i % 7;
+        const int64_t step = (kind == 0)   ? 0
+                             : (kind == 1) ? 60
+                             : (kind == 2) ? 250
+                             : (kind == 3) ? 2000
+                             : (kind == 4) ? int64_t{1} << 40
+                                           : static_cast<int64_t>(gen() % 10000u);
+        time += step;
+        times.push_back(time);
+        double kelvin;
+        const uint64_t bits = gen() >> 2;  // Positive and finite.
+        std::memcpy(&kelvin, &bits, sizeof kelvin);
+        temps.push_back(Temperature::from_kelvin((i % 3 == 0) ? 300.0 : kelvin));
+    }
+    temps[17] = Temperature::from_kelvin(NAN);
+    temps[18] = Temperature::from_kelvin(-0.0);
+    temps[19] = Temperature::from_kelvin(INFINITY);
+    for (size_t per_block : {1u, 2u, 3u, 100u, 100000u}) {
+        TemperatureSeries series(per_block);
+        for (size_t i = 0u; i < times.size(); ++i) {
+            ASSERT_TRUE(series.append(times[i], temps[i]));
+        }
+        expect_round_trip(series, times, temps);
+    }
+
+    // The largest gaps either way around.
+    TemperatureSeries series;
+    times = {std::numeric_limits<int64_t>::min(), 0, std::numeric_limits<int64_t>::max(),
+             std::numeric_limits<int64_t>::max()};
+    temps.assign(times.size(), Temperature::freezing());
+    for (size_t i = 0u; i < times.size(); ++i) {
+        ASSERT_TRUE(series.append(times[i], temps[i]));
+    }
+    expect_round_trip(series, times, temps);
+}
+
+TEST(TemperatureSeriesTests, OutOfOrder) {
+    TemperatureSeries series;
+    EXPECT_TRUE(series.append(100, Temperature::freezing()));
+    EXPECT_TRUE(series.append(100, Temperature::boiling()));
+    EXPECT_FALSE(series.append(99, Temperature::body_temp()));
+    EXPECT_TRUE(series.append(101, Temperature::body_temp()));
+    EXPECT_EQ(series.size(), 3u);
+}
+
+TEST(TemperatureSeriesTests, RangesAndSummaries) {
+    std::vector<int64_t> times;
+    std::vector<Temperature> temps;
+    probe_samples(5000u, &times, &temps);
+    TemperatureSeries series(256u);
+    for (size_t i = 0u; i < times.size(); ++i) {
+        series.append(times[i], temps[i]);
+    }
+    for (size_t b = 0u; b < series.num_blocks(); ++b) {
+        EXPECT_LE(series.block_first_time(b), series.block_last_time(b));
+    }
+
+    std::mt19937_64 gen(3u);
+    for (int trial = 0; trial < 200; ++trial) {
+        int64_t begin = times.front() - 10 + static_cast<int64_t>(gen() % 5100u);
+        int64_t end = begin + static_cast<int64_t>(gen() % 3000u);
+        if (trial == 0) {
+            begin = times[256];  // Exactly one whole block.
+            end = times[512];
+        }
+
+        TemperatureSeries::Summary expected;
+        std::vector<int64_t> want_times;
+        for (size_t i = 0u; i < times.size(); ++i) {
+            if (times[i] >= begin && times[i] < end) {
+                expected.add(temps[i]);
+                want_times.push_back(times[i]);
+            }
+        }
+
+        std::vector<int64_t> got_times = {42};  // Results are appended.
+        std::vector<Temperature> got_temps = {Temperature::boiling()};
+        EXPECT_EQ(series.read(begin, end, &got_times, &got_temps), want_times.size());
+        ASSERT_EQ(got_times.size(), want_times.size() + 1u);
+        EXPECT_EQ(got_times[0], 42);
+        EXPECT_TRUE(std::equal(want_times.begin(), want_times.end(), got_times.begin() + 1));
+        EXPECT_EQ(got_temps.size(), got_times.size());
+
+        const auto summary = series.summarize(begin, end);
+        EXPECT_EQ(summary.count, expected.count);
+        if (expected.count != 0u) {
+            EXPECT_EQ(summary.min, expected.min);
+            EXPECT_EQ(summary.max, expected.max);
+            EXPECT_TRUE(summary.mean().almost_equal(expected.mean(), 1e-9));
+        }
+    }
+    EXPECT_EQ(series.summarize(times.back() + 1, times.back() + 100).count, 0u);
+}
+
+}  // namespace djehuti
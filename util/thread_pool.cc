@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/thread_pool.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace djehuti {
+
+ThreadPool::ThreadPool(Options options)
+    : max_queued_(options.max_queued), on_exception_(std::move(options.on_exception)) {
+    const size_t num_threads = options.num_threads != 0u
+                                   ? options.num_threads
+                                   : std::max(1u, std::thread::hardware_concurrency());
+    threads_.reserve(num_threads);
+    for (size_t i = 0u; i < num_threads; ++i) {
+        threads_.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread &thread : threads_) {
+        thread.join();
+    }
+}
+
+bool ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max_queued_ != 0u && tasks_.size() >= max_queued_) {
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+    return true;
+}
+
+size_t ThreadPool::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void ThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        // An exception escaping a thread's function would terminate the process.
+        try {
+            task();
+        } catch (...) {
+            if (on_exception_) {
+                on_exception_(std::current_exception());
+            }
+        }
+    }
+}
+
+}  // namespace djehuti
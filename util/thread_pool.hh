@@ -0,0 +1,80 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace djehuti {
+
+/**
+ * A ThreadPool runs tasks on a fixed set of threads of its own, in the order they're submitted,
+ * so that slow work (such as analyzing a request body) stays off the threads that handed it over.
+ * The queue can be bounded, so that a flood of work is turned away at submit() rather than piling
+ * up without limit.
+ */
+class ThreadPool final {
+ public:
+    struct Options {
+        /// The number of threads, or 0 for one per hardware thread.
+        size_t num_threads = 0u;
+        /// The most tasks waiting for a thread, or 0 for no limit.
+        size_t max_queued = 0u;
+        /// Called on the pool's thread with whatever a task throws, before the thread goes on to
+        /// the next task. If it's not set, the exception is dropped.
+        std::function<void(std::exception_ptr)> on_exception;
+    };
+
+    ThreadPool() : ThreadPool(Options()) {}
+    explicit ThreadPool(Options options);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    /// Runs every task already submitted, then stops the threads.
+    ~ThreadPool();
+
+    /// Queue the task to run on one of the threads, or return false if the queue is full.
+    bool submit(std::function<void()> task);
+
+    /// Returns the number of threads.
+    size_t num_threads() const { return threads_.size(); }
+    /// Returns the number of tasks waiting for a thread.
+    size_t queued() const;
+
+ private:
+    void work();
+
+    const size_t max_queued_;
+    const std::function<void(std::exception_ptr)> on_exception_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace djehuti
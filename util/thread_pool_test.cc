@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/thread_pool.hh"
+
+#include <atomic>
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+
+TEST(ThreadPoolTest, RunsEverything) {
+    std::atomic<int> sum{0};
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    {
+        ThreadPool pool(ThreadPool::Options{4u, 0u, {}});
+        EXPECT_EQ(pool.num_threads(), 4u);
+        for (int i = 1; i <= 1000; ++i) {
+            EXPECT_TRUE(pool.submit([&, i] {
+                sum += i;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }));
+        }
+    }  // The destructor runs whatever is still queued.
+    EXPECT_EQ(sum.load(), 500500);
+    EXPECT_EQ(threads.count(std::this_thread::get_id()), 0u);
+    EXPECT_LE(threads.size(), 4u);
+}
+
+TEST(ThreadPoolTest, Bounded) {
+    ThreadPool pool(ThreadPool::Options{1u, 2u, {}});
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+    ASSERT_TRUE(pool.submit([&] {
+        started.set_value();
+        released.wait();
+    }));
+    started.get_future().wait();  // The thread is busy, and the queue is empty.
+    EXPECT_TRUE(pool.submit([] {}));
+    EXPECT_TRUE(pool.submit([] {}));
+    EXPECT_EQ(pool.queued(), 2u);
+    EXPECT_FALSE(pool.submit([] {}));
+    release.set_value();
+}
+
+TEST(ThreadPoolTest, Throws) {
+    std::atomic<int> ran{0};
+    std::vector<std::string> thrown;  // Only the pool's one thread touches it until it's done.
+    {
+        ThreadPool::Options options;
+        options.num_threads = 1u;
+        options.on_exception = [&thrown](std::exception_ptr exception) {
+            try {
+                std::rethrow_exception(exception);
+            } catch (const std::runtime_error &e) {
+                thrown.push_back(e.what());
+            } catch (int n) {
+                thrown.push_back(std::to_string(n));
+            }
+        };
+        ThreadPool pool(std::move(options));
+        EXPECT_TRUE(pool.submit([] { throw std::runtime_error("oops"); }));
+        EXPECT_TRUE(pool.submit([] { throw 42; }));
+        EXPECT_TRUE(pool.submit([&] { ++ran; }));
+    }
+    EXPECT_EQ(ran.load(), 1);  // The thread survived both to run the last.
+    EXPECT_EQ(thrown, (std::vector<std::string>{"oops", "42"}));
+}
+
+}  // namespace djehuti
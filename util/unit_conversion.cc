@@ -0,0 +1,218 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/unit_conversion.hh"
+
+#include <array>
+#include <charconv>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+#include "util/string_scan.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace units {
+
+namespace {
+
+// A dimension's units, with the conversions between every pair of them.
+template <typename... Units>
+struct Table {
+    static constexpr size_t SIZE = sizeof...(Units);
+
+    template <typename From>
+    static constexpr std::array<RuntimeConversion, SIZE> row() {
+        return {RuntimeConversion::of<From, Units>()...};
+    }
+
+    static constexpr std::array<std::array<RuntimeConversion, SIZE>, SIZE> conversions = {
+        row<Units>()...};
+};
+
+using AngleTable = Table<Radians, Degrees, Turns, Gradians>;
+using TemperatureTable = Table<Kelvin, Celsius, Fahrenheit, Rankine>;
+using FrequencyTable = Table<Hertz, Kilohertz, Megahertz, PerMinute>;
+using IntervalTable = Table<Semitones, Cents, Octaves>;
+
+// A name for the unit at the index in its dimension's table.
+struct UnitName {
+    std::string_view name;
+    size_t index;
+};
+
+constexpr UnitName ANGLE_UNITS[] = {{"radians", 0u}, {"rad", 0u},  {"degrees", 1u},
+                                    {"deg", 1u},     {"turns", 2u}, {"gradians", 3u}};
+constexpr UnitName TEMPERATURE_UNITS[] = {{"kelvin", 0u},     {"k", 0u}, {"celsius", 1u},
+                                          {"c", 1u},          {"fahrenheit", 2u},
+                                          {"f", 2u},          {"rankine", 3u}};
+constexpr UnitName FREQUENCY_UNITS[] = {{"hertz", 0u},     {"hz", 0u},  {"kilohertz", 1u},
+                                        {"khz", 1u},       {"megahertz", 2u},
+                                        {"mhz", 2u},       {"per_minute", 3u},
+                                        {"bpm", 3u},       {"rpm", 3u}};
+constexpr UnitName INTERVAL_UNITS[] = {{"semitones", 0u}, {"cents", 1u}, {"octaves", 2u}};
+
+template <typename TableT, size_t N>
+std::optional<RuntimeConversion> find_in(const UnitName (&names)[N],
+                                         std::string_view from,
+                                         std::string_view to) {
+    const UnitName *from_unit = nullptr;
+    const UnitName *to_unit = nullptr;
+    for (const UnitName &unit : names) {
+        if (unit.name == from) {
+            from_unit = &unit;
+        }
+        if (unit.name == to) {
+            to_unit = &unit;
+        }
+    }
+    if (from_unit == nullptr || to_unit == nullptr) {
+        return std::nullopt;
+    }
+    return TableT::conversions[from_unit->index][to_unit->index];
+}
+
+}  // namespace
+
+std::optional<RuntimeConversion> RuntimeConversion::find(std::string_view dimension,
+                                                         std::string_view from,
+                                                         std::string_view to) {
+    if (dimension == "angle") {
+        return find_in<AngleTable>(ANGLE_UNITS, from, to);
+    }
+    if (dimension == "temperature") {
+        return find_in<TemperatureTable>(TEMPERATURE_UNITS, from, to);
+    }
+    if (dimension == "frequency") {
+        return find_in<FrequencyTable>(FREQUENCY_UNITS, from, to);
+    }
+    if (dimension == "interval") {
+        return find_in<IntervalTable>(INTERVAL_UNITS, from, to);
+    }
+    return std::nullopt;
+}
+
+#if HAVE_X86_SIMD
+
+#define AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+// Converts as many values as fill whole vectors, and returns how many that is. Each step is
+// the same IEEE operation as in the scalar apply() (in particular, not a fused multiply-add), so
+// the results are the same.
+template <bool SUBTRACT, bool MULTIPLY, bool DIVIDE, bool ADD>
+AVX2 size_t apply_avx2(double subtrahend, double factor, double addend, const double *in,
+                       size_t count, double *out) {
+    const __m256d s = _mm256_set1_pd(subtrahend);
+    const __m256d f = _mm256_set1_pd(factor);
+    const __m256d a = _mm256_set1_pd(addend);
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+        __m256d x = _mm256_loadu_pd(in + i);
+        if (SUBTRACT) {
+            x = _mm256_sub_pd(x, s);
+        }
+        if (MULTIPLY) {
+            x = _mm256_mul_pd(x, f);
+        }
+        if (DIVIDE) {
+            x = _mm256_div_pd(x, f);
+        }
+        if (ADD) {
+            x = _mm256_add_pd(x, a);
+        }
+        _mm256_storeu_pd(out + i, x);
+    }
+    return i;
+}
+
+// Picks the kernel for the multiply or divide (or neither), given whether to subtract and add.
+template <bool SUBTRACT, bool ADD>
+AVX2 size_t apply_avx2(bool multiply, bool divide, double subtrahend, double factor,
+                       double addend, const double *in, size_t count, double *out) {
+    if (multiply) {
+        return apply_avx2<SUBTRACT, true, false, ADD>(subtrahend, factor, addend, in, count, out);
+    }
+    if (divide) {
+        return apply_avx2<SUBTRACT, false, true, ADD>(subtrahend, factor, addend, in, count, out);
+    }
+    return apply_avx2<SUBTRACT, false, false, ADD>(subtrahend, factor, addend, in, count, out);
+}
+
+}  // namespace
+
+#endif  // HAVE_X86_SIMD
+
+void RuntimeConversion::apply(const double *in, size_t count, double *out) const {
+    size_t i = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        const bool multiply = op_ == Op::MULTIPLY;
+        const bool divide = op_ == Op::DIVIDE;
+        if (has_subtrahend_) {
+            i = has_addend_ ? apply_avx2<true, true>(multiply, divide, subtrahend_, factor_,
+                                                     addend_, in, count, out)
+                            : apply_avx2<true, false>(multiply, divide, subtrahend_, factor_,
+                                                      addend_, in, count, out);
+        } else {
+            i = has_addend_ ? apply_avx2<false, true>(multiply, divide, subtrahend_, factor_,
+                                                      addend_, in, count, out)
+                            : apply_avx2<false, false>(multiply, divide, subtrahend_, factor_,
+                                                       addend_, in, count, out);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = apply(in[i]);
+    }
+}
+
+std::optional<size_t> convert_list(const RuntimeConversion &conversion,
+                                   std::string_view text,
+                                   std::vector<double> *values,
+                                   string::StringBuilder *out,
+                                   size_t *error_offset) {
+    static const string::SeparatorSet SEPARATORS(" \t\r\n,");
+    values->clear();
+    for (const std::string_view number : string::split_view(text, SEPARATORS)) {
+        double value;
+        const char *const end = number.data() + number.size();
+        const auto result = std::from_chars(number.data(), end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            if (error_offset != nullptr) {
+                *error_offset = static_cast<size_t>(number.data() - text.data());
+            }
+            return std::nullopt;
+        }
+        values->push_back(value);
+    }
+    conversion.apply(values->data(), values->size(), values->data());
+    for (const double value : *values) {
+        out->append(value).append('\n');
+    }
+    return values->size();
+}
+
+}  // namespace units
+}  // namespace djehuti
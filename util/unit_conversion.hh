@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "util/quantity.hh"
+#include "util/string_builder.hh"
+
+namespace djehuti {
+namespace units {
+
+/**
+ * A RuntimeConversion converts values between two units of a dimension chosen at run time, such
+ * as by name. It does just the arithmetic that the compile-time units::convert<From, To> does,
+ * so its results are bit-for-bit the same; converting many values at once uses AVX2 when the
+ * CPU has it.
+ */
+class RuntimeConversion final {
+ public:
+    /**
+     * Returns the conversion between the named units of the named dimension, or nothing if
+     * there's no such dimension or unit. The dimensions are "angle" (radians or rad, degrees or
+     * deg, turns, gradians), "temperature" (kelvin or k, celsius or c, fahrenheit or f,
+     * rankine), "frequency" (hertz or hz, kilohertz or khz, megahertz or mhz, per_minute, bpm
+     * or rpm) and "interval" (semitones, cents, octaves).
+     */
+    static std::optional<RuntimeConversion> find(std::string_view dimension,
+                                                 std::string_view from,
+                                                 std::string_view to);
+
+    /// Returns the conversion from one unit to another.
+    template <typename From, typename To>
+    static constexpr RuntimeConversion of() {
+        using C = Conversion<From, To>;
+        using R = typename C::ratio;
+        constexpr bool has_subtrahend = C::shift::num != 0;
+        constexpr bool has_addend = C::offset::num != 0;
+        constexpr auto make = [](Op op, double factor) {
+            return RuntimeConversion(has_subtrahend, C::subtrahend, op, factor, has_addend,
+                                     C::addend);
+        };
+        if constexpr (R::num == 1 && R::den == 1 && C::pi_power == 0) {
+            return make(Op::IDENTITY, 1.0);
+        } else if constexpr (C::pi_power != 0) {
+            return make(Op::MULTIPLY, C::multiplier);
+        } else if constexpr (R::den == 1) {
+            return make(Op::MULTIPLY, static_cast<double>(R::num));
+        } else if constexpr (R::num == 1) {
+            return make(Op::DIVIDE, static_cast<double>(R::den));
+        } else {
+            return make(Op::MULTIPLY, C::multiplier);
+        }
+    }
+
+    /// Convert a value.
+    constexpr double apply(double x) const {
+        if (has_subtrahend_) {
+            x -= subtrahend_;
+        }
+        const double scaled = op_ == Op::MULTIPLY ? x * factor_ : op_ == Op::DIVIDE ? x / factor_
+                                                                                     : x;
+        return has_addend_ ? scaled + addend_ : scaled;
+    }
+
+    /// Convert count values. The arrays may be the same array, but must not otherwise overlap.
+    void apply(const double *in, size_t count, double *out) const;
+
+ private:
+    enum class Op { IDENTITY, MULTIPLY, DIVIDE };
+
+    constexpr RuntimeConversion(
+            bool has_subtrahend, double subtrahend, Op op, double factor, bool has_addend,
+            double addend)
+        : has_subtrahend_(has_subtrahend),
+          subtrahend_(subtrahend),
+          op_(op),
+          factor_(factor),
+          has_addend_(has_addend),
+          addend_(addend) {}
+
+    bool has_subtrahend_;
+    double subtrahend_;
+    Op op_;
+    double factor_;
+    bool has_addend_;  // Adding zero would turn -0 into +0.
+    double addend_;
+};
+
+/**
+ * Parses the numbers in text, which are separated by whitespace or commas, converts them all in
+ * one pass, and appends them to out, a line each, in the shortest form that reads back as the
+ * same double. values is scratch space, which the caller can keep to reuse its memory; with it
+ * and out warmed up, nothing is allocated. Returns the number of values, or nothing if one
+ * isn't a number, with *error_offset (if it's not null) set to where in the text that is.
+ */
+std::optional<size_t> convert_list(const RuntimeConversion &conversion,
+                                   std::string_view text,
+                                   std::vector<double> *values,
+                                   string::StringBuilder *out,
+                                   size_t *error_offset = nullptr);
+
+}  // namespace units
+}  // namespace djehuti
@@ -0,0 +1,75 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/unit_conversion.hh"
+
+// Converting a request body of 100,000 temperatures: parsing, converting and formatting them
+// with convert_list, against doing it with string streams; and the conversion alone, in bulk
+// and a value at a time.
+
+int main() {
+    using namespace djehuti;
+    constexpr size_t COUNT = 100000u;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-50.0, 150.0);
+    std::string body;
+    for (size_t i = 0u; i < COUNT; ++i) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.2f\n", dist(gen));
+        body += number;
+    }
+    const auto conversion = *units::RuntimeConversion::find("temperature", "celsius", "fahrenheit");
+
+    std::vector<double> values;
+    string::StringBuilder out;
+    benchmark::run("convert_list", [&] {
+        out.clear();
+        benchmark::do_not_optimize(units::convert_list(conversion, body, &values, &out));
+    }, COUNT, body.size());
+    benchmark::run("string streams", [&] {
+        std::istringstream in(body);
+        std::ostringstream converted;
+        double value;
+        while (in >> value) {
+            converted << conversion.apply(value) << '\n';
+        }
+        benchmark::do_not_optimize(converted.str());
+    }, COUNT, body.size());
+
+    std::vector<double> converted(COUNT);
+    benchmark::run("apply, in bulk", [&] {
+        conversion.apply(values.data(), COUNT, converted.data());
+        benchmark::do_not_optimize(converted.data());
+    }, COUNT);
+    benchmark::run("apply, a value at a time", [&] {
+        for (size_t i = 0u; i < COUNT; ++i) {
+            converted[i] = conversion.apply(values[i]);
+            benchmark::do_not_optimize(converted[i]);
+        }
+    }, COUNT);
+    return 0;
+}
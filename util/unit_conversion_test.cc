@@ -0,0 +1,152 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/unit_conversion.hh"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace units {
+
+namespace {
+
+bool same_bits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+// Checks that the conversion found by name gives bit-for-bit what convert<From, To> does, one
+// value at a time and in bulk.
+template <typename From, typename To>
+void check(const char *dimension, const char *from, const char *to) {
+    const auto conversion = RuntimeConversion::find(dimension, from, to);
+    ASSERT_TRUE(conversion.has_value()) << dimension << " " << from << " " << to;
+    std::mt19937_64 gen(1u);
+    std::uniform_real_distribution<double> dist(-1e4, 1e4);
+    std::vector<double> values = {0.0, -0.0, 1.0, -1.0, 1e300, -1e-300, INFINITY, NAN};
+    while (values.size() < 103u) {
+        values.push_back(dist(gen));
+    }
+    std::vector<double> converted(values.size());
+    conversion->apply(values.data(), values.size(), converted.data());
+    for (size_t i = 0u; i < values.size(); ++i) {
+        const double expected = convert<From, To>(values[i]);
+        EXPECT_TRUE(same_bits(conversion->apply(values[i]), expected)) << from << " " << to;
+        EXPECT_TRUE(same_bits(converted[i], expected))
+            << from << " to " << to << ": " << values[i];
+    }
+}
+
+template <typename... Units>
+struct Dimension {
+    template <typename From>
+    static void check_from(const char *dimension, const char *from, const char *const *names) {
+        size_t i = 0u;
+        (check<From, Units>(dimension, from, names[i++]), ...);
+    }
+    static void check_all(const char *dimension, const char *const *names) {
+        size_t i = 0u;
+        (check_from<Units>(dimension, names[i++], names), ...);
+    }
+};
+
+}  // namespace
+
+TEST(UnitConversionTests, SameAsCompileTime) {
+    const char *const angles[] = {"radians", "degrees", "turns", "gradians"};
+    Dimension<Radians, Degrees, Turns, Gradians>::check_all("angle", angles);
+    const char *const temperatures[] = {"kelvin", "celsius", "fahrenheit", "rankine"};
+    Dimension<Kelvin, Celsius, Fahrenheit, Rankine>::check_all("temperature", temperatures);
+    const char *const frequencies[] = {"hertz", "kilohertz", "megahertz", "per_minute"};
+    Dimension<Hertz, Kilohertz, Megahertz, PerMinute>::check_all("frequency", frequencies);
+    const char *const intervals[] = {"semitones", "cents", "octaves"};
+    Dimension<Semitones, Cents, Octaves>::check_all("interval", intervals);
+}
+
+TEST(UnitConversionTests, Names) {
+    EXPECT_DOUBLE_EQ(RuntimeConversion::find("temperature", "c", "f")->apply(37.0), 98.6);
+    EXPECT_DOUBLE_EQ(RuntimeConversion::find("angle", "deg", "rad")->apply(180.0), M_PI);
+    EXPECT_DOUBLE_EQ(RuntimeConversion::find("frequency", "bpm", "hz")->apply(120.0), 2.0);
+    EXPECT_DOUBLE_EQ(RuntimeConversion::find("frequency", "khz", "rpm")->apply(1.0), 60000.0);
+    EXPECT_DOUBLE_EQ(RuntimeConversion::find("interval", "octaves", "cents")->apply(1.5), 1800.0);
+    EXPECT_FALSE(RuntimeConversion::find("length", "m", "ft"));
+    EXPECT_FALSE(RuntimeConversion::find("temperature", "celsius", "degrees"));
+    EXPECT_FALSE(RuntimeConversion::find("angle", "Degrees", "radians"));
+    EXPECT_FALSE(RuntimeConversion::find("angle", "", "radians"));
+}
+
+TEST(UnitConversionTests, ConvertList) {
+    const auto c_to_f = *RuntimeConversion::find("temperature", "celsius", "fahrenheit");
+    std::vector<double> values;
+    string::StringBuilder out;
+    EXPECT_EQ(convert_list(c_to_f, "37 100,-40\n\n0.5e1 ,\t-0", &values, &out), 5u);
+    EXPECT_EQ(out.view(), "98.60000000000001\n212\n-40\n41\n32\n");
+
+    out.clear();
+    EXPECT_EQ(convert_list(c_to_f, "", &values, &out), 0u);
+    EXPECT_EQ(convert_list(c_to_f, " , \n", &values, &out), 0u);
+    EXPECT_TRUE(out.empty());
+
+    // Each value is written so that it reads back as what convert() gives.
+    std::mt19937_64 gen(2u);
+    std::uniform_real_distribution<double> dist(-300.0, 300.0);
+    std::vector<double> celsius;
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.17g\n", dist(gen));
+        text += number;
+        celsius.push_back(std::strtod(number, nullptr));
+    }
+    out.clear();
+    ASSERT_EQ(convert_list(c_to_f, text, &values, &out), 1000u);
+    const std::string written(out.view());
+    const char *p = written.c_str();
+    for (const double c : celsius) {
+        char *end;
+        EXPECT_TRUE(same_bits(std::strtod(p, &end), convert<Celsius, Fahrenheit>(c))) << c;
+        ASSERT_EQ(*end, '\n');
+        p = end + 1;
+    }
+    EXPECT_EQ(*p, '\0');
+}
+
+TEST(UnitConversionTests, BadNumbers) {
+    const auto identity = *RuntimeConversion::find("angle", "rad", "rad");
+    std::vector<double> values;
+    string::StringBuilder out;
+    size_t error = 0u;
+    EXPECT_FALSE(convert_list(identity, "1 2 three 4", &values, &out, &error));
+    EXPECT_EQ(error, 4u);
+    EXPECT_FALSE(convert_list(identity, "1,2x", &values, &out, &error));
+    EXPECT_EQ(error, 2u);
+    EXPECT_FALSE(convert_list(identity, "+1", &values, &out, &error));
+    EXPECT_EQ(error, 0u);
+    EXPECT_FALSE(convert_list(identity, "1 - 3", &values, &out));
+    EXPECT_TRUE(out.empty());
+}
+
+}  // namespace units
+}  // namespace djehuti
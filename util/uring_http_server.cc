@@ -0,0 +1,680 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/uring_http_server.hh"
+
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace djehuti {
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void *arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// The bare minimum of a ring: its submission and completion queues, mapped into our memory.
+class Ring final {
+ public:
+    Ring() = default;
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    ~Ring() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (rings_ != nullptr) {
+            ::munmap(rings_, rings_size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    // Sets the ring up for use by this thread alone, or returns false (with errno set).
+    bool init(unsigned entries) {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER |
+                       IORING_SETUP_DEFER_TASKRUN;
+        params.cq_entries = entries * 4u;
+        fd_ = io_uring_setup(entries, &params);
+        if (fd_ < 0 && errno == EINVAL) {
+            // An older kernel, which can't defer its work to when we ask for completions.
+            params = io_uring_params{};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * 4u;
+            fd_ = io_uring_setup(entries, &params);
+        }
+        if (fd_ < 0) {
+            return false;
+        }
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0u) {
+            errno = ENOSYS;
+            return false;
+        }
+        rings_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                               params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        void *rings = ::mmap(nullptr, rings_size_, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (rings == MAP_FAILED) {
+            return false;
+        }
+        rings_ = static_cast<char *>(rings);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        sq_head_ = reinterpret_cast<unsigned *>(rings_ + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(rings_ + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(rings_ + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned *>(rings_ + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(rings_ + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(rings_ + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(rings_ + params.cq_off.cqes);
+        // The entries are always filled in order, so the indirection array never changes.
+        unsigned *array = reinterpret_cast<unsigned *>(rings_ + params.sq_off.array);
+        for (unsigned i = 0u; i < sq_entries_; ++i) {
+            array[i] = i;
+        }
+        tail_ = *sq_tail_;
+        return true;
+    }
+
+    int fd() const { return fd_; }
+    uint64_t enters() const { return enters_; }
+
+    // Returns a cleared entry to fill in, submitting what's queued first if there's no room.
+    io_uring_sqe *get_sqe() {
+        if (tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            submit_and_wait(0u);
+        }
+        io_uring_sqe *sqe = &sqes_[tail_ & sq_mask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++tail_;
+        return sqe;
+    }
+
+    // Submits everything queued and waits until there are at least wait completions.
+    int submit_and_wait(unsigned wait) {
+        const unsigned to_submit = tail_ - *sq_tail_;
+        __atomic_store_n(sq_tail_, tail_, __ATOMIC_RELEASE);
+        for (;;) {
+            ++enters_;
+            const int result =
+                io_uring_enter(fd_, to_submit, wait, wait != 0u ? IORING_ENTER_GETEVENTS : 0u);
+            if (result >= 0 || errno != EINTR) {
+                return result;
+            }
+        }
+    }
+
+    // Calls fn with each completion there is, and then lets the kernel reuse their slots.
+    template <typename Fn>
+    void for_each_cqe(Fn &&fn) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            fn(cqes_[head & cq_mask_]);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+ private:
+    int fd_ = -1;
+    char *rings_ = nullptr;
+    size_t rings_size_ = 0u;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0u;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0u;
+    unsigned sq_entries_ = 0u;
+    unsigned tail_ = 0u;  // Ours, ahead of sq_tail_ by what we haven't submitted.
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0u;
+    io_uring_cqe *cqes_ = nullptr;
+    uint64_t enters_ = 0u;
+};
+
+// What a completion is for is kept in the top byte of its user_data, and the connection it's
+// for in the rest: its slot, and the slot's generation, so that a completion for a connection
+// that has since closed isn't taken for one for the next connection in the slot.
+enum Op : uint64_t { ACCEPT = 1u, RECV, SEND, CLOSE, CANCEL, WAKE, RESUME_ACCEPT };
+
+uint64_t user_data(Op op, uint32_t slot = 0u, uint32_t generation = 0u) {
+    return (uint64_t{op} << 56) | (uint64_t{generation & 0xffffffu} << 32) | slot;
+}
+
+const char *reason(int status) {
+    switch (status) {
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 413:
+            return "Payload Too Large";
+        case 429:
+            return "Too Many Requests";
+        case 500:
+            return "Internal Server Error";
+        case 501:
+            return "Not Implemented";
+        case 503:
+            return "Service Unavailable";
+        default:
+            return status < 400 ? "OK" : "Error";
+    }
+}
+
+}  // namespace
+
+void UringHttpServer::Response::send(int status,
+                                     std::string_view content_type,
+                                     std::string_view body,
+                                     std::string_view extra_headers) {
+    if (sent_) {
+        return;
+    }
+    sent_ = true;
+    char length[24];
+    const int length_size = std::snprintf(length, sizeof(length), "%zu", body.size());
+    char status_text[8];
+    std::snprintf(status_text, sizeof(status_text), "%03d", status);
+    out_->append("HTTP/1.1 ").append(status_text).append(" ").append(reason(status));
+    out_->append("\r\nContent-Type: ").append(content_type);
+    out_->append("\r\nContent-Length: ").append(length, static_cast<size_t>(length_size));
+    out_->append("\r\n").append(extra_headers);
+    if (!keep_alive_) {
+        out_->append("Connection: close\r\n");
+    }
+    out_->append("\r\n").append(body);
+}
+
+// One thread's ring, its buffers and its connections.
+class UringHttpServer::Loop final : public ServerLoop {
+ public:
+    Loop(const Options &options, const Handler &handler, int listen_fd)
+        : options_(options), handler_(handler), listen_fd_(listen_fd) {}
+
+    ~Loop() {
+        for (Connection &c : connections_) {
+            if (c.in_use) {
+                ::close(c.fd);
+            }
+        }
+        if (buffer_ring_ != nullptr) {
+            ::munmap(buffer_ring_, buffer_ring_size_);
+        }
+        if (buffers_ != nullptr) {
+            ::munmap(buffers_, options_.num_buffers * options_.buffer_size);
+        }
+        if (wake_fd_ >= 0) {
+            ::close(wake_fd_);
+        }
+        ::close(listen_fd_);
+    }
+
+    // Sets up the ring and its buffers, on the thread that will use them. Returns false (with
+    // errno set) if we can't.
+    bool init() override;
+    // Serves until woken.
+    void run() override;
+    // Tells run() to stop; safe from any thread.
+    void wake() override {
+        const uint64_t one = 1u;
+        if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+            // It's a counter, so it can only fail if it's full, and then it's awake anyway.
+        }
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.connections = connections_accepted_.load(std::memory_order_relaxed);
+        stats.requests = requests_.load(std::memory_order_relaxed);
+        stats.enters = enters_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+ private:
+    struct Connection {
+        int fd = -1;
+        uint32_t slot = 0u;  // Where it is in connections_.
+        uint32_t generation = 0u;
+        bool in_use = false;
+        bool receiving = false;  // The multishot recv is armed.
+        bool sending = false;
+        bool closing = false;
+        bool close_after_send = false;
+        std::string input;      // A request we've only had part of.
+        std::string output;     // Responses waiting for the send in flight.
+        std::string in_flight;  // What's being sent.
+        char peer[INET6_ADDRSTRLEN] = "";
+        size_t sent = 0u;
+    };
+
+    void arm_accept() {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd_;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = user_data(ACCEPT);
+    }
+
+    // Stops accepting when we're out of descriptors (or memory), which re-arming at once would
+    // only fail again on, until we close a connection or a little while has passed.
+    void pause_accepting() {
+        accept_paused_ = true;
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->addr = reinterpret_cast<uint64_t>(&ACCEPT_BACKOFF);
+        sqe->len = 1u;
+        sqe->user_data = user_data(RESUME_ACCEPT);
+    }
+
+    void resume_accepting() {
+        if (accept_paused_ && !stopping_) {
+            accept_paused_ = false;
+            arm_accept();
+        }
+    }
+
+    void arm_wake() {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wake_fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+        sqe->len = sizeof(wake_value_);
+        sqe->user_data = user_data(WAKE);
+    }
+
+    void arm_recv(Connection *c) {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = c->fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0u;
+        sqe->user_data = user_data(RECV, c->slot, c->generation);
+        c->receiving = true;
+    }
+
+    void send_output(Connection *c) {
+        if (c->sending || c->output.empty()) {
+            return;
+        }
+        c->in_flight.swap(c->output);
+        c->output.clear();
+        c->sent = 0u;
+        c->sending = true;
+        queue_send(c);
+    }
+
+    void queue_send(Connection *c) {
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = c->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(c->in_flight.data() + c->sent);
+        sqe->len = static_cast<uint32_t>(c->in_flight.size() - c->sent);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = user_data(SEND, c->slot, c->generation);
+    }
+
+    void return_buffer(uint16_t id) {
+        // Not buffer_ring_->bufs: the uapi header's flexible array lands at offset 8 in C++.
+        io_uring_buf &buf = reinterpret_cast<io_uring_buf *>(
+            buffer_ring_)[buffer_tail_ & (options_.num_buffers - 1u)];
+        buf.addr = reinterpret_cast<uint64_t>(buffers_ + size_t{id} * options_.buffer_size);
+        buf.len = static_cast<uint32_t>(options_.buffer_size);
+        buf.bid = id;
+        ++buffer_tail_;
+    }
+
+    void accepted(int fd);
+    void received(Connection *c, std::string_view data);
+    size_t serve(Connection *c, std::string_view data);
+    void close(Connection *c);
+    void release_if_done(Connection *c);
+    void complete(const io_uring_cqe &cqe);
+
+    const Options &options_;
+    const Handler &handler_;
+    const int listen_fd_;
+    Ring ring_;
+    int wake_fd_ = -1;
+    uint64_t wake_value_ = 0u;
+    bool stopping_ = false;
+    bool accept_paused_ = false;
+    static constexpr __kernel_timespec ACCEPT_BACKOFF = {0, 10000000};
+    io_uring_buf_ring *buffer_ring_ = nullptr;
+    size_t buffer_ring_size_ = 0u;
+    char *buffers_ = nullptr;
+    uint16_t buffer_tail_ = 0u;
+    std::deque<Connection> connections_;  // A deque, so connections never move.
+    std::vector<uint32_t> free_slots_;
+    std::atomic<uint64_t> connections_accepted_{0u};
+    std::atomic<uint64_t> requests_{0u};
+    std::atomic<uint64_t> enters_{0u};
+};
+
+bool UringHttpServer::Loop::init() {
+    if (options_.num_buffers == 0u || options_.num_buffers > 32768u ||
+        (options_.num_buffers & (options_.num_buffers - 1u)) != 0u) {
+        errno = EINVAL;
+        return false;
+    }
+    wake_fd_ = ::eventfd(0u, EFD_CLOEXEC);
+    if (wake_fd_ < 0 || !ring_.init(1024u)) {
+        return false;
+    }
+
+    // The receive buffers, and the ring the kernel picks them from.
+    void *buffers = ::mmap(nullptr, options_.num_buffers * options_.buffer_size,
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+        return false;
+    }
+    buffers_ = static_cast<char *>(buffers);
+    buffer_ring_size_ = options_.num_buffers * sizeof(io_uring_buf);
+    void *ring = ::mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        return false;
+    }
+    buffer_ring_ = static_cast<io_uring_buf_ring *>(ring);
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buffer_ring_);
+    reg.ring_entries = static_cast<uint32_t>(options_.num_buffers);
+    reg.bgid = 0u;
+    if (io_uring_register(ring_.fd(), IORING_REGISTER_PBUF_RING, &reg, 1u) != 0) {
+        return false;
+    }
+    for (size_t id = 0u; id < options_.num_buffers; ++id) {
+        return_buffer(static_cast<uint16_t>(id));
+    }
+    __atomic_store_n(&buffer_ring_->tail, buffer_tail_, __ATOMIC_RELEASE);
+    return true;
+}
+
+void UringHttpServer::Loop::run() {
+    arm_accept();
+    arm_wake();
+    while (!stopping_) {
+        if (ring_.submit_and_wait(1u) < 0 && errno != EAGAIN && errno != EBUSY) {
+            break;
+        }
+        ring_.for_each_cqe([this](const io_uring_cqe &cqe) { complete(cqe); });
+        // Give back the buffers we've taken the data from, all at once.
+        __atomic_store_n(&buffer_ring_->tail, buffer_tail_, __ATOMIC_RELEASE);
+        enters_.store(ring_.enters(), std::memory_order_relaxed);
+    }
+}
+
+void UringHttpServer::Loop::complete(const io_uring_cqe &cqe) {
+    const auto op = static_cast<Op>(cqe.user_data >> 56);
+    const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0u;
+    if (op == WAKE) {
+        stopping_ = true;
+        return;
+    }
+    if (op == ACCEPT) {
+        if (cqe.res >= 0) {
+            accepted(cqe.res);
+        }
+        if (!more && !stopping_) {
+            if (cqe.res == -EMFILE || cqe.res == -ENFILE || cqe.res == -ENOBUFS ||
+                cqe.res == -ENOMEM) {
+                pause_accepting();
+            } else {
+                arm_accept();
+            }
+        }
+        return;
+    }
+    if (op == RESUME_ACCEPT) {
+        resume_accepting();
+        return;
+    }
+    if (op != RECV && op != SEND) {
+        return;  // A close or cancel, which we needn't hear about.
+    }
+
+    const bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0u;
+    const auto buffer = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    Connection &c = connections_[cqe.user_data & 0xffffffffu];
+    if (!c.in_use || (c.generation & 0xffffffu) != ((cqe.user_data >> 32) & 0xffffffu)) {
+        if (has_buffer) {
+            return_buffer(buffer);
+        }
+        return;
+    }
+
+    if (op == RECV) {
+        if (!more) {
+            c.receiving = false;
+        }
+        if (cqe.res > 0 && has_buffer) {
+            if (!c.closing) {
+                received(&c, std::string_view(buffers_ + size_t{buffer} * options_.buffer_size,
+                                              static_cast<size_t>(cqe.res)));
+            }
+            return_buffer(buffer);
+        } else if (cqe.res == -ENOBUFS) {
+            // Every buffer is in use; they come back at the end of this batch.
+        } else if (cqe.res <= 0) {
+            close(&c);  // The client closed the connection, or it broke.
+        }
+        if (!c.receiving && !c.closing) {
+            arm_recv(&c);
+        }
+        release_if_done(&c);
+        return;
+    }
+
+    // A send finished.
+    if (cqe.res < 0) {
+        c.sending = false;
+        close(&c);
+        release_if_done(&c);
+        return;
+    }
+    c.sent += static_cast<size_t>(cqe.res);
+    if (c.sent < c.in_flight.size()) {
+        queue_send(&c);
+        return;
+    }
+    c.sending = false;
+    c.in_flight.clear();
+    send_output(&c);
+    if (!c.sending && c.close_after_send) {
+        close(&c);
+    }
+    release_if_done(&c);
+}
+
+void UringHttpServer::Loop::accepted(int fd) {
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    Connection *c;
+    if (!free_slots_.empty()) {
+        c = &connections_[free_slots_.back()];
+        free_slots_.pop_back();
+    } else {
+        connections_.emplace_back();
+        c = &connections_.back();
+        c->slot = static_cast<uint32_t>(connections_.size() - 1u);
+    }
+    c->fd = fd;
+    sockaddr_in addr{};
+    socklen_t addr_size = sizeof(addr);
+    if (::getpeername(fd, reinterpret_cast<sockaddr *>(&addr), &addr_size) != 0 ||
+        ::inet_ntop(AF_INET, &addr.sin_addr, c->peer, sizeof(c->peer)) == nullptr) {
+        c->peer[0] = '\0';
+    }
+    c->in_use = true;
+    connections_accepted_.fetch_add(1u, std::memory_order_relaxed);
+    arm_recv(c);
+}
+
+void UringHttpServer::Loop::received(Connection *c, std::string_view data) {
+    serve_input(&c->input, data, [this, c](std::string_view input) { return serve(c, input); });
+    if (!c->closing && !c->close_after_send && c->input.size() > options_.max_request_bytes) {
+        Response response(&c->output, false);
+        response.send(413, "text/plain", "Request too large\n");
+        c->input.clear();
+        c->close_after_send = true;
+    }
+    if (c->close_after_send) {
+        c->input.clear();
+    }
+    send_output(c);
+    if (!c->sending && c->close_after_send) {
+        close(c);
+    }
+}
+
+size_t UringHttpServer::Loop::serve(Connection *c, std::string_view data) {
+    size_t used = 0u;
+    while (used < data.size() && !c->close_after_send) {
+        HttpRequest request;
+        size_t size;
+        const HttpParse parse = parse_http_request(data.substr(used), &request, &size);
+        if (parse == HttpParse::INCOMPLETE) {
+            break;
+        }
+        request.peer = c->peer;
+        if (parse == HttpParse::BAD) {
+            Response response(&c->output, false);
+            response.send(400, "text/plain", "Bad request\n");
+            c->close_after_send = true;
+            return data.size();
+        }
+        Response response(&c->output, request.keep_alive);
+        handler_(request, &response);
+        if (!response.sent()) {
+            response.send(500, "text/plain", "No response\n");
+        }
+        requests_.fetch_add(1u, std::memory_order_relaxed);
+        used += size;
+        c->close_after_send = !request.keep_alive;
+    }
+    return used;
+}
+
+void UringHttpServer::Loop::close(Connection *c) {
+    if (c->closing) {
+        return;
+    }
+    c->closing = true;
+    if (c->receiving) {
+        // Its last completion comes without IORING_CQE_F_MORE, and then we can let it go.
+        io_uring_sqe *sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = user_data(RECV, c->slot, c->generation);
+        sqe->user_data = user_data(CANCEL);
+    }
+}
+
+void UringHttpServer::Loop::release_if_done(Connection *c) {
+    if (!c->closing || c->receiving || c->sending) {
+        return;
+    }
+    io_uring_sqe *sqe = ring_.get_sqe();
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = c->fd;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = user_data(CLOSE);
+    const uint32_t slot = c->slot;
+    const uint32_t generation = c->generation + 1u;
+    *c = Connection();
+    c->slot = slot;
+    c->generation = generation;
+    free_slots_.push_back(c->slot);
+    resume_accepting();  // The descriptor is on its way back.
+}
+
+UringHttpServer::UringHttpServer(Options options, Handler handler)
+    : options_(std::move(options)), handler_(std::move(handler)) {}
+
+UringHttpServer::~UringHttpServer() { stop(); }
+
+bool UringHttpServer::start() {
+    // Each ring is set up on its own thread, which is the only one that may submit to it.
+    return threads_.start(
+        {options_.address, options_.port, options_.num_threads, options_.pin_threads},
+        [this](int listen_fd) { return std::make_unique<Loop>(options_, handler_, listen_fd); });
+}
+
+void UringHttpServer::wait() { threads_.wait(); }
+
+void UringHttpServer::stop() { threads_.stop(); }
+
+UringHttpServer::Stats UringHttpServer::stats() const {
+    Stats total;
+    for (const auto &loop : threads_.loops()) {
+        const Stats stats = static_cast<const Loop &>(*loop).stats();
+        total.connections += stats.connections;
+        total.requests += stats.requests;
+        total.enters += stats.enters;
+    }
+    return total;
+}
+
+}  // namespace djehuti
@@ -0,0 +1,130 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "util/http_request.hh"
+#include "util/server_threads.hh"
+
+namespace djehuti {
+
+/**
+ * A UringHttpServer is a small HTTP/1.1 server built directly on io_uring (Linux 6.0 or later),
+ * for answering simple requests with as few system calls as we can manage. Each thread has a
+ * ring and a listening socket of its own (with SO_REUSEPORT, so the kernel spreads connections
+ * over them), and from then on:
+ *
+ * - one multishot accept takes every connection;
+ * - one multishot recv per connection takes everything it sends, into buffers from a ring of
+ *   them registered with the kernel (so no buffer is tied up by an idle connection);
+ * - the requests that arrive together are parsed, pipelined or not, and their responses are
+ *   written into one buffer and sent with a single send;
+ * - every operation queued while handling a batch of completions is submitted, and the next
+ *   batch waited for, with a single io_uring_enter.
+ *
+ * Connections are kept alive unless the client says otherwise. The handler is called on the
+ * thread that owns the connection, and must answer before it returns.
+ */
+class UringHttpServer final {
+ public:
+    /// Where a handler writes its response, straight into the connection's output.
+    class Response final {
+     public:
+        /**
+         * Sends the response; extra_headers, if any, are whole header lines each ending in CRLF.
+         * Only the first call counts.
+         */
+        void send(int status,
+                  std::string_view content_type,
+                  std::string_view body,
+                  std::string_view extra_headers = std::string_view());
+
+        bool sent() const { return sent_; }
+
+     private:
+        friend class UringHttpServer;
+        Response(std::string *out, bool keep_alive) : out_(out), keep_alive_(keep_alive) {}
+
+        std::string *out_;
+        bool keep_alive_;
+        bool sent_ = false;
+    };
+
+    using Handler = std::function<void(const HttpRequest &, Response *)>;
+
+    struct Options {
+        /// The address to listen on ("*" or "0.0.0.0" for any), and the port (0 to pick one).
+        std::string address = "0.0.0.0";
+        uint16_t port = 8080u;
+        /// The number of threads, each with its own ring, or 0 for one per hardware thread.
+        size_t num_threads = 0u;
+        /// Whether to pin each thread to a CPU of its own (as far as they go).
+        bool pin_threads = false;
+        /// The number and size of the receive buffers each ring shares among its connections.
+        /// The number must be a power of two.
+        size_t num_buffers = 1024u;
+        size_t buffer_size = 16u << 10;
+        /// The most a request (headers and body) may be; bigger ones get a 413.
+        size_t max_request_bytes = 1u << 20;
+    };
+
+    struct Stats {
+        uint64_t connections = 0u;
+        uint64_t requests = 0u;
+        uint64_t enters = 0u;  // Calls to io_uring_enter, which are nearly all our system calls.
+    };
+
+    UringHttpServer(Options options, Handler handler);
+    UringHttpServer(const UringHttpServer &) = delete;
+    UringHttpServer &operator=(const UringHttpServer &) = delete;
+    /// Stops the server if it's running.
+    ~UringHttpServer();
+
+    /**
+     * Opens the sockets and rings and starts the threads serving them. Returns false (with
+     * errno set) if we can't, such as when the kernel doesn't have what we need.
+     */
+    bool start();
+    /// Returns the port we're listening on, once we've started.
+    uint16_t port() const { return threads_.port(); }
+    /// Waits until the server is stopped (from another thread).
+    void wait();
+    /// Stops serving: the threads drop their connections and finish.
+    void stop();
+
+    /// Returns the counts so far, summed across the threads.
+    Stats stats() const;
+
+ private:
+    class Loop;
+
+    const Options options_;
+    const Handler handler_;
+    ServerThreads threads_;
+};
+
+}  // namespace djehuti
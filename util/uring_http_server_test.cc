@@ -0,0 +1,212 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/uring_http_server.hh"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/http_response.hh"
+
+namespace djehuti {
+
+namespace {
+
+// Echoes the request: its method, path, query and body.
+void echo(const HttpRequest &request, UringHttpServer::Response *response) {
+    std::string body;
+    body.append(request.method).append(" ").append(request.path).append("?");
+    body.append(request.query).append(" ").append(request.body);
+    response->send(request.path == "/missing" ? 404 : 200, "text/plain", body, "X-Echo: yes\r\n");
+}
+
+class Client final {
+ public:
+    explicit Client(uint16_t port) : fd_(::socket(AF_INET, SOCK_STREAM, 0)) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(::connect(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)), 0);
+    }
+    ~Client() { ::close(fd_); }
+
+    void write(const std::string &data) {
+        EXPECT_EQ(::write(fd_, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    // Reads a whole response, returning its status and body (or 0 if the connection closed).
+    std::pair<int, std::string> read_response() {
+        HttpResponseParser parser;
+        std::string response;
+        while (parser.state() == HttpResponseParser::State::INCOMPLETE) {
+            if (pending_.empty()) {
+                char buffer[4096];
+                const ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    return {0, ""};
+                }
+                pending_.assign(buffer, static_cast<size_t>(n));
+            }
+            const size_t used = parser.parse(pending_);
+            response += pending_.substr(0u, used);
+            pending_.erase(0u, used);
+        }
+        EXPECT_EQ(parser.state(), HttpResponseParser::State::COMPLETE);
+        return {parser.status(), response.substr(response.find("\r\n\r\n") + 4u)};
+    }
+
+    bool closed() {
+        char c;
+        return pending_.empty() && ::read(fd_, &c, 1u) == 0;
+    }
+
+ private:
+    int fd_;
+    std::string pending_;
+};
+
+UringHttpServer::Options test_options() {
+    UringHttpServer::Options options;
+    options.address = "127.0.0.1";
+    options.port = 0u;
+    options.num_threads = 2u;
+    options.num_buffers = 16u;
+    options.buffer_size = 64u;  // Small, so requests straddle buffers.
+    options.max_request_bytes = 4096u;
+    return options;
+}
+
+}  // namespace
+
+TEST(UringHttpServerTest, KeepAliveAndPipelining) {
+    UringHttpServer server(test_options(), echo);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    ASSERT_NE(server.port(), 0u);
+    Client client(server.port());
+    client.write("GET /a?x=1 HTTP/1.1\r\nHost: h\r\n\r\n");
+    EXPECT_EQ(client.read_response(), std::make_pair(200, std::string("GET /a?x=1 ")));
+
+    // Three at once, the last in two pieces with a body longer than a buffer.
+    const std::string body(300u, 'b');
+    client.write("GET /b HTTP/1.1\r\n\r\nGET /missing HTTP/1.1\r\n\r\nPOST /c HTTP/1.1\r\n"
+                 "Content-Length: 300\r\n\r\n" + body.substr(0u, 100u));
+    EXPECT_EQ(client.read_response(), std::make_pair(200, std::string("GET /b? ")));
+    EXPECT_EQ(client.read_response(), std::make_pair(404, std::string("GET /missing? ")));
+    client.write(body.substr(100u));
+    EXPECT_EQ(client.read_response(), std::make_pair(200, "POST /c? " + body));
+
+    client.write("GET /last HTTP/1.1\r\nConnection: close\r\n\r\nGET /ignored HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(client.read_response(), std::make_pair(200, std::string("GET /last? ")));
+    EXPECT_TRUE(client.closed());
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.connections, 1u);
+    EXPECT_EQ(stats.requests, 5u);
+    EXPECT_GT(stats.enters, 0u);
+    server.stop();
+}
+
+TEST(UringHttpServerTest, Peer) {
+    UringHttpServer server(test_options(),
+                           [](const HttpRequest &request, UringHttpServer::Response *response) {
+                               response->send(200, "text/plain", request.peer);
+                           });
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    Client client(server.port());
+    client.write("GET / HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(client.read_response(), std::make_pair(200, std::string("127.0.0.1")));
+    server.stop();
+}
+
+TEST(UringHttpServerTest, BadRequests) {
+    UringHttpServer server(test_options(), echo);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+    {
+        Client client(server.port());
+        client.write("NONSENSE\r\n\r\n");
+        EXPECT_EQ(client.read_response().first, 400);
+        EXPECT_TRUE(client.closed());
+    }
+    {
+        Client client(server.port());
+        client.write("POST / HTTP/1.1\r\nContent-Length: 100000\r\n\r\n" + std::string(5000u, 'x'));
+        EXPECT_EQ(client.read_response().first, 413);
+        EXPECT_TRUE(client.closed());
+    }
+    {
+        // Many connections at once, more than there are buffers.
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i < 40; ++i) {
+            clients.push_back(std::make_unique<Client>(server.port()));
+            clients.back()->write("GET /" + std::to_string(i) + " HTTP/1.1\r\n\r\n");
+        }
+        for (int i = 0; i < 40; ++i) {
+            EXPECT_EQ(clients[static_cast<size_t>(i)]->read_response().second,
+                      "GET /" + std::to_string(i) + "? ");
+        }
+    }
+    server.stop();
+    server.stop();  // Stopping twice is harmless.
+}
+
+TEST(UringHttpServerTest, OutOfDescriptors) {
+    UringHttpServer::Options options = test_options();
+    options.num_threads = 1u;
+    UringHttpServer server(options, echo);
+    ASSERT_TRUE(server.start()) << std::strerror(errno);
+
+    // Leave room for just the client's end of a connection, not the server's.
+    rlimit saved;
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+    const int lowest_free = ::dup(0);
+    ::close(lowest_free);
+    rlimit limit = saved;
+    limit.rlim_cur = static_cast<rlim_t>(lowest_free + 1);
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &limit), 0);
+    Client client(server.port());
+
+    // The server can't accept it, and mustn't spin trying.
+    const uint64_t enters = server.stats().enters;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LT(server.stats().enters - enters, 50u);
+    EXPECT_EQ(server.stats().connections, 0u);
+
+    // Once there are descriptors again, it gets to it.
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &saved), 0);
+    client.write("GET /late HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(client.read_response(), std::make_pair(200, std::string("GET /late? ")));
+    EXPECT_EQ(server.stats().connections, 1u);
+    server.stop();
+}
+
+}  // namespace djehuti
@@ -0,0 +1,571 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/utf8.hh"
+
+#include <cstdint>
+#include <cstring>
+
+#include "util/cpu.hh"
+#include "util/platform.hh"
+
+#if HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace djehuti {
+namespace utf8 {
+
+namespace {
+
+// Decodes the code point at p, before end, into *code_point and returns its length, or returns
+// 0 if it isn't valid (Table 3-7 of the Unicode standard).
+inline size_t decode(const unsigned char *p, const unsigned char *end, char32_t *code_point) {
+    const unsigned char b0 = p[0];
+    if (b0 < 0x80u) {
+        *code_point = b0;
+        return 1u;
+    }
+    const auto available = static_cast<size_t>(end - p);
+    if (b0 < 0xc2u) {
+        return 0u;
+    }
+    if (b0 < 0xe0u) {
+        if (available < 2u || (p[1] & 0xc0u) != 0x80u) {
+            return 0u;
+        }
+        *code_point = (char32_t{b0 & 0x1fu} << 6) | (p[1] & 0x3fu);
+        return 2u;
+    }
+    if (b0 < 0xf0u) {
+        const unsigned char lo = (b0 == 0xe0u) ? 0xa0u : 0x80u;
+        const unsigned char hi = (b0 == 0xedu) ? 0x9fu : 0xbfu;
+        if (available < 3u || p[1] < lo || p[1] > hi || (p[2] & 0xc0u) != 0x80u) {
+            return 0u;
+        }
+        *code_point = (char32_t{b0 & 0x0fu} << 12) | (char32_t{p[1] & 0x3fu} << 6) | (p[2] & 0x3fu);
+        return 3u;
+    }
+    if (b0 < 0xf5u) {
+        const unsigned char lo = (b0 == 0xf0u) ? 0x90u : 0x80u;
+        const unsigned char hi = (b0 == 0xf4u) ? 0x8fu : 0xbfu;
+        if (available < 4u || p[1] < lo || p[1] > hi || (p[2] & 0xc0u) != 0x80u ||
+            (p[3] & 0xc0u) != 0x80u) {
+            return 0u;
+        }
+        *code_point = (char32_t{b0 & 0x07u} << 18) | (char32_t{p[1] & 0x3fu} << 12) |
+                      (char32_t{p[2] & 0x3fu} << 6) | (p[3] & 0x3fu);
+        return 4u;
+    }
+    return 0u;
+}
+
+// Encodes the code point into out and returns its length, or returns 0 if it's a surrogate or
+// above U+10FFFF.
+inline size_t encode(char32_t code_point, char *out) {
+    if (code_point < 0x80u) {
+        out[0] = static_cast<char>(code_point);
+        return 1u;
+    }
+    if (code_point < 0x800u) {
+        out[0] = static_cast<char>(0xc0u | (code_point >> 6));
+        out[1] = static_cast<char>(0x80u | (code_point & 0x3fu));
+        return 2u;
+    }
+    if (code_point < 0x10000u) {
+        if (code_point >= 0xd800u && code_point < 0xe000u) {
+            return 0u;
+        }
+        out[0] = static_cast<char>(0xe0u | (code_point >> 12));
+        out[1] = static_cast<char>(0x80u | ((code_point >> 6) & 0x3fu));
+        out[2] = static_cast<char>(0x80u | (code_point & 0x3fu));
+        return 3u;
+    }
+    if (code_point < 0x110000u) {
+        out[0] = static_cast<char>(0xf0u | (code_point >> 18));
+        out[1] = static_cast<char>(0x80u | ((code_point >> 12) & 0x3fu));
+        out[2] = static_cast<char>(0x80u | ((code_point >> 6) & 0x3fu));
+        out[3] = static_cast<char>(0x80u | (code_point & 0x3fu));
+        return 4u;
+    }
+    return 0u;
+}
+
+inline bool is_continuation(char c) { return (static_cast<unsigned char>(c) & 0xc0u) == 0x80u; }
+
+// Appends the code point to out.
+inline void put(char32_t code_point, char32_t *&out) { *out++ = code_point; }
+inline void put(char32_t code_point, char16_t *&out) {
+    if (code_point < 0x10000u) {
+        *out++ = static_cast<char16_t>(code_point);
+    } else {
+        code_point -= 0x10000u;
+        *out++ = static_cast<char16_t>(0xd800u + (code_point >> 10));
+        *out++ = static_cast<char16_t>(0xdc00u + (code_point & 0x3ffu));
+    }
+}
+
+// Decodes the next code point from *p into *out, advancing both; returns false if it's invalid.
+template <typename Char>
+inline bool transcode_one(const unsigned char *&p, const unsigned char *end, Char *&out) {
+    if (*p < 0x80u) {
+        *out++ = *p++;
+        return true;
+    }
+    char32_t code_point;
+    const size_t length = decode(p, end, &code_point);
+    if (length == 0u) {
+        return false;
+    }
+    put(code_point, out);
+    p += length;
+    return true;
+}
+
+// Encodes the next code point from *p into *out, advancing both; returns false if it's invalid.
+inline bool transcode_one(const char32_t *&p, const char32_t *, char *&out) {
+    const size_t length = encode(*p++, out);
+    out += length;
+    return length != 0u;
+}
+
+inline bool transcode_one(const char16_t *&p, const char16_t *end, char *&out) {
+    char32_t code_point = *p++;
+    if (code_point >= 0xd800u && code_point < 0xe000u) {
+        if (code_point >= 0xdc00u || p == end || *p < 0xdc00u || *p >= 0xe000u) {
+            return false;
+        }
+        code_point = 0x10000u + ((code_point - 0xd800u) << 10) + (*p++ - 0xdc00u);
+    }
+    out += encode(code_point, out);
+    return true;
+}
+
+// Transcodes from [p, end) to out, and returns the number of units written or INVALID.
+template <typename From, typename To>
+size_t transcode_scalar(const From *p, const From *end, To *out) {
+    To *const start = out;
+    while (p < end) {
+        if (!transcode_one(p, end, out)) {
+            return INVALID;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+bool is_valid_scalar(const unsigned char *p, const unsigned char *end) {
+    while (p < end) {
+        // Skip ASCII eight bytes at a time.
+        uint64_t word;
+        if (end - p >= 8 && (std::memcpy(&word, p, 8u), (word & 0x8080808080808080u) == 0u)) {
+            p += 8;
+            continue;
+        }
+        char32_t code_point;
+        const size_t length = decode(p, end, &code_point);
+        if (length == 0u) {
+            return false;
+        }
+        p += length;
+    }
+    return true;
+}
+
+#if HAVE_X86_SIMD
+
+#define AVX2 __attribute__((target("avx2")))
+
+// The Keiser-Lemire validator. Each byte is classified by the high and low nibbles of the byte
+// before it and the high nibble of the byte itself; each bit of the classification is one kind
+// of error, so ANDing the three lookups leaves only the errors that all three agree on.
+constexpr uint8_t TOO_SHORT = 1u << 0;     // A lead byte followed by a lead byte or ASCII.
+constexpr uint8_t TOO_LONG = 1u << 1;      // ASCII followed by a continuation byte.
+constexpr uint8_t OVERLONG_3 = 1u << 2;    // E0 followed by 80-9F.
+constexpr uint8_t TOO_LARGE = 1u << 3;     // F4 followed by 90-BF, or F5-FF.
+constexpr uint8_t SURROGATE = 1u << 4;     // ED followed by A0-BF.
+constexpr uint8_t OVERLONG_2 = 1u << 5;    // C0 or C1.
+constexpr uint8_t TOO_LARGE_1000 = 1u << 6;  // F5-FF followed by 80-8F.
+constexpr uint8_t OVERLONG_4 = 1u << 6;    // F0 followed by 80-8F.
+constexpr uint8_t TWO_CONTS = 1u << 7;     // Two continuation bytes in a row.
+constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+AVX2 inline __m256i table(uint8_t t0, uint8_t t1, uint8_t t2, uint8_t t3, uint8_t t4,
+                          uint8_t t5, uint8_t t6, uint8_t t7, uint8_t t8, uint8_t t9,
+                          uint8_t t10, uint8_t t11, uint8_t t12, uint8_t t13, uint8_t t14,
+                          uint8_t t15) {
+    return _mm256_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15,
+                            t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15);
+}
+
+AVX2 inline __m256i high_nibbles(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+}
+
+// Returns the 32 bytes starting N bytes before input (the first N from the end of previous).
+template <int N>
+AVX2 inline __m256i prev(__m256i input, __m256i previous) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+struct Validator {
+    __m256i error;
+    __m256i previous;
+    __m256i previous_incomplete;
+
+    AVX2 void check(__m256i input) {
+        if (_mm256_movemask_epi8(input) == 0) {
+            // All ASCII: only an unfinished sequence at the end of the last block can be wrong.
+            error = _mm256_or_si256(error, previous_incomplete);
+        } else {
+            error = _mm256_or_si256(error, check_lengths(input, check_special_cases(input)));
+            // A lead byte in the last three bytes needs continuation bytes in the next block.
+            previous_incomplete = _mm256_subs_epu8(
+                input, _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1));
+        }
+        previous = input;
+    }
+
+    AVX2 __m256i check_special_cases(__m256i input) const {
+        const __m256i prev1 = prev<1>(input, previous);
+        const __m256i byte_1_high = _mm256_shuffle_epi8(
+            table(TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                  TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT,
+                  TOO_SHORT | OVERLONG_3 | SURROGATE,
+                  TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4),
+            high_nibbles(prev1));
+        const __m256i byte_1_low = _mm256_shuffle_epi8(
+            table(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+                  CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+                  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000),
+            _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)));
+        const __m256i byte_2_high = _mm256_shuffle_epi8(
+            table(TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                  TOO_SHORT,
+                  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+                  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+                  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT,
+                  TOO_SHORT, TOO_SHORT),
+            high_nibbles(input));
+        return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    }
+
+    // The third and fourth bytes of three- and four-byte sequences must be continuation bytes;
+    // those are where TWO_CONTS is expected, so flip it there.
+    AVX2 __m256i check_lengths(__m256i input, __m256i special_cases) const {
+        const __m256i third = _mm256_subs_epu8(prev<2>(input, previous), _mm256_set1_epi8(0x60));
+        const __m256i fourth = _mm256_subs_epu8(prev<3>(input, previous), _mm256_set1_epi8(0x70));
+        const __m256i must_be_continuation =
+            _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(-128));
+        return _mm256_xor_si256(must_be_continuation, special_cases);
+    }
+};
+
+AVX2 bool is_valid_avx2(const char *text, size_t size) {
+    Validator validator{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    size_t i = 0u;
+    for (; i + 32u <= size; i += 32u) {
+        validator.check(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i)));
+    }
+    if (i < size) {
+        // Pad the rest out with ASCII NULs.
+        alignas(32) char last[32] = {};
+        std::memcpy(last, text + i, size - i);
+        validator.check(_mm256_load_si256(reinterpret_cast<const __m256i *>(last)));
+    }
+    const __m256i error = _mm256_or_si256(validator.error, validator.previous_incomplete);
+    return _mm256_testz_si256(error, error);
+}
+
+// Each of these handles as many whole vectors as there are, and returns how many bytes that was.
+
+AVX2 size_t count_code_points_avx2(const char *text, size_t size, size_t *count) {
+    // Continuation bytes are 80-BF, which are -128 to -65 as signed bytes.
+    const __m256i last_continuation = _mm256_set1_epi8(-65);
+    size_t i = 0u;
+    size_t n = 0u;
+    for (; i + 32u <= size; i += 32u) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+        n += __builtin_popcount(
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, last_continuation))));
+    }
+    *count = n;
+    return i;
+}
+
+AVX2 size_t utf16_length_avx2(const char *text, size_t size, size_t *count) {
+    const __m256i last_continuation = _mm256_set1_epi8(-65);
+    // Four-byte leads are F0-FF, which are -16 to -1.
+    const __m256i before_four_byte_lead = _mm256_set1_epi8(-17);
+    size_t i = 0u;
+    size_t n = 0u;
+    for (; i + 32u <= size; i += 32u) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+        const auto leads =
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, last_continuation)));
+        const auto negative = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+        const auto four_byte_leads = negative & static_cast<uint32_t>(_mm256_movemask_epi8(
+                                                    _mm256_cmpgt_epi8(v, before_four_byte_lead)));
+        n += __builtin_popcount(leads) + __builtin_popcount(four_byte_leads);
+    }
+    *count = n;
+    return i;
+}
+
+// Returns true if the 32 bytes at p are all ASCII.
+AVX2 inline bool is_ascii32(const char *p) {
+    return _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))) == 0;
+}
+
+// Widens the 32 ASCII bytes at p.
+AVX2 inline void widen32(const char *p, char32_t *out) {
+    for (size_t k = 0u; k < 4u; ++k) {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + 8u * k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 8u * k),
+                            _mm256_cvtepu8_epi32(bytes));
+    }
+}
+
+AVX2 inline void widen32(const char *p, char16_t *out) {
+    for (size_t k = 0u; k < 2u; ++k) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16u * k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16u * k),
+                            _mm256_cvtepu8_epi16(bytes));
+    }
+}
+
+// Transcodes UTF-8 32 bytes at a time: an all-ASCII block is widened, and any other block is
+// decoded a code point at a time until we're past it, so that text which isn't mostly ASCII
+// doesn't pay for a vector test per code point.
+template <typename To>
+AVX2 size_t transcode_avx2(const unsigned char *p, const unsigned char *end, To *out) {
+    To *const start = out;
+    while (end - p >= 32) {
+        if (is_ascii32(reinterpret_cast<const char *>(p))) {
+            widen32(reinterpret_cast<const char *>(p), out);
+            p += 32;
+            out += 32;
+            continue;
+        }
+        for (const unsigned char *const block_end = p + 32; p < block_end;) {
+            if (!transcode_one(p, end, out)) {
+                return INVALID;
+            }
+        }
+    }
+    while (p < end) {
+        if (!transcode_one(p, end, out)) {
+            return INVALID;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+// Transcodes UTF-32 a code point at a time, except for runs of 8 ASCII characters.
+AVX2 size_t transcode_avx2(const char32_t *p, const char32_t *end, char *out) {
+    char *const start = out;
+    // Pick out the low byte of each code point, into the low eight bytes.
+    const __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                               -1, -1, -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1,
+                                               -1, -1, -1, -1, -1, -1);
+    const __m256i gather = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    const __m256i non_ascii = _mm256_set1_epi32(~0x7f);
+    while (p < end) {
+        if (end - p >= 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            if (_mm256_testz_si256(v, non_ascii)) {
+                const __m256i packed =
+                    _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, low_bytes), gather);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+                p += 8;
+                out += 8;
+                continue;
+            }
+        }
+        if (!transcode_one(p, end, out)) {
+            return INVALID;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+// Transcodes UTF-16 a code point at a time, except for runs of 16 ASCII characters.
+AVX2 size_t transcode_avx2(const char16_t *p, const char16_t *end, char *out) {
+    char *const start = out;
+    const __m256i non_ascii = _mm256_set1_epi16(static_cast<short>(0xff80));
+    while (p < end) {
+        if (end - p >= 16) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            if (_mm256_testz_si256(v, non_ascii)) {
+                const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(v),
+                                                        _mm256_extracti128_si256(v, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), packed);
+                p += 16;
+                out += 16;
+                continue;
+            }
+        }
+        if (!transcode_one(p, end, out)) {
+            return INVALID;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+#endif  // HAVE_X86_SIMD
+
+// Transcodes from [p, end) to out, with AVX2 if we can.
+template <typename From, typename To>
+size_t transcode(const From *p, const From *end, To *out) {
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        return transcode_avx2(p, end, out);
+    }
+#endif
+    return transcode_scalar(p, end, out);
+}
+
+const unsigned char *bytes(std::string_view text) {
+    return reinterpret_cast<const unsigned char *>(text.data());
+}
+
+}  // namespace
+
+bool is_valid(std::string_view text) {
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        return is_valid_avx2(text.data(), text.size());
+    }
+#endif
+    const auto *p = reinterpret_cast<const unsigned char *>(text.data());
+    return is_valid_scalar(p, p + text.size());
+}
+
+size_t count_code_points(std::string_view text) {
+    size_t count = 0u;
+    size_t i = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        i = count_code_points_avx2(text.data(), text.size(), &count);
+    }
+#endif
+    for (; i < text.size(); ++i) {
+        count += !is_continuation(text[i]);
+    }
+    return count;
+}
+
+size_t utf16_length(std::string_view text) {
+    size_t count = 0u;
+    size_t i = 0u;
+#if HAVE_X86_SIMD
+    if (cpu::has_avx2()) {
+        i = utf16_length_avx2(text.data(), text.size(), &count);
+    }
+#endif
+    for (; i < text.size(); ++i) {
+        const auto b = static_cast<unsigned char>(text[i]);
+        count += !is_continuation(text[i]) + (b >= 0xf0u);
+    }
+    return count;
+}
+
+size_t utf8_length(std::u16string_view text) {
+    size_t length = 0u;
+    for (char16_t c : text) {
+        // A surrogate pair is four bytes, two for each half.
+        length += (c < 0x80u) ? 1u : (c < 0x800u || (c >= 0xd800u && c < 0xe000u)) ? 2u : 3u;
+    }
+    return length;
+}
+
+size_t utf8_length(std::u32string_view text) {
+    size_t length = 0u;
+    for (char32_t c : text) {
+        length += (c < 0x80u) ? 1u : (c < 0x800u) ? 2u : (c < 0x10000u) ? 3u : 4u;
+    }
+    return length;
+}
+
+size_t to_utf32(std::string_view text, char32_t *out) {
+    return transcode(bytes(text), bytes(text) + text.size(), out);
+}
+
+size_t to_utf16(std::string_view text, char16_t *out) {
+    return transcode(bytes(text), bytes(text) + text.size(), out);
+}
+
+size_t to_utf8(std::u32string_view text, char *out) {
+    return transcode(text.data(), text.data() + text.size(), out);
+}
+
+size_t to_utf8(std::u16string_view text, char *out) {
+    return transcode(text.data(), text.data() + text.size(), out);
+}
+
+std::optional<std::u32string> to_u32string(std::string_view text) {
+    std::u32string converted(text.size(), U'\0');
+    const size_t size = to_utf32(text, converted.data());
+    if (size == INVALID) {
+        return std::nullopt;
+    }
+    converted.resize(size);
+    return converted;
+}
+
+std::optional<std::u16string> to_u16string(std::string_view text) {
+    std::u16string converted(text.size(), u'\0');
+    const size_t size = to_utf16(text, converted.data());
+    if (size == INVALID) {
+        return std::nullopt;
+    }
+    converted.resize(size);
+    return converted;
+}
+
+std::optional<std::string> to_string(std::u32string_view text) {
+    std::string converted(4u * text.size(), '\0');
+    const size_t size = to_utf8(text, converted.data());
+    if (size == INVALID) {
+        return std::nullopt;
+    }
+    converted.resize(size);
+    return converted;
+}
+
+std::optional<std::string> to_string(std::u16string_view text) {
+    std::string converted(3u * text.size(), '\0');
+    const size_t size = to_utf8(text, converted.data());
+    if (size == INVALID) {
+        return std::nullopt;
+    }
+    converted.resize(size);
+    return converted;
+}
+
+}  // namespace utf8
+}  // namespace djehuti
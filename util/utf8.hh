@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// UTF-8 validation, counting and transcoding. Validation and counting use AVX2 when the CPU has
+// it (validating 32 bytes at a time with the lookup-table method of Keiser and Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte"); the transcoders use it to copy runs of ASCII and
+// decode or encode everything else a code point at a time. Valid UTF-8 here is as the Unicode
+// standard defines it: no overlong forms, no surrogates and nothing above U+10FFFF.
+
+namespace djehuti {
+namespace utf8 {
+
+/// What the transcoders return for invalid input.
+constexpr size_t INVALID = std::string_view::npos;
+
+/// Return true if text is valid UTF-8.
+bool is_valid(std::string_view text);
+
+/// Return the number of code points in text, which should be valid UTF-8 (if it isn't, this
+/// counts the bytes that aren't continuation bytes).
+size_t count_code_points(std::string_view text);
+
+/// Return the number of UTF-16 code units it takes to hold the valid UTF-8 text.
+size_t utf16_length(std::string_view text);
+
+/// Return the number of bytes it takes to hold the valid UTF-16 text as UTF-8.
+size_t utf8_length(std::u16string_view text);
+
+/// Return the number of bytes it takes to hold the valid UTF-32 text as UTF-8.
+size_t utf8_length(std::u32string_view text);
+
+/// Convert UTF-8 to UTF-32, writing count_code_points(text) code points (at most text.size())
+/// to out, and return how many; or return INVALID (having written some) if text isn't valid.
+size_t to_utf32(std::string_view text, char32_t *out);
+
+/// Convert UTF-8 to UTF-16, writing utf16_length(text) code units (at most text.size()) to out,
+/// and return how many; or return INVALID (having written some) if text isn't valid.
+size_t to_utf16(std::string_view text, char16_t *out);
+
+/// Convert UTF-32 to UTF-8, writing utf8_length(text) bytes (at most 4 * text.size()) to out,
+/// and return how many; or return INVALID if text has surrogates or values above U+10FFFF.
+size_t to_utf8(std::u32string_view text, char *out);
+
+/// Convert UTF-16 to UTF-8, writing utf8_length(text) bytes (at most 3 * text.size()) to out,
+/// and return how many; or return INVALID if text has unpaired surrogates.
+size_t to_utf8(std::u16string_view text, char *out);
+
+/// Convert UTF-8 to a UTF-32 string, or return nothing if text isn't valid.
+std::optional<std::u32string> to_u32string(std::string_view text);
+
+/// Convert UTF-8 to a UTF-16 string, or return nothing if text isn't valid.
+std::optional<std::u16string> to_u16string(std::string_view text);
+
+/// Convert UTF-32 to a UTF-8 string, or return nothing if text isn't valid.
+std::optional<std::string> to_string(std::u32string_view text);
+
+/// Convert UTF-16 to a UTF-8 string, or return nothing if text isn't valid.
+std::optional<std::string> to_string(std::u16string_view text);
+
+}  // namespace utf8
+}  // namespace djehuti
@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/benchmark.hh"
+#include "util/utf8.hh"
+
+// UTF-8 validation, counting and transcoding on 1 MB of text of various scripts, with a plain
+// byte-at-a-time validator for comparison.
+
+namespace {
+
+bool byte_at_a_time_valid(std::string_view text) {
+    size_t i = 0u;
+    while (i < text.size()) {
+        const auto b = static_cast<unsigned char>(text[i]);
+        size_t length;
+        char32_t code_point;
+        if (b < 0x80u) {
+            ++i;
+            continue;
+        } else if ((b & 0xe0u) == 0xc0u) {
+            length = 2u;
+            code_point = b & 0x1fu;
+        } else if ((b & 0xf0u) == 0xe0u) {
+            length = 3u;
+            code_point = b & 0x0fu;
+        } else if ((b & 0xf8u) == 0xf0u) {
+            length = 4u;
+            code_point = b & 0x07u;
+        } else {
+            return false;
+        }
+        if (i + length > text.size()) {
+            return false;
+        }
+        for (size_t k = 1u; k < length; ++k) {
+            const auto c = static_cast<unsigned char>(text[i + k]);
+            if ((c & 0xc0u) != 0x80u) {
+                return false;
+            }
+            code_point = (code_point << 6) | (c & 0x3fu);
+        }
+        static const char32_t MIN[] = {0u, 0u, 0x80u, 0x800u, 0x10000u};
+        if (code_point < MIN[length] || code_point > 0x10ffffu ||
+            (code_point >= 0xd800u && code_point < 0xe000u)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+// About a megabyte of text, with code points drawn from [lo, hi) a fraction of the time and
+// ASCII otherwise.
+std::string make_text(double fraction, char32_t lo, char32_t hi) {
+    std::mt19937_64 gen(1u);
+    std::bernoulli_distribution other(fraction);
+    std::uniform_int_distribution<char32_t> ascii(0x20u, 0x7eu);
+    std::uniform_int_distribution<char32_t> range(lo, hi - 1u);
+    std::u32string utf32;
+    std::string text;
+    while (text.size() < (1u << 20)) {
+        utf32.assign(1024u, U'\0');
+        for (auto &c : utf32) {
+            c = other(gen) ? range(gen) : ascii(gen);
+        }
+        text += *djehuti::utf8::to_string(utf32);
+    }
+    return text;
+}
+
+}  // namespace
+
+int main() {
+    using namespace djehuti;
+    const std::pair<const char *, std::string> texts[] = {
+        {"ASCII", make_text(0.0, 0x20u, 0x7fu)},
+        {"Latin", make_text(0.1, 0xc0u, 0x180u)},
+        {"CJK", make_text(1.0, 0x4e00u, 0x9fa0u)},
+        {"emoji", make_text(0.5, 0x1f600u, 0x1f650u)},
+    };
+    for (const auto &named : texts) {
+        const std::string label = named.first;
+        const std::string &text = named.second;
+        const size_t code_points = utf8::count_code_points(text);
+        std::vector<char16_t> utf16(text.size());
+        std::vector<char32_t> utf32(text.size());
+        std::vector<char> back(4u * text.size());
+        const size_t utf16_size = utf8::to_utf16(text, utf16.data());
+        utf8::to_utf32(text, utf32.data());
+
+        benchmark::run(label + ", byte-at-a-time validation", [&] {
+            benchmark::do_not_optimize(byte_at_a_time_valid(text));
+        }, code_points, text.size());
+        benchmark::run(label + ", is_valid", [&] {
+            benchmark::do_not_optimize(utf8::is_valid(text));
+        }, code_points, text.size());
+        benchmark::run(label + ", count_code_points", [&] {
+            benchmark::do_not_optimize(utf8::count_code_points(text));
+        }, code_points, text.size());
+        benchmark::run(label + ", to_utf16", [&] {
+            benchmark::do_not_optimize(utf8::to_utf16(text, utf16.data()));
+        }, code_points, text.size());
+        benchmark::run(label + ", to_utf32", [&] {
+            benchmark::do_not_optimize(utf8::to_utf32(text, utf32.data()));
+        }, code_points, text.size());
+        benchmark::run(label + ", UTF-16 to_utf8", [&] {
+            benchmark::do_not_optimize(
+                utf8::to_utf8(std::u16string_view(utf16.data(), utf16_size), back.data()));
+        }, code_points, text.size());
+        benchmark::run(label + ", UTF-32 to_utf8", [&] {
+            benchmark::do_not_optimize(
+                utf8::to_utf8(std::u32string_view(utf32.data(), code_points), back.data()));
+        }, code_points, text.size());
+    }
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2019 Ben Cox <cox@djehuti.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util/utf8.hh"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace djehuti {
+namespace utf8 {
+
+// An independent check of validity, straight from Table 3-7 of the Unicode standard.
+bool reference_valid(std::string_view text) {
+    struct Sequence {
+        unsigned char lead_lo, lead_hi, second_lo, second_hi;
+        size_t length;
+    };
+    static const Sequence SEQUENCES[] = {
+        {0x00, 0x7f, 0, 0, 1},          {0xc2, 0xdf, 0x80, 0xbf, 2},
+        {0xe0, 0xe0, 0xa0, 0xbf, 3},    {0xe1, 0xec, 0x80, 0xbf, 3},
+        {0xed, 0xed, 0x80, 0x9f, 3},    {0xee, 0xef, 0x80, 0xbf, 3},
+        {0xf0, 0xf0, 0x90, 0xbf, 4},    {0xf1, 0xf3, 0x80, 0xbf, 4},
+        {0xf4, 0xf4, 0x80, 0x8f, 4},
+    };
+    const auto byte = [&text](size_t i) { return static_cast<unsigned char>(text[i]); };
+    size_t i = 0u;
+    while (i < text.size()) {
+        const Sequence *found = nullptr;
+        for (const auto &sequence : SEQUENCES) {
+            if (byte(i) >= sequence.lead_lo && byte(i) <= sequence.lead_hi) {
+                found = &sequence;
+            }
+        }
+        if (found == nullptr || i + found->length > text.size()) {
+            return false;
+        }
+        if (found->length > 1u &&
+            (byte(i + 1u) < found->second_lo || byte(i + 1u) > found->second_hi)) {
+            return false;
+        }
+        for (size_t k = 2u; k < found->length; ++k) {
+            if (byte(i + k) < 0x80u || byte(i + k) > 0xbfu) {
+                return false;
+            }
+        }
+        i += found->length;
+    }
+    return true;
+}
+
+// Checks text against the reference, by itself, at the end of a vector's worth of ASCII so that
+// it straddles a vector boundary, and followed by more ASCII.
+void expect_valid_as_reference(const std::string &text) {
+    const bool expected = reference_valid(text);
+    ASSERT_EQ(is_valid(text), expected) << testing::PrintToString(text);
+    std::vector<char32_t> out(text.size() + 64u);
+    ASSERT_EQ(to_utf32(text, out.data()) != INVALID, expected) << testing::PrintToString(text);
+    const std::string straddling = std::string(31u, 'x') + text;
+    ASSERT_EQ(is_valid(straddling), expected) << testing::PrintToString(text);
+    ASSERT_EQ(is_valid(straddling + std::string(40u, 'y')), expected)
+        << testing::PrintToString(text);
+}
+
+TEST(Utf8Tests, ExhaustiveShort) {
+    std::string text;
+    for (int a = 0; a < 256; ++a) {
+        text.assign(1u, static_cast<char>(a));
+        expect_valid_as_reference(text);
+        for (int b = 0; b < 256; ++b) {
+            text.assign({static_cast<char>(a), static_cast<char>(b)});
+            expect_valid_as_reference(text);
+        }
+    }
+}
+
+TEST(Utf8Tests, ExhaustiveThreeBytes) {
+    // All 2^24 three-byte strings, by themselves and straddling a vector boundary.
+    std::string buffer(64u, 'x');
+    std::vector<char32_t> out(64u);
+    for (uint32_t n = 0u; n < (1u << 24); ++n) {
+        buffer[30] = static_cast<char>(n >> 16);
+        buffer[31] = static_cast<char>(n >> 8);
+        buffer[32] = static_cast<char>(n);
+        const std::string_view alone(buffer.data() + 30, 3u);
+        const bool expected = reference_valid(alone);
+        ASSERT_EQ(is_valid(alone), expected) << std::hex << n;
+        ASSERT_EQ(is_valid(std::string_view(buffer.data(), 40u)), expected) << std::hex << n;
+        if (n % 16u == 0u) {
+            ASSERT_EQ(to_utf16(alone, reinterpret_cast<char16_t *>(out.data())) != INVALID,
+                      expected)
+                << std::hex << n;
+        }
+    }
+}
+
+TEST(Utf8Tests, FourBytes) {
+    const unsigned char interesting[] = {0x00, 0x7f, 0x80, 0x8f, 0x90,
+                                         0x9f, 0xa0, 0xbf, 0xc0, 0xff};
+    std::string text(4u, '\0');
+    for (int lead = 0xe0; lead < 0x100; ++lead) {
+        for (int second = 0; second < 256; ++second) {
+            for (unsigned char third : interesting) {
+                for (unsigned char fourth : interesting) {
+                    text[0] = static_cast<char>(lead);
+                    text[1] = static_cast<char>(second);
+                    text[2] = static_cast<char>(third);
+                    text[3] = static_cast<char>(fourth);
+                    expect_valid_as_reference(text);
+                }
+            }
+        }
+    }
+}
+
+TEST(Utf8Tests, Boundaries) {
+    EXPECT_TRUE(is_valid(""));
+    EXPECT_TRUE(is_valid("plain ASCII"));
+    EXPECT_TRUE(is_valid("\x7f\xc2\x80\xdf\xbf\xe0\xa0\x80\xef\xbf\xbf"
+                         "\xf0\x90\x80\x80\xf4\x8f\xbf\xbf"));
+    EXPECT_FALSE(is_valid("\xc0\xaf"));          // Overlong '/'.
+    EXPECT_FALSE(is_valid("\xe0\x9f\xbf"));      // Overlong U+07FF.
+    EXPECT_FALSE(is_valid("\xf0\x8f\xbf\xbf"));  // Overlong U+FFFF.
+    EXPECT_FALSE(is_valid("\xed\xa0\x80"));      // U+D800.
+    EXPECT_FALSE(is_valid("\xed\xbf\xbf"));      // U+DFFF.
+    EXPECT_TRUE(is_valid("\xed\x9f\xbf"));       // U+D7FF.
+    EXPECT_TRUE(is_valid("\xee\x80\x80"));       // U+E000.
+    EXPECT_FALSE(is_valid("\xf4\x90\x80\x80"));  // U+110000.
+    EXPECT_FALSE(is_valid("\xf8\x88\x80\x80\x80"));
+
+    // Every multi-byte sequence cut short, at every position relative to the vectors.
+    for (const std::string sequence : {"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80"}) {
+        for (size_t cut = 1u; cut < sequence.size(); ++cut) {
+            for (size_t padding = 0u; padding < 70u; ++padding) {
+                const std::string ascii(padding, 'a');
+                EXPECT_FALSE(is_valid(ascii + sequence.substr(0u, cut))) << padding << " " << cut;
+                EXPECT_FALSE(is_valid(ascii + sequence.substr(0u, cut) + "b")) << padding;
+                EXPECT_TRUE(is_valid(ascii + sequence)) << padding;
+                // A continuation byte by itself, and one too many.
+                EXPECT_FALSE(is_valid(ascii + sequence.substr(cut))) << padding << " " << cut;
+                EXPECT_FALSE(is_valid(ascii + sequence + sequence.substr(cut))) << padding;
+            }
+        }
+    }
+}
+
+std::u32string random_code_points(std::mt19937_64 &gen, size_t count) {
+    // Mostly ASCII, with some of each length, and the edges of each range.
+    static const char32_t EDGES[] = {0x7f,   0x80,   0x7ff,   0x800,   0xd7ff,  0xe000,
+                                     0xfffd, 0xffff, 0x10000, 0xfffff, 0x10ffff};
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::u32string text;
+    for (size_t i = 0u; i < count; ++i) {
+        switch (kind(gen)) {
+            case 0:
+                text.push_back(EDGES[gen() % std::size(EDGES)]);
+                break;
+            case 1:
+                text.push_back(0x80u + gen() % 0x780u);
+                break;
+            case 2:
+                text.push_back(0x800u + gen() % (0xd800u - 0x800u));
+                break;
+            case 3:
+                text.push_back(0x10000u + gen() % 0x100000u);
+                break;
+            default:
+                text.push_back(gen() % 0x80u);
+                break;
+        }
+    }
+    return text;
+}
+
+TEST(Utf8Tests, RoundTrips) {
+    std::mt19937_64 gen(1u);
+    for (size_t count : {0u, 1u, 7u, 8u, 9u, 31u, 32u, 33u, 100u, 1000u, 10000u}) {
+        const std::u32string utf32 = random_code_points(gen, count);
+        const auto utf8 = to_string(utf32);
+        ASSERT_TRUE(utf8.has_value());
+        ASSERT_TRUE(is_valid(*utf8));
+        ASSERT_TRUE(reference_valid(*utf8));
+        EXPECT_EQ(utf8->size(), utf8_length(utf32));
+        EXPECT_EQ(count_code_points(*utf8), count);
+        EXPECT_EQ(to_u32string(*utf8), utf32);
+
+        const auto utf16 = to_u16string(*utf8);
+        ASSERT_TRUE(utf16.has_value());
+        EXPECT_EQ(utf16->size(), utf16_length(*utf8));
+        EXPECT_EQ(utf8_length(*utf16), utf8->size());
+        EXPECT_EQ(to_string(*utf16), utf8);
+    }
+    // Long runs of ASCII take the vector paths.
+    const std::string ascii(1000u, 'q');
+    EXPECT_EQ(to_u32string(ascii), std::u32string(1000u, U'q'));
+    EXPECT_EQ(to_u16string(ascii), std::u16string(1000u, u'q'));
+    EXPECT_EQ(to_string(std::u32string(1000u, U'q')), ascii);
+    EXPECT_EQ(to_string(std::u16string(1000u, u'q')), ascii);
+}
+
+TEST(Utf8Tests, Invalid) {
+    EXPECT_FALSE(to_u32string("ok\xff").has_value());
+    EXPECT_FALSE(to_u16string(std::string(100u, 'a') + "\xe2\x82").has_value());
+    EXPECT_FALSE(to_string(std::u32string{U'a', 0xd800u}).has_value());
+    EXPECT_FALSE(to_string(std::u32string{0x110000u}).has_value());
+    EXPECT_FALSE(to_string(std::u16string{u'a', 0xd800u}).has_value());         // High at the end.
+    EXPECT_FALSE(to_string(std::u16string{0xd800u, u'a'}).has_value());         // Unpaired high.
+    EXPECT_FALSE(to_string(std::u16string{0xdc00u, 0xd800u}).has_value());      // Backwards.
+    EXPECT_EQ(to_string(std::u16string{0xd83du, 0xde00u}), "\xf0\x9f\x98\x80");  // U+1F600.
+}
+
+TEST(Utf8Tests, Fuzz) {
+    // Valid text with a byte or two changed, checked against the reference.
+    std::mt19937_64 gen(2u);
+    for (int trial = 0; trial < 3000; ++trial) {
+        std::string text = *to_string(random_code_points(gen, gen() % 200u));
+        for (int changes = trial % 3; changes > 0 && !text.empty(); --changes) {
+            text[gen() % text.size()] = static_cast<char>(gen());
+        }
+        expect_valid_as_reference(text);
+    }
+}
+
+}  // namespace utf8
+}  // namespace djehuti